@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+# /// script
+# requires-python = ">=3.10"
+# ///
+"""
+HoloCube broadcast: draw on every cube of the LAN with one multicast datagram
+
+Cubes with the broadcast listener on (/api/v1/config/broadcast) join one
+multicast group and apply the draw packets addressed to group 0 or to one of
+their groups. Each group is a sequence: a cube that misses a packet sends a NACK
+back to this sender, which sends the missing packets again (unicast, to that
+cube only). The cost of an update is one datagram however many cubes show it.
+
+    from holocast import Caster, rect, text, clear
+
+    caster = Caster()
+    caster.send(group=1, commands=[clear(0x000000), text(20, 100, "21.5 C", size=4, color=0xFFFFFF)], key=True)
+
+Commands are dicts as in /api/v1/draw/batch (clear, rect, roundrect, circle,
+ellipse, line, lineaa, thickline, arc, pixel, triangle, text, push_clip,
+pop_clip, translate), colors are 0xRRGGBB. A key packet redraws the whole
+screen: a cube that missed packets before it skips them instead of asking.
+
+Usage:
+    uv run --script holocast.py clock --group 1 [--seconds 30]
+    uv run --script holocast.py bench --group 1 [--count 200]
+"""
+
+import argparse
+import select
+import socket
+import struct
+import time
+
+DEFAULT_ADDRESS = "239.72.67.1"
+DEFAULT_PORT = 4210
+VERSION = 1
+MAX_PACKET = 1400
+HISTORY = 256
+
+FLAG_KEY = 1 << 0
+FLAG_RETRANSMIT = 1 << 1
+
+CMD_FILL = 1 << 0
+CMD_COLOR = 1 << 1
+CMD_BG = 1 << 2
+CMD_ALPHA = 1 << 3
+CMD_CLEAR_BG = 1 << 4
+CAPS = {"butt": 0, "square": 1, "round": 2}
+
+# Command code and argument names, as in include/display/DrawPacket.h
+OPS = {
+    "clear": (0x01, []),
+    "rect": (0x02, ["x", "y", "w", "h"]),
+    "roundrect": (0x03, ["x", "y", "w", "h", "r"]),
+    "circle": (0x04, ["x", "y", "r"]),
+    "ellipse": (0x05, ["x", "y", "rx", "ry"]),
+    "line": (0x06, ["x0", "y0", "x1", "y1"]),
+    "lineaa": (0x07, ["x0", "y0", "x1", "y1"]),
+    "thickline": (0x08, ["x0", "y0", "x1", "y1", "width"]),
+    "arc": (0x09, ["x", "y", "r", "thickness", "start", "sweep"]),
+    "pixel": (0x0A, ["x", "y"]),
+    "triangle": (0x0B, ["x0", "y0", "x1", "y1", "x2", "y2"]),
+    "text": (0x0C, ["x", "y"]),
+    "push_clip": (0x10, ["x", "y", "w", "h"]),
+    "pop_clip": (0x11, []),
+    "translate": (0x12, ["x", "y"]),
+}
+
+
+def rgb565(rgb: int) -> int:
+    r, g, b = (rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def clear(color: int | None = None) -> dict:
+    return {"type": "clear"} if color is None else {"type": "clear", "color": color, "fill": True}
+
+
+def rect(x: int, y: int, w: int, h: int, color: int, fill: bool = True) -> dict:
+    return {"type": "rect", "x": x, "y": y, "w": w, "h": h, "color": color, "fill": fill}
+
+
+def text(x: int, y: int, value: str, size: int = 2, color: int = 0xFFFFFF, bg: int | None = None) -> dict:
+    cmd = {"type": "text", "x": x, "y": y, "text": value, "size": size, "color": color}
+    if bg is not None:
+        cmd["bg"] = bg
+    return cmd
+
+
+def encode_command(cmd: dict, current_color: int | None) -> tuple[bytes, int | None]:
+    """One command, and the color the next command inherits"""
+    code, arg_names = OPS[cmd["type"]]
+    flags = CMD_FILL if cmd.get("fill") else 0
+    flags |= CAPS[cmd.get("cap", "butt")] << 5
+    if cmd.get("clear"):
+        flags |= CMD_CLEAR_BG
+
+    tail = b""
+    color = rgb565(cmd["color"]) if "color" in cmd else current_color
+    if color is not None and color != current_color:
+        flags |= CMD_COLOR
+        tail += struct.pack("<H", color)
+    if "bg" in cmd:
+        flags |= CMD_BG
+        tail += struct.pack("<H", rgb565(cmd["bg"]))
+    if "alpha" in cmd:
+        flags |= CMD_ALPHA
+        tail += struct.pack("<B", cmd["alpha"])
+    if cmd["type"] == "text":
+        tail += struct.pack("<B", cmd.get("size", 2)) + cmd["text"].encode("latin-1") + b"\0"
+
+    args = struct.pack(f"<{len(arg_names)}h", *(int(cmd.get(name, 0)) for name in arg_names))
+    return struct.pack("<BB", code, flags) + args + tail, color
+
+
+def encode_packet(group: int, sequence: int, commands: list[dict], key: bool = False) -> bytes:
+    body = b""
+    color = 0xFFFF  # the device starts each packet in white
+    for cmd in commands:
+        encoded, color = encode_command(cmd, color)
+        body += encoded
+    packet = b"HD" + struct.pack("<BBHIH", VERSION, FLAG_KEY if key else 0, group, sequence, len(commands)) + body
+    if len(packet) > MAX_PACKET:
+        raise ValueError(f"packet is {len(packet)} bytes, {MAX_PACKET} at most")
+    return packet
+
+
+class Caster:
+    """Multicast sender keeping the last packets of each group for retransmission"""
+
+    def __init__(self, address: str = DEFAULT_ADDRESS, port: int = DEFAULT_PORT, ttl: int = 1):
+        self.target = (address, port)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, ttl)
+        self.sequences: dict[int, int] = {}
+        self.history: dict[tuple[int, int], bytes] = {}
+        self.retransmitted = 0
+
+    def send(self, group: int, commands: list[dict], key: bool = False) -> int:
+        sequence = self.sequences.get(group, int(time.time()) & 0xFFFF) + 1
+        self.sequences[group] = sequence
+        packet = encode_packet(group, sequence, commands, key)
+        self.history[(group, sequence)] = packet
+        self.history.pop((group, sequence - HISTORY), None)
+        self.sock.sendto(packet, self.target)
+        self.serve_nacks(0)
+        return sequence
+
+    def serve_nacks(self, timeout: float) -> None:
+        """Answer the NACKs that arrived, waiting up to timeout seconds for the first one"""
+        while select.select([self.sock], [], [], timeout)[0]:
+            timeout = 0
+            data, peer = self.sock.recvfrom(64)
+            if len(data) != 12 or data[:2] != b"HN":
+                continue
+            _, _, group, first, count = struct.unpack("<BBHIH", data[2:])
+            for sequence in range(first, first + count):
+                packet = self.history.get((group, sequence))
+                if packet is not None:
+                    resent = packet[:3] + bytes((packet[3] | FLAG_RETRANSMIT,)) + packet[4:]
+                    self.sock.sendto(resent, peer)
+                    self.retransmitted += 1
+
+
+def clock(caster: Caster, group: int, seconds: float) -> None:
+    caster.send(group, [clear(0x000000), text(30, 60, "HoloCast", size=3, color=0x4080FF)], key=True)
+    end = time.time() + seconds
+    while time.time() < end:
+        now = time.strftime("%H:%M:%S")
+        caster.send(group, [text(24, 110, now, size=4, color=0xFFFFFF, bg=0x000000)])
+        caster.serve_nacks(1.0)
+    print(f"retransmitted {caster.retransmitted} packets")
+
+
+def bench(caster: Caster, group: int, count: int) -> None:
+    caster.send(group, [clear(0x000000)], key=True)
+    start = time.perf_counter()
+    for i in range(count):
+        caster.send(group, [rect(0, 100, 240, 40, 0x000000), text(20, 110, f"update {i}", size=3)])
+        caster.serve_nacks(0.01)
+    elapsed = time.perf_counter() - start
+    print(f"{count} updates in {elapsed:.2f} s ({count / elapsed:.0f}/s), one datagram each for every cube")
+    print(f"retransmitted {caster.retransmitted} packets, see /api/v1/metrics 'broadcast' on each cube")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="HoloCube multicast draw sender")
+    parser.add_argument("command", choices=["clock", "bench"])
+    parser.add_argument("--group", type=int, default=0, help="0 reaches every cube")
+    parser.add_argument("--address", default=DEFAULT_ADDRESS)
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT)
+    parser.add_argument("--seconds", type=float, default=30.0)
+    parser.add_argument("--count", type=int, default=200)
+    args = parser.parse_args()
+
+    caster = Caster(args.address, args.port)
+    if args.command == "clock":
+        clock(caster, args.group, args.seconds)
+    else:
+        bench(caster, args.group, args.count)
+
+
+if __name__ == "__main__":
+    main()
@@ -752,14 +752,21 @@ class HoloCube:
         """List available GIFs"""
         return self._get("/api/v1/gif")
 
-    def play_gif(self, name: str) -> dict:
-        """Play a GIF by name"""
-        return self._post("/api/v1/gif/play", {"name": name})
+    def play_gif(self, name: str, at: Optional[int] = None, frame: int = 0) -> dict:
+        """Play a GIF by name, or loop it from frame at sync time at (microseconds, see sync())"""
+        body = {"name": name}
+        if at is not None:
+            body.update({"at": at, "frame": frame})
+        return self._post("/api/v1/gif/play", body)
 
     def stop_gif(self) -> dict:
         """Stop GIF playback"""
         return self._post("/api/v1/gif/stop", {})
 
+    def sync(self) -> dict:
+        """Get the sync clock and the frame deadlines met by the synced GIF"""
+        return self._get("/api/v1/sync")
+
     # =========================================================================
     # System
     # =========================================================================
@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+# /// script
+# requires-python = ">=3.10"
+# dependencies = ["requests"]
+# ///
+"""
+HoloCube scripts: assembler for the on-device bytecode VM, upload and VM benchmark
+
+Scripts run on the device from loop(), a few thousand instructions per tick, so
+a clock or a gauge keeps updating with no host attached. This tool assembles the
+text form below into the bytecode file the firmware verifies and stores.
+
+    ; a seconds counter
+    var secs
+    const Y 100
+
+            push #000000
+            color
+            clear                 ; in the current color
+            push 1000
+            timerset 0            ; timer 0 fires every second
+    loop:   timerdue 0
+            jz wait
+            load secs
+            push 1
+            add
+            dup
+            store secs
+            push #ffffff
+            color
+            push 4
+            size
+            push 60               ; x
+            push Y                ; y
+            number                ; pops x and y, then the value
+            text_at 60 140 "seconds"
+    wait:   yield
+            jmp loop
+
+One instruction per line, "label:" before it if needed. Operands: numbers
+(decimal, 0x hex, #rrggbb colors converted to RGB565), "var" and "const" names,
+labels, input names (input millis) and "strings" (text "Hi" pops x, y).
+"text_at x y "..."" is shorthand for push x, push y, text.
+
+Usage:
+    uv run --script holoscript.py asm clock.hs clock.hsc
+    uv run --script holoscript.py upload clock.hs --name clock [--run] [--ip 192.168.7.80]
+    uv run --script holoscript.py bench [--ip 192.168.7.80] [--seconds 5]
+"""
+
+import argparse
+import re
+import shlex
+import struct
+import sys
+import time
+
+import requests
+
+MAGIC = b"HSCR"
+FORMAT_VERSION = 1
+MAX_CODE = 4096
+MAX_STRINGS = 1024
+MAX_GLOBALS = 32
+TIMERS = 4
+COUNTERS = 8
+
+# Opcode numbers and operand kinds, as in include/script/ScriptVm.h
+OPCODES = {
+    "halt": (0x00, None), "nop": (0x01, None),
+    "load": (0x05, "global"), "store": (0x06, "global"),
+    "dup": (0x07, None), "drop": (0x08, None), "swap": (0x09, None), "over": (0x0A, None),
+    "add": (0x10, None), "sub": (0x11, None), "mul": (0x12, None), "div": (0x13, None), "mod": (0x14, None),
+    "neg": (0x15, None), "and": (0x16, None), "or": (0x17, None), "xor": (0x18, None), "not": (0x19, None),
+    "shl": (0x1A, None), "shr": (0x1B, None), "eq": (0x1C, None), "ne": (0x1D, None), "lt": (0x1E, None),
+    "le": (0x1F, None), "gt": (0x20, None), "ge": (0x21, None), "min": (0x22, None), "max": (0x23, None),
+    "lnot": (0x24, None),
+    "jmp": (0x30, "label"), "jz": (0x31, "label"), "jnz": (0x32, "label"), "call": (0x33, "label"),
+    "ret": (0x34, None),
+    "yield": (0x38, None), "sleep": (0x39, None), "timerset": (0x3A, "timer"), "timerdue": (0x3B, "timer"),
+    "input": (0x40, "input"),
+    "color": (0x48, None), "bg": (0x49, None), "size": (0x4A, None),
+    "clear": (0x50, None), "rect": (0x51, None), "fillrect": (0x52, None), "circle": (0x53, None),
+    "fillcircle": (0x54, None), "line": (0x55, None), "lineaa": (0x56, None), "thickline": (0x57, None),
+    "pixel": (0x58, None), "triangle": (0x59, None), "filltriangle": (0x5A, None), "ellipse": (0x5B, None),
+    "fillellipse": (0x5C, None), "roundrect": (0x5D, None), "fillroundrect": (0x5E, None), "arc": (0x5F, None),
+    "text": (0x60, "string"), "number": (0x61, None),
+}
+PUSH8, PUSH16, PUSH32 = 0x02, 0x03, 0x04
+
+INPUTS = ["millis", "uptime", "wifi", "rssi", "freeheap", "width", "height", "random", "ticks"] + [
+    f"counter{i}" for i in range(COUNTERS)
+]
+
+LABEL_RE = re.compile(r"^([A-Za-z_]\w*):")
+
+
+class AsmError(Exception):
+    pass
+
+
+def to_rgb565(hex_color: str) -> int:
+    value = int(hex_color[1:], 16)
+    r, g, b = (value >> 16) & 0xFF, (value >> 8) & 0xFF, value & 0xFF
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def push_bytes(value: int) -> bytes:
+    """Shortest push for a value"""
+    if -128 <= value <= 127:
+        return struct.pack("<Bb", PUSH8, value)
+    if -32768 <= value <= 32767:
+        return struct.pack("<Bh", PUSH16, value)
+    if -(1 << 31) <= value < (1 << 32):
+        return struct.pack("<BI", PUSH32, value & 0xFFFFFFFF)
+    raise AsmError(f"value {value} does not fit in 32 bits")
+
+
+class Assembler:
+    def __init__(self):
+        self.globals: dict[str, int] = {}
+        self.consts: dict[str, int] = {}
+        self.strings = bytearray()
+        self.string_offsets: dict[str, int] = {}
+        self.labels: dict[str, int] = {}
+
+    def number(self, token: str) -> int:
+        if token.startswith("#") and len(token) == 7:
+            return to_rgb565(token)
+        if token in self.consts:
+            return self.consts[token]
+        try:
+            return int(token, 0)
+        except ValueError:
+            raise AsmError(f"not a number: {token}") from None
+
+    def string(self, text: str) -> int:
+        if text not in self.string_offsets:
+            self.string_offsets[text] = len(self.strings)
+            self.strings += text.encode("latin-1") + b"\0"
+        return self.string_offsets[text]
+
+    def parse(self, source: str) -> list[tuple[int, str, list[str]]]:
+        """Split the source into (line number, mnemonic, operands), declarations and labels taken out"""
+        lines = []
+        for number, raw in enumerate(source.splitlines(), 1):
+            lexer = shlex.shlex(raw, posix=True)
+            lexer.whitespace_split = True
+            lexer.commenters = ";"
+            tokens = list(lexer)
+            while tokens and LABEL_RE.match(tokens[0]):
+                lines.append((number, ":", [tokens[0][:-1]]))
+                tokens = tokens[1:]
+            if not tokens:
+                continue
+            mnemonic, operands = tokens[0].lower(), [t.rstrip(",") for t in tokens[1:]]
+            if mnemonic == "var":
+                for name in operands:
+                    if len(self.globals) == MAX_GLOBALS:
+                        raise AsmError(f"line {number}: too many globals ({MAX_GLOBALS} at most)")
+                    self.globals.setdefault(name, len(self.globals))
+            elif mnemonic == "const":
+                self.consts[operands[0]] = self.number(operands[1])
+            elif mnemonic == "text_at":
+                lines += [(number, "push", [operands[0]]), (number, "push", [operands[1]]),
+                          (number, "text", [operands[2]])]
+            else:
+                lines.append((number, mnemonic, operands))
+        return lines
+
+    def encode(self, number: int, mnemonic: str, operands: list[str], resolve: bool) -> bytes:
+        if mnemonic == "push":
+            return push_bytes(self.number(operands[0]))
+        if mnemonic not in OPCODES:
+            raise AsmError(f"line {number}: unknown instruction {mnemonic}")
+
+        code, kind = OPCODES[mnemonic]
+        if kind is None:
+            return bytes((code,))
+        if not operands:
+            raise AsmError(f"line {number}: {mnemonic} needs an operand")
+
+        operand = operands[0]
+        if kind == "global":
+            if operand not in self.globals:
+                raise AsmError(f"line {number}: unknown var {operand}")
+            return bytes((code, self.globals[operand]))
+        if kind == "timer":
+            timer = self.number(operand)
+            if not 0 <= timer < TIMERS:
+                raise AsmError(f"line {number}: timer must be 0 to {TIMERS - 1}")
+            return bytes((code, timer))
+        if kind == "input":
+            if operand.lower() not in INPUTS:
+                raise AsmError(f"line {number}: unknown input {operand} ({', '.join(INPUTS)})")
+            return bytes((code, INPUTS.index(operand.lower())))
+        if kind == "string":
+            return struct.pack("<BH", code, self.string(operand) if resolve else 0)
+        if resolve and operand not in self.labels:
+            raise AsmError(f"line {number}: unknown label {operand}")
+        return struct.pack("<BH", code, self.labels.get(operand, 0))
+
+    def assemble(self, source: str) -> bytes:
+        lines = self.parse(source)
+
+        # First pass places the labels, every instruction has its final size already
+        address = 0
+        for number, mnemonic, operands in lines:
+            if mnemonic == ":":
+                self.labels[operands[0]] = address
+            else:
+                address += len(self.encode(number, mnemonic, operands, resolve=False))
+
+        code = bytearray()
+        for number, mnemonic, operands in lines:
+            if mnemonic != ":":
+                code += self.encode(number, mnemonic, operands, resolve=True)
+        code.append(OPCODES["halt"][0])
+
+        if len(code) > MAX_CODE:
+            raise AsmError(f"code is {len(code)} bytes, {MAX_CODE} at most")
+        if len(self.strings) > MAX_STRINGS:
+            raise AsmError(f"strings are {len(self.strings)} bytes, {MAX_STRINGS} at most")
+
+        header = MAGIC + struct.pack("<BBHH", FORMAT_VERSION, len(self.globals), len(code), len(self.strings))
+        return header + bytes(code) + bytes(self.strings)
+
+
+def assemble_file(path: str) -> bytes:
+    with open(path, encoding="utf-8") as f:
+        return Assembler().assemble(f.read())
+
+
+def upload(ip: str, name: str, image: bytes, run: bool) -> dict:
+    resp = requests.post(
+        f"http://{ip}/api/v1/script",
+        params={"name": name, "run": "1" if run else "0"},
+        data=image,
+        headers={"Content-Type": "application/octet-stream"},
+        timeout=10,
+    )
+    result = resp.json()
+    if result.get("status") != "ok":
+        raise SystemExit(f"upload failed: {result.get('message')}")
+    return result
+
+
+# Tight arithmetic loop: five instructions per iteration, no drawing
+BENCH_SOURCE = """
+var i
+loop:   load i
+        push 1
+        add
+        store i
+        jmp loop
+"""
+
+
+def bench(ip: str, seconds: float) -> None:
+    base = f"http://{ip}"
+    upload(ip, "bench", Assembler().assemble(BENCH_SOURCE), run=True)
+    time.sleep(seconds)
+    state = requests.get(f"{base}/api/v1/script", timeout=10).json()
+    requests.post(f"{base}/api/v1/script/stop", timeout=10)
+    requests.post(f"{base}/api/v1/script/delete", json={"name": "bench"}, timeout=10)
+
+    ticks = max(state["ticks"], 1)
+    vm_seconds = max(state["vmUs"], 1) / 1e6
+    print(f"ticks          {state['ticks']}")
+    print(f"instructions   {state['instructions']}")
+    print(f"per tick       {state['instructions'] // ticks} (budget {state['budget']})")
+    print(f"VM speed       {state['instructions'] / vm_seconds / 1e6:.2f} M instructions/s")
+    print(f"tick time      {state['lastTickUs']} us (max {state['maxTickUs']} us)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="HoloCube script assembler")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    asm = sub.add_parser("asm", help="assemble a script into a bytecode file")
+    asm.add_argument("src")
+    asm.add_argument("dst")
+
+    up = sub.add_parser("upload", help="assemble and store a script on the device")
+    up.add_argument("src")
+    up.add_argument("--name", required=True)
+    up.add_argument("--run", action="store_true", help="start it right away")
+    up.add_argument("--ip", default="192.168.7.80", help="HoloCube IP address")
+
+    ben = sub.add_parser("bench", help="measure the VM speed on the device")
+    ben.add_argument("--ip", default="192.168.7.80", help="HoloCube IP address")
+    ben.add_argument("--seconds", type=float, default=5.0)
+
+    args = parser.parse_args()
+    try:
+        if args.command == "asm":
+            image = assemble_file(args.src)
+            with open(args.dst, "wb") as f:
+                f.write(image)
+            print(f"{args.dst}: {len(image)} bytes")
+        elif args.command == "upload":
+            state = upload(args.ip, args.name, assemble_file(args.src), args.run)
+            print(f"stored {args.name}, running: {state['running']}")
+        else:
+            bench(args.ip, args.seconds)
+    except AsmError as e:
+        sys.exit(f"error: {e}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+# /// script
+# requires-python = ">=3.10"
+# dependencies = ["requests"]
+# ///
+"""
+HoloCube sync: play the same GIF on several cubes, frame for frame
+
+Every cube keeps a sync clock. A cube given a time server (/api/v1/config/sync)
+estimates the offset and the rate of the server clock from bursts of UDP
+requests, NTP style, and follows it. A cube without one is the reference.
+Either one cube is the reference for the others, or this host is (serve). A
+synced GIF is started with "at", a time on that clock, and every cube shows
+frame "frame" at that time and the next frames on the same deadlines.
+
+Usage:
+    uv run --script holosync.py serve
+    uv run --script holosync.py follow 192.168.7.20 --ips 192.168.7.80 192.168.7.81
+    uv run --script holosync.py play cat.gif --ips 192.168.7.80 192.168.7.81 [--lead 2] [--frame 0]
+    uv run --script holosync.py skew --ips 192.168.7.80 192.168.7.81
+
+skew reads /api/v1/sync on each cube. Lateness is measured on the sync clock,
+so two cubes show a frame at most the difference of their mean lateness plus
+their two clock error bounds apart.
+"""
+
+import argparse
+import socket
+import struct
+import time
+
+import requests
+
+PORT = 4211
+VERSION = 1
+REQUEST = 0
+REPLY = 1
+PACKET = struct.Struct("<2sBBI3Q")  # magic, version, type, reserved, t1, t2, t3
+
+
+def now_us() -> int:
+    return time.time_ns() // 1000
+
+
+def serve(port: int) -> None:
+    """Answer the cubes' time requests with this host's clock (Unix time in microseconds)"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("", port))
+    print(f"answering time requests on udp/{port}")
+    answered = 0
+    while True:
+        data, peer = sock.recvfrom(64)
+        received = now_us()
+        if len(data) != PACKET.size:
+            continue
+        magic, version, kind, _, t1, _, _ = PACKET.unpack(data)
+        if magic != b"HT" or version != VERSION or kind != REQUEST:
+            continue
+        sock.sendto(PACKET.pack(b"HT", VERSION, REPLY, 0, t1, received, now_us()), peer)
+        answered += 1
+        if answered % 100 == 0:
+            print(f"{answered} requests answered")
+
+
+def get_sync(ip: str) -> dict:
+    return requests.get(f"http://{ip}/api/v1/sync", timeout=5).json()
+
+
+def follow(server: str, ips: list[str]) -> None:
+    for ip in ips:
+        resp = requests.post(f"http://{ip}/api/v1/config/sync", json={"server": server, "save": True}, timeout=5)
+        print(ip, resp.json())
+
+
+def play(name: str, ips: list[str], lead: float, frame: int) -> None:
+    # Any cube's clock will do once they are synced: take the first one
+    state = get_sync(ips[0])
+    at = state["nowUs"] + int(lead * 1_000_000)
+    for ip in ips:
+        sync = get_sync(ip)
+        if not sync["synced"]:
+            print(f"{ip}: not synced yet")
+        resp = requests.post(f"http://{ip}/api/v1/gif/play", json={"name": name, "at": at, "frame": frame}, timeout=5)
+        body = resp.json()
+        print(f"{ip}: {body['status']}, starts in {body.get('leadUs', 0) / 1000:.0f} ms")
+
+
+def skew(ips: list[str]) -> None:
+    rows = []
+    for ip in ips:
+        sync = get_sync(ip)
+        gif = sync["gif"]
+        rows.append((ip, sync, gif))
+        print(
+            f"{ip}: offset {sync['offsetUs']} us, skew {sync['skewPpb'] / 1000:.1f} ppm, error ±{sync['errorUs']} us, "
+            f"{gif['frames']} frames, {gif['late']} late, lateness avg {gif['avgLateUs']} us max {gif['maxLateUs']} us"
+        )
+
+    playing = [row for row in rows if row[2]["frames"] > 0]
+    if len(playing) < 2:
+        print("play a synced GIF on two cubes or more first")
+        return
+    late = [gif["avgLateUs"] for _, _, gif in playing]
+    errors = sorted((sync["errorUs"] for _, sync, _ in playing), reverse=True)
+    spread = max(late) - min(late)
+    bound = spread + errors[0] + errors[1]
+    print(f"inter-device skew: {spread} us from frame lateness, at most {bound} us with the clock errors")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="HoloCube synchronised GIF playback")
+    parser.add_argument("command", choices=["serve", "follow", "play", "skew"])
+    parser.add_argument("arg", nargs="?", help="GIF name (play) or time server address (follow)")
+    parser.add_argument("--ips", nargs="+", default=[])
+    parser.add_argument("--port", type=int, default=PORT)
+    parser.add_argument("--lead", type=float, default=2.0, help="seconds between the request and the first frame")
+    parser.add_argument("--frame", type=int, default=0)
+    args = parser.parse_args()
+
+    if args.command == "serve":
+        serve(args.port)
+    elif args.command == "follow":
+        follow(args.arg, args.ips)
+    elif args.command == "play":
+        play(args.arg, args.ips, args.lead, args.frame)
+    else:
+        skew(args.ips)
+
+
+if __name__ == "__main__":
+    main()
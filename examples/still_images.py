@@ -0,0 +1,246 @@
+#!/usr/bin/env python3
+# /// script
+# requires-python = ">=3.10"
+# dependencies = ["requests", "pillow"]
+# ///
+"""
+Still images for HoloCube: QOI, R565 and tiled background conversion, and a decode benchmark
+
+QOI and R565 (raw or run-length encoded RGB565) decode much faster than GIF on
+the ESP8266 and keep full colour. This script converts any image Pillow can read
+and compares the on-device decode time of the same picture as GIF, JPEG, QOI,
+R565 RLE and raw R565.
+
+Usage:
+    uv run --script still_images.py convert photo.png photo.qoi
+    uv run --script still_images.py convert photo.png photo.565 --raw
+    uv run --script still_images.py convert wallpaper.png wallpaper.r5t --tile 32
+    uv run --script still_images.py bench photo.png [--ip 192.168.7.80]
+"""
+
+import argparse
+import io
+import struct
+import time
+
+import requests
+from PIL import Image
+
+SCREEN_SIZE = (240, 240)
+
+QOI_OP_INDEX = 0x00
+QOI_OP_DIFF = 0x40
+QOI_OP_LUMA = 0x80
+QOI_OP_RUN = 0xC0
+QOI_OP_RGB = 0xFE
+QOI_OP_RGBA = 0xFF
+QOI_END = b"\x00" * 7 + b"\x01"
+
+R565_RLE_MAX = 128
+R565_RUN_MIN = 2
+R565_RUN_MAX = 129
+
+
+def encode_qoi(img: Image.Image) -> bytes:
+    """Encode an image as QOI (RGBA if it has transparency, RGB otherwise)"""
+    has_alpha = img.mode in ("RGBA", "LA") or "transparency" in img.info
+    img = img.convert("RGBA")
+    out = bytearray(b"qoif" + struct.pack(">IIBB", img.width, img.height, 4 if has_alpha else 3, 0))
+    index = [(0, 0, 0, 0)] * 64
+    prev = (0, 0, 0, 255)
+    run = 0
+
+    for px in img.getdata():
+        if px == prev:
+            run += 1
+            if run == 62:
+                out.append(QOI_OP_RUN | (run - 1))
+                run = 0
+            continue
+        if run:
+            out.append(QOI_OP_RUN | (run - 1))
+            run = 0
+
+        slot = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64
+        if index[slot] == px:
+            out.append(QOI_OP_INDEX | slot)
+        elif px[3] == prev[3]:
+            dr = (px[0] - prev[0] + 128) % 256 - 128
+            dg = (px[1] - prev[1] + 128) % 256 - 128
+            db = (px[2] - prev[2] + 128) % 256 - 128
+            if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                out.append(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2))
+            elif -32 <= dg <= 31 and -8 <= dr - dg <= 7 and -8 <= db - dg <= 7:
+                out += bytes((QOI_OP_LUMA | (dg + 32), (dr - dg + 8) << 4 | (db - dg + 8)))
+            else:
+                out += bytes((QOI_OP_RGB, px[0], px[1], px[2]))
+        else:
+            out += bytes((QOI_OP_RGBA, *px))
+        index[slot] = px
+        prev = px
+
+    if run:
+        out.append(QOI_OP_RUN | (run - 1))
+    return bytes(out + QOI_END)
+
+
+def to_rgb565(img: Image.Image) -> list[int]:
+    img = img.convert("RGB")
+    return [((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3) for r, g, b in img.getdata()]
+
+
+def pack_r565(pixels: list[int], rle: bool) -> bytes:
+    """Big-endian RGB565 pixels, raw or as R565 run-length packets"""
+    out = bytearray()
+
+    if not rle:
+        for px in pixels:
+            out += struct.pack(">H", px)
+        return bytes(out)
+
+    literals: list[int] = []
+
+    def flush_literals():
+        while literals:
+            chunk = literals[:R565_RLE_MAX]
+            del literals[:R565_RLE_MAX]
+            out.append(len(chunk) - 1)
+            for px in chunk:
+                out.extend(struct.pack(">H", px))
+
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < R565_RUN_MAX and pixels[i + run] == pixels[i]:
+            run += 1
+        if run >= R565_RUN_MIN:
+            flush_literals()
+            out.append(run + 126)
+            out.extend(struct.pack(">H", pixels[i]))
+        else:
+            literals.append(pixels[i])
+        i += run
+    flush_literals()
+    return bytes(out)
+
+
+def encode_r565(img: Image.Image, rle: bool = True) -> bytes:
+    """Encode an image as R565: big-endian RGB565, raw or run-length encoded"""
+    header = b"R565" + struct.pack(">HHB3x", img.width, img.height, 1 if rle else 0)
+    return header + pack_r565(to_rgb565(img), rle)
+
+
+def encode_r5tl(img: Image.Image, tile: int = 32, rle: bool = True) -> bytes:
+    """Encode a background layer as R5TL: R565 tiles behind a table of tile offsets
+
+    Tiles are stored row by row, each one raw or run-length encoded on its own so
+    the device can read back any tile without decoding its neighbours
+    """
+    img = img.convert("RGB")
+    cols = (img.width + tile - 1) // tile
+    rows = (img.height + tile - 1) // tile
+    header = b"R5TL" + struct.pack(">HHBB2x", img.width, img.height, tile, 1 if rle else 0)
+
+    tiles = []
+    for ty in range(rows):
+        for tx in range(cols):
+            box = (tx * tile, ty * tile, min((tx + 1) * tile, img.width), min((ty + 1) * tile, img.height))
+            tiles.append(pack_r565(to_rgb565(img.crop(box)), rle))
+
+    offset = len(header) + 4 * (len(tiles) + 1)
+    table = bytearray()
+    for data in tiles:
+        table += struct.pack(">I", offset)
+        offset += len(data)
+    table += struct.pack(">I", offset)
+    return header + bytes(table) + b"".join(tiles)
+
+
+def encode_gif(img: Image.Image) -> bytes:
+    buf = io.BytesIO()
+    img.convert("RGB").save(buf, format="GIF")
+    return buf.getvalue()
+
+
+def encode_jpeg(img: Image.Image) -> bytes:
+    buf = io.BytesIO()
+    img.convert("RGB").save(buf, format="JPEG", quality=90, progressive=False)
+    return buf.getvalue()
+
+
+def convert(src: str, dst: str, raw: bool, tile: int) -> None:
+    img = Image.open(src)
+    if dst.lower().endswith(".qoi"):
+        data = encode_qoi(img)
+    elif dst.lower().endswith(".r5t"):
+        data = encode_r5tl(img, tile=tile, rle=not raw)
+    else:
+        data = encode_r565(img, rle=not raw)
+    with open(dst, "wb") as f:
+        f.write(data)
+    print(f"{dst}: {img.width}x{img.height}, {len(data)} bytes")
+
+
+def bench(src: str, ip: str) -> None:
+    """Decode the same picture in every format and print the device-side decode times"""
+    base = f"http://{ip}"
+    img = Image.open(src)
+    img.thumbnail(SCREEN_SIZE)
+    pixels = img.width * img.height
+
+    rows = []
+
+    # GIF: play it for a moment and read the per-frame decode time from the metrics
+    gif_data = encode_gif(img)
+    requests.post(f"{base}/api/v1/gif", files={"file": ("bench.gif", gif_data)}, timeout=30)
+    requests.post(f"{base}/api/v1/gif/play", json={"name": "bench.gif"}, timeout=10)
+    time.sleep(2)
+    gif_us = requests.get(f"{base}/api/v1/metrics", timeout=5).json()["gif"]["avgUs"]
+    requests.post(f"{base}/api/v1/gif/stop", json={}, timeout=10)
+    rows.append(("gif", len(gif_data), gif_us))
+
+    stored = [
+        ("jpeg", "bench.jpg", encode_jpeg(img)),
+        ("qoi", "bench.qoi", encode_qoi(img)),
+        ("r565 rle", "bench.565", encode_r565(img)),
+        ("r565 raw", "bench_raw.565", encode_r565(img, rle=False)),
+    ]
+    for label, name, data in stored:
+        resp = requests.post(f"{base}/api/v1/image", files={"file": (name, data)}, timeout=30).json()
+        rows.append((label, len(data), resp.get("decodeUs", 0)))
+
+    for label, data in (("qoi stream", encode_qoi(img)), ("r565 stream", encode_r565(img))):
+        resp = requests.post(f"{base}/api/v1/image/stream", data=data,
+                             headers={"Content-Type": "application/octet-stream"}, timeout=30).json()
+        rows.append((label, len(data), resp.get("decodeUs", 0)))
+
+    print(f"{img.width}x{img.height} ({pixels} pixels)")
+    print(f"{'format':<12} {'bytes':>8} {'decode us':>10} {'Mpix/s':>8}")
+    for label, size, us in rows:
+        rate = pixels / us if us else 0.0
+        print(f"{label:<12} {size:>8} {us:>10} {rate:>8.2f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="HoloCube still images")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    conv = sub.add_parser("convert", help="Convert an image to .qoi, .r5t (tiled background) or .565")
+    conv.add_argument("src")
+    conv.add_argument("dst", help="Output file, .qoi for QOI, .r5t for a tiled background, anything else for R565")
+    conv.add_argument("--raw", action="store_true", help="R565 without run-length encoding")
+    conv.add_argument("--tile", type=int, default=32, choices=(8, 16, 32, 64), help="Tile side of a .r5t background")
+
+    ben = sub.add_parser("bench", help="Compare decode times on the device")
+    ben.add_argument("src")
+    ben.add_argument("--ip", default="192.168.7.80", help="HoloCube IP address")
+
+    args = parser.parse_args()
+    if args.command == "convert":
+        convert(args.src, args.dst, args.raw, args.tile)
+    else:
+        bench(args.src, args.ip)
+
+
+if __name__ == "__main__":
+    main()
@@ -4,6 +4,7 @@
 #include <ArduinoJson.h>
 #include <string>
 #include <cstdint>
+#include <vector>
 
 // LCD configuration defaults for hellocubic lite
 static constexpr bool LCD_ENABLE = true;
@@ -28,12 +29,18 @@ class ConfigManager {
     bool load();
     bool save();
     void setWiFi(const char* newSsid, const char* newPassword);
+    void setLCDTransform(uint16_t rotate, bool mirrorX, bool mirrorY);
     const char* getSSID() const;
     const char* getPassword() const;
+    const char* getBoard() const;
     bool getLCDEnable() const;
     int16_t getLCDWidth() const;
     int16_t getLCDHeight() const;
     uint8_t getLCDRotation() const;
+    bool hasLCDTransform() const;
+    uint16_t getLCDRotate() const;
+    bool getLCDMirrorX() const;
+    bool getLCDMirrorY() const;
     int8_t getLCDMosiGpio() const;
     int8_t getLCDSckGpio() const;
     int8_t getLCDCsGpio() const;
@@ -46,12 +53,27 @@ class ConfigManager {
     uint32_t getLCDSpiHz() const;
     int8_t getLCDBacklightGpio() const;
     bool getLCDBacklightActiveLow() const;
+    const char* getMqttHost() const;
+    uint16_t getMqttPort() const;
+    const char* getMqttUser() const;
+    const char* getMqttPassword() const;
+    const std::vector<std::string>& getMqttTopics() const;
+    const char* getMqttScreenTopic() const;
+    void setMqtt(const char* host, uint16_t port, const char* user, const char* password,
+                 const std::vector<std::string>& topics, const char* screenTopic);
+    bool getBroadcastEnabled() const;
+    const char* getBroadcastAddress() const;
+    uint16_t getBroadcastPort() const;
+    const std::vector<uint16_t>& getBroadcastGroups() const;
+    void setBroadcast(bool enabled, const char* address, uint16_t port, const std::vector<uint16_t>& groups);
+    const char* getSyncServer() const;
+    void setSyncServer(const char* server);
 
    public:
     bool getLCDEnableSafe() const { return lcd_enable; }
     int16_t getLCDWidthSafe() const { return (lcd_w > 0) ? lcd_w : LCD_W; }
     int16_t getLCDHeightSafe() const { return (lcd_h > 0) ? lcd_h : LCD_H; }
-    uint8_t getLCDRotationSafe() const { return lcd_rotation; }
+    uint8_t getLCDRotationSafe() const { return (lcd_rotation < 8) ? lcd_rotation : LCD_ROTATION; }
     int8_t getLCDMosiGpioSafe() const { return (lcd_mosi_gpio >= 0) ? lcd_mosi_gpio : LCD_MOSI_GPIO; }
     int8_t getLCDSckGpioSafe() const { return (lcd_sck_gpio >= 0) ? lcd_sck_gpio : LCD_SCK_GPIO; }
     int8_t getLCDCsGpioSafe() const { return (lcd_cs_gpio >= 0) ? lcd_cs_gpio : LCD_CS_GPIO; }
@@ -69,10 +91,14 @@ class ConfigManager {
     std::string ssid;
     std::string password;
     std::string filename;
+    std::string board;
     bool lcd_enable = true;
     int16_t lcd_w = 240;
     int16_t lcd_h = 240;
     uint8_t lcd_rotation = 4;
+    int16_t lcd_rotate = -1;  // -1 when the orientation comes from lcd_rotation
+    bool lcd_mirror_x = false;
+    bool lcd_mirror_y = false;
     int8_t lcd_mosi_gpio = 13;
     int8_t lcd_sck_gpio = 14;
     int8_t lcd_cs_gpio = 2;
@@ -85,6 +111,17 @@ class ConfigManager {
     uint32_t lcd_spi_hz = 40000000;
     int8_t lcd_backlight_gpio = 5;
     bool lcd_backlight_active_low = true;
+    std::string mqtt_host;  // empty when MQTT is off
+    uint16_t mqtt_port = 1883;
+    std::string mqtt_user;
+    std::string mqtt_password;
+    std::vector<std::string> mqtt_topics;
+    std::string mqtt_screen_topic;
+    bool broadcast_enabled = false;
+    std::string broadcast_address;  // empty uses the default group
+    uint16_t broadcast_port = 4210;
+    std::vector<uint16_t> broadcast_groups;
+    std::string sync_server;  // empty when this device is the time reference
 };
 
 #endif  // CONFIG_MANAGER_H
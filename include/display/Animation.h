@@ -0,0 +1,108 @@
+#ifndef DISPLAY_ANIMATION_H
+#define DISPLAY_ANIMATION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Animations running at the same time, further starts are rejected
+static constexpr size_t ANIMATION_POOL_SIZE = 8;
+
+// Shortest time between two repaints of the animations (50 fps at most)
+static constexpr uint32_t ANIMATION_FRAME_MS = 20;
+
+// Longest text an animation can carry, terminator included
+static constexpr size_t ANIMATION_TEXT_MAX = 32;
+
+// Repeat count that never ends
+static constexpr uint16_t ANIMATION_REPEAT_FOREVER = UINT16_MAX;
+
+/**
+ * @brief Shape moved by an animation
+ */
+enum class AnimationShape : uint8_t {
+    Rect,       // x, y, w, h
+    RoundRect,  // x, y, w, h, r
+    Circle,     // center x, y and radius r
+    Text,       // single line at x, y
+};
+
+/**
+ * @brief Easing curve, quadratic or cubic
+ */
+enum class Easing : uint8_t {
+    Linear,
+    In,
+    Out,
+    InOut,
+    InCubic,
+    OutCubic,
+    InOutCubic,
+};
+
+/**
+ * @brief Animated properties of a shape
+ */
+struct AnimationState {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+    int16_t r;
+    uint16_t color;
+};
+
+/**
+ * @brief One tween: a shape going from one state to another
+ *
+ * Every property of from and to is interpolated, properties that do not change simply stay put. The area the
+ * shape leaves is repainted with bg (or the background layer when one is loaded)
+ */
+struct AnimationSpec {
+    uint8_t id;
+    AnimationShape shape;
+    bool fill;
+    Easing easing;
+    AnimationState from;
+    AnimationState to;
+    uint16_t bg;
+    uint32_t durationMs;
+    uint32_t delayMs;
+    uint16_t repeat;  // extra runs after the first one, ANIMATION_REPEAT_FOREVER for endless loops
+    bool yoyo;        // every other run goes back from to to from
+    uint8_t textSize;
+    std::array<char, ANIMATION_TEXT_MAX> text;
+};
+
+/**
+ * @brief Repaint cost of the animations since boot
+ */
+struct AnimationStats {
+    uint32_t ticks;
+    uint32_t lastTickUs;
+    uint32_t maxTickUs;
+    uint32_t rejected;  // starts refused because the pool was full
+};
+
+/**
+ * @brief Tween engine driven by DisplayManager::update()
+ *
+ * Animations live in a fixed pool of ANIMATION_POOL_SIZE slots, so nothing is allocated while they run. Each tick
+ * maps the elapsed time to a 16.16 fixed-point progress, shapes it with the easing curve (integer polynomials)
+ * and interpolates every property from it. Only shapes whose state changed are repainted: the part of the old
+ * bounds the new shape does not cover is erased, then the shape is drawn at its new place
+ */
+namespace Animation {
+
+auto start(const AnimationSpec& spec, uint32_t nowMs) -> bool;
+auto stop(uint8_t id) -> bool;
+void stopAll();
+auto current(uint8_t id, AnimationState& state) -> bool;
+void update(uint32_t nowMs);
+auto activeCount() -> size_t;
+auto stats() -> AnimationStats;
+auto ease(Easing easing, uint32_t progress) -> uint32_t;
+
+}  // namespace Animation
+
+#endif  // DISPLAY_ANIMATION_H
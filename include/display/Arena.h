@@ -0,0 +1,71 @@
+#ifndef DISPLAY_ARENA_H
+#define DISPLAY_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+/**
+ * @class Arena
+ * @brief Bump allocator with a fixed capacity, for data that lives as long as one request
+ *
+ * The buffer is allocated on the first allocation and released with the arena, so requests that do not need it
+ * cost nothing. Allocations are never freed individually: mark()/rewind() drop everything allocated after a mark,
+ * which is how scratch memory is reused between commands. A full arena returns nullptr instead of growing
+ */
+class Arena {
+   public:
+    explicit Arena(size_t capacity) : m_capacity(capacity) {}
+
+    Arena(const Arena&) = delete;
+    auto operator=(const Arena&) -> Arena& = delete;
+
+    /**
+     * @brief Allocate an uninitialized array
+     *
+     * @param count Number of elements
+     * @return The array, nullptr when the arena is full (or its buffer could not be allocated)
+     */
+    template <typename T>
+    auto allocate(size_t count) -> T* {
+        if (!m_buffer) {
+            m_buffer.reset(new (std::nothrow) uint8_t[m_capacity]);
+            if (!m_buffer) {
+                return nullptr;
+            }
+        }
+
+        const size_t offset = (m_used + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (offset > m_capacity || count > (m_capacity - offset) / sizeof(T)) {
+            return nullptr;
+        }
+
+        m_used = offset + count * sizeof(T);
+        return reinterpret_cast<T*>(m_buffer.get() + offset);
+    }
+
+    /**
+     * @brief Current fill level, to be passed to rewind()
+     */
+    auto mark() const -> size_t { return m_used; }
+
+    /**
+     * @brief Drop every allocation made after a mark
+     */
+    void rewind(size_t mark) {
+        if (mark < m_used) {
+            m_used = mark;
+        }
+    }
+
+    auto used() const -> size_t { return m_used; }
+    auto capacity() const -> size_t { return m_capacity; }
+
+   private:
+    std::unique_ptr<uint8_t[]> m_buffer;
+    size_t m_capacity;
+    size_t m_used = 0;
+};
+
+#endif  // DISPLAY_ARENA_H
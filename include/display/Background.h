@@ -0,0 +1,76 @@
+#ifndef DISPLAY_BACKGROUND_H
+#define DISPLAY_BACKGROUND_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+
+// Background layer restored at boot
+static constexpr const char* BACKGROUND_PATH = "/img/background.r5t";
+
+// Tile sides accepted: 8 to 64 pixels
+static constexpr uint8_t BACKGROUND_TILE_MIN = 8;
+static constexpr uint8_t BACKGROUND_TILE_MAX = 64;
+
+// Tiles kept in RAM at most, and the RAM they may take
+static constexpr size_t BACKGROUND_CACHE_SLOTS = 32;
+static constexpr size_t BACKGROUND_CACHE_BYTES = 16384;
+
+// Free heap left to the rest of the firmware when the tile cache is allocated
+static constexpr uint32_t BACKGROUND_HEAP_RESERVE = 20480;
+
+/**
+ * @brief Geometry of the loaded background layer
+ */
+struct BackgroundInfo {
+    uint16_t width;
+    uint16_t height;
+    uint8_t tileSize;
+    bool rle;
+    uint16_t columns;
+    uint16_t rows;
+    uint16_t cacheSlots;  // tiles that fit in the RAM cache
+};
+
+/**
+ * @brief Background repaints since boot
+ */
+struct BackgroundStats {
+    uint32_t restores;
+    uint32_t lastUs;
+    uint32_t tileReads;  // tiles read from flash
+    uint32_t cacheHits;  // tiles served from RAM
+};
+
+/**
+ * @brief One decoded tile, panel-order RGB565 with a stride of w pixels
+ */
+struct BackgroundTile {
+    const uint16_t* pixels;  // nullptr when the tile could not be read
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+};
+
+/**
+ * @brief Wallpaper kept on LittleFS as independent tiles, read back to repaint erased areas
+ *
+ * R5TL layout: "R5TL", width and height (uint16 big-endian), tile side, encoding (0 raw, 1 RLE), 2 reserved bytes,
+ * then columns * rows + 1 big-endian uint32 file offsets, one per tile (row-major) plus the end of the last one.
+ * Each tile is R565 pixel data of its own (edge tiles are cut to the image), so any tile is reached with one seek
+ * and decoded without its neighbours. Decoded tiles live in a small LRU cache sized from the free heap
+ */
+namespace Background {
+
+auto load(const String& path) -> bool;
+void unload();
+auto active() -> bool;
+auto info() -> BackgroundInfo;
+auto tile(uint16_t column, uint16_t row) -> BackgroundTile;
+void recordRestore(uint32_t elapsedUs);
+auto stats() -> BackgroundStats;
+
+}  // namespace Background
+
+#endif  // DISPLAY_BACKGROUND_H
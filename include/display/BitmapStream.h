@@ -0,0 +1,87 @@
+#ifndef DISPLAY_BITMAP_STREAM_H
+#define DISPLAY_BITMAP_STREAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "display/PanelRowWriter.h"
+#include "display/Shapes.h"
+
+/**
+ * @brief Pixel layout of a raw bitmap body
+ */
+enum class BitmapFormat : uint8_t {
+    Rgb565,    // 2 bytes per pixel, big-endian (panel order)
+    Rgb565Le,  // 2 bytes per pixel, little-endian
+    Mask,      // 1 bit per pixel, MSB first, rows padded to a byte: 1 = color, 0 = background or transparent
+    Indexed,   // palette of paletteSize big-endian RGB565 entries, then 1 byte per pixel
+};
+
+// Largest bitmap side accepted
+static constexpr uint16_t BITMAP_MAX_SIDE = 1024;
+
+static constexpr uint16_t BITMAP_PALETTE_MAX = 256;
+
+// Spans of a transparent mask written per bus transaction
+static constexpr size_t BITMAP_MASK_SPANS = 32;
+
+/**
+ * @brief Placement and layout of a raw bitmap
+ */
+struct BitmapSpec {
+    BitmapFormat format;
+    int16_t x;
+    int16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint16_t color;        // Mask: color of the 1 bits
+    uint16_t background;   // Mask: color of the 0 bits, unless transparent
+    bool transparent;      // Mask: leave the 0 bits untouched
+    uint16_t paletteSize;  // Indexed: palette entries at the start of the body
+};
+
+/**
+ * @class BitmapStream
+ * @brief Writes a raw bitmap to the panel while its bytes arrive
+ *
+ * Nothing but a row buffer is held: RGB565 bodies are copied (big-endian) or byte-swapped (little-endian) into a
+ * PanelRowWriter, indexed bodies are looked up in their palette, opaque masks expand to two colors and transparent
+ * masks are sent as spans of set bits through DisplayManager::fillSpans(). A 2-byte pixel or palette entry cut by
+ * a chunk boundary is carried over; bytes past the end of the image are ignored
+ */
+class BitmapStream {
+   public:
+    explicit BitmapStream(const BitmapSpec& spec);
+
+    auto feed(const uint8_t* data, size_t len) -> void;
+    auto finish() -> void;
+    auto done() const -> bool { return m_remaining == 0; }
+    auto pixelsWritten() const -> uint32_t;
+    auto busyUs() const -> uint32_t { return m_busyUs; }
+
+   private:
+    auto feedPalette(const uint8_t* data, size_t len) -> size_t;
+    auto feedWords(const uint8_t* data, size_t len) -> size_t;
+    auto feedIndexed(const uint8_t* data, size_t len) -> size_t;
+    auto feedMask(const uint8_t* data, size_t len) -> size_t;
+    void addMaskSpan(uint16_t column);
+    void flushMaskSpans();
+
+    BitmapSpec m_spec;
+    PanelRowWriter m_output;
+    uint32_t m_remaining;
+    uint32_t m_busyUs = 0;
+    uint16_t m_paletteFill = 0;
+    std::array<uint16_t, BITMAP_PALETTE_MAX> m_palette{};
+    uint8_t m_carry = 0;
+    bool m_hasCarry = false;
+
+    uint16_t m_maskRow = 0;
+    uint16_t m_maskColumn = 0;
+    int32_t m_spanStart = -1;  // column where the current run of set bits started, -1 outside a run
+    std::array<Span, BITMAP_MASK_SPANS> m_spans{};
+    size_t m_spanCount = 0;
+};
+
+#endif  // DISPLAY_BITMAP_STREAM_H
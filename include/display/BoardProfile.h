@@ -0,0 +1,86 @@
+#ifndef DISPLAY_BOARD_PROFILE_H
+#define DISPLAY_BOARD_PROFILE_H
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Compile-time display wiring of the HelloCubic Lite (see data/config-hellocubic.example)
+ */
+struct HelloCubicLiteProfile {
+    static constexpr const char* NAME = "hellocubic-lite";
+    static constexpr int16_t WIDTH = 240;
+    static constexpr int16_t HEIGHT = 240;
+    static constexpr uint8_t ROTATION = 4;
+    static constexpr int8_t MOSI_GPIO = 13;
+    static constexpr int8_t SCK_GPIO = 14;
+    static constexpr int8_t CS_GPIO = 2;
+    static constexpr int8_t DC_GPIO = 0;
+    static constexpr int8_t RST_GPIO = 15;
+    static constexpr bool CS_ACTIVE_HIGH = true;
+    static constexpr bool DC_CMD_HIGH = false;
+    static constexpr uint8_t SPI_MODE = 0;
+    static constexpr uint32_t SPI_HZ = 40000000;
+    static constexpr bool KEEP_CS_ASSERTED = true;
+    static constexpr int8_t BACKLIGHT_GPIO = 5;
+    static constexpr bool BACKLIGHT_ACTIVE_LOW = true;
+};
+
+/**
+ * @brief Compile-time display wiring of the SmallTV Ultra (see data/config-smartTV.example)
+ *
+ * The wiring is the same as the cube, only the default orientation differs
+ */
+struct SmallTvUltraProfile : HelloCubicLiteProfile {
+    static constexpr const char* NAME = "smalltv-ultra";
+    static constexpr uint8_t ROTATION = 0;
+};
+
+/**
+ * @brief Boards with a compile-time profile
+ */
+enum class BoardId : uint8_t {
+    Unknown,
+    HelloCubicLite,
+    SmallTvUltra,
+};
+
+/**
+ * @brief Resolve the "board" configuration value to a known profile
+ *
+ * @param name The board name from the configuration (may be null)
+ * @return The matching board, BoardId::Unknown when the runtime configuration must be used
+ */
+inline auto boardFromName(const char* name) -> BoardId {
+    if (name == nullptr) {
+        return BoardId::Unknown;
+    }
+    if (strcmp(name, HelloCubicLiteProfile::NAME) == 0) {
+        return BoardId::HelloCubicLite;
+    }
+    if (strcmp(name, SmallTvUltraProfile::NAME) == 0) {
+        return BoardId::SmallTvUltra;
+    }
+
+    return BoardId::Unknown;
+}
+
+/**
+ * @brief Default legacy rotation ("lcd_rotation") of a board, used when the configuration does not set one
+ *
+ * @param board The configured board
+ * @param fallback The rotation of boards without a profile
+ * @return The Arduino_GFX rotation (0-7)
+ */
+inline auto boardRotation(BoardId board, uint8_t fallback) -> uint8_t {
+    switch (board) {
+        case BoardId::HelloCubicLite:
+            return HelloCubicLiteProfile::ROTATION;
+        case BoardId::SmallTvUltra:
+            return SmallTvUltraProfile::ROTATION;
+        default:
+            return fallback;
+    }
+}
+
+#endif  // DISPLAY_BOARD_PROFILE_H
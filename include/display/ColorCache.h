@@ -0,0 +1,77 @@
+#ifndef DISPLAY_COLOR_CACHE_H
+#define DISPLAY_COLOR_CACHE_H
+
+#include <array>
+#include <cstdint>
+
+#include "display/Rgb565.h"
+
+/**
+ * @class ColorCache
+ * @brief Small open-addressing cache from color strings to RGB565, scoped to one parsed request
+ *
+ * ArduinoJson stores each distinct string once per document, so every occurrence of the same "#rrggbb" in a batch
+ * has the same address. The cache is keyed on that address: a hit costs a pointer hash and compare instead of a
+ * parse. Distinct pointers holding the same text simply occupy two slots. When the table is full, strings are
+ * parsed directly
+ *
+ * @tparam SLOTS Table size, a power of two
+ */
+template <uint8_t SLOTS = 32>
+class ColorCache {
+    static_assert((SLOTS & (SLOTS - 1U)) == 0, "SLOTS must be a power of two");
+
+   public:
+    /**
+     * @brief Resolve a color string
+     *
+     * @param hex The color string, must stay valid for the lifetime of the cache
+     * @param fallback Value used when the string is not a valid color
+     * @return The native RGB565 color
+     */
+    auto lookup(const char* hex, uint16_t fallback) -> uint16_t {
+        if (hex == nullptr) {
+            return fallback;
+        }
+
+        auto slot = static_cast<uint8_t>(hash(hex) & (SLOTS - 1U));
+        for (uint8_t probe = 0; probe < SLOTS; ++probe) {
+            Entry& entry = m_entries[slot];
+
+            if (entry.key == hex) {
+                m_hits++;
+                return entry.color;
+            }
+            if (entry.key == nullptr) {
+                entry.key = hex;
+                entry.color = Rgb565::parseHex(hex, fallback);
+                return entry.color;
+            }
+
+            slot = static_cast<uint8_t>((slot + 1U) & (SLOTS - 1U));
+        }
+
+        return Rgb565::parseHex(hex, fallback);
+    }
+
+    /**
+     * @brief Number of lookups answered without parsing
+     */
+    auto hits() const -> uint32_t { return m_hits; }
+
+   private:
+    struct Entry {
+        const char* key;
+        uint16_t color;
+    };
+
+    static auto hash(const char* key) -> uint32_t {
+        constexpr uint32_t GOLDEN = 2654435761U;
+        return (static_cast<uint32_t>(reinterpret_cast<uintptr_t>(key)) * GOLDEN) >> 24U;
+    }
+
+    std::array<Entry, SLOTS> m_entries{};
+    uint32_t m_hits = 0;
+};
+
+#endif  // DISPLAY_COLOR_CACHE_H
@@ -3,6 +3,18 @@
 #include <Arduino.h>
 #include <Arduino_GFX_Library.h>
 
+#include "display/Animation.h"
+#include "display/Background.h"
+#include "display/Effects.h"
+#include "display/Gif.h"
+#include "display/GeekMagicST7789.h"
+#include "display/Gradient.h"
+#include "display/Jpeg.h"
+#include "display/StillImage.h"
+#include "display/Shapes.h"
+#include "display/Template.h"
+#include "display/Transition.h"
+
 // Colors definitions
 static constexpr uint16_t LCD_BLACK = 0x0000;
 static constexpr uint16_t LCD_WHITE = 0xFFFF;
@@ -36,18 +48,38 @@ class DisplayManager {
     static bool isReady();
     static void ensureInit();
     static Arduino_GFX* getGfx();
+    static Arduino_DataBus* getBus();
     static int16_t screenWidth();
     static int16_t screenHeight();
+    static bool setTransform(const DisplayTransform& transform);
+    static DisplayTransform getTransform();
     static void drawStartup(String currentIP);
     static void drawTextWrapped(int16_t xPos, int16_t yPos, const String& text, uint8_t textSize, uint16_t fgColor,
                                 uint16_t bgColor, bool clearBg);
+    static void drawGlyphs(int16_t posX, int16_t posY, const char* text, size_t count, uint8_t textSize,
+                           uint16_t fgColor, uint16_t bgColor);
     static void drawLoadingBar(float progress, int yPos = 180, int barWidth = 200, int barHeight = 20,
                                uint16_t fgColor = 0x07E0, uint16_t bgColor = 0x39E7);
-    static bool playGifFullScreen(const String& path, uint32_t timeMs = 0);
+    static bool playGifFullScreen(const String& path, uint32_t timeMs = 0,
+                                  const TransitionSpec& transition = Transition::defaults());
+    static bool playGifAt(const String& path, uint64_t startUs, uint16_t startFrame);
     static bool stopGif();
+    static void stopGifPlayback();
+    static GifFrameStats gifFrameStats();
+    static GifSyncStats gifSyncStats();
+    static JpegResult drawJpeg(const String& path, int16_t posX, int16_t posY, uint8_t scale,
+                               const TransitionSpec& transition = Transition::defaults());
+    static JpegStats jpegStats();
+    static StillResult drawStill(const String& path, int16_t posX, int16_t posY,
+                                 const TransitionSpec& transition = Transition::defaults());
     static void update();
     static void clearScreen();
 
+    // Transitions between content sources: what is drawn in between is paced into a slide, wipe or dissolve
+    static void beginTransition(const TransitionSpec& spec);
+    static void endTransition();
+    static TransitionStats transitionStats();
+
     // Layout rectangles for a simple 3-region UI: status bar, body, footer (mascot)
     static UiRect getStatusBarRect();
     static UiRect getBodyRect();
@@ -62,6 +94,20 @@ class DisplayManager {
     static void drawBodyText(const String& text, uint8_t textSize = 2, uint16_t fgColor = LCD_WHITE,
                              uint16_t bgColor = LCD_BLACK, bool clearBg = true);
 
+    // Viewport: clip rect stack and translation honoured by the drawing primitives below
+    static void pushClip(int16_t posX, int16_t posY, int16_t width, int16_t height);
+    static void popClip();
+    static void translate(int16_t deltaX, int16_t deltaY);
+    static void resetViewport();
+
+    // Background layer: tiled wallpaper on flash that clears and erases repaint from
+    static bool setBackground(const String& path);
+    static void clearBackground();
+    static bool hasBackground();
+    static void fillBackground(int16_t posX, int16_t posY, int16_t width, int16_t height, uint16_t color);
+    static void clearToBackground(uint16_t color);
+    static BackgroundStats backgroundStats();
+
     // Drawing primitives for custom screens
     static void fillScreen(uint16_t color);
     static void drawPixel(int16_t posX, int16_t posY, uint16_t color);
@@ -83,6 +129,27 @@ class DisplayManager {
     static void drawRoundRect(int16_t posX, int16_t posY, int16_t width, int16_t height, int16_t radius, uint16_t color);
     static void fillRoundRect(int16_t posX, int16_t posY, int16_t width, int16_t height, int16_t radius, uint16_t color);
 
-    // Helper to convert hex color string to RGB565
+    // Alpha-blended primitives, composited over a known backdrop color (see backdropColor())
+    static uint16_t backdropColor();
+    static void setBackdrop(uint16_t color, bool fill);
+    static void fillRectBlended(int16_t posX, int16_t posY, int16_t width, int16_t height, uint16_t color, uint8_t alpha,
+                                uint16_t backdrop);
+    static void fillRoundRectBlended(int16_t posX, int16_t posY, int16_t width, int16_t height, int16_t radius,
+                                     uint16_t color, uint8_t alpha, uint16_t backdrop);
+    static void blitBlended(int16_t posX, int16_t posY, int16_t width, int16_t height, const uint16_t* pixels,
+                            uint8_t alpha, uint16_t backdrop);
+
+    // Span output of the Shapes rasterizers, in one bus transaction
+    static void fillSpans(const Span* spans, size_t count);
+
+    // Panel-order (big-endian) pixel blocks from the image decoders, sent without conversion
+    static void blitPanel(int16_t posX, int16_t posY, int16_t width, int16_t height, const uint16_t* pixels,
+                          int16_t stride);
+
+    // Gradient fill, one address window per line
+    static void fillGradient(int16_t posX, int16_t posY, int16_t width, int16_t height, const Gradient& gradient);
+
+    // Helpers to convert hex color string to RGB565
+    static uint16_t hexToRgb565(const char* hex);
     static uint16_t hexToRgb565(const String& hex);
 };
@@ -0,0 +1,69 @@
+#ifndef DISPLAY_DRAW_BATCH_H
+#define DISPLAY_DRAW_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "display/Arena.h"
+#include "display/DrawCommand.h"
+#include "display/Gradient.h"
+#include "display/Path.h"
+
+/**
+ * @brief What the optimizer removed from a batch
+ */
+struct DrawBatchStats {
+    uint32_t culled;       // commands dropped because nothing of them would stay visible
+    uint32_t merged;       // commands folded into a neighbouring rect
+    uint32_t pixelsSaved;  // pixels no longer written by the dropped commands
+};
+
+// Per-batch arena for path vertices, sprite pixels and the rasterizer's edge tables
+static constexpr size_t DRAW_BATCH_ARENA_SIZE = 8192;
+
+/**
+ * @brief Pixels of a sprite, native RGB565 row-major in the batch arena
+ */
+struct SpriteSpec {
+    const uint16_t* pixels;
+    uint16_t width;
+    uint16_t height;
+};
+
+/**
+ * @class DrawBatch
+ * @brief Parsed draw commands, optimized as a whole before they reach the panel
+ *
+ * optimize() runs a pre-pass over the batch:
+ *  - commands whose area is entirely repainted by a later opaque fill or clear are dropped
+ *  - commands that repaint, in the same colour, an area the previous opaque fill already painted are dropped
+ *  - consecutive same-colour filled rects sharing a full edge are merged into one
+ *
+ * A culled clear stays in the batch as a Backdrop command, so translucent commands blend over the same color with
+ * or without the optimizer
+ */
+class DrawBatch {
+   public:
+    explicit DrawBatch(size_t capacity = 0);
+
+    auto add(const DrawCommand& command) -> void;
+    auto addGradient(const GradientSpec& spec) -> uint16_t;
+    auto addPath(const PathSpec& spec) -> uint16_t;
+    auto addSprite(const SpriteSpec& spec) -> uint16_t;
+    auto gradient(uint16_t ref) const -> const GradientSpec& { return m_gradients[ref]; }
+    auto path(uint16_t ref) const -> const PathSpec& { return m_paths[ref]; }
+    auto arena() -> Arena& { return m_arena; }
+    auto optimize(int16_t screenW, int16_t screenH) -> DrawBatchStats;
+    auto execute() -> size_t;
+    auto size() const -> size_t;
+
+   private:
+    std::vector<DrawCommand> m_commands;
+    std::vector<GradientSpec> m_gradients;
+    std::vector<PathSpec> m_paths;
+    std::vector<SpriteSpec> m_sprites;
+    Arena m_arena{DRAW_BATCH_ARENA_SIZE};
+};
+
+#endif  // DISPLAY_DRAW_BATCH_H
@@ -0,0 +1,87 @@
+#ifndef DISPLAY_DRAW_COMMAND_H
+#define DISPLAY_DRAW_COMMAND_H
+
+#include <cstdint>
+
+#include "display/Shapes.h"
+
+/**
+ * @brief Primitive executed by a draw command
+ */
+enum class DrawOp : uint8_t {
+    None,
+    Clear,
+    Rect,
+    Circle,
+    Line,
+    Pixel,
+    Text,
+    Triangle,
+    Ellipse,
+    RoundRect,
+    PushClip,
+    PopClip,
+    Translate,
+    Gradient,
+    LineAA,
+    ThickLine,
+    Arc,
+    Path,
+    Sprite,
+    Backdrop,
+};
+
+/**
+ * @brief Number of integer arguments a draw command can carry
+ */
+static constexpr uint8_t DRAW_COMMAND_ARGS = 6;
+
+/**
+ * @brief Text sizes a draw command accepts, larger ones are clamped (size 8 is 48x64 pixels a glyph)
+ */
+static constexpr uint8_t DRAW_TEXT_SIZE_MIN = 1;
+static constexpr uint8_t DRAW_TEXT_SIZE_MAX = 8;
+
+/**
+ * @brief One parsed draw-batch command
+ *
+ * Arguments by operation:
+ *  - Rect/RoundRect/PushClip/Gradient: x, y, w, h (, r)
+ *  - Translate: dx, dy
+ *  - Circle: x, y, r
+ *  - Ellipse: x, y, rx, ry
+ *  - Line/LineAA: x0, y0, x1, y1
+ *  - ThickLine: x0, y0, x1, y1, width
+ *  - Arc: x, y, r, thickness, start, sweep (degrees, clockwise from 12 o'clock)
+ *  - Path: bounding box x, y, w, h (the vertices are in the batch)
+ *  - Sprite: x, y, w, h (the pixels are in the batch)
+ *  - Pixel/Text: x, y
+ *  - Triangle: x0, y0, x1, y1, x2, y2
+ *
+ * A Clear without a color (fill unset) repaints the background layer when one is loaded. Backdrop is a clear the
+ * optimizer culled: it draws nothing but leaves the same backdrop color behind.
+ *
+ * alpha is the opacity (255 opaque). Translucent commands are blended over bg when hasBg is set, over the last
+ * clear color otherwise. For text, bg is the text background.
+ *
+ * ref indexes the payload a command keeps in its batch (the GradientSpec of a Gradient, the PathSpec of a Path, the
+ * SpriteSpec of a Sprite). cap finishes the ends of thick lines and arcs.
+ *
+ * The text pointer is not owned, it points into the parsed request and must outlive the batch
+ */
+struct DrawCommand {
+    DrawOp op;
+    bool fill;
+    bool clearBg;
+    uint8_t size;
+    uint8_t alpha;
+    bool hasBg;
+    uint16_t color;
+    uint16_t bg;
+    int16_t args[DRAW_COMMAND_ARGS];
+    const char* text;
+    uint16_t ref;
+    LineCap cap;
+};
+
+#endif  // DISPLAY_DRAW_COMMAND_H
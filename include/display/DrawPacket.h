@@ -0,0 +1,88 @@
+#ifndef DISPLAY_DRAW_PACKET_H
+#define DISPLAY_DRAW_PACKET_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "display/DrawBatch.h"
+
+static constexpr std::array<uint8_t, 2> DRAW_PACKET_MAGIC = {'H', 'D'};
+static constexpr uint8_t DRAW_PACKET_VERSION = 1;
+static constexpr size_t DRAW_PACKET_HEADER_SIZE = 12;
+
+// Largest packet: fits one Ethernet frame with the IP and UDP headers, so it is never fragmented
+static constexpr size_t DRAW_PACKET_MAX = 1400;
+
+/**
+ * @brief Packet flags
+ */
+enum DrawPacketFlag : uint8_t {
+    DRAW_PACKET_KEY = 1U << 0U,         // redraws the whole screen, earlier packets are not needed to show it
+    DRAW_PACKET_RETRANSMIT = 1U << 1U,  // sent again after a NACK
+};
+
+/**
+ * @brief Command flags, the line cap of ThickLine and Arc is in bits 5-6
+ */
+enum DrawPacketCommandFlag : uint8_t {
+    DRAW_PACKET_FILL = 1U << 0U,
+    DRAW_PACKET_COLOR = 1U << 1U,     // a color follows the arguments, otherwise the previous command's is kept
+    DRAW_PACKET_BG = 1U << 2U,        // a background color follows
+    DRAW_PACKET_ALPHA = 1U << 3U,     // an opacity byte follows, otherwise opaque
+    DRAW_PACKET_CLEAR_BG = 1U << 4U,  // text: clear the text box first
+};
+static constexpr uint8_t DRAW_PACKET_CAP_SHIFT = 5;
+static constexpr uint8_t DRAW_PACKET_CAP_MASK = 0x03;
+
+/**
+ * @brief Command codes of the packet format, part of the wire format and independent of DrawOp
+ */
+enum class PacketOp : uint8_t {
+    Clear = 0x01,  // fill set: clear to the color, otherwise repaint the background layer
+    Rect = 0x02,
+    RoundRect = 0x03,
+    Circle = 0x04,
+    Ellipse = 0x05,
+    Line = 0x06,
+    LineAA = 0x07,
+    ThickLine = 0x08,
+    Arc = 0x09,
+    Pixel = 0x0A,
+    Triangle = 0x0B,
+    Text = 0x0C,  // then the text size (1 byte, clamped to 1-8) and the text, NUL terminated
+    PushClip = 0x10,
+    PopClip = 0x11,
+    Translate = 0x12,
+};
+
+/**
+ * @brief Header of a draw packet
+ */
+struct DrawPacketHeader {
+    uint8_t flags;
+    uint16_t group;
+    uint32_t sequence;
+    uint16_t commands;
+};
+
+/**
+ * @brief Binary draw format: a batch in a datagram, read field by field with no text parsing
+ *
+ * Little endian. Header: "HD", version, flags, group (uint16), sequence (uint32), command count (uint16). Each
+ * command is its code, its flags and its arguments as int16 (as many as DrawCommand takes for its DrawOp), then the
+ * optional color, background (RGB565, uint16) and opacity (uint8). The color carries over from one command to the
+ * next, so a run of same-colour shapes costs 2 bytes per shape plus their arguments.
+ *
+ * Decoding is a bounds-checked walk over fixed-size fields, with no JSON document and no number or color parsing.
+ * The commands are still copied into the batch, and text pointers point into the packet, which must outlive the
+ * batch. Gradients and paths are not in the format, they stay with /api/v1/draw/batch
+ */
+namespace DrawPacket {
+
+auto readHeader(const uint8_t* data, size_t length, DrawPacketHeader& header) -> bool;
+auto decode(const uint8_t* data, size_t length, DrawBatch& batch) -> const char*;
+
+}  // namespace DrawPacket
+
+#endif  // DISPLAY_DRAW_PACKET_H
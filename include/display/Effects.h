@@ -0,0 +1,102 @@
+#ifndef DISPLAY_EFFECTS_H
+#define DISPLAY_EFFECTS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel rows rendered into the strip buffer before it is sent
+static constexpr int16_t EFFECT_STRIP_ROWS = 8;
+
+// Longest time one DisplayManager::update() spends rendering, a slower frame is finished on the next calls
+static constexpr uint32_t EFFECT_SLICE_US = 12000;
+
+// Frame rate aimed at until another one is asked for, and the highest accepted
+static constexpr uint8_t EFFECT_DEFAULT_FPS = 30;
+static constexpr uint8_t EFFECT_MAX_FPS = 60;
+
+// Coarsest detail step: one sample covers at most EFFECT_MAX_STEP x EFFECT_MAX_STEP pixels
+static constexpr uint8_t EFFECT_MAX_STEP = 4;
+
+// Stars a starfield can hold
+static constexpr uint8_t EFFECT_MAX_STARS = 128;
+
+/**
+ * @brief Procedural effect
+ */
+enum class EffectKind : uint8_t {
+    Plasma,     // sum of sine waves mapped through a cycling palette
+    Starfield,  // stars flying towards the viewer
+    Fire,       // heat rising from the bottom row and cooling as it goes
+    Matrix,     // columns of glyphs raining down
+};
+
+static constexpr size_t EFFECT_KIND_COUNT = 4;
+
+/**
+ * @brief Palette of the plasma and the fire (the starfield and the matrix use shades of their color)
+ */
+enum class EffectPalette : uint8_t {
+    Rainbow,
+    Fire,
+    Ocean,
+    Mono,  // shades of the effect color
+};
+
+/**
+ * @brief Effect settings
+ *
+ * speed, scale and density are 1-16 with 4 as a middle value, except the starfield density which is a star count
+ * (up to EFFECT_MAX_STARS). The area is in screen coordinates
+ */
+struct EffectParams {
+    EffectKind kind;
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+    uint8_t fps;      // frame rate aimed at, the detail step follows it
+    uint8_t speed;    // how fast the effect moves
+    uint8_t scale;    // plasma: wave frequency, fire: flame height, matrix: trail length
+    uint8_t density;  // starfield: stars, matrix: columns raining at a time
+    uint16_t color;   // starfield and matrix tint, plasma mono palette
+    EffectPalette palette;
+};
+
+/**
+ * @brief Achieved frame rate of one effect (the last time it ran)
+ */
+struct EffectStats {
+    uint32_t frames;
+    uint16_t fps;        // frames completed over the last second
+    uint32_t frameUs;    // rendering time of the last frame, slices added up
+    uint32_t maxFrameUs;
+    uint8_t step;        // detail step in use: one sample per step x step pixels
+};
+
+/**
+ * @brief Procedural effects rendered on the device, driven by DisplayManager::update()
+ *
+ * A frame is rendered line by line into a strip buffer of EFFECT_STRIP_ROWS rows and sent with blitPanel(), so no
+ * framebuffer is needed. The effects only use integer math and lookup tables built when they start (a 256-entry
+ * sine table and a 256-entry palette in panel byte order).
+ *
+ * Each frame gets a budget of 1/fps seconds. An effect that overruns it is rendered at a coarser detail step (one
+ * sample per 2x2 then 4x4 pixels), one that stays well below goes back to a finer step; rendering is cut into
+ * slices of EFFECT_SLICE_US so the web server keeps answering while a frame is drawn
+ */
+namespace Effects {
+
+auto start(const EffectParams& params, uint32_t nowMs) -> bool;
+auto setParams(const EffectParams& params, uint32_t nowMs) -> bool;
+void stop();
+auto running() -> bool;
+auto params() -> EffectParams;
+auto defaults(EffectKind kind) -> EffectParams;
+void update(uint32_t nowMs);
+auto stats(EffectKind kind) -> EffectStats;
+auto kindName(EffectKind kind) -> const char*;
+auto paletteName(EffectPalette palette) -> const char*;
+
+}  // namespace Effects
+
+#endif  // DISPLAY_EFFECTS_H
@@ -0,0 +1,126 @@
+#ifndef DISPLAY_FIXED_MATH_H
+#define DISPLAY_FIXED_MATH_H
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Integer trigonometry and roots for the rasterizers
+ *
+ * Angles are binary angles: ANGLE_FULL steps per turn, so wrapping is a mask. Sines are Q14 (ONE = 1.0), read from
+ * a quarter-wave table generated at compile time and linearly interpolated (error around 1e-4)
+ */
+namespace FixedMath {
+
+static constexpr uint8_t ONE_SHIFT = 14;
+static constexpr int32_t ONE = 1 << ONE_SHIFT;
+
+static constexpr int32_t ANGLE_FULL = 4096;
+static constexpr int32_t ANGLE_QUARTER = ANGLE_FULL / 4;
+
+static constexpr uint8_t SINE_TABLE_SHIFT = 6;  // 64 segments per quarter turn
+static constexpr int32_t SINE_TABLE_SIZE = 1 << SINE_TABLE_SHIFT;
+static constexpr int32_t SINE_SEGMENT = ANGLE_QUARTER / SINE_TABLE_SIZE;
+
+/**
+ * @brief sin(x) for x in [0, pi/2], evaluated with a Taylor series at compile time
+ */
+constexpr auto taylorSine(double rad) -> double {
+    double term = rad;
+    double sum = rad;
+    for (int n = 1; n < 12; ++n) {
+        term *= -rad * rad / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr auto makeSineQuarter() -> std::array<int16_t, SINE_TABLE_SIZE + 1> {
+    constexpr double HALF_PI = 1.57079632679489661923;
+    std::array<int16_t, SINE_TABLE_SIZE + 1> table{};
+    for (int32_t i = 0; i <= SINE_TABLE_SIZE; ++i) {
+        table[i] = static_cast<int16_t>(taylorSine(HALF_PI * i / SINE_TABLE_SIZE) * ONE + 0.5);
+    }
+    return table;
+}
+
+static constexpr std::array<int16_t, SINE_TABLE_SIZE + 1> SINE_QUARTER = makeSineQuarter();
+
+/**
+ * @brief Sine of a binary angle
+ *
+ * @param angle Angle in 1/ANGLE_FULL turns, any value (wraps)
+ * @return sin(angle) in Q14
+ */
+inline auto sin(int32_t angle) -> int32_t {
+    angle &= ANGLE_FULL - 1;
+
+    const bool negative = angle >= ANGLE_FULL / 2;
+    angle &= ANGLE_FULL / 2 - 1;
+    if (angle > ANGLE_QUARTER) {
+        angle = ANGLE_FULL / 2 - angle;
+    }
+
+    const int32_t index = angle / SINE_SEGMENT;
+    const int32_t fraction = angle % SINE_SEGMENT;
+    int32_t value = SINE_QUARTER[index];
+    if (fraction != 0) {
+        value += ((SINE_QUARTER[index + 1] - value) * fraction) / SINE_SEGMENT;
+    }
+
+    return negative ? -value : value;
+}
+
+/**
+ * @brief Cosine of a binary angle, in Q14
+ */
+inline auto cos(int32_t angle) -> int32_t { return FixedMath::sin(angle + ANGLE_QUARTER); }
+
+/**
+ * @brief Convert degrees to a binary angle (rounded)
+ */
+constexpr auto fromDegrees(int32_t degrees) -> int32_t {
+    constexpr int32_t DEGREES_FULL = 360;
+    const int32_t scaled = degrees * ANGLE_FULL;
+    return (scaled >= 0 ? scaled + DEGREES_FULL / 2 : scaled - DEGREES_FULL / 2) / DEGREES_FULL;
+}
+
+/**
+ * @brief Integer square root, rounded down
+ */
+inline auto isqrt(uint32_t value) -> uint32_t {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30U;
+
+    while (bit > value) {
+        bit >>= 2U;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1U) + bit;
+        } else {
+            root >>= 1U;
+        }
+        bit >>= 2U;
+    }
+
+    return root;
+}
+
+/**
+ * @brief Division rounded towards negative infinity
+ */
+constexpr auto floorDiv(int32_t num, int32_t den) -> int32_t {
+    const int32_t quotient = num / den;
+    return (quotient * den != num && ((num < 0) != (den < 0))) ? quotient - 1 : quotient;
+}
+
+/**
+ * @brief Division rounded towards positive infinity
+ */
+constexpr auto ceilDiv(int32_t num, int32_t den) -> int32_t { return -floorDiv(-num, den); }
+
+}  // namespace FixedMath
+
+#endif  // DISPLAY_FIXED_MATH_H
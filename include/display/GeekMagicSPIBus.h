@@ -4,6 +4,8 @@
 #include <Arduino_GFX_Library.h>
 #include <SPI.h>
 
+#include "display/SpiFifo.h"
+
 /**
  * @brief Determines whether the Chip Select (CS) line should remain asserted (active low) between SPI transactions
  */
@@ -31,9 +33,16 @@ class GeekMagicSPIBus : public Arduino_DataBus {
     void writeCommandBytes(uint8_t* data, uint32_t len) override { _spi.writeCommandBytes(data, len); }
     void write(uint8_t d) override { _spi.write(d); }
     void write16(uint16_t d) override { _spi.write16(d); }
+#if GEEKMAGIC_FAST_SPI && defined(ESP8266)
+    // Pixel bursts bypass Arduino_HWSPI/SPIClass and load the HSPI data registers directly
+    void writeRepeat(uint16_t p, uint32_t len) override { HspiFifo::writeRepeat(p, len); }
+    void writeBytes(uint8_t* data, uint32_t len) override { HspiFifo::writeBytes(data, len); }
+    void writePixels(uint16_t* data, uint32_t len) override { HspiFifo::writePixels(data, len); }
+#else
     void writeRepeat(uint16_t p, uint32_t len) override { _spi.writeRepeat(p, len); }
     void writeBytes(uint8_t* data, uint32_t len) override { _spi.writeBytes(data, len); }
     void writePixels(uint16_t* data, uint32_t len) override { _spi.writePixels(data, len); }
+#endif
 
    private:
     Arduino_HWSPI _spi;
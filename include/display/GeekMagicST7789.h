@@ -0,0 +1,90 @@
+#ifndef DISPLAY_GEEKMAGIC_ST7789_H
+#define DISPLAY_GEEKMAGIC_ST7789_H
+
+#include <Arduino_GFX_Library.h>
+
+#include "display/Viewport.h"
+
+/**
+ * @brief Orientation of the picture on the panel
+ *
+ * Mirroring is applied in screen space after the rotation, so mirrorX always flips left/right as seen by the viewer.
+ * HoloCube units show the panel through a reflective prism and need mirrorX
+ */
+struct DisplayTransform {
+    bool mirrorX;
+    bool mirrorY;
+    uint16_t rotate;  // 0, 90, 180 or 270 degrees
+};
+
+/**
+ * @brief Map a legacy Arduino_GFX rotation (0-7, "lcd_rotation") to a display transform
+ *
+ * @param rotation The Arduino_GFX rotation
+ * @return The equivalent transform
+ */
+auto transformFromRotation(uint8_t rotation) -> DisplayTransform;
+
+/**
+ * @brief Check that a rotation in degrees is one the panel supports
+ *
+ * @param degrees The rotation
+ * @return true for 0, 90, 180 and 270
+ */
+auto isValidRotate(int degrees) -> bool;
+
+/**
+ * @class GeekMagicST7789
+ * @brief ST7789 driver whose orientation is a free combination of rotation and mirroring
+ *
+ * The transform is folded into the MADCTL register (MX/MY/MV) and the RAM address offsets, so mirroring and
+ * rotation cost nothing per pixel and apply to every primitive, text and GIF alike.
+ *
+ * An optional clip rect trims everything Arduino_GFX rasterizes: all primitives and text funnel into the
+ * writePixelPreclipped()/writeFillRectPreclipped() overrides. Raw address-window writes (GIF lines) are not clipped
+ *
+ * Every address window also goes through an optional hook, which screen transitions use to pace whatever is being
+ * drawn. The frame memory lines the panel does not show can be filled and scrolled into view with the hardware
+ * vertical scrolling registers (VSCRDEF/VSCSAD)
+ */
+class GeekMagicST7789 : public Arduino_ST7789 {
+   public:
+    // Called with every address window before it is set: x, y, w, h in screen coordinates
+    using WindowHook = void (*)(int16_t, int16_t, uint16_t, uint16_t);
+
+    GeekMagicST7789(Arduino_DataBus* bus, int16_t width, int16_t height, const DisplayTransform& transform);
+
+    void setRotation(uint8_t r) override;
+
+    auto setTransform(const DisplayTransform& transform) -> void;
+    auto getTransform() const -> DisplayTransform;
+    auto madctl() const -> uint8_t;
+
+    static auto madctlFor(const DisplayTransform& transform) -> uint8_t;
+
+    auto setClip(const ClipRect& clip) -> void;
+    auto clearClip() -> void;
+
+    auto setWindowHook(WindowHook hook) -> void;
+    void writeAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) override;
+
+    auto spareRows() const -> int16_t;
+    auto fillSpareRows(uint16_t color) -> void;
+    auto setScroll(uint16_t lines) -> void;
+    auto endScroll() -> void;
+
+    void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) override;
+    void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg) override;
+
+   private:
+    DisplayTransform m_transform;
+    ClipRect m_clip{0, 0, 0, 0};
+    bool m_clipped = false;
+    WindowHook m_windowHook = nullptr;
+    bool m_scrolling = false;
+    int16_t m_panelW;
+    int16_t m_panelH;
+};
+
+#endif  // DISPLAY_GEEKMAGIC_ST7789_H
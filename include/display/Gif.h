@@ -6,6 +6,29 @@
 #include <LittleFS.h>
 #include <array>
 
+/**
+ * @brief Per-frame decode cost of the GIF currently (or last) played
+ */
+struct GifFrameStats {
+    uint32_t frames;
+    uint32_t avgCycles;
+    uint32_t maxCycles;
+    uint32_t avgUs;
+};
+
+/**
+ * @brief Frame deadlines met by a synced playback (see Gif::playAt), lateness in sync-clock microseconds
+ */
+struct GifSyncStats {
+    bool active;
+    uint64_t startUs;
+    uint16_t startFrame;
+    uint32_t frames;    // frames shown against a deadline
+    uint32_t late;      // shown after their slot had ended, back to back to catch up
+    int32_t avgLateUs;  // mean of shown minus due, negative when ahead
+    int32_t maxLateUs;
+};
+
 class Gif {
    public:
     Gif();
@@ -13,11 +36,14 @@ class Gif {
 
     auto begin() -> bool;
     auto playOne(const String& path) -> bool;
+    auto playAt(const String& path, uint64_t startUs, uint16_t startFrame) -> bool;
     auto update() -> void;
     auto playAllFromLittleFS() -> bool;
     auto stop() -> void;
     auto isPlaying() const -> bool;
     auto setLoopEnabled(bool enabled) -> void;
+    auto frameStats() const -> GifFrameStats;
+    auto syncStats() const -> GifSyncStats;
 
    private:
     AnimatedGIF* m_gif;
@@ -32,6 +58,20 @@ class Gif {
     uint32_t m_startMs;
     int m_frameCount;
 
+    uint32_t m_statFrames = 0;
+    uint64_t m_statCycles = 0;
+    uint32_t m_statMaxCycles = 0;
+
+    bool m_synced = false;
+    uint64_t m_deadlineUs = 0;
+    uint64_t m_syncStartUs = 0;
+    uint16_t m_syncStartFrame = 0;
+    uint16_t m_startFrame = 0;  // frames before it are drawn without waiting, 0 after the first loop
+    uint32_t m_syncFrames = 0;
+    uint32_t m_syncLate = 0;
+    int64_t m_syncLateSumUs = 0;
+    int32_t m_syncMaxLateUs = 0;
+
     static constexpr size_t LINEBUF_MAX = 240;
 
     std::array<uint16_t, LINEBUF_MAX> m_lineBuf;
@@ -62,6 +102,9 @@ class Gif {
 
     static Gif* s_instance;
 
+    auto waitForDeadline() -> bool;
+    auto recordDeadline(uint64_t shownUs, uint32_t slotMs) -> void;
+
     static auto gifOpenFile(const char* fname, int32_t* pSize) -> void*;
     static auto gifCloseFile(void* pHandle) -> void;
     static auto gifReadFile(GIFFILE* pFile, uint8_t* pBuf, int32_t iLen) -> int32_t;
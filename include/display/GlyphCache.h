@@ -0,0 +1,47 @@
+#ifndef DISPLAY_GLYPH_CACHE_H
+#define DISPLAY_GLYPH_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel memory of the cache, allocated on the first glyph and kept until clear()
+static constexpr size_t GLYPH_CACHE_BYTES = 8192;
+
+// Glyphs the cache holds at most
+static constexpr size_t GLYPH_CACHE_ENTRIES = 64;
+
+// Largest text size kept in the cache, bigger glyphs are drawn by Arduino_GFX
+static constexpr uint8_t GLYPH_CACHE_MAX_SIZE = 4;
+
+// Cell of the built-in 5x7 font at size 1, spacing column included
+static constexpr int16_t GLYPH_CELL_WIDTH = 6;
+static constexpr int16_t GLYPH_CELL_HEIGHT = 8;
+
+/**
+ * @brief Lookups since boot
+ */
+struct GlyphCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t flushes;  // times the cache was full and started over
+    uint32_t bytes;    // pixel memory in use
+};
+
+/**
+ * @brief Rendered glyphs of the built-in font, ready to be sent to the panel
+ *
+ * A glyph is rendered once per character, size and color pair into a cell of GLYPH_CELL_WIDTH x GLYPH_CELL_HEIGHT
+ * pixels times the size, in panel byte order, and then sent with one address window each time it is drawn
+ * (Arduino_GFX fills one rectangle per font pixel at sizes above 1). Cells are packed one after the other; when the
+ * memory or the entry table is full the whole cache starts over, which suits screens reusing a small set of
+ * characters such as digits
+ */
+namespace GlyphCache {
+
+auto glyph(char chr, uint8_t size, uint16_t fgColor, uint16_t bgColor) -> const uint16_t*;
+void clear();
+auto stats() -> GlyphCacheStats;
+
+}  // namespace GlyphCache
+
+#endif  // DISPLAY_GLYPH_CACHE_H
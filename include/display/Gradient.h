@@ -0,0 +1,89 @@
+#ifndef DISPLAY_GRADIENT_H
+#define DISPLAY_GRADIENT_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Number of color stops a gradient can have
+static constexpr uint8_t GRADIENT_MIN_STOPS = 2;
+static constexpr uint8_t GRADIENT_MAX_STOPS = 4;
+
+enum class GradientKind : uint8_t {
+    Linear,
+    Radial,
+};
+
+/**
+ * @brief One color stop, at position 0 (start) to 255 (end) along the gradient
+ */
+struct GradientStop {
+    uint8_t pos;
+    uint32_t rgb;  // 0xRRGGBB
+};
+
+/**
+ * @brief Definition of a gradient, in the same coordinates as the area it fills
+ *
+ * Linear gradients run from (startX, startY) to (endX, endY) and are constant across that axis. Radial gradients
+ * run from (centerX, centerY) out to radius. Colors before the first stop and past the last one are clamped
+ */
+struct GradientSpec {
+    GradientKind kind;
+    uint8_t stopCount;
+    std::array<GradientStop, GRADIENT_MAX_STOPS> stops;
+    int16_t startX;
+    int16_t startY;
+    int16_t endX;
+    int16_t endY;
+    int16_t centerX;
+    int16_t centerY;
+    int16_t radius;
+    bool dither;
+};
+
+/**
+ * @class Gradient
+ * @brief Scanline generator for a GradientSpec
+ *
+ * The stops are expanded once into a 256-entry ramp. Per pixel, linear gradients advance a 12.20 fixed-point
+ * position by a constant step and radial gradients track the ramp index against precomputed squared-distance
+ * thresholds, so the inner loop is additions and compares only (one division per line at most). The 8-bit ramp
+ * is reduced to RGB565 through a 4x4 ordered (Bayer) dither to hide the banding of the 5/6-bit channels
+ */
+class Gradient {
+   public:
+    static constexpr uint16_t RAMP_SIZE = 256;
+
+    explicit Gradient(const GradientSpec& spec);
+
+    void renderLine(uint16_t* out, int16_t posX, int16_t posY, uint16_t count) const;
+
+   private:
+    void buildRamp(const GradientSpec& spec);
+    void renderLinear(uint16_t* out, int16_t posX, int16_t posY, uint16_t count) const;
+    void renderRadial(uint16_t* out, int16_t posX, int16_t posY, uint16_t count) const;
+
+    GradientKind m_kind;
+    bool m_dither;
+
+    // Ramp channels, pre-scaled so that (value + threshold) >> shift never exceeds the 5/6-bit channel maximum
+    std::array<uint8_t, RAMP_SIZE> m_red{};
+    std::array<uint8_t, RAMP_SIZE> m_green{};
+    std::array<uint8_t, RAMP_SIZE> m_blue{};
+
+    // Linear: axis start and direction, squared axis length and the per-pixel position step along x (12.20)
+    int16_t m_startX = 0;
+    int16_t m_startY = 0;
+    int32_t m_axisX = 0;
+    int32_t m_axisY = 0;
+    int64_t m_axisLength2 = 1;
+    int32_t m_stepX = 0;
+
+    // Radial: center and the squared distance at which each ramp index starts
+    int16_t m_centerX = 0;
+    int16_t m_centerY = 0;
+    std::vector<uint32_t> m_thresholds;
+};
+
+#endif  // DISPLAY_GRADIENT_H
@@ -0,0 +1,47 @@
+#ifndef DISPLAY_JPEG_H
+#define DISPLAY_JPEG_H
+
+#include <Arduino.h>
+
+// Scale value asking for the largest of 1/1, 1/2, 1/4, 1/8 that fits the screen
+static constexpr uint8_t JPEG_SCALE_FIT = 0;
+
+/**
+ * @brief Outcome of one JPEG decode
+ */
+struct JpegResult {
+    bool ok;
+    int16_t width;      // drawn size, after scaling
+    int16_t height;
+    uint8_t scale;      // divisor applied during the IDCT: 1, 2, 4 or 8
+    uint32_t decodeUs;  // decode and transfer time
+    int error;          // JPEGDEC error code, 0 on success
+};
+
+/**
+ * @brief Decode cost of the JPEG images drawn since boot
+ */
+struct JpegStats {
+    uint32_t images;
+    uint32_t lastUs;
+    uint32_t avgUs;
+    uint32_t maxUs;
+};
+
+/**
+ * @brief Streaming baseline JPEG decoder writing straight to the panel
+ *
+ * The file is read from LittleFS through JPEGDEC's small input buffer and decoded one MCU row at a time (8x8 or
+ * 16x16 blocks); each decoded block is already big-endian RGB565 and goes to its own address window through
+ * DisplayManager::blitPanel(), so no frame buffer is involved. Scaling by 1/2, 1/4 and 1/8 happens inside the
+ * IDCT, which also makes the reduced decodes proportionally cheaper. The decoder state (~17 KB) only lives on the
+ * heap for the duration of one image
+ */
+namespace Jpeg {
+
+auto drawFile(const String& path, int16_t posX, int16_t posY, uint8_t scale) -> JpegResult;
+auto stats() -> JpegStats;
+
+}  // namespace Jpeg
+
+#endif  // DISPLAY_JPEG_H
@@ -0,0 +1,182 @@
+#ifndef DISPLAY_MACRO_H
+#define DISPLAY_MACRO_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "display/DrawBatch.h"
+
+// Compiled macros live in this directory, one file per macro
+static constexpr const char* MACRO_DIR = "/macro";
+
+// Longest macro and parameter names, terminator included
+static constexpr size_t MACRO_NAME_MAX = 24;
+static constexpr size_t MACRO_PARAM_NAME_MAX = 16;
+
+// Limits of one macro
+static constexpr size_t MACRO_MAX_PARAMS = 16;
+static constexpr size_t MACRO_MAX_COMMANDS = 128;
+static constexpr size_t MACRO_MAX_TEXT_BYTES = 2048;
+
+// Macros the RAM index holds at most
+static constexpr size_t MACRO_MAX_STORED = 32;
+
+// Text offset of a command without text
+static constexpr uint16_t MACRO_NO_TEXT = UINT16_MAX;
+
+/**
+ * @brief Command field a parameter writes when the macro is invoked
+ */
+enum class MacroField : uint8_t {
+    Arg0,  // Arg0 to Arg5 are DrawCommand::args
+    Arg1,
+    Arg2,
+    Arg3,
+    Arg4,
+    Arg5,
+    Color,
+    Bg,
+    Text,
+    Size,
+    Alpha,
+};
+
+/**
+ * @brief What the values of a parameter are read as, one bit per use
+ */
+enum MacroUse : uint8_t {
+    MACRO_USE_NUMBER = 1U << 0U,
+    MACRO_USE_COLOR = 1U << 1U,
+    MACRO_USE_TEXT = 1U << 2U,
+};
+
+/**
+ * @brief A draw command as stored in a macro: the text is an offset in the text pool, ref indexes the macro's
+ * gradients or paths
+ */
+struct MacroCommand {
+    DrawOp op;
+    bool fill;
+    bool clearBg;
+    uint8_t size;
+    uint8_t alpha;
+    bool hasBg;
+    LineCap cap;
+    uint16_t color;
+    uint16_t bg;
+    int16_t args[DRAW_COMMAND_ARGS];
+    uint16_t text;
+    uint16_t ref;
+};
+
+/**
+ * @brief Parameter slot: invoking the macro with a value for param writes it into one field of one command
+ */
+struct MacroBinding {
+    uint16_t command;
+    MacroField field;
+    uint8_t param;
+};
+
+/**
+ * @brief A path of a macro, its vertices are a range of the macro's vertex pool
+ */
+struct MacroPath {
+    uint16_t first;
+    uint16_t count;
+    FillRule rule;
+    int16_t boundsX0;
+    int16_t boundsY0;
+    int16_t boundsX1;
+    int16_t boundsY1;
+};
+
+/**
+ * @brief Value of one parameter for an invocation, read as every use the macro makes of it
+ */
+struct MacroArg {
+    bool set;  // false keeps the default compiled into the macro
+    int16_t number;
+    uint16_t color;
+    const char* text;  // not owned, must outlive the batch
+};
+
+/**
+ * @brief Entry of the RAM index
+ */
+struct MacroInfo {
+    std::array<char, MACRO_NAME_MAX> name;
+    uint16_t commands;
+    uint8_t params;
+    uint32_t bytes;
+};
+
+/**
+ * @brief Invocations since boot
+ */
+struct MacroStats {
+    uint32_t invocations;
+    uint32_t misses;  // invocations of a macro that does not exist
+    uint32_t lastLoadUs;
+    uint32_t lastExpandUs;
+};
+
+/**
+ * @class MacroProgram
+ * @brief A compiled macro: draw commands with their defaults baked in, and the parameter slots that override them
+ *
+ * Built once from JSON when the macro is uploaded, then stored as is. Invoking it copies the commands into a batch
+ * and patches the bound fields, nothing is parsed. The program must outlive the batch it expanded into (text
+ * pointers point into its text pool)
+ */
+class MacroProgram {
+   public:
+    auto addParam(const char* name) -> int;
+    auto findParam(const char* name) const -> int;
+    auto addCommand(const DrawCommand& command) -> bool;
+    auto bind(MacroField field, uint8_t param) -> void;
+    auto addGradient(const GradientSpec& spec) -> uint16_t;
+    auto addPath(const PathSpec& spec) -> uint16_t;
+
+    auto paramCount() const -> size_t { return m_params.size(); }
+    auto paramName(size_t index) const -> const char* { return m_params[index].data(); }
+    auto paramUses(size_t index) const -> uint8_t;
+    auto commandCount() const -> size_t { return m_commands.size(); }
+
+    auto expand(DrawBatch& batch, const MacroArg* args) const -> bool;
+
+    auto save(File& file) const -> bool;
+    auto load(File& file) -> bool;
+
+   private:
+    std::vector<std::array<char, MACRO_PARAM_NAME_MAX>> m_params;
+    std::vector<MacroCommand> m_commands;
+    std::vector<MacroBinding> m_bindings;
+    std::vector<GradientSpec> m_gradients;
+    std::vector<MacroPath> m_paths;
+    std::vector<PathVertex> m_vertices;
+    std::vector<char> m_text;
+};
+
+/**
+ * @brief Stored macros on LittleFS, indexed in RAM so a lookup never touches the file system
+ */
+namespace Macro {
+
+void loadIndex();
+auto validName(const char* name) -> bool;
+auto store(const char* name, const MacroProgram& program) -> bool;
+auto remove(const char* name) -> bool;
+auto load(const char* name) -> std::unique_ptr<MacroProgram>;
+auto index() -> const std::vector<MacroInfo>&;
+void recordExpand(uint32_t elapsedUs);
+auto stats() -> MacroStats;
+
+}  // namespace Macro
+
+#endif  // DISPLAY_MACRO_H
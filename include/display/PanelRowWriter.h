@@ -0,0 +1,54 @@
+#ifndef DISPLAY_PANEL_ROW_WRITER_H
+#define DISPLAY_PANEL_ROW_WRITER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Pixels gathered before a transfer, two 240-pixel rows
+static constexpr size_t PANEL_ROW_BUFFER_PIXELS = 480;
+
+/**
+ * @class PanelRowWriter
+ * @brief Collects a streamed image, pixel by pixel in row-major order, into whole rows sent to the panel
+ *
+ * Pixels are panel-order RGB565. As many whole rows as fit the buffer go out with one address window through
+ * DisplayManager::blitPanel() (viewport translation and clip apply); rows wider than the buffer go out in
+ * segments. Memory use does not depend on the image size, which is what lets decoders stream images of any size
+ */
+class PanelRowWriter {
+   public:
+    void begin(int16_t posX, int16_t posY, uint16_t width, uint16_t height);
+
+    /**
+     * @brief Append one pixel, pixels past the end of the image are dropped
+     */
+    void push(uint16_t color) {
+        if (m_fill < m_limit) {
+            m_buffer[m_fill++] = color;
+            if (m_fill == m_limit) {
+                flush();
+            }
+        }
+    }
+
+    void pushRun(uint16_t color, uint32_t count);
+    void pushBytes(const uint8_t* src, uint32_t count);
+
+   private:
+    void flush();
+    void updateLimit();
+
+    int16_t m_posX = 0;
+    int16_t m_posY = 0;
+    uint16_t m_width = 0;
+    uint16_t m_height = 0;
+
+    std::array<uint16_t, PANEL_ROW_BUFFER_PIXELS> m_buffer{};
+    uint32_t m_fill = 0;
+    uint32_t m_limit = 0;  // fill level at which the buffer ends a row (or segment) and is flushed
+    uint16_t m_row = 0;    // image row of the first buffered pixel
+    uint16_t m_column = 0;
+};
+
+#endif  // DISPLAY_PANEL_ROW_WRITER_H
@@ -0,0 +1,86 @@
+#ifndef DISPLAY_PATH_H
+#define DISPLAY_PATH_H
+
+#include <cstdint>
+
+#include "display/Arena.h"
+
+/**
+ * @brief Which points a self-intersecting or nested path covers
+ */
+enum class FillRule : uint8_t {
+    NonZero,
+    EvenOdd,
+};
+
+/**
+ * @brief Path vertex in 12.4 fixed point (1/16 pixel)
+ */
+struct PathVertex {
+    int16_t x;
+    int16_t y;
+};
+
+static constexpr uint8_t PATH_SUBPIXEL_SHIFT = 4;
+static constexpr int32_t PATH_SUBPIXEL_ONE = 1 << PATH_SUBPIXEL_SHIFT;
+
+// Separates the contours (sub-paths) of a path
+static constexpr PathVertex PATH_CONTOUR_BREAK{INT16_MIN, INT16_MIN};
+
+/**
+ * @brief A flattened path: contours of straight edges, each implicitly closed
+ *
+ * The vertices live in the request arena. bounds is the covered pixel box [x0, x1) x [y0, y1)
+ */
+struct PathSpec {
+    const PathVertex* vertices;
+    uint16_t count;
+    FillRule rule;
+    int16_t boundsX0;
+    int16_t boundsY0;
+    int16_t boundsX1;
+    int16_t boundsY1;
+};
+
+/**
+ * @class PathBuilder
+ * @brief Appends move/line/quadratic segments to a path in an arena
+ *
+ * Coordinates are 12.4 fixed point, like PathVertex. Quadratic curves are flattened on the fly into just enough
+ * line segments to stay within a quarter pixel of the curve. Building stops (and every call returns false) once
+ * maxVertices or the arena is exhausted
+ */
+class PathBuilder {
+   public:
+    PathBuilder(Arena& arena, uint16_t maxVertices);
+
+    auto moveTo(int32_t posX, int32_t posY) -> bool;
+    auto lineTo(int32_t posX, int32_t posY) -> bool;
+    auto quadTo(int32_t controlX, int32_t controlY, int32_t posX, int32_t posY) -> bool;
+    auto close() -> bool;
+
+    auto ok() const -> bool { return m_ok; }
+    auto finish(FillRule rule) const -> PathSpec;
+
+   private:
+    auto append(PathVertex vertex) -> bool;
+
+    Arena& m_arena;
+    uint16_t m_maxVertices;
+    PathVertex* m_vertices = nullptr;
+    uint16_t m_count = 0;
+    bool m_ok = true;
+    bool m_contourOpen = false;
+    int32_t m_startX = 0;
+    int32_t m_startY = 0;
+    int32_t m_lastX = 0;
+    int32_t m_lastY = 0;
+    int32_t m_minX = INT32_MAX;
+    int32_t m_minY = INT32_MAX;
+    int32_t m_maxX = INT32_MIN;
+    int32_t m_maxY = INT32_MIN;
+};
+
+auto parsePathData(const char* data, PathBuilder& builder) -> bool;
+
+#endif  // DISPLAY_PATH_H
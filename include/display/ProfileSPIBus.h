@@ -0,0 +1,133 @@
+#ifndef DISPLAY_PROFILE_SPI_BUS_H
+#define DISPLAY_PROFILE_SPI_BUS_H
+
+#if defined(ESP8266)
+
+#include <Arduino_GFX_Library.h>
+#include <SPI.h>
+
+#include "display/SpiFifo.h"
+
+/**
+ * @class ProfileSPIBus
+ * @brief Display bus specialised on a compile-time board profile
+ *
+ * Pins, polarities and clock come from the profile as constants, CS and DC are driven through the GPIO set/clear
+ * registers and every transfer goes straight to the HSPI data buffer. The class is final so that, apart from the
+ * single virtual call Arduino_GFX makes into the bus, the write path inlines completely
+ *
+ * @tparam Profile A board profile such as HelloCubicLiteProfile
+ */
+template <typename Profile>
+class ProfileSPIBus final : public Arduino_DataBus {
+    static_assert(Profile::CS_GPIO >= 0 && Profile::CS_GPIO < 16, "CS must be a GPIO0-15 pin");
+    static_assert(Profile::DC_GPIO >= 0 && Profile::DC_GPIO < 16, "DC must be a GPIO0-15 pin");
+
+    static constexpr uint32_t CS_MASK = 1UL << Profile::CS_GPIO;
+    static constexpr uint32_t DC_MASK = 1UL << Profile::DC_GPIO;
+
+   public:
+    ProfileSPIBus() = default;
+    virtual ~ProfileSPIBus() { endTransaction(); }
+
+    bool begin(int32_t speed = GFX_NOT_DEFINED, int8_t dataMode = GFX_NOT_DEFINED) override {
+        (void)speed;
+        (void)dataMode;
+
+        pinMode(static_cast<uint8_t>(Profile::CS_GPIO), OUTPUT);
+        pinMode(static_cast<uint8_t>(Profile::DC_GPIO), OUTPUT);
+        csRelease();
+        dcData();
+
+        // The bus keeps HSPI for its whole life: begin() runs again after a panel reset, so the transaction is
+        // closed before it is opened with the profile settings
+        endTransaction();
+        SPI.begin();
+        SPI.beginTransaction(SPISettings(Profile::SPI_HZ, MSBFIRST, Profile::SPI_MODE));
+        m_transaction = true;
+
+        return true;
+    }
+
+    void beginWrite() override {
+        csSelect();
+        dcData();
+    }
+
+    void endWrite() override {
+        if (Profile::KEEP_CS_ASSERTED) {
+            return;
+        }
+        csRelease();
+    }
+
+    void writeCommand(uint8_t c) override {
+        dcCommand();
+        HspiFifo::writeBytes(&c, 1);
+        dcData();
+    }
+
+    void writeCommand16(uint16_t c) override {
+        dcCommand();
+        HspiFifo::writePixels(&c, 1);
+        dcData();
+    }
+
+    void writeCommandBytes(uint8_t* data, uint32_t len) override {
+        dcCommand();
+        HspiFifo::writeBytes(data, len);
+        dcData();
+    }
+
+    void write(uint8_t d) override { HspiFifo::writeBytes(&d, 1); }
+    void write16(uint16_t d) override { HspiFifo::writePixels(&d, 1); }
+    void writeRepeat(uint16_t p, uint32_t len) override { HspiFifo::writeRepeat(p, len); }
+    void writeBytes(uint8_t* data, uint32_t len) override { HspiFifo::writeBytes(data, len); }
+    void writePixels(uint16_t* data, uint32_t len) override { HspiFifo::writePixels(data, len); }
+
+   private:
+    bool m_transaction = false;
+
+    void endTransaction() {
+        if (m_transaction) {
+            SPI.endTransaction();
+            m_transaction = false;
+        }
+    }
+
+    static inline void csSelect() {
+        if (Profile::CS_ACTIVE_HIGH) {
+            GPOS = CS_MASK;
+        } else {
+            GPOC = CS_MASK;
+        }
+    }
+
+    static inline void csRelease() {
+        if (Profile::CS_ACTIVE_HIGH) {
+            GPOC = CS_MASK;
+        } else {
+            GPOS = CS_MASK;
+        }
+    }
+
+    static inline void dcCommand() {
+        if (Profile::DC_CMD_HIGH) {
+            GPOS = DC_MASK;
+        } else {
+            GPOC = DC_MASK;
+        }
+    }
+
+    static inline void dcData() {
+        if (Profile::DC_CMD_HIGH) {
+            GPOC = DC_MASK;
+        } else {
+            GPOS = DC_MASK;
+        }
+    }
+};
+
+#endif  // ESP8266
+
+#endif  // DISPLAY_PROFILE_SPI_BUS_H
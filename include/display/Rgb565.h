@@ -0,0 +1,167 @@
+#ifndef DISPLAY_RGB565_H
+#define DISPLAY_RGB565_H
+
+#include <cstdint>
+
+/**
+ * @brief Helpers for RGB565 pixels in panel byte order
+ *
+ * The ST7789 expects every pixel MSB first. Buffers that are streamed with Arduino_DataBus::writeBytes() must
+ * therefore hold big-endian (BE) RGB565 values, which on the little-endian ESP8266 means byte-swapped uint16_t
+ */
+namespace Rgb565 {
+
+/**
+ * @brief Convert a native RGB565 value to panel (big-endian) byte order, or back
+ *
+ * @param color The color to swap
+ * @return The byte-swapped color
+ */
+constexpr auto swap(uint16_t color) -> uint16_t {
+    return static_cast<uint16_t>(static_cast<uint16_t>(color << 8U) | static_cast<uint16_t>(color >> 8U));
+}
+
+/**
+ * @brief Pack 8-bit channels into a native RGB565 value
+ *
+ * @param red Red channel
+ * @param green Green channel
+ * @param blue Blue channel
+ * @return The RGB565 color
+ */
+constexpr auto fromRgb(uint8_t red, uint8_t green, uint8_t blue) -> uint16_t {
+    return static_cast<uint16_t>(((red & 0xF8U) << 8U) | ((green & 0xFCU) << 3U) | (blue >> 3U));
+}
+
+/**
+ * @brief Value of one hexadecimal digit
+ *
+ * @param chr The character
+ * @return 0-15, or -1 when the character is not a hex digit
+ */
+constexpr auto hexDigit(char chr) -> int8_t {
+    return (chr >= '0' && chr <= '9')   ? static_cast<int8_t>(chr - '0')
+           : (chr >= 'a' && chr <= 'f') ? static_cast<int8_t>(chr - 'a' + 10)
+           : (chr >= 'A' && chr <= 'F') ? static_cast<int8_t>(chr - 'A' + 10)
+                                        : static_cast<int8_t>(-1);
+}
+
+/**
+ * @brief Parse a "#rrggbb" (or "rrggbb") color to 24-bit RGB without allocating
+ *
+ * @param hex The color string (may be null)
+ * @param fallback Value returned when the string is not a valid color
+ * @return The color as 0xRRGGBB
+ */
+constexpr auto parseHexRgb(const char* hex, uint32_t fallback) -> uint32_t {
+    if (hex == nullptr) {
+        return fallback;
+    }
+    if (*hex == '#') {
+        ++hex;
+    }
+
+    uint32_t rgb = 0;
+    for (uint8_t i = 0; i < 6; ++i) {
+        const int8_t digit = hexDigit(hex[i]);
+        if (digit < 0) {
+            return fallback;
+        }
+        rgb = (rgb << 4U) | static_cast<uint32_t>(digit);
+    }
+
+    return rgb;
+}
+
+/**
+ * @brief Parse a "#rrggbb" (or "rrggbb") color without allocating
+ *
+ * @param hex The color string (may be null)
+ * @param fallback Value returned when the string is not a valid color
+ * @return The native RGB565 color
+ */
+constexpr auto parseHex(const char* hex, uint16_t fallback) -> uint16_t {
+    constexpr uint32_t INVALID = 0xFF000000U;
+    const uint32_t rgb = parseHexRgb(hex, INVALID);
+
+    if (rgb == INVALID) {
+        return fallback;
+    }
+
+    return fromRgb(static_cast<uint8_t>(rgb >> 16U), static_cast<uint8_t>(rgb >> 8U), static_cast<uint8_t>(rgb));
+}
+
+/**
+ * @brief Expand a native RGB565 value to 24-bit RGB (low bits replicated)
+ *
+ * @param color The RGB565 color
+ * @return The color as 0xRRGGBB
+ */
+constexpr auto toRgb(uint16_t color) -> uint32_t {
+    const uint32_t red = (color >> 11U) & 0x1FU;
+    const uint32_t green = (color >> 5U) & 0x3FU;
+    const uint32_t blue = color & 0x1FU;
+
+    return (((red << 3U) | (red >> 2U)) << 16U) | (((green << 2U) | (green >> 4U)) << 8U) |
+           ((blue << 3U) | (blue >> 2U));
+}
+
+/**
+ * @brief SWAR lane masks for two RGB565 pixels packed in a 32-bit word
+ *
+ * Each lane keeps 5 free bits above its field so it can be multiplied by a 0-32 alpha without spilling into its
+ * neighbour: lane A holds B0, R0 and G1 in place, lane B holds G0, B1 and R1 and is shifted down by 5 first
+ */
+static constexpr uint32_t SWAR_LANE_A = 0x07E0F81FU;
+static constexpr uint32_t SWAR_LANE_B = 0xF81F07E0U;
+static constexpr uint32_t SWAR_ALPHA_MAX = 32;
+
+/**
+ * @brief Reduce an 8-bit alpha to the 0-32 range used by the SWAR blend
+ *
+ * @param alpha Alpha, 0 transparent and 255 opaque
+ * @return Alpha in 0-32
+ */
+constexpr auto alpha32(uint8_t alpha) -> uint32_t { return (static_cast<uint32_t>(alpha) + 4U) >> 3U; }
+
+/**
+ * @brief Blend two native RGB565 pixels over two others in a single pass
+ *
+ * @param fg Two source pixels packed in a word
+ * @param bg Two destination pixels packed in the same order
+ * @param alpha Source weight in 0-32 (see alpha32())
+ * @return The two blended pixels
+ */
+constexpr auto blend2(uint32_t fg, uint32_t bg, uint32_t alpha) -> uint32_t {
+    const uint32_t inverse = SWAR_ALPHA_MAX - alpha;
+    const uint32_t laneA = (((fg & SWAR_LANE_A) * alpha + (bg & SWAR_LANE_A) * inverse) >> 5U) & SWAR_LANE_A;
+    const uint32_t laneB = (((fg & SWAR_LANE_B) >> 5U) * alpha + ((bg & SWAR_LANE_B) >> 5U) * inverse) & SWAR_LANE_B;
+
+    return laneA | laneB;
+}
+
+/**
+ * @brief Blend one native RGB565 pixel over another
+ *
+ * @param fg Source color
+ * @param bg Destination color
+ * @param alpha Source alpha, 0 transparent and 255 opaque
+ * @return The blended color
+ */
+constexpr auto blend(uint16_t fg, uint16_t bg, uint8_t alpha) -> uint16_t {
+    return static_cast<uint16_t>(blend2(fg, bg, alpha32(alpha)));
+}
+
+/**
+ * @brief Convert two packed native pixels to panel byte order, or back
+ *
+ * @param pair Two pixels packed in a word
+ * @return The pair with each pixel byte-swapped
+ */
+constexpr auto swap2(uint32_t pair) -> uint32_t {
+    return ((pair & 0xFF00FF00U) >> 8U) | ((pair & 0x00FF00FFU) << 8U);
+}
+
+}  // namespace Rgb565
+
+#endif  // DISPLAY_RGB565_H
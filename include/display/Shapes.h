@@ -0,0 +1,46 @@
+#ifndef DISPLAY_SHAPES_H
+#define DISPLAY_SHAPES_H
+
+#include <cstdint>
+
+#include "display/Arena.h"
+#include "display/Path.h"
+
+/**
+ * @brief How the ends of thick lines and arcs are finished
+ */
+enum class LineCap : uint8_t {
+    Butt,    // flat, at the end point
+    Square,  // flat, extended by half the width
+    Round,   // half disc
+};
+
+/**
+ * @brief Horizontal run of one color: [x0, x1) on row y
+ */
+struct Span {
+    int16_t x0;
+    int16_t x1;
+    int16_t y;
+    uint16_t color;
+};
+
+/**
+ * @brief Span-based rasterizers for the primitives Arduino_GFX lacks
+ *
+ * Everything is computed in integer/fixed point and emitted as spans through DisplayManager::fillSpans(), so the
+ * current translation and clip apply as for the other primitives. Anti-aliased edges are blended over a known
+ * backdrop color (there is no frame buffer to read back)
+ */
+namespace Shapes {
+
+void drawLineAA(int16_t startX, int16_t startY, int16_t endX, int16_t endY, uint16_t color, uint16_t backdrop);
+void drawThickLine(int16_t startX, int16_t startY, int16_t endX, int16_t endY, uint8_t width, LineCap cap,
+                   uint16_t color);
+void fillArc(int16_t centerX, int16_t centerY, int16_t radius, int16_t thickness, int16_t startDeg, int16_t sweepDeg,
+             LineCap cap, uint16_t color);
+auto fillPath(const PathSpec& path, uint16_t color, Arena& scratch) -> bool;
+
+}  // namespace Shapes
+
+#endif  // DISPLAY_SHAPES_H
@@ -0,0 +1,203 @@
+#ifndef DISPLAY_SPI_FIFO_H
+#define DISPLAY_SPI_FIFO_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(ESP8266)
+#include <esp8266_peri.h>
+#endif
+
+/**
+ * @brief Enables the direct-register HSPI burst writer used by the display buses
+ *
+ * When 0 every pixel transfer goes through Arduino_HWSPI and the Arduino SPI class
+ */
+#ifndef GEEKMAGIC_FAST_SPI
+#define GEEKMAGIC_FAST_SPI 0
+#endif
+
+/**
+ * @brief Size in bytes of the ESP8266 SPI data buffer (W0-W15)
+ */
+static constexpr uint32_t SPI_FIFO_BYTES = 64;
+
+/**
+ * @brief Number of 32-bit data registers in the ESP8266 SPI data buffer
+ */
+static constexpr uint32_t SPI_FIFO_WORDS = SPI_FIFO_BYTES / sizeof(uint32_t);
+
+namespace SpiFifoPack {
+
+/**
+ * @brief Pack up to four bytes into a data register, first byte shifted out first
+ *
+ * The SPI engine sends a data register LSB byte first, so byte 0 of the stream sits in bits 0-7
+ *
+ * @param data Source bytes
+ * @param count Number of valid bytes (1-4), missing bytes are zero
+ * @return The register word
+ */
+inline auto bytes(const uint8_t* data, uint32_t count) -> uint32_t {
+    uint32_t word = 0;
+
+    for (uint32_t i = 0; i < count && i < sizeof(uint32_t); ++i) {
+        word |= static_cast<uint32_t>(data[i]) << (8U * i);
+    }
+
+    return word;
+}
+
+/**
+ * @brief Pack two native RGB565 pixels so that each goes out MSB first
+ *
+ * @param first The pixel sent first
+ * @param second The pixel sent second
+ * @return The register word
+ */
+constexpr auto pixels(uint16_t first, uint16_t second) -> uint32_t {
+    return static_cast<uint32_t>((first >> 8U) | ((first & 0xFFU) << 8U)) |
+           (static_cast<uint32_t>((second >> 8U) | ((second & 0xFFU) << 8U)) << 16U);
+}
+
+/**
+ * @brief Pack a native RGB565 pixel repeated twice
+ *
+ * @param color The pixel
+ * @return The register word
+ */
+constexpr auto repeat(uint16_t color) -> uint32_t { return pixels(color, color); }
+
+}  // namespace SpiFifoPack
+
+#if defined(ESP8266)
+/**
+ * @brief Register access for the ESP8266 HSPI (SPI1) peripheral
+ */
+struct Esp8266Spi1Regs {
+    static inline void waitIdle() {
+        while ((SPI1CMD & SPIBUSY) != 0) {
+        }
+    }
+
+    static inline void setBitLength(uint32_t bits) {
+        const uint32_t mask = ~((SPIMMOSI << SPILMOSI) | (SPIMMISO << SPILMISO));
+        const uint32_t len = bits - 1U;
+        SPI1U1 = (SPI1U1 & mask) | (len << SPILMOSI) | (len << SPILMISO);
+    }
+
+    static inline void load(uint32_t index, uint32_t word) { (&SPI1W0)[index] = word; }
+
+    static inline void kick() { SPI1CMD |= SPIBUSY; }
+};
+#endif
+
+/**
+ * @brief Burst writer that fills the 64-byte SPI data buffer 32 bits at a time
+ *
+ * The bus must already be configured (clock, mode, CS asserted and DC in data state). Every call returns with the
+ * transfer finished so that a following DC toggle cannot corrupt the tail of the burst
+ *
+ * @tparam Regs Register access policy: waitIdle(), setBitLength(bits), load(index, word) and kick()
+ */
+template <typename Regs>
+class SpiFifoWriter {
+   public:
+    /**
+     * @brief Send raw bytes in stream order
+     *
+     * @param data The bytes
+     * @param len Number of bytes
+     */
+    static void writeBytes(const uint8_t* data, uint32_t len) {
+        while (len > 0) {
+            const uint32_t chunk = (len > SPI_FIFO_BYTES) ? SPI_FIFO_BYTES : len;
+
+            Regs::waitIdle();
+            Regs::setBitLength(chunk * 8U);
+
+            uint32_t offset = 0;
+            for (uint32_t i = 0; offset < chunk; ++i) {
+                const uint32_t count = chunk - offset;
+                Regs::load(i, SpiFifoPack::bytes(data + offset, count));
+                offset += sizeof(uint32_t);
+            }
+
+            Regs::kick();
+            data += chunk;
+            len -= chunk;
+        }
+
+        Regs::waitIdle();
+    }
+
+    /**
+     * @brief Send native RGB565 pixels, each MSB first
+     *
+     * @param data The pixels
+     * @param len Number of pixels
+     */
+    static void writePixels(const uint16_t* data, uint32_t len) {
+        constexpr uint32_t pixelsPerChunk = SPI_FIFO_BYTES / sizeof(uint16_t);
+
+        while (len > 0) {
+            const uint32_t chunk = (len > pixelsPerChunk) ? pixelsPerChunk : len;
+            const uint32_t pairs = chunk / 2U;
+
+            Regs::waitIdle();
+            Regs::setBitLength(chunk * 16U);
+
+            for (uint32_t i = 0; i < pairs; ++i) {
+                Regs::load(i, SpiFifoPack::pixels(data[2U * i], data[2U * i + 1U]));
+            }
+            if ((chunk & 1U) != 0) {
+                Regs::load(pairs, SpiFifoPack::pixels(data[chunk - 1U], 0));
+            }
+
+            Regs::kick();
+            data += chunk;
+            len -= chunk;
+        }
+
+        Regs::waitIdle();
+    }
+
+    /**
+     * @brief Send the same native RGB565 pixel len times
+     *
+     * @param color The pixel
+     * @param len Number of pixels
+     */
+    static void writeRepeat(uint16_t color, uint32_t len) {
+        constexpr uint32_t pixelsPerChunk = SPI_FIFO_BYTES / sizeof(uint16_t);
+        const uint32_t word = SpiFifoPack::repeat(color);
+        uint32_t loadedBits = 0;
+
+        while (len > 0) {
+            const uint32_t chunk = (len > pixelsPerChunk) ? pixelsPerChunk : len;
+            const uint32_t bits = chunk * 16U;
+
+            Regs::waitIdle();
+
+            // Full-duplex transfers overwrite the data buffer with MISO, so the pattern is reloaded every burst
+            for (uint32_t i = 0; i < (chunk + 1U) / 2U; ++i) {
+                Regs::load(i, word);
+            }
+            if (bits != loadedBits) {
+                Regs::setBitLength(bits);
+                loadedBits = bits;
+            }
+
+            Regs::kick();
+            len -= chunk;
+        }
+
+        Regs::waitIdle();
+    }
+};
+
+#if defined(ESP8266)
+using HspiFifo = SpiFifoWriter<Esp8266Spi1Regs>;
+#endif
+
+#endif  // DISPLAY_SPI_FIFO_H
@@ -0,0 +1,64 @@
+#ifndef DISPLAY_STARFIELD_H
+#define DISPLAY_STARFIELD_H
+
+#include <algorithm>
+#include <cstdint>
+
+// Stars spread over +-STAR_SPREAD, fly from STAR_DEPTH to STAR_NEAR and are then thrown back
+static constexpr int32_t STAR_SPREAD = 1024;
+static constexpr int32_t STAR_DEPTH = 1024;
+static constexpr int32_t STAR_NEAR = 32;
+static constexpr int32_t STAR_MIN_LEVEL = 48;
+static constexpr int32_t STAR_MAX_LEVEL = 255;
+
+// Row of a star that is not drawn this frame, no sample line matches it
+static constexpr int16_t STAR_HIDDEN = -1;
+
+/**
+ * @brief A star, x and y around the line of sight and z its depth
+ */
+struct Star {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+/**
+ * @brief Where a star lands this frame, in samples
+ */
+struct StarSample {
+    int16_t column;
+    int16_t row;
+    uint8_t level;
+};
+
+/**
+ * @brief Project a star on a width x height area sampled every step pixels
+ *
+ * Both axes share one focal length so the field keeps its aspect on any area, which puts stars of the spread past
+ * the short side of a non-square area: those, and stars nearer than STAR_NEAR, come back hidden
+ *
+ * @param star The star
+ * @param width Area width in pixels
+ * @param height Area height in pixels
+ * @param step Detail step, pixels per sample
+ * @return The sample, inside [0, columns) x [0, rows) or with row STAR_HIDDEN
+ */
+inline auto projectStar(const Star& star, int32_t width, int32_t height, int32_t step) -> StarSample {
+    if (star.z < STAR_NEAR) {
+        return StarSample{STAR_HIDDEN, STAR_HIDDEN, 0};
+    }
+
+    const int32_t focal = std::max(width, height) / 2;
+    const auto level =
+        static_cast<uint8_t>(STAR_MIN_LEVEL + (STAR_DEPTH - star.z) * (STAR_MAX_LEVEL - STAR_MIN_LEVEL) / STAR_DEPTH);
+    const int32_t posX = width / 2 + star.x * focal / star.z;
+    const int32_t posY = height / 2 + star.y * focal / star.z;
+    if (posX < 0 || posX >= width || posY < 0 || posY >= height) {
+        return StarSample{STAR_HIDDEN, STAR_HIDDEN, 0};
+    }
+
+    return StarSample{static_cast<int16_t>(posX / step), static_cast<int16_t>(posY / step), level};
+}
+
+#endif  // DISPLAY_STARFIELD_H
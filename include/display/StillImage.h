@@ -0,0 +1,122 @@
+#ifndef DISPLAY_STILL_IMAGE_H
+#define DISPLAY_STILL_IMAGE_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "display/PanelRowWriter.h"
+
+/**
+ * @brief Still image formats decoded as a stream
+ */
+enum class StillFormat : uint8_t {
+    None,
+    Qoi,     // "qoif": Quite OK Image format, RGB or RGBA
+    Rgb565,  // "R565": panel-order RGB565, raw or run-length encoded
+};
+
+// Largest image side accepted (QOI headers allow up to 2^32)
+static constexpr uint32_t STILL_MAX_SIDE = 4096;
+
+// Longest unit (header or QOI op) that may straddle two chunks
+static constexpr size_t STILL_CARRY_MAX = 16;
+
+/**
+ * @brief Outcome of one still image decode
+ */
+struct StillResult {
+    bool ok;
+    StillFormat format;
+    int16_t width;
+    int16_t height;
+    uint32_t decodeUs;  // time spent decoding and sending pixels (network and file waits excluded for streams)
+};
+
+/**
+ * @brief Throughput of one still format since boot
+ */
+struct StillStats {
+    uint32_t images;
+    uint32_t lastUs;
+    uint64_t pixels;
+    uint64_t totalUs;
+};
+
+/**
+ * @class StillDecoder
+ * @brief Push decoder for QOI and R565 images, writing to the panel as bytes arrive
+ *
+ * Bytes can be fed in chunks of any size (HTTP body pieces, file reads): an op or header cut by a chunk boundary
+ * is carried over in a few bytes, everything else is decoded in place. Decoded pixels go to the panel in whole
+ * rows through a PanelRowWriter, so memory use does not depend on the image size. QOI state is the 64-entry color
+ * index and the previous pixel; translucent QOI pixels are blended over DisplayManager::backdropColor()
+ *
+ * R565 layout: "R565", width and height (uint16 big-endian), encoding (0 raw, 1 RLE), 3 reserved bytes, then
+ * big-endian RGB565 pixels. RLE packets start with a byte n: n < 128 is followed by n + 1 literal pixels,
+ * n >= 128 by one pixel repeated n - 126 times
+ */
+class StillDecoder {
+   public:
+    StillDecoder(int16_t posX, int16_t posY);
+
+    auto feed(const uint8_t* data, size_t len) -> bool;
+    auto done() const -> bool { return m_state == State::Done; }
+    auto failed() const -> bool { return m_state == State::Error; }
+    auto result() const -> StillResult;
+
+   private:
+    enum class State : uint8_t { Header, Qoi, Raw, Rle, Done, Error };
+
+    struct QoiPixel {
+        uint8_t r;
+        uint8_t g;
+        uint8_t b;
+        uint8_t a;
+    };
+
+    auto consume(const uint8_t* data, size_t len) -> size_t;
+    auto consumeHeader(const uint8_t* data, size_t len) -> size_t;
+    auto consumeQoi(const uint8_t* data, size_t len) -> size_t;
+    auto consumeRaw(const uint8_t* data, size_t len) -> size_t;
+    auto consumeRle(const uint8_t* data, size_t len) -> size_t;
+    auto start(StillFormat format, uint32_t width, uint32_t height, State body) -> bool;
+
+    auto qoiColor(const QoiPixel& pixel) const -> uint16_t;
+
+    int16_t m_posX;
+    int16_t m_posY;
+    State m_state = State::Header;
+    StillFormat m_format = StillFormat::None;
+    uint16_t m_width = 0;
+    uint16_t m_height = 0;
+    uint32_t m_remaining = 0;    // pixels still to decode
+    uint32_t m_literalLeft = 0;  // RLE literal pixels still to read
+    uint32_t m_busyUs = 0;
+
+    std::array<uint8_t, STILL_CARRY_MAX> m_carry{};
+    size_t m_carryLen = 0;
+
+    std::array<QoiPixel, 64> m_index{};
+    QoiPixel m_previous{0, 0, 0, 255};
+    uint16_t m_previousColor = 0;
+    uint16_t m_backdrop = 0;
+
+    PanelRowWriter m_output;
+};
+
+/**
+ * @brief Still images on LittleFS and decode statistics
+ */
+namespace Still {
+
+auto probeFile(const String& path) -> StillFormat;
+auto drawFile(const String& path, int16_t posX, int16_t posY) -> StillResult;
+void record(const StillResult& result);
+auto stats(StillFormat format) -> StillStats;
+auto formatName(StillFormat format) -> const char*;
+
+}  // namespace Still
+
+#endif  // DISPLAY_STILL_IMAGE_H
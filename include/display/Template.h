@@ -0,0 +1,152 @@
+#ifndef DISPLAY_TEMPLATE_H
+#define DISPLAY_TEMPLATE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Templates held in RAM at a time
+static constexpr size_t TEMPLATE_MAX = 4;
+
+// Limits of one template
+static constexpr size_t TEMPLATE_MAX_WIDGETS = 24;
+static constexpr size_t TEMPLATE_MAX_VARS = 16;
+
+// Longest names, texts and values, terminator included
+static constexpr size_t TEMPLATE_NAME_MAX = 16;
+static constexpr size_t TEMPLATE_VAR_NAME_MAX = 16;
+static constexpr size_t TEMPLATE_VALUE_MAX = 24;
+static constexpr size_t TEMPLATE_TEXT_MAX = 24;
+
+// Longest line a text widget shows: its format with the value in place of {}
+static constexpr size_t TEMPLATE_LINE_MAX = TEMPLATE_TEXT_MAX + TEMPLATE_VALUE_MAX;
+
+// Variable index of a widget bound to none
+static constexpr uint8_t TEMPLATE_NO_VAR = UINT8_MAX;
+
+/**
+ * @brief Screen region a widget is laid out in (see DisplayManager::getStatusBarRect() and friends)
+ */
+enum class TemplateRegion : uint8_t {
+    Screen,
+    Status,
+    Body,
+    Footer,
+};
+
+/**
+ * @brief What a widget shows
+ */
+enum class TemplateWidgetKind : uint8_t {
+    Label,  // fixed text
+    Text,   // its format with the value of its variable in place of {}
+    Bar,    // horizontal bar filled from min to max by the number its variable holds
+    Fill,   // rectangle in the "#rrggbb" color its variable holds
+};
+
+enum class TemplateAlign : uint8_t {
+    Left,
+    Center,
+    Right,
+};
+
+/**
+ * @brief A widget as laid out: the position is relative to its region until TemplateScreen::addWidget() places it
+ */
+struct TemplateWidget {
+    TemplateWidgetKind kind;
+    TemplateRegion region;
+    TemplateAlign align;
+    uint8_t size;
+    uint8_t var;
+    int16_t x;
+    int16_t y;
+    int16_t w;  // 0 stretches to the right edge of the region
+    int16_t h;  // 0 is one text line (text widgets) or the rest of the region
+    uint16_t color;
+    uint16_t bg;
+    int32_t min;
+    int32_t max;
+    std::array<char, TEMPLATE_TEXT_MAX> text;  // label text, or text widget format
+};
+
+/**
+ * @brief Template updates since boot
+ */
+struct TemplateStats {
+    uint32_t updates;         // value posts
+    uint32_t valuesChanged;   // values that differed from the one shown
+    uint32_t widgetsDrawn;    // widgets drawn by value posts
+    uint32_t widgetsSkipped;  // widgets left alone by value posts because their value did not change
+    uint32_t glyphsDrawn;     // text cells sent by text widgets
+    uint32_t glyphsSkipped;   // text cells already showing the right character
+    uint32_t lastRenderUs;
+};
+
+/**
+ * @class TemplateScreen
+ * @brief A screen of widgets bound to named variables
+ *
+ * Posting values only marks the widgets bound to a changed variable; render() then draws those alone. A text
+ * widget resends only the cells whose character changed (glyphs come from the glyph cache) and erases what its
+ * previous text covered beyond the new one, a bar only paints the span between its old and new fill
+ */
+class TemplateScreen {
+   public:
+    explicit TemplateScreen(uint16_t bgColor) : m_bg(bgColor) {}
+
+    auto addVar(const char* name) -> int;
+    auto findVar(const char* name) const -> int;
+    auto addWidget(const TemplateWidget& widget) -> bool;
+    auto setValue(size_t var, const char* value) -> bool;
+
+    auto varCount() const -> size_t { return m_vars.size(); }
+    auto varName(size_t var) const -> const char* { return m_vars[var].name.data(); }
+    auto value(size_t var) const -> const char* { return m_vars[var].value.data(); }
+    auto widgetCount() const -> size_t { return m_widgets.size(); }
+
+    auto render(bool all, TemplateStats& stats) -> void;
+
+   private:
+    struct Var {
+        std::array<char, TEMPLATE_VAR_NAME_MAX> name;
+        std::array<char, TEMPLATE_VALUE_MAX> value;
+        bool changed;
+    };
+
+    struct Placed {
+        TemplateWidget spec;
+        std::array<char, TEMPLATE_LINE_MAX> shown;  // text on the screen, empty when nothing is drawn
+        int16_t shownX;                             // left edge of that text
+        int16_t shownFill;                          // bar width filled on the screen, -1 when nothing is drawn
+    };
+
+    auto drawText(Placed& widget, const char* line, TemplateStats& stats) const -> void;
+    auto drawBar(Placed& widget) const -> void;
+
+    uint16_t m_bg;
+    std::vector<Var> m_vars;
+    std::vector<Placed> m_widgets;
+};
+
+/**
+ * @brief Named templates held in RAM, one of them shown at a time
+ */
+namespace Template {
+
+auto validName(const char* name) -> bool;
+auto define(const char* name, std::unique_ptr<TemplateScreen> screen) -> bool;
+auto remove(const char* name) -> bool;
+auto find(const char* name) -> TemplateScreen*;
+auto show(const char* name) -> bool;
+void hide();
+auto shown() -> const char*;
+auto refresh(TemplateScreen& screen, uint32_t changed) -> uint32_t;
+auto names() -> std::vector<const char*>;
+auto stats() -> TemplateStats;
+
+}  // namespace Template
+
+#endif  // DISPLAY_TEMPLATE_H
@@ -0,0 +1,80 @@
+#ifndef DISPLAY_TRANSITION_H
+#define DISPLAY_TRANSITION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "display/Animation.h"
+
+class GeekMagicST7789;
+
+// Transition length used until another one is configured, and the longest accepted
+static constexpr uint32_t TRANSITION_DEFAULT_MS = 400;
+static constexpr uint32_t TRANSITION_MAX_MS = 5000;
+
+// Shortest time between two steps of a transition (about the panel refresh rate)
+static constexpr uint32_t TRANSITION_FRAME_MS = 16;
+
+// Side of the squares a dissolve clears, in pixels
+static constexpr int16_t TRANSITION_DISSOLVE_BLOCK = 16;
+
+/**
+ * @brief How the old content makes way for the new one
+ */
+enum class TransitionEffect : uint8_t {
+    None,      // cleared at once, then drawn (the old behaviour)
+    Slide,     // the old content scrolls up and out, the new one follows it in (hardware scrolling)
+    Wipe,      // the new content replaces the old one row by row from the top
+    Dissolve,  // the old content breaks up into the background in scattered squares, then the new one is drawn
+};
+
+/**
+ * @brief Transition settings
+ */
+struct TransitionSpec {
+    TransitionEffect effect;
+    Easing easing;
+    uint16_t color;  // background where the new content does not cover the screen (the layer when one is loaded)
+    uint32_t durationMs;
+};
+
+/**
+ * @brief Frame timing of the transitions
+ */
+struct TransitionStats {
+    uint32_t transitions;
+    TransitionEffect lastEffect;  // effect actually run, a slide on a rotated panel runs as a wipe
+    uint32_t lastMs;              // wall time of the last transition
+    uint32_t frames;              // steps of the last transition
+    uint32_t avgFrameUs;
+    uint32_t maxFrameUs;  // longest step, a decoder slower than the frame rate shows up here
+};
+
+/**
+ * @brief Screen transitions that pace the drawing of the new content instead of buffering it
+ *
+ * There is no room for a second frame in RAM, so the new content is drawn exactly once, by its own decoder, while
+ * the transition holds each address window back until the effect reaches its rows (a hook in the panel driver).
+ * The decoders all write in row order, which is what makes this work:
+ *
+ * - Slide scrolls the whole 320-line frame memory with VSCSAD. The 80 lines the panel does not show are filled
+ *   with the background first and scroll in behind the old content; each row of the new content is written while
+ *   it is out of view, so about one frame of pixels moves in total and nothing tears
+ * - Wipe lets the rows through as an eased edge goes down the screen
+ * - Dissolve clears the old content to the background in squares, in a scattered order, then lets the content in
+ *
+ * Whatever the new content leaves uncovered (margins, rows it skips) gets the background as its rows come in
+ */
+namespace Transition {
+
+void begin(GeekMagicST7789* panel, const TransitionSpec& spec);
+void end();
+auto active() -> bool;
+auto defaults() -> TransitionSpec;
+void setDefaults(const TransitionSpec& spec);
+auto stats() -> TransitionStats;
+auto effectName(TransitionEffect effect) -> const char*;
+
+}  // namespace Transition
+
+#endif  // DISPLAY_TRANSITION_H
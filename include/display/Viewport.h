@@ -0,0 +1,140 @@
+#ifndef DISPLAY_VIEWPORT_H
+#define DISPLAY_VIEWPORT_H
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Half-open screen area [x0, x1) x [y0, y1)
+ */
+struct ClipRect {
+    int16_t x0;
+    int16_t y0;
+    int16_t x1;
+    int16_t y1;
+};
+
+/**
+ * @class Viewport
+ * @brief Clip-rectangle stack and translation applied to drawing coordinates
+ *
+ * pushClip() saves the current clip and translation and intersects the clip with a rect given in translated
+ * coordinates, popClip() restores both, so a translate() between them is scoped like a canvas save/restore.
+ * Pushes beyond MAX_DEPTH keep the current state and are still balanced by their pops
+ */
+class Viewport {
+   public:
+    static constexpr uint8_t MAX_DEPTH = 8;
+
+    /**
+     * @brief Drop every clip and translation
+     *
+     * @param screenW Screen width in pixels
+     * @param screenH Screen height in pixels
+     */
+    void reset(int16_t screenW, int16_t screenH) {
+        m_state = State{ClipRect{0, 0, screenW, screenH}, 0, 0};
+        m_screenW = screenW;
+        m_screenH = screenH;
+        m_depth = 0;
+    }
+
+    /**
+     * @brief Narrow the clip to a rect given in translated coordinates
+     *
+     * @param posX Left edge
+     * @param posY Top edge
+     * @param width Width in pixels
+     * @param height Height in pixels
+     */
+    void pushClip(int16_t posX, int16_t posY, int16_t width, int16_t height) {
+        if (m_depth < MAX_DEPTH) {
+            m_stack[m_depth] = m_state;
+        }
+        if (m_depth < UINT8_MAX) {
+            m_depth++;
+        }
+
+        const int32_t left = static_cast<int32_t>(posX) + m_state.dx;
+        const int32_t top = static_cast<int32_t>(posY) + m_state.dy;
+        const int32_t right = left + (width > 0 ? width : 0);
+        const int32_t bottom = top + (height > 0 ? height : 0);
+
+        ClipRect& clip = m_state.clip;
+        clip.x0 = static_cast<int16_t>(clamp(left, clip.x0, clip.x1));
+        clip.y0 = static_cast<int16_t>(clamp(top, clip.y0, clip.y1));
+        clip.x1 = static_cast<int16_t>(clamp(right, clip.x0, clip.x1));
+        clip.y1 = static_cast<int16_t>(clamp(bottom, clip.y0, clip.y1));
+    }
+
+    /**
+     * @brief Restore the clip and translation saved by the matching pushClip()
+     */
+    void popClip() {
+        if (m_depth == 0) {
+            return;
+        }
+
+        m_depth--;
+        if (m_depth < MAX_DEPTH) {
+            m_state = m_stack[m_depth];
+        }
+    }
+
+    /**
+     * @brief Move the origin of the following drawing commands
+     *
+     * @param deltaX Horizontal offset in pixels
+     * @param deltaY Vertical offset in pixels
+     */
+    void translate(int16_t deltaX, int16_t deltaY) {
+        m_state.dx = static_cast<int16_t>(m_state.dx + deltaX);
+        m_state.dy = static_cast<int16_t>(m_state.dy + deltaY);
+    }
+
+    auto dx() const -> int16_t { return m_state.dx; }
+    auto dy() const -> int16_t { return m_state.dy; }
+    auto clip() const -> const ClipRect& { return m_state.clip; }
+
+    /**
+     * @brief Whether the clip is narrower than the screen
+     */
+    auto isClipped() const -> bool {
+        const ClipRect& clip = m_state.clip;
+        return clip.x0 > 0 || clip.y0 > 0 || clip.x1 < m_screenW || clip.y1 < m_screenH;
+    }
+
+    /**
+     * @brief Whether the viewport changes anything (clip or translation)
+     */
+    auto isActive() const -> bool { return isClipped() || m_state.dx != 0 || m_state.dy != 0; }
+
+    /**
+     * @brief Test a screen-space bounding box against the clip
+     *
+     * @return true if any of [x0, x1) x [y0, y1) is inside the clip
+     */
+    auto isVisible(int32_t x0, int32_t y0, int32_t x1, int32_t y1) const -> bool {
+        const ClipRect& clip = m_state.clip;
+        return x0 < clip.x1 && y0 < clip.y1 && x1 > clip.x0 && y1 > clip.y0 && x0 < x1 && y0 < y1;
+    }
+
+   private:
+    struct State {
+        ClipRect clip;
+        int16_t dx;
+        int16_t dy;
+    };
+
+    static auto clamp(int32_t value, int32_t low, int32_t high) -> int32_t {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    std::array<State, MAX_DEPTH> m_stack{};
+    State m_state{ClipRect{0, 0, INT16_MAX, INT16_MAX}, 0, 0};
+    int16_t m_screenW = INT16_MAX;
+    int16_t m_screenH = INT16_MAX;
+    uint8_t m_depth = 0;
+};
+
+#endif  // DISPLAY_VIEWPORT_H
@@ -0,0 +1,66 @@
+#ifndef SCRIPT_SCRIPT_H
+#define SCRIPT_SCRIPT_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "script/ScriptVm.h"
+
+// Bytecode files live in this directory, one file per script
+static constexpr const char* SCRIPT_DIR = "/script";
+
+// Longest script name, terminator included
+static constexpr size_t SCRIPT_NAME_MAX = 24;
+
+// Largest bytecode file
+static constexpr size_t SCRIPT_FILE_MAX = sizeof(ScriptHeader) + SCRIPT_MAX_CODE + SCRIPT_MAX_STRINGS;
+
+// Instructions a script may execute per tick, and the shortest time between two ticks
+static constexpr uint32_t SCRIPT_TICK_BUDGET = 2000;
+static constexpr uint32_t SCRIPT_TICK_MS = 16;
+
+// Draw commands collected before they are sent in the middle of a tick
+static constexpr size_t SCRIPT_FLUSH_COMMANDS = 64;
+
+/**
+ * @brief Cost of the script running (or last run) since it started
+ */
+struct ScriptStats {
+    uint32_t ticks;
+    uint32_t instructions;
+    uint32_t draws;       // draw commands sent to the panel, after the batch optimizer
+    uint32_t vmUs;        // time spent interpreting, drawing left out
+    uint32_t lastTickUs;  // whole tick, drawing included
+    uint32_t maxTickUs;
+};
+
+/**
+ * @brief Stored bytecode scripts on LittleFS, one of them running from loop()
+ *
+ * A tick runs the script until it yields, sleeps or spends SCRIPT_TICK_BUDGET instructions. Its draw commands
+ * go through a DrawBatch, optimized and sent at the end of the tick (or every SCRIPT_FLUSH_COMMANDS commands),
+ * so a script draws the same way /api/v1/draw/batch does
+ */
+namespace Script {
+
+auto validName(const char* name) -> bool;
+auto store(const char* name, const uint8_t* image, size_t bytes) -> const char*;
+auto remove(const char* name) -> bool;
+auto names() -> std::vector<String>;
+auto run(const char* name) -> const char*;
+void stop();
+auto running() -> const char*;
+auto vm() -> const ScriptVm&;
+auto setCounter(size_t index, int32_t value) -> bool;
+auto counter(size_t index) -> int32_t;
+void update(uint32_t nowMs);
+auto stats() -> ScriptStats;
+auto stateName(ScriptState state) -> const char*;
+auto faultName(ScriptFault fault) -> const char*;
+
+}  // namespace Script
+
+#endif  // SCRIPT_SCRIPT_H
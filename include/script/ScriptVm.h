@@ -0,0 +1,219 @@
+#ifndef SCRIPT_SCRIPT_VM_H
+#define SCRIPT_SCRIPT_VM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "display/DrawCommand.h"
+
+// Limits of one script
+static constexpr size_t SCRIPT_STACK_SIZE = 32;
+static constexpr size_t SCRIPT_CALL_DEPTH = 8;
+static constexpr size_t SCRIPT_MAX_GLOBALS = 32;
+static constexpr size_t SCRIPT_TIMERS = 4;
+static constexpr size_t SCRIPT_MAX_CODE = 4096;
+static constexpr size_t SCRIPT_MAX_STRINGS = 1024;
+
+// Counters the API can set and scripts read
+static constexpr size_t SCRIPT_COUNTERS = 8;
+
+// Bytecode files are checked against this before anything runs
+static constexpr std::array<char, 4> SCRIPT_MAGIC = {'H', 'S', 'C', 'R'};
+static constexpr uint8_t SCRIPT_FORMAT_VERSION = 1;
+
+/**
+ * @brief Instruction set, the operand (little endian) follows the opcode
+ *
+ * Values are 32-bit signed integers. Binary operators pop b then a and push a op b; comparisons push 0 or 1.
+ * Draw instructions pop their arguments (pushed in the order listed in DrawCommand.h) and draw in the current
+ * color; the number of each opcode is part of the bytecode format and must not change
+ */
+enum class ScriptOp : uint8_t {
+    Halt = 0x00,
+    Nop = 0x01,
+    Push8 = 0x02,   // i8 operand
+    Push16 = 0x03,  // i16 operand
+    Push32 = 0x04,  // i32 operand
+    Load = 0x05,    // u8 global index
+    Store = 0x06,   // u8 global index
+    Dup = 0x07,
+    Drop = 0x08,
+    Swap = 0x09,
+    Over = 0x0A,
+
+    Add = 0x10,
+    Sub = 0x11,
+    Mul = 0x12,
+    Div = 0x13,  // division by zero faults
+    Mod = 0x14,
+    Neg = 0x15,
+    And = 0x16,
+    Or = 0x17,
+    Xor = 0x18,
+    Not = 0x19,  // bitwise
+    Shl = 0x1A,
+    Shr = 0x1B,  // arithmetic
+    Eq = 0x1C,
+    Ne = 0x1D,
+    Lt = 0x1E,
+    Le = 0x1F,
+    Gt = 0x20,
+    Ge = 0x21,
+    Min = 0x22,
+    Max = 0x23,
+    LNot = 0x24,  // 1 for 0, 0 otherwise
+
+    Jmp = 0x30,   // u16 address
+    Jz = 0x31,    // u16 address, pops the condition
+    Jnz = 0x32,   // u16 address, pops the condition
+    Call = 0x33,  // u16 address
+    Ret = 0x34,
+
+    Yield = 0x38,      // end the tick, go on with the next one
+    Sleep = 0x39,      // pops ms: end the tick and wait that long
+    TimerSet = 0x3A,   // u8 timer, pops the period in ms (0 stops the timer)
+    TimerDue = 0x3B,   // u8 timer, pushes 1 once per elapsed period, 0 otherwise
+    Input = 0x40,      // u8 ScriptInput, pushes its value
+
+    Color = 0x48,  // pops an RGB565 color
+    Bg = 0x49,     // pops an RGB565 color, text background
+    Size = 0x4A,   // pops the text size
+
+    Clear = 0x50,
+    Rect = 0x51,
+    FillRect = 0x52,
+    Circle = 0x53,
+    FillCircle = 0x54,
+    Line = 0x55,
+    LineAA = 0x56,
+    ThickLine = 0x57,
+    Pixel = 0x58,
+    Triangle = 0x59,
+    FillTriangle = 0x5A,
+    Ellipse = 0x5B,
+    FillEllipse = 0x5C,
+    RoundRect = 0x5D,
+    FillRoundRect = 0x5E,
+    Arc = 0x5F,
+    Text = 0x60,    // u16 offset in the string pool, pops x and y
+    Number = 0x61,  // pops x and y, then the value to draw in decimal
+};
+
+/**
+ * @brief Device state a script can read with the Input instruction
+ */
+enum class ScriptInput : uint8_t {
+    Millis,    // milliseconds since boot (wraps)
+    Uptime,    // seconds since boot
+    Wifi,      // 1 when connected to a network
+    Rssi,      // signal strength in dBm, 0 without a network
+    FreeHeap,  // bytes
+    Width,     // screen size in pixels
+    Height,
+    Random,    // 0 to 32767
+    Ticks,     // ticks this script has run
+    Counter0,  // Counter0 to Counter0 + SCRIPT_COUNTERS - 1 are set through the API
+};
+
+static constexpr size_t SCRIPT_INPUT_COUNT = static_cast<size_t>(ScriptInput::Counter0) + SCRIPT_COUNTERS;
+
+enum class ScriptState : uint8_t {
+    Stopped,
+    Running,
+    Sleeping,
+    Halted,
+    Faulted,
+};
+
+enum class ScriptFault : uint8_t {
+    None,
+    StackOverflow,
+    StackUnderflow,
+    CallOverflow,
+    CallUnderflow,
+    DivideByZero,
+    OutOfMemory,
+};
+
+/**
+ * @brief Start of a bytecode file, followed by the code and the string pool (NUL-terminated strings)
+ */
+struct ScriptHeader {
+    std::array<char, 4> magic;
+    uint8_t version;
+    uint8_t globals;
+    uint16_t codeBytes;
+    uint16_t stringBytes;
+};
+
+/**
+ * @brief What a script runs against: device state, and where its draw commands go
+ */
+class ScriptHost {
+   public:
+    virtual auto input(ScriptInput input) -> int32_t = 0;
+    virtual auto draw(const DrawCommand& command) -> void = 0;
+    virtual auto allocateText(size_t bytes) -> char* = 0;  // must live until the commands are drawn
+
+   protected:
+    ~ScriptHost() = default;
+};
+
+/**
+ * @class ScriptVm
+ * @brief Sandboxed stack machine running one bytecode script
+ *
+ * load() verifies the whole program once: every opcode is known, every jump lands on an instruction, every global,
+ * timer, input and string operand is in range. At run time only the stacks and divisions are checked, a script
+ * that breaks a rule is stopped with a fault. run() executes until the script yields or sleeps, or until the
+ * instruction budget of the tick is spent; the next run() carries on from there, so a script cannot hold the loop
+ */
+class ScriptVm {
+   public:
+    auto load(const uint8_t* image, size_t bytes) -> const char*;
+    auto run(ScriptHost& host, uint32_t nowMs, uint32_t budget) -> uint32_t;
+    auto stop() -> void;
+
+    auto state() const -> ScriptState { return m_state; }
+    auto fault() const -> ScriptFault { return m_fault; }
+    auto pc() const -> uint16_t { return m_pc; }
+    auto globalCount() const -> size_t { return m_globalCount; }
+    auto global(size_t index) const -> int32_t { return m_globals[index]; }
+
+   private:
+    auto push(int32_t value) -> void;
+    auto pop() -> int32_t;
+    auto operand8() -> uint8_t;
+    auto operand16() -> uint16_t;
+    auto operand32() -> uint32_t;
+    auto raise(ScriptFault fault) -> void;
+    auto arithmetic(ScriptOp op) -> void;
+    auto timerDue(uint8_t timer) -> bool;
+    auto emit(ScriptHost& host, ScriptOp op) -> void;
+
+    std::vector<uint8_t> m_code;  // code, then the string pool
+    uint16_t m_codeBytes = 0;
+    uint8_t m_globalCount = 0;
+
+    ScriptState m_state = ScriptState::Stopped;
+    ScriptFault m_fault = ScriptFault::None;
+    uint16_t m_pc = 0;
+    uint32_t m_nowMs = 0;
+    uint32_t m_wakeMs = 0;
+
+    std::array<int32_t, SCRIPT_STACK_SIZE> m_stack{};
+    size_t m_sp = 0;
+    std::array<uint16_t, SCRIPT_CALL_DEPTH> m_calls{};
+    size_t m_csp = 0;
+    std::array<int32_t, SCRIPT_MAX_GLOBALS> m_globals{};
+    std::array<uint32_t, SCRIPT_TIMERS> m_timerPeriod{};
+    std::array<uint32_t, SCRIPT_TIMERS> m_timerDue{};
+
+    uint16_t m_color = 0xFFFF;
+    uint16_t m_bg = 0x0000;
+    uint8_t m_size = 2;
+};
+
+#endif  // SCRIPT_SCRIPT_VM_H
@@ -13,10 +13,33 @@ void handleListGifs(Webserver* webserver);
 void handlePlayGif(Webserver* webserver);
 void handleStopGif(Webserver* webserver);
 
+void handleImageUpload(Webserver* webserver);
+void handleImageUploaded(Webserver* webserver);
+void handlePlayImage(Webserver* webserver);
+void handleImageStream(Webserver* webserver);
+void handleImageStreamed(Webserver* webserver);
+void handleBackgroundUpload(Webserver* webserver);
+void handleBackgroundUploaded(Webserver* webserver);
+void handleGetBackground(Webserver* webserver);
+void handleRemoveBackground(Webserver* webserver);
+
 void handleWifiScan(Webserver* webserver);
 void handleWifiConnect(Webserver* webserver);
 void handleWifiStatus(Webserver* webserver);
 
+void handleMetrics(Webserver* webserver);
+
+void handleGetDisplayConfig(Webserver* webserver);
+void handleSetDisplayConfig(Webserver* webserver);
+void handleGetTransitionConfig(Webserver* webserver);
+void handleSetTransitionConfig(Webserver* webserver);
+void handleGetMqttConfig(Webserver* webserver);
+void handleSetMqttConfig(Webserver* webserver);
+void handleGetBroadcastConfig(Webserver* webserver);
+void handleSetBroadcastConfig(Webserver* webserver);
+void handleGetSyncConfig(Webserver* webserver);
+void handleSetSyncConfig(Webserver* webserver);
+
 // Drawing API endpoints
 void handleDrawClear(Webserver* webserver);
 void handleDrawText(Webserver* webserver);
@@ -27,6 +50,57 @@ void handleDrawPixel(Webserver* webserver);
 void handleDrawTriangle(Webserver* webserver);
 void handleDrawEllipse(Webserver* webserver);
 void handleDrawRoundRect(Webserver* webserver);
+void handleDrawGradient(Webserver* webserver);
+void handleDrawBitmap(Webserver* webserver);
+void handleDrawBitmapStream(Webserver* webserver);
 void handleDrawBatch(Webserver* webserver);
 
+// Macro API endpoints
+void handleStoreMacro(Webserver* webserver);
+void handleListMacros(Webserver* webserver);
+void handleDeleteMacro(Webserver* webserver);
+
+// Template API endpoints
+void handleDefineTemplate(Webserver* webserver);
+void handleTemplateValues(Webserver* webserver);
+void handleShowTemplate(Webserver* webserver);
+void handleDeleteTemplate(Webserver* webserver);
+void handleListTemplates(Webserver* webserver);
+
+// Script API endpoints
+void handleScriptUpload(Webserver* webserver);
+void handleStoreScript(Webserver* webserver);
+void handleRunScript(Webserver* webserver);
+void handleStopScript(Webserver* webserver);
+void handleDeleteScript(Webserver* webserver);
+void handleScriptCounters(Webserver* webserver);
+void handleGetScript(Webserver* webserver);
+
+// Data source API endpoints
+void handleDefineSource(Webserver* webserver);
+void handleListSources(Webserver* webserver);
+void handleDeleteSource(Webserver* webserver);
+void handlePollSource(Webserver* webserver);
+
+// Animation API endpoints
+void handleAnimate(Webserver* webserver);
+void handleStopAnimation(Webserver* webserver);
+
+// Effect API endpoints
+void handleStartEffect(Webserver* webserver);
+void handleGetEffect(Webserver* webserver);
+void handleStopEffect(Webserver* webserver);
+
+// MQTT
+void startMqtt();
+auto handleMqttMessage(const char* topic, uint8_t* payload, size_t length) -> bool;
+
+// Broadcast
+void startBroadcast();
+auto handleBroadcastPacket(const uint8_t* packet, size_t length) -> bool;
+
+// Time sync
+void startTimeSync();
+void handleGetSync(Webserver* webserver);
+
 #endif  // API_H
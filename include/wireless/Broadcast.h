@@ -0,0 +1,90 @@
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+static constexpr uint16_t BROADCAST_DEFAULT_PORT = 4210;
+
+// 239.72.67.1: "H" and "C" in the organization-local multicast scope
+static constexpr std::array<uint8_t, 4> BROADCAST_DEFAULT_ADDRESS = {239, 72, 67, 1};
+
+// Groups a device listens to, besides group 0 that every device applies
+static constexpr size_t BROADCAST_MAX_GROUPS = 8;
+static constexpr uint16_t BROADCAST_GROUP_ALL = 0;
+
+// Out-of-order packets held per device while the missing ones are asked again
+static constexpr size_t BROADCAST_PENDING_MAX = 4;
+
+// NACKs sent for one gap, and the time between them; after the last one the gap is skipped
+static constexpr uint8_t BROADCAST_NACK_TRIES = 3;
+static constexpr uint32_t BROADCAST_NACK_INTERVAL_MS = 40;
+
+// A sequence further than this from the expected one starts the group again (restarted sender, long outage)
+static constexpr uint32_t BROADCAST_RESYNC_WINDOW = 64;
+
+// Packets read per update(), so a flood cannot hold loop()
+static constexpr uint8_t BROADCAST_PACKETS_PER_UPDATE = 8;
+
+static constexpr std::array<uint8_t, 2> BROADCAST_NACK_MAGIC = {'H', 'N'};
+static constexpr size_t BROADCAST_NACK_SIZE = 12;
+
+/**
+ * @brief Multicast address, port and the groups this device belongs to
+ */
+struct BroadcastSettings {
+    bool enabled;
+    IPAddress address;
+    uint16_t port;
+    std::vector<uint16_t> groups;
+};
+
+/**
+ * @brief Packets since boot
+ */
+struct BroadcastStats {
+    uint32_t received;
+    uint32_t applied;
+    uint32_t ignored;     // addressed to groups this device is not in
+    uint32_t invalid;     // not a draw packet, or refused by the handler
+    uint32_t duplicates;  // already applied, or already held
+    uint32_t reordered;   // held until the packets before them arrived
+    uint32_t nacks;       // NACK datagrams sent
+    uint32_t recovered;   // missing packets that arrived after a NACK
+    uint32_t lost;        // missing packets given up on
+    uint32_t lastApplyUs;
+};
+
+/**
+ * @brief Called for every packet to apply, in sequence order; the packet is only valid during the call
+ *
+ * @return false when the packet was refused
+ */
+using BroadcastHandler = bool (*)(const uint8_t* packet, size_t length);
+
+/**
+ * @brief Multicast draw listener ticked from loop()
+ *
+ * One sender updates any number of devices with one datagram: every device joins the same multicast group and
+ * applies the draw packets (see DrawPacket.h) addressed to group 0 or to one of its groups. Each group is its own
+ * sequence: a packet after a gap is held while a NACK (unicast to the sender: "HN", version, 0, group, first missing
+ * sequence, count) asks for the missing ones. They are applied in order as they come back. After
+ * BROADCAST_NACK_TRIES unanswered NACKs, or when a key packet (the full screen) arrives, the gap is skipped. Senders
+ * are not acknowledged, so the cost of a fleet is one datagram per update plus the retransmissions of the devices that
+ * missed it
+ */
+namespace Broadcast {
+
+void begin(const BroadcastSettings& settings, BroadcastHandler handler);
+void update(uint32_t nowMs);
+auto listening() -> bool;
+auto settings() -> const BroadcastSettings&;
+auto stats() -> BroadcastStats;
+
+}  // namespace Broadcast
+
+#endif  // BROADCAST_H
@@ -0,0 +1,98 @@
+#ifndef DATA_SOURCE_H
+#define DATA_SOURCE_H
+
+#include <Arduino.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "display/Template.h"
+
+// Sources polled at a time
+static constexpr size_t DATA_SOURCE_MAX = 4;
+
+// Limits of one source
+static constexpr size_t DATA_SOURCE_MAX_BINDINGS = 8;
+static constexpr size_t DATA_SOURCE_URL_MAX = 128;
+static constexpr size_t DATA_SOURCE_NAME_MAX = 16;
+
+// Limits of one path expression: steps, and longest key of a step (terminator included)
+static constexpr size_t DATA_SOURCE_PATH_STEPS = 8;
+static constexpr size_t DATA_SOURCE_KEY_MAX = 24;
+
+// Shortest poll interval, and longest a poll may hold loop()
+static constexpr uint32_t DATA_SOURCE_MIN_INTERVAL_MS = 5000;
+static constexpr uint16_t DATA_SOURCE_TIMEOUT_MS = 3000;
+
+// Shortest time between two polls, of any source
+static constexpr uint32_t DATA_SOURCE_GAP_MS = 500;
+
+// Step of a path that indexes an array rather than naming a key
+static constexpr int16_t DATA_SOURCE_NO_INDEX = -1;
+
+/**
+ * @brief One step of a path expression: an object key, or an array index
+ */
+struct DataSourceStep {
+    std::array<char, DATA_SOURCE_KEY_MAX> key;
+    int16_t index;  // DATA_SOURCE_NO_INDEX for a key
+};
+
+/**
+ * @brief Where a template variable takes its value from in the response
+ */
+struct DataSourceBinding {
+    std::array<char, TEMPLATE_VAR_NAME_MAX> var;
+    std::vector<DataSourceStep> path;
+};
+
+/**
+ * @brief A JSON endpoint polled on its own schedule, feeding the variables of a template
+ */
+struct DataSourceSpec {
+    std::array<char, DATA_SOURCE_NAME_MAX> name;
+    String url;
+    uint32_t intervalMs;
+    std::array<char, TEMPLATE_NAME_MAX> templateName;
+    std::vector<DataSourceBinding> bindings;
+};
+
+/**
+ * @brief Polls of one source since it was defined
+ */
+struct DataSourceStats {
+    uint32_t polls;
+    uint32_t notModified;    // 304 answers: nothing was downloaded or parsed
+    uint32_t errors;         // connection failures, bad status codes and invalid JSON
+    uint32_t valuesChanged;  // template variables that got a new value
+    int16_t lastStatus;      // HTTP status of the last poll, negative for a connection error
+    uint32_t lastPollMs;     // duration of the last poll, request and parse
+};
+
+/**
+ * @brief Pull-mode data: the device polls JSON endpoints and updates the template variables bound to them
+ *
+ * Each source keeps the ETag and Last-Modified of its last answer and sends them back, so an unchanged document
+ * costs a 304 and no parsing. A changed one is parsed straight from the socket through a filter built from the
+ * bound paths, so only the values in use are kept, however large the response. A variable holding the same value
+ * as before does not draw anything.
+ *
+ * Polls are spread out: each source is given a phase within its interval derived from the chip id and its name, so
+ * sources (and devices) sharing an interval do not poll together, and polls of any source are at least
+ * DATA_SOURCE_GAP_MS apart
+ */
+namespace DataSource {
+
+auto parsePath(const char* text, std::vector<DataSourceStep>& path) -> bool;
+auto define(const DataSourceSpec& spec) -> const char*;
+auto remove(const char* name) -> bool;
+auto pollSoon(const char* name) -> bool;
+void update(uint32_t nowMs);
+auto count() -> size_t;
+auto spec(size_t index) -> const DataSourceSpec&;
+auto stats(size_t index) -> DataSourceStats;
+
+}  // namespace DataSource
+
+#endif  // DATA_SOURCE_H
@@ -0,0 +1,86 @@
+#ifndef MQTT_H
+#define MQTT_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+static constexpr uint16_t MQTT_DEFAULT_PORT = 1883;
+
+// Largest message accepted: the client keeps one buffer of this size for the packet being received
+static constexpr size_t MQTT_BUFFER_SIZE = 4096;
+
+// Draw topics subscribed at most, besides the screen topic
+static constexpr size_t MQTT_MAX_TOPICS = 8;
+
+// Connection back-off: attempts are at least MQTT_RETRY_MIN_MS apart, the gap doubles after each failed one
+static constexpr uint32_t MQTT_RETRY_MIN_MS = 1000;
+static constexpr uint32_t MQTT_RETRY_MAX_MS = 60000;
+
+// Longest a connection attempt waits for the name lookup and for the TCP connect. A lookup still running then
+// completes in the background and the next attempt finds the address in the DNS cache
+static constexpr uint32_t MQTT_CONNECT_TIMEOUT_MS = 200;
+
+// Longest the wait for the broker's CONNACK or a partly received packet may hold loop(), the client counts in
+// whole seconds
+static constexpr uint16_t MQTT_SOCKET_TIMEOUT_S = 1;
+
+/**
+ * @brief Broker and topics
+ *
+ * Every topic (MQTT wildcards allowed) carries draw batches. The screen topic is meant to be published with the
+ * retain flag: the broker keeps the last full screen and sends it as soon as the device subscribes, so the screen
+ * comes back right after a reboot or a reconnection
+ */
+struct MqttSettings {
+    String host;  // empty disables MQTT
+    uint16_t port;
+    String user;
+    String password;
+    String clientId;  // empty uses holocube-<chip id>
+    std::vector<String> topics;
+    String screenTopic;
+};
+
+/**
+ * @brief Messages since boot
+ */
+struct MqttStats {
+    uint32_t connects;
+    uint32_t failures;    // connection attempts that failed
+    uint32_t messages;
+    uint32_t drawn;       // messages the handler accepted
+    uint32_t rejected;    // messages the handler refused (not a batch)
+    uint32_t bytes;
+    uint32_t lastDrawUs;  // handler time of the last message, parse and draw
+    uint32_t maxDrawUs;
+};
+
+/**
+ * @brief Called for every message, the payload can be modified in place and is only valid during the call
+ *
+ * @return false when the payload was refused
+ */
+using MqttHandler = bool (*)(const char* topic, uint8_t* payload, size_t length);
+
+/**
+ * @brief MQTT subscriber ticked from loop()
+ *
+ * Subscriptions are QoS 0: the broker sends each message once and the device sends nothing back, so a message
+ * costs one TCP segment and is handed to the handler straight from the receive buffer. update() makes at most one
+ * connection attempt per back-off interval. An attempt holds loop() for up to 2 x MQTT_CONNECT_TIMEOUT_MS when the
+ * broker cannot be reached (name lookup, TCP connect), and for MQTT_SOCKET_TIMEOUT_S more when it accepts the
+ * connection but does not answer; a partly received packet holds it for up to MQTT_SOCKET_TIMEOUT_S
+ */
+namespace Mqtt {
+
+void begin(const MqttSettings& settings, MqttHandler handler);
+void update(uint32_t nowMs);
+auto connected() -> bool;
+auto settings() -> const MqttSettings&;
+auto stats() -> MqttStats;
+
+}  // namespace Mqtt
+
+#endif  // MQTT_H
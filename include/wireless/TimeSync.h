@@ -0,0 +1,73 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+static constexpr uint16_t TIME_SYNC_PORT = 4211;
+
+static constexpr std::array<uint8_t, 2> TIME_SYNC_MAGIC = {'H', 'T'};
+static constexpr uint8_t TIME_SYNC_VERSION = 1;
+static constexpr size_t TIME_SYNC_PACKET_SIZE = 32;
+
+// Requests of one exchange, the one with the shortest round trip is kept
+static constexpr uint8_t TIME_SYNC_BURST = 4;
+static constexpr uint32_t TIME_SYNC_REQUEST_GAP_MS = 30;
+static constexpr uint32_t TIME_SYNC_REPLY_TIMEOUT_MS = 200;
+
+// Time between exchanges: short until the skew is known, then long
+static constexpr uint32_t TIME_SYNC_FAST_INTERVAL_MS = 2000;
+static constexpr uint32_t TIME_SYNC_INTERVAL_MS = 16000;
+static constexpr uint8_t TIME_SYNC_FAST_EXCHANGES = 4;
+
+// A sample with a longer round trip is dropped, its error bound would be too wide to be of use
+static constexpr uint32_t TIME_SYNC_MAX_DELAY_US = 30000;
+
+// Crystal tolerance: a larger measured skew is clamped (parts per billion)
+static constexpr int32_t TIME_SYNC_MAX_SKEW_PPB = 500000;
+
+/**
+ * @brief State of the clock model
+ */
+struct TimeSyncStats {
+    bool synced;         // the sync clock follows the server, always true without one (this device is the reference)
+    int64_t offsetUs;    // sync time minus local time at the last sample
+    int32_t skewPpb;     // how much faster the server clock runs, parts per billion
+    uint32_t delayUs;    // round trip of the last sample kept
+    uint32_t errorUs;    // bound on the offset error of the last sample: half its round trip
+    int32_t residualUs;  // last sample minus what the model predicted for it
+    uint32_t samples;
+    uint32_t requests;
+    uint32_t replies;
+    uint32_t answered;  // requests of other devices answered
+    uint32_t lastSampleMs;
+};
+
+/**
+ * @brief LAN clock shared by the devices: NTP-style offset and skew estimation over UDP
+ *
+ * Every device answers time requests on TIME_SYNC_PORT with its sync clock, so a cube or the host (holosync.py
+ * serve) can be the reference. A device given a server sends it bursts of requests; each reply gives the offset
+ * ((t2 - t1) + (t3 - t4)) / 2 and the round trip (t4 - t1) - (t3 - t2), and the sample with the shortest round trip of
+ * the burst is kept, as queueing only ever adds delay. Consecutive samples give the skew, so between exchanges
+ * the sync clock is the local clock plus the offset plus the skew times the time since the last sample.
+ *
+ * Times are microseconds on 64 bits. Timestamps are taken when loop() reads the packet, not when it arrives, which
+ * the shortest round trip filter mostly takes out
+ */
+namespace TimeSync {
+
+void begin(const IPAddress& server);
+void update(uint32_t nowMs);
+auto localUs() -> uint64_t;
+auto now() -> uint64_t;
+auto toLocal(uint64_t syncUs) -> uint64_t;
+auto server() -> IPAddress;
+auto stats() -> TimeSyncStats;
+
+}  // namespace TimeSync
+
+#endif  // TIME_SYNC_H
@@ -3,9 +3,15 @@
 
 #include <Logger.h>
 #include "config/ConfigManager.h"
+#include "display/BoardProfile.h"
 
 ConfigManager::ConfigManager(const char* filename) : filename(filename) {}
 
+/**
+ * @brief Check an lcd_rotate value: a quarter turn in degrees
+ */
+static auto isQuarterTurn(int16_t degrees) -> bool { return degrees >= 0 && degrees < 360 && degrees % 90 == 0; }
+
 /**
  * @brief Loads the configuration from a file stored in SPIFFS
  *
@@ -44,11 +50,19 @@ auto ConfigManager::load() -> bool {
 
     ssid = doc["wifi_ssid"].as<const char*>();
     password = doc["wifi_password"].as<const char*>();
+    board = doc["board"] | "";
 
     lcd_enable = doc["lcd_enable"] | lcd_enable;
     lcd_w = doc["lcd_w"] | lcd_w;
     lcd_h = doc["lcd_h"] | lcd_h;
-    lcd_rotation = doc["lcd_rotation"] | lcd_rotation;
+    lcd_rotation = doc["lcd_rotation"] | boardRotation(boardFromName(board.c_str()), lcd_rotation);
+    lcd_rotate = doc["lcd_rotate"] | lcd_rotate;
+    if (lcd_rotate >= 0 && !isQuarterTurn(lcd_rotate)) {
+        Logger::warn("lcd_rotate must be 0, 90, 180 or 270, lcd_rotation is used instead", "ConfigManager");
+        lcd_rotate = -1;
+    }
+    lcd_mirror_x = doc["lcd_mirror_x"] | lcd_mirror_x;
+    lcd_mirror_y = doc["lcd_mirror_y"] | lcd_mirror_y;
     lcd_mosi_gpio = doc["lcd_mosi_gpio"] | lcd_mosi_gpio;
     lcd_sck_gpio = doc["lcd_sck_gpio"] | lcd_sck_gpio;
     lcd_cs_gpio = doc["lcd_cs_gpio"] | lcd_cs_gpio;
@@ -62,6 +76,26 @@ auto ConfigManager::load() -> bool {
     lcd_backlight_gpio = doc["lcd_backlight_gpio"] | lcd_backlight_gpio;
     lcd_backlight_active_low = doc["lcd_backlight_active_low"] | lcd_backlight_active_low;
 
+    mqtt_host = doc["mqtt_host"] | "";
+    mqtt_port = doc["mqtt_port"] | mqtt_port;
+    mqtt_user = doc["mqtt_user"] | "";
+    mqtt_password = doc["mqtt_password"] | "";
+    mqtt_topics.clear();
+    for (JsonVariantConst topic : doc["mqtt_topics"].as<JsonArrayConst>()) {
+        mqtt_topics.emplace_back(topic | "");
+    }
+    mqtt_screen_topic = doc["mqtt_screen_topic"] | "";
+
+    broadcast_enabled = doc["broadcast_enabled"] | false;
+    broadcast_address = doc["broadcast_address"] | "";
+    broadcast_port = doc["broadcast_port"] | broadcast_port;
+    broadcast_groups.clear();
+    for (JsonVariantConst group : doc["broadcast_groups"].as<JsonArrayConst>()) {
+        broadcast_groups.push_back(group.as<uint16_t>());
+    }
+
+    sync_server = doc["sync_server"] | "";
+
     return true;
 }
 
@@ -79,6 +113,13 @@ auto ConfigManager::getSSID() const -> const char* { return ssid.c_str(); }
  */
 auto ConfigManager::getPassword() const -> const char* { return password.c_str(); }
 
+/**
+ * @brief Retrieves the board name used to select a compile-time display profile
+ *
+ * @return The board name as a c style string (empty when not configured)
+ */
+auto ConfigManager::getBoard() const -> const char* { return board.c_str(); }
+
 /**
  * @brief Returns the current status of the LCD enable flag
  *
@@ -105,6 +146,36 @@ auto ConfigManager::getLCDHeight() const -> int16_t { return lcd_h; }
  */
 auto ConfigManager::getLCDRotation() const -> uint8_t { return lcd_rotation; }
 
+/**
+ * @brief Returns whether an explicit display transform (lcd_rotate, lcd_mirror_x, lcd_mirror_y) is configured
+ *
+ * @return true if the transform is configured false if it must be derived from lcd_rotation
+ */
+auto ConfigManager::hasLCDTransform() const -> bool { return lcd_rotate >= 0; }
+
+/**
+ * @brief Retrieves the display rotation in degrees
+ *
+ * @return The rotation (0, 90, 180 or 270)
+ */
+auto ConfigManager::getLCDRotate() const -> uint16_t {
+    return (lcd_rotate >= 0) ? static_cast<uint16_t>(lcd_rotate) : 0;
+}
+
+/**
+ * @brief Returns whether the display is mirrored horizontally
+ *
+ * @return true if the display is mirrored horizontally false otherwise
+ */
+auto ConfigManager::getLCDMirrorX() const -> bool { return lcd_mirror_x; }
+
+/**
+ * @brief Returns whether the display is mirrored vertically
+ *
+ * @return true if the display is mirrored vertically false otherwise
+ */
+auto ConfigManager::getLCDMirrorY() const -> bool { return lcd_mirror_y; }
+
 /**
  * @brief Retrieves the GPIO pin number for LCD MOSI
  *
@@ -188,6 +259,83 @@ auto ConfigManager::getLCDBacklightGpio() const -> int8_t { return lcd_backlight
  */
 auto ConfigManager::getLCDBacklightActiveLow() const -> bool { return lcd_backlight_active_low; }
 
+/**
+ * @brief Retrieves the MQTT broker host
+ *
+ * @return The host name or address as a c style string (empty when MQTT is off)
+ */
+auto ConfigManager::getMqttHost() const -> const char* { return mqtt_host.c_str(); }
+
+/**
+ * @brief Retrieves the MQTT broker port
+ *
+ * @return The TCP port of the broker
+ */
+auto ConfigManager::getMqttPort() const -> uint16_t { return mqtt_port; }
+
+/**
+ * @brief Retrieves the MQTT user name
+ *
+ * @return The user name as a c style string (empty for an anonymous connection)
+ */
+auto ConfigManager::getMqttUser() const -> const char* { return mqtt_user.c_str(); }
+
+/**
+ * @brief Retrieves the MQTT password
+ *
+ * @return The password as a c style string
+ */
+auto ConfigManager::getMqttPassword() const -> const char* { return mqtt_password.c_str(); }
+
+/**
+ * @brief Retrieves the MQTT topics carrying draw batches
+ *
+ * @return The topic filters
+ */
+auto ConfigManager::getMqttTopics() const -> const std::vector<std::string>& { return mqtt_topics; }
+
+/**
+ * @brief Retrieves the retained MQTT topic holding the last full screen
+ *
+ * @return The topic as a c style string (empty when not used)
+ */
+auto ConfigManager::getMqttScreenTopic() const -> const char* { return mqtt_screen_topic.c_str(); }
+
+/**
+ * @brief Retrieves whether the multicast draw listener is on
+ *
+ * @return true when the device joins the broadcast group
+ */
+auto ConfigManager::getBroadcastEnabled() const -> bool { return broadcast_enabled; }
+
+/**
+ * @brief Retrieves the multicast address of the draw broadcast
+ *
+ * @return The address as a c style string (empty for the default group)
+ */
+auto ConfigManager::getBroadcastAddress() const -> const char* { return broadcast_address.c_str(); }
+
+/**
+ * @brief Retrieves the UDP port of the draw broadcast
+ *
+ * @return The port
+ */
+auto ConfigManager::getBroadcastPort() const -> uint16_t { return broadcast_port; }
+
+/**
+ * @brief Retrieves the broadcast groups this device applies, besides group 0
+ *
+ * @return The group ids
+ */
+auto ConfigManager::getBroadcastGroups() const -> const std::vector<uint16_t>& { return broadcast_groups; }
+
+/**
+ * @brief Retrieves the address the sync clock follows
+ *
+ * @return The address as a c style string (empty when this device is the reference)
+ */
+auto ConfigManager::getSyncServer() const -> const char* { return sync_server.c_str(); }
+
 /**
  * @brief Set WiFi credentials in memory
  * @param newSsid The SSID
@@ -204,6 +352,66 @@ auto ConfigManager::setWiFi(const char* newSsid, const char* newPassword) -> voi
     }
 }
 
+/**
+ * @brief Set the display transform in memory
+ * @param rotate The rotation in degrees (0, 90, 180 or 270)
+ * @param mirrorX Mirror horizontally
+ * @param mirrorY Mirror vertically
+ *
+ * @return void
+ */
+auto ConfigManager::setLCDTransform(uint16_t rotate, bool mirrorX, bool mirrorY) -> void {
+    lcd_rotate = static_cast<int16_t>(rotate);
+    lcd_mirror_x = mirrorX;
+    lcd_mirror_y = mirrorY;
+}
+
+/**
+ * @brief Set the MQTT broker and topics in memory
+ * @param host The broker host, empty turns MQTT off
+ * @param port The broker port
+ * @param user The user name, empty for an anonymous connection
+ * @param password The password
+ * @param topics The topic filters carrying draw batches
+ * @param screenTopic The retained topic holding the last full screen
+ *
+ * @return void
+ */
+auto ConfigManager::setMqtt(const char* host, uint16_t port, const char* user, const char* password,
+                            const std::vector<std::string>& topics, const char* screenTopic) -> void {
+    mqtt_host = host;
+    mqtt_port = port;
+    mqtt_user = user;
+    mqtt_password = password;
+    mqtt_topics = topics;
+    mqtt_screen_topic = screenTopic;
+}
+
+/**
+ * @brief Set the multicast draw listener in memory
+ * @param enabled Join the broadcast group
+ * @param address The multicast address, empty for the default group
+ * @param port The UDP port
+ * @param groups The groups this device applies, besides group 0
+ *
+ * @return void
+ */
+auto ConfigManager::setBroadcast(bool enabled, const char* address, uint16_t port, const std::vector<uint16_t>& groups)
+    -> void {
+    broadcast_enabled = enabled;
+    broadcast_address = address;
+    broadcast_port = port;
+    broadcast_groups = groups;
+}
+
+/**
+ * @brief Set the time sync server in memory
+ * @param server The address to take the time from, empty makes this device the reference
+ *
+ * @return void
+ */
+auto ConfigManager::setSyncServer(const char* server) -> void { sync_server = server; }
+
 /**
  * @brief Save the current configuration to the file
  *
@@ -228,10 +436,53 @@ auto ConfigManager::save() -> bool {
 
     doc["wifi_ssid"] = ssid.c_str();
     doc["wifi_password"] = password.c_str();
+    if (!board.empty()) {
+        doc["board"] = board.c_str();
+    }
     doc["lcd_enable"] = lcd_enable;
     doc["lcd_w"] = lcd_w;
     doc["lcd_h"] = lcd_h;
     doc["lcd_rotation"] = lcd_rotation;
+    if (lcd_rotate >= 0) {
+        doc["lcd_rotate"] = lcd_rotate;
+        doc["lcd_mirror_x"] = lcd_mirror_x;
+        doc["lcd_mirror_y"] = lcd_mirror_y;
+    }
+    doc["lcd_mosi_gpio"] = lcd_mosi_gpio;
+    doc["lcd_sck_gpio"] = lcd_sck_gpio;
+    doc["lcd_cs_gpio"] = lcd_cs_gpio;
+    doc["lcd_dc_gpio"] = lcd_dc_gpio;
+    doc["lcd_rst_gpio"] = lcd_rst_gpio;
+    doc["lcd_cs_active_high"] = lcd_cs_active_high;
+    doc["lcd_dc_cmd_high"] = lcd_dc_cmd_high;
+    doc["lcd_spi_mode"] = lcd_spi_mode;
+    doc["lcd_keep_cs_asserted"] = lcd_keep_cs_asserted;
+    doc["lcd_spi_hz"] = lcd_spi_hz;
+    doc["lcd_backlight_gpio"] = lcd_backlight_gpio;
+    doc["lcd_backlight_active_low"] = lcd_backlight_active_low;
+    if (!mqtt_host.empty()) {
+        doc["mqtt_host"] = mqtt_host.c_str();
+        doc["mqtt_port"] = mqtt_port;
+        doc["mqtt_user"] = mqtt_user.c_str();
+        doc["mqtt_password"] = mqtt_password.c_str();
+        JsonArray topics = doc["mqtt_topics"].to<JsonArray>();
+        for (const std::string& topic : mqtt_topics) {
+            topics.add(topic.c_str());
+        }
+        doc["mqtt_screen_topic"] = mqtt_screen_topic.c_str();
+    }
+    if (broadcast_enabled) {
+        doc["broadcast_enabled"] = true;
+        doc["broadcast_address"] = broadcast_address.c_str();
+        doc["broadcast_port"] = broadcast_port;
+        JsonArray groups = doc["broadcast_groups"].to<JsonArray>();
+        for (uint16_t group : broadcast_groups) {
+            groups.add(group);
+        }
+    }
+    if (!sync_server.empty()) {
+        doc["sync_server"] = sync_server.c_str();
+    }
 
     if (serializeJson(doc, file) == 0) {
         Logger::error("Failed to write config file", "ConfigManager");
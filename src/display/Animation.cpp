@@ -0,0 +1,419 @@
+#include <Arduino.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "display/Animation.h"
+#include "display/DisplayManager.h"
+
+// Progress and easing outputs are 16.16 fixed point: 0 is the start, FIXED_ONE the end
+static constexpr uint32_t FIXED_ONE = 1UL << 16U;
+static constexpr uint32_t FIXED_HALF = FIXED_ONE / 2;
+static constexpr uint8_t FRACTION_BITS = 16;
+
+static constexpr uint8_t FONT_CHAR_WIDTH = 6;
+static constexpr uint8_t FONT_CHAR_HEIGHT = 8;
+
+/**
+ * @brief Screen area of a shape, x1/y1 exclusive
+ */
+struct AnimationBounds {
+    int32_t x0;
+    int32_t y0;
+    int32_t x1;
+    int32_t y1;
+};
+
+/**
+ * @brief One slot of the pool
+ */
+struct AnimationSlot {
+    bool used;
+    bool drawn;          // whether state is on the screen
+    AnimationSpec spec;
+    uint32_t startMs;    // start of the current run, delay included
+    uint16_t runsLeft;
+    bool reversed;       // current run goes from to back to from
+    AnimationState state;
+};
+
+static auto mulFixed(uint32_t left, uint32_t right) -> uint32_t {
+    return static_cast<uint32_t>((static_cast<uint64_t>(left) * right) >> FRACTION_BITS);
+}
+
+static auto lerp(int32_t from, int32_t to, uint32_t eased) -> int16_t {
+    return static_cast<int16_t>(from + (((to - from) * static_cast<int64_t>(eased)) >> FRACTION_BITS));
+}
+
+// Interpolate each RGB565 channel on its own
+static auto lerpColor(uint16_t from, uint16_t to, uint32_t eased) -> uint16_t {
+    const auto red = static_cast<uint16_t>(lerp(from >> 11U, to >> 11U, eased));
+    const auto green = static_cast<uint16_t>(lerp((from >> 5U) & 0x3FU, (to >> 5U) & 0x3FU, eased));
+    const auto blue = static_cast<uint16_t>(lerp(from & 0x1FU, to & 0x1FU, eased));
+    return static_cast<uint16_t>((red << 11U) | (green << 5U) | blue);
+}
+
+static auto sameState(const AnimationState& left, const AnimationState& right) -> bool {
+    return left.x == right.x && left.y == right.y && left.w == right.w && left.h == right.h && left.r == right.r &&
+           left.color == right.color;
+}
+
+static auto boundsOf(const AnimationSpec& spec, const AnimationState& state) -> AnimationBounds {
+    switch (spec.shape) {
+        case AnimationShape::Circle:
+            return AnimationBounds{state.x - state.r, state.y - state.r, state.x + state.r + 1, state.y + state.r + 1};
+        case AnimationShape::Text: {
+            const auto length = static_cast<int32_t>(strnlen(spec.text.data(), spec.text.size()));
+            return AnimationBounds{state.x, state.y, state.x + length * FONT_CHAR_WIDTH * spec.textSize,
+                                   state.y + FONT_CHAR_HEIGHT * spec.textSize};
+        }
+        default:
+            return AnimationBounds{state.x, state.y, state.x + std::max<int16_t>(state.w, 0),
+                                   state.y + std::max<int16_t>(state.h, 0)};
+    }
+}
+
+static auto boundsEmpty(const AnimationBounds& bounds) -> bool {
+    return bounds.x0 >= bounds.x1 || bounds.y0 >= bounds.y1;
+}
+
+static auto boundsContain(const AnimationBounds& outer, const AnimationBounds& inner) -> bool {
+    return outer.x0 <= inner.x0 && outer.y0 <= inner.y0 && outer.x1 >= inner.x1 && outer.y1 >= inner.y1;
+}
+
+/**
+ * @brief Whether the new shape paints over every pixel the old one left on the screen
+ */
+static auto covers(const AnimationSpec& spec, const AnimationState& next, const AnimationState& prev) -> bool {
+    const AnimationBounds nextBounds = boundsOf(spec, next);
+    const AnimationBounds prevBounds = boundsOf(spec, prev);
+
+    if (!spec.fill && spec.shape != AnimationShape::Text) {
+        return false;
+    }
+
+    switch (spec.shape) {
+        case AnimationShape::Rect:
+            return boundsContain(nextBounds, prevBounds);
+        case AnimationShape::RoundRect:
+            // Old corners are covered when the old rect sits a radius inside the new one
+            return boundsContain(
+                AnimationBounds{nextBounds.x0 + next.r, nextBounds.y0 + next.r, nextBounds.x1 - next.r,
+                                nextBounds.y1 - next.r},
+                prevBounds);
+        case AnimationShape::Circle: {
+            const int32_t deltaX = next.x - prev.x;
+            const int32_t deltaY = next.y - prev.y;
+            const int32_t reach = next.r - prev.r;
+            return reach >= 0 && deltaX * deltaX + deltaY * deltaY <= reach * reach;
+        }
+        case AnimationShape::Text:
+            // Same glyphs at the same place: only the color can differ
+            return next.x == prev.x && next.y == prev.y;
+    }
+
+    return false;
+}
+
+static void eraseArea(const AnimationBounds& area, uint16_t color) {
+    if (!boundsEmpty(area)) {
+        DisplayManager::fillBackground(static_cast<int16_t>(area.x0), static_cast<int16_t>(area.y0),
+                                       static_cast<int16_t>(area.x1 - area.x0),
+                                       static_cast<int16_t>(area.y1 - area.y0), color);
+    }
+}
+
+/**
+ * @brief Fill the part of outer that inner does not cover, as up to four bands (above, below, left, right)
+ */
+static void fillOutside(const AnimationBounds& outer, const AnimationBounds& inner,
+                        void (*fill)(const AnimationBounds&, uint16_t), uint16_t color) {
+    const int32_t midTop = std::max(outer.y0, inner.y0);
+    const int32_t midBottom = std::min(outer.y1, inner.y1);
+
+    if (midTop >= midBottom || inner.x0 >= outer.x1 || inner.x1 <= outer.x0) {
+        fill(outer, color);
+        return;
+    }
+
+    fill(AnimationBounds{outer.x0, outer.y0, outer.x1, midTop}, color);
+    fill(AnimationBounds{outer.x0, midBottom, outer.x1, outer.y1}, color);
+    fill(AnimationBounds{outer.x0, midTop, std::min(outer.x1, inner.x0), midBottom}, color);
+    fill(AnimationBounds{std::max(outer.x0, inner.x1), midTop, outer.x1, midBottom}, color);
+}
+
+static void fillArea(const AnimationBounds& area, uint16_t color) {
+    if (!boundsEmpty(area)) {
+        DisplayManager::fillRect(static_cast<int16_t>(area.x0), static_cast<int16_t>(area.y0),
+                                 static_cast<int16_t>(area.x1 - area.x0), static_cast<int16_t>(area.y1 - area.y0),
+                                 color);
+    }
+}
+
+static void drawShape(const AnimationSpec& spec, const AnimationState& state) {
+    switch (spec.shape) {
+        case AnimationShape::Rect:
+            if (spec.fill) {
+                DisplayManager::fillRect(state.x, state.y, state.w, state.h, state.color);
+            } else {
+                DisplayManager::drawRect(state.x, state.y, state.w, state.h, state.color);
+            }
+            break;
+        case AnimationShape::RoundRect:
+            if (spec.fill) {
+                DisplayManager::fillRoundRect(state.x, state.y, state.w, state.h, state.r, state.color);
+            } else {
+                DisplayManager::drawRoundRect(state.x, state.y, state.w, state.h, state.r, state.color);
+            }
+            break;
+        case AnimationShape::Circle:
+            if (spec.fill) {
+                DisplayManager::fillCircle(state.x, state.y, state.r, state.color);
+            } else {
+                DisplayManager::drawCircle(state.x, state.y, state.r, state.color);
+            }
+            break;
+        case AnimationShape::Text:
+            DisplayManager::drawTextWrapped(state.x, state.y, String(spec.text.data()), spec.textSize, state.color,
+                                            spec.bg, false);
+            break;
+    }
+}
+
+/**
+ * @brief Move a shape on the screen from its drawn state to the next one
+ */
+static void repaint(AnimationSlot& slot, const AnimationState& next) {
+    const AnimationSpec& spec = slot.spec;
+    const bool solidRect = spec.shape == AnimationShape::Rect && spec.fill;
+    const AnimationBounds prevBounds = boundsOf(spec, slot.state);
+    const AnimationBounds nextBounds = boundsOf(spec, next);
+
+    if (slot.drawn && solidRect && next.color == slot.state.color) {
+        // Same color: only the pixels the rect gains or loses change
+        fillOutside(prevBounds, nextBounds, eraseArea, spec.bg);
+        fillOutside(nextBounds, prevBounds, fillArea, next.color);
+    } else {
+        if (slot.drawn && !covers(spec, next, slot.state)) {
+            if (solidRect) {
+                // The new rect repaints the overlap itself
+                fillOutside(prevBounds, nextBounds, eraseArea, spec.bg);
+            } else {
+                eraseArea(prevBounds, spec.bg);
+            }
+        }
+        drawShape(spec, next);
+    }
+
+    slot.state = next;
+    slot.drawn = true;
+}
+
+namespace Animation {
+
+static std::array<AnimationSlot, ANIMATION_POOL_SIZE> s_slots{};
+static uint32_t s_lastTickMs = 0;
+static AnimationStats s_stats{};
+
+static auto findSlot(uint8_t id) -> AnimationSlot* {
+    for (AnimationSlot& slot : s_slots) {
+        if (slot.used && slot.spec.id == id) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Start an animation, replacing the running one with the same id
+ *
+ * A replaced animation keeps its shape on the screen, so the new one moves it on from where it was instead of
+ * leaving a copy behind
+ *
+ * @param spec The animation
+ * @param nowMs Current time (millis())
+ * @return false when every slot of the pool is taken
+ */
+auto start(const AnimationSpec& spec, uint32_t nowMs) -> bool {
+    AnimationSlot* slot = findSlot(spec.id);
+    const bool replacing = slot != nullptr;
+
+    for (size_t i = 0; slot == nullptr && i < s_slots.size(); ++i) {
+        if (!s_slots[i].used) {
+            slot = &s_slots[i];
+        }
+    }
+    if (slot == nullptr) {
+        s_stats.rejected++;
+        return false;
+    }
+
+    const bool drawn = replacing && slot->drawn;
+    const AnimationState drawnState = slot->state;
+
+    *slot = AnimationSlot{true, drawn, spec, nowMs, spec.repeat, false, drawn ? drawnState : spec.from};
+    slot->spec.durationMs = std::max<uint32_t>(spec.durationMs, 1);
+    slot->spec.text.back() = '\0';
+
+    return true;
+}
+
+/**
+ * @brief Stop an animation where it is (the shape stays on the screen)
+ *
+ * @param id Animation id
+ * @return false if no animation has this id
+ */
+auto stop(uint8_t id) -> bool {
+    AnimationSlot* slot = findSlot(id);
+    if (slot == nullptr) {
+        return false;
+    }
+
+    slot->used = false;
+    return true;
+}
+
+/**
+ * @brief Stop every animation
+ */
+void stopAll() {
+    for (AnimationSlot& slot : s_slots) {
+        slot.used = false;
+    }
+}
+
+/**
+ * @brief State last drawn by a running animation
+ *
+ * @param id Animation id
+ * @param state Receives the state
+ * @return false if no animation has this id
+ */
+auto current(uint8_t id, AnimationState& state) -> bool {
+    const AnimationSlot* slot = findSlot(id);
+    if (slot == nullptr) {
+        return false;
+    }
+
+    state = slot->state;
+    return true;
+}
+
+/**
+ * @brief Shape a linear progress with an easing curve
+ *
+ * @param easing The curve
+ * @param progress 16.16 progress, 0 to 1
+ * @return 16.16 eased progress, 0 to 1
+ */
+auto ease(Easing easing, uint32_t progress) -> uint32_t {
+    const uint32_t t = std::min(progress, FIXED_ONE);
+    const uint32_t inv = FIXED_ONE - t;
+
+    switch (easing) {
+        case Easing::In:
+            return mulFixed(t, t);
+        case Easing::Out:
+            return FIXED_ONE - mulFixed(inv, inv);
+        case Easing::InOut:
+            return t < FIXED_HALF ? 2 * mulFixed(t, t) : FIXED_ONE - 2 * mulFixed(inv, inv);
+        case Easing::InCubic:
+            return mulFixed(mulFixed(t, t), t);
+        case Easing::OutCubic:
+            return FIXED_ONE - mulFixed(mulFixed(inv, inv), inv);
+        case Easing::InOutCubic:
+            return t < FIXED_HALF ? 4 * mulFixed(mulFixed(t, t), t) : FIXED_ONE - 4 * mulFixed(mulFixed(inv, inv), inv);
+        default:
+            return t;
+    }
+}
+
+/**
+ * @brief Advance one slot, returns false once it is finished
+ */
+static auto advance(AnimationSlot& slot, uint32_t nowMs) -> bool {
+    const AnimationSpec& spec = slot.spec;
+    const uint32_t elapsed = nowMs - slot.startMs;
+
+    if (elapsed < spec.delayMs) {
+        return true;
+    }
+
+    const uint32_t runMs = elapsed - spec.delayMs;
+    const bool runDone = runMs >= spec.durationMs;
+    uint32_t progress =
+        runDone ? FIXED_ONE : static_cast<uint32_t>((static_cast<uint64_t>(runMs) << FRACTION_BITS) / spec.durationMs);
+    if (slot.reversed) {
+        progress = FIXED_ONE - progress;
+    }
+
+    const uint32_t eased = ease(spec.easing, progress);
+    const AnimationState next{lerp(spec.from.x, spec.to.x, eased), lerp(spec.from.y, spec.to.y, eased),
+                              lerp(spec.from.w, spec.to.w, eased), lerp(spec.from.h, spec.to.h, eased),
+                              lerp(spec.from.r, spec.to.r, eased), lerpColor(spec.from.color, spec.to.color, eased)};
+
+    if (!slot.drawn || !sameState(next, slot.state)) {
+        repaint(slot, next);
+    }
+
+    if (!runDone) {
+        return true;
+    }
+    if (slot.runsLeft == 0) {
+        return false;
+    }
+
+    if (slot.runsLeft != ANIMATION_REPEAT_FOREVER) {
+        slot.runsLeft--;
+    }
+    if (spec.yoyo) {
+        slot.reversed = !slot.reversed;
+    }
+    // The next run starts right away, the delay only applies to the first one
+    slot.startMs = nowMs - spec.delayMs;
+
+    return true;
+}
+
+/**
+ * @brief Repaint the running animations, at most once per ANIMATION_FRAME_MS
+ *
+ * @param nowMs Current time (millis())
+ */
+void update(uint32_t nowMs) {
+    if (activeCount() == 0 || nowMs - s_lastTickMs < ANIMATION_FRAME_MS) {
+        return;
+    }
+    s_lastTickMs = nowMs;
+
+    const uint32_t startUs = micros();
+
+    // Animations draw in screen coordinates, whatever a batch left behind
+    DisplayManager::resetViewport();
+    for (AnimationSlot& slot : s_slots) {
+        if (slot.used && !advance(slot, nowMs)) {
+            slot.used = false;
+        }
+    }
+
+    const uint32_t tickUs = micros() - startUs;
+    s_stats.ticks++;
+    s_stats.lastTickUs = tickUs;
+    s_stats.maxTickUs = std::max(s_stats.maxTickUs, tickUs);
+}
+
+/**
+ * @brief Number of running animations
+ */
+auto activeCount() -> size_t {
+    return static_cast<size_t>(
+        std::count_if(s_slots.begin(), s_slots.end(), [](const AnimationSlot& slot) { return slot.used; }));
+}
+
+/**
+ * @brief Ticks, their cost and the starts refused since boot
+ */
+auto stats() -> AnimationStats { return s_stats; }
+
+}  // namespace Animation
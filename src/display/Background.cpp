@@ -0,0 +1,298 @@
+#include <LittleFS.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "display/Background.h"
+
+static constexpr size_t R5TL_HEADER_SIZE = 12;
+static constexpr size_t R5TL_MAGIC_SIZE = 4;
+static constexpr size_t R5TL_OFFSET_SIZE = 4;
+static constexpr uint8_t R5TL_ENCODING_RAW = 0;
+static constexpr uint8_t R5TL_ENCODING_RLE = 1;
+static constexpr uint8_t RLE_RUN_FLAG = 0x80;
+static constexpr uint8_t RLE_RUN_BIAS = 126;
+static constexpr size_t TILE_READ_CHUNK = 128;
+
+static auto readBe16(const uint8_t* src) -> uint32_t { return (static_cast<uint32_t>(src[0]) << 8U) | src[1]; }
+
+static auto readBe32(const uint8_t* src) -> uint32_t { return (readBe16(src) << 16U) | readBe16(src + 2); }
+
+/**
+ * @brief Sequential reads of one tile through a small buffer
+ */
+struct TileReader {
+    File& file;
+    uint32_t left;
+    std::array<uint8_t, TILE_READ_CHUNK> buffer{};
+    size_t pos = 0;
+    size_t len = 0;
+
+    auto next(uint8_t& value) -> bool {
+        if (pos == len) {
+            len = (left > 0) ? file.read(buffer.data(), std::min<uint32_t>(buffer.size(), left)) : 0;
+            pos = 0;
+            if (len == 0) {
+                return false;
+            }
+            left -= len;
+        }
+        value = buffer[pos++];
+        return true;
+    }
+
+    // Next big-endian pixel, kept in panel byte order
+    auto nextPixel(uint16_t& pixel) -> bool {
+        std::array<uint8_t, 2> bytes{};
+        if (!next(bytes[0]) || !next(bytes[1])) {
+            return false;
+        }
+        std::memcpy(&pixel, bytes.data(), sizeof(pixel));
+        return true;
+    }
+};
+
+/**
+ * @brief Decode R565 run-length packets until count pixels are written
+ */
+static auto decodeRle(TileReader& reader, uint16_t* out, uint32_t count) -> bool {
+    uint32_t filled = 0;
+
+    while (filled < count) {
+        uint8_t control = 0;
+        uint16_t pixel = 0;
+        if (!reader.next(control)) {
+            return false;
+        }
+
+        if (control < RLE_RUN_FLAG) {
+            const uint32_t literals = std::min<uint32_t>(control + 1U, count - filled);
+            for (uint32_t i = 0; i < literals; ++i) {
+                if (!reader.nextPixel(pixel)) {
+                    return false;
+                }
+                out[filled++] = pixel;
+            }
+        } else {
+            if (!reader.nextPixel(pixel)) {
+                return false;
+            }
+            const uint32_t run = std::min<uint32_t>(control - RLE_RUN_BIAS, count - filled);
+            std::fill_n(out + filled, run, pixel);
+            filled += run;
+        }
+    }
+
+    return true;
+}
+
+namespace Background {
+
+/**
+ * @brief A decoded tile held in RAM
+ */
+struct TileSlot {
+    std::unique_ptr<uint16_t[]> pixels;
+    int32_t tile = -1;  // index of the cached tile, -1 when empty
+    uint32_t lastUse = 0;
+};
+
+static File s_file;
+static BackgroundInfo s_info{};
+static bool s_active = false;
+static std::array<TileSlot, BACKGROUND_CACHE_SLOTS> s_slots;
+static uint32_t s_useClock = 0;
+static BackgroundStats s_stats{};
+
+/**
+ * @brief Allocate as many tile slots as the image, the cache budget and the free heap allow, at least one
+ */
+static auto allocateSlots() -> uint16_t {
+    const size_t tileBytes = static_cast<size_t>(s_info.tileSize) * s_info.tileSize * sizeof(uint16_t);
+    const size_t wanted = std::min<size_t>({BACKGROUND_CACHE_SLOTS, static_cast<size_t>(s_info.columns) * s_info.rows,
+                                            std::max<size_t>(BACKGROUND_CACHE_BYTES / tileBytes, 1)});
+    uint16_t count = 0;
+
+    while (count < wanted) {
+        const uint32_t freeHeap = ESP.getFreeHeap();  // NOLINT(readability-static-accessed-through-instance)
+        if (count > 0 && freeHeap < BACKGROUND_HEAP_RESERVE + tileBytes) {
+            break;
+        }
+
+        s_slots[count].pixels.reset(new (std::nothrow) uint16_t[tileBytes / sizeof(uint16_t)]);
+        if (!s_slots[count].pixels) {
+            break;
+        }
+        s_slots[count].tile = -1;
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Use a tiled image on LittleFS as the background layer
+ *
+ * The file stays open so tiles can be read back on demand, nothing is decoded until a tile is needed
+ *
+ * @param path Path of an R5TL file
+ * @return true if the file is a valid R5TL image and a tile buffer could be allocated
+ */
+auto load(const String& path) -> bool {
+    unload();
+
+    File file = LittleFS.open(path, "r");
+    std::array<uint8_t, R5TL_HEADER_SIZE> header{};
+
+    if (!file || file.read(header.data(), header.size()) != header.size() ||
+        std::memcmp(header.data(), "R5TL", R5TL_MAGIC_SIZE) != 0) {
+        return false;
+    }
+
+    const auto width = static_cast<uint16_t>(readBe16(&header[4]));
+    const auto height = static_cast<uint16_t>(readBe16(&header[6]));
+    const uint8_t tileSize = header[8];
+    const uint8_t encoding = header[9];
+
+    if (width == 0 || height == 0 || tileSize < BACKGROUND_TILE_MIN || tileSize > BACKGROUND_TILE_MAX ||
+        (encoding != R5TL_ENCODING_RAW && encoding != R5TL_ENCODING_RLE)) {
+        return false;
+    }
+
+    s_info = BackgroundInfo{width,
+                            height,
+                            tileSize,
+                            encoding == R5TL_ENCODING_RLE,
+                            static_cast<uint16_t>((width + tileSize - 1) / tileSize),
+                            static_cast<uint16_t>((height + tileSize - 1) / tileSize),
+                            0};
+    s_info.cacheSlots = allocateSlots();
+    if (s_info.cacheSlots == 0) {
+        return false;
+    }
+
+    s_file = file;
+    s_active = true;
+
+    return true;
+}
+
+/**
+ * @brief Drop the background layer, its file handle and its tile cache
+ */
+void unload() {
+    if (s_file) {
+        s_file.close();
+    }
+    for (TileSlot& slot : s_slots) {
+        slot.pixels.reset();
+        slot.tile = -1;
+    }
+    s_info = BackgroundInfo{};
+    s_active = false;
+}
+
+/**
+ * @brief Whether a background layer is loaded
+ */
+auto active() -> bool { return s_active; }
+
+/**
+ * @brief Geometry of the loaded background layer
+ */
+auto info() -> BackgroundInfo { return s_info; }
+
+/**
+ * @brief Read one tile from flash into a slot, seeking straight to it through the offset table
+ */
+static auto readTile(uint32_t index, uint16_t count, uint16_t* out) -> bool {
+    std::array<uint8_t, 2 * R5TL_OFFSET_SIZE> offsets{};
+
+    if (!s_file.seek(R5TL_HEADER_SIZE + index * R5TL_OFFSET_SIZE) ||
+        s_file.read(offsets.data(), offsets.size()) != offsets.size()) {
+        return false;
+    }
+
+    const uint32_t start = readBe32(offsets.data());
+    const uint32_t end = readBe32(&offsets[R5TL_OFFSET_SIZE]);
+    if (end < start || !s_file.seek(start)) {
+        return false;
+    }
+
+    if (!s_info.rle) {
+        const size_t bytes = static_cast<size_t>(count) * sizeof(uint16_t);
+        return end - start == bytes && s_file.read(reinterpret_cast<uint8_t*>(out), bytes) == bytes;
+    }
+
+    TileReader reader{s_file, end - start};
+    return decodeRle(reader, out, count);
+}
+
+/**
+ * @brief Decoded pixels of a tile, from the RAM cache or read from flash
+ *
+ * The returned pointer stays valid until the next call
+ *
+ * @param column Tile column
+ * @param row Tile row
+ * @return The tile and its position in the image, pixels is nullptr on a read error or outside the image
+ */
+auto tile(uint16_t column, uint16_t row) -> BackgroundTile {
+    BackgroundTile result{nullptr, 0, 0, 0, 0};
+
+    if (!s_active || column >= s_info.columns || row >= s_info.rows) {
+        return result;
+    }
+
+    const uint16_t size = s_info.tileSize;
+    result.x = static_cast<int16_t>(column * size);
+    result.y = static_cast<int16_t>(row * size);
+    result.w = static_cast<int16_t>(std::min<uint16_t>(size, s_info.width - result.x));
+    result.h = static_cast<int16_t>(std::min<uint16_t>(size, s_info.height - result.y));
+
+    const auto index = static_cast<int32_t>(row) * s_info.columns + column;
+    TileSlot* victim = &s_slots[0];
+
+    for (uint16_t i = 0; i < s_info.cacheSlots; ++i) {
+        TileSlot& slot = s_slots[i];
+        if (slot.tile == index) {
+            slot.lastUse = ++s_useClock;
+            s_stats.cacheHits++;
+            result.pixels = slot.pixels.get();
+            return result;
+        }
+        if (slot.tile < 0 || (victim->tile >= 0 && slot.lastUse < victim->lastUse)) {
+            victim = &slot;
+        }
+    }
+
+    s_stats.tileReads++;
+    if (!readTile(static_cast<uint32_t>(index), static_cast<uint16_t>(result.w * result.h), victim->pixels.get())) {
+        victim->tile = -1;
+        return result;
+    }
+
+    victim->tile = index;
+    victim->lastUse = ++s_useClock;
+    result.pixels = victim->pixels.get();
+
+    return result;
+}
+
+/**
+ * @brief Add a completed repaint to the statistics
+ */
+void recordRestore(uint32_t elapsedUs) {
+    s_stats.restores++;
+    s_stats.lastUs = elapsedUs;
+}
+
+/**
+ * @brief Repaints, tiles read from flash and cache hits since boot
+ */
+auto stats() -> BackgroundStats { return s_stats; }
+
+}  // namespace Background
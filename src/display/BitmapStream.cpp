@@ -0,0 +1,210 @@
+#include <Arduino.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "display/BitmapStream.h"
+#include "display/DisplayManager.h"
+#include "display/Rgb565.h"
+
+static constexpr uint8_t MASK_BITS_PER_BYTE = 8;
+static constexpr uint8_t MASK_ALL_SET = 0xFF;
+static constexpr uint8_t MASK_FIRST_BIT = 0x80;
+
+// Two bytes in stream order, as they must reach the panel
+static auto loadPanelPair(uint8_t first, uint8_t second) -> uint16_t {
+    const std::array<uint8_t, 2> bytes = {first, second};
+    uint16_t pixel = 0;
+    std::memcpy(&pixel, bytes.data(), sizeof(pixel));
+    return pixel;
+}
+
+/**
+ * @brief Construct a new BitmapStream object
+ *
+ * @param spec Placement and layout, width and height must be at least 1
+ */
+BitmapStream::BitmapStream(const BitmapSpec& spec)
+    : m_spec(spec), m_remaining(static_cast<uint32_t>(spec.width) * spec.height) {
+    if (m_spec.format != BitmapFormat::Indexed) {
+        m_spec.paletteSize = 0;
+    }
+    m_spec.paletteSize = std::min(m_spec.paletteSize, BITMAP_PALETTE_MAX);
+
+    if (m_spec.format == BitmapFormat::Mask) {
+        m_palette[0] = Rgb565::swap(m_spec.background);
+        m_palette[1] = Rgb565::swap(m_spec.color);
+    }
+
+    m_output.begin(m_spec.x, m_spec.y, m_spec.width, m_spec.height);
+}
+
+/**
+ * @brief Write the next piece of the body
+ *
+ * @param data Next bytes of the body
+ * @param len Number of bytes
+ */
+auto BitmapStream::feed(const uint8_t* data, size_t len) -> void {
+    const uint32_t startUs = micros();
+
+    while (len > 0 && m_remaining > 0) {
+        size_t used = 0;
+
+        if (m_paletteFill < m_spec.paletteSize) {
+            used = feedPalette(data, len);
+        } else {
+            switch (m_spec.format) {
+                case BitmapFormat::Rgb565:
+                case BitmapFormat::Rgb565Le:
+                    used = feedWords(data, len);
+                    break;
+                case BitmapFormat::Indexed:
+                    used = feedIndexed(data, len);
+                    break;
+                case BitmapFormat::Mask:
+                    used = feedMask(data, len);
+                    break;
+            }
+        }
+
+        data += used;
+        len -= used;
+    }
+
+    m_busyUs += micros() - startUs;
+}
+
+/**
+ * @brief Send what is still buffered, at the end of the body
+ */
+auto BitmapStream::finish() -> void { flushMaskSpans(); }
+
+/**
+ * @brief Pixels received so far
+ */
+auto BitmapStream::pixelsWritten() const -> uint32_t {
+    return static_cast<uint32_t>(m_spec.width) * m_spec.height - m_remaining;
+}
+
+auto BitmapStream::feedPalette(const uint8_t* data, size_t len) -> size_t {
+    size_t pos = 0;
+
+    if (m_hasCarry) {
+        m_palette[m_paletteFill++] = loadPanelPair(m_carry, data[pos++]);
+        m_hasCarry = false;
+    }
+    while (m_paletteFill < m_spec.paletteSize && pos + 2 <= len) {
+        m_palette[m_paletteFill++] = loadPanelPair(data[pos], data[pos + 1]);
+        pos += 2;
+    }
+    if (m_paletteFill < m_spec.paletteSize && pos < len) {
+        m_carry = data[pos++];
+        m_hasCarry = true;
+    }
+
+    return pos;
+}
+
+auto BitmapStream::feedWords(const uint8_t* data, size_t len) -> size_t {
+    const bool bigEndian = m_spec.format == BitmapFormat::Rgb565;
+    size_t pos = 0;
+
+    if (m_hasCarry) {
+        const uint16_t pixel = loadPanelPair(m_carry, data[pos++]);
+        m_output.push(bigEndian ? pixel : Rgb565::swap(pixel));
+        m_remaining--;
+        m_hasCarry = false;
+    }
+
+    const auto count = std::min(static_cast<uint32_t>((len - pos) / sizeof(uint16_t)), m_remaining);
+    if (bigEndian) {
+        m_output.pushBytes(data + pos, count);
+    } else {
+        for (uint32_t i = 0; i < count; ++i) {
+            m_output.push(loadPanelPair(data[pos + 2 * i + 1], data[pos + 2 * i]));
+        }
+    }
+    pos += count * sizeof(uint16_t);
+    m_remaining -= count;
+
+    if (m_remaining > 0 && pos < len) {
+        m_carry = data[pos++];
+        m_hasCarry = true;
+    }
+
+    return pos;
+}
+
+auto BitmapStream::feedIndexed(const uint8_t* data, size_t len) -> size_t {
+    const auto count = static_cast<uint32_t>(std::min<size_t>(len, m_remaining));
+
+    for (uint32_t i = 0; i < count; ++i) {
+        m_output.push(m_palette[data[i]]);
+    }
+    m_remaining -= count;
+
+    return count;
+}
+
+/**
+ * @brief Expand mask bytes, whole 0x00/0xFF bytes are handled as runs
+ */
+auto BitmapStream::feedMask(const uint8_t* data, size_t len) -> size_t {
+    size_t pos = 0;
+
+    while (pos < len && m_remaining > 0) {
+        const uint8_t bits = data[pos++];
+        const auto count = static_cast<uint16_t>(std::min<uint32_t>(MASK_BITS_PER_BYTE, m_spec.width - m_maskColumn));
+
+        if (!m_spec.transparent) {
+            if (bits == 0 || bits == MASK_ALL_SET) {
+                m_output.pushRun(m_palette[bits & 1U], count);
+            } else {
+                for (uint16_t bit = 0; bit < count; ++bit) {
+                    m_output.push(m_palette[(bits & (MASK_FIRST_BIT >> bit)) != 0 ? 1 : 0]);
+                }
+            }
+        } else if ((bits != 0 || m_spanStart >= 0) && (bits != MASK_ALL_SET || m_spanStart < 0)) {
+            for (uint16_t bit = 0; bit < count; ++bit) {
+                const bool set = (bits & (MASK_FIRST_BIT >> bit)) != 0;
+                if (set && m_spanStart < 0) {
+                    m_spanStart = m_maskColumn + bit;
+                } else if (!set && m_spanStart >= 0) {
+                    addMaskSpan(static_cast<uint16_t>(m_maskColumn + bit));
+                }
+            }
+        }
+
+        m_maskColumn += count;
+        m_remaining -= count;
+
+        if (m_maskColumn == m_spec.width) {
+            if (m_spanStart >= 0) {
+                addMaskSpan(m_spec.width);
+            }
+            m_maskColumn = 0;
+            m_maskRow++;
+        }
+    }
+
+    return pos;
+}
+
+/**
+ * @brief Close the run of set bits ending before column
+ */
+void BitmapStream::addMaskSpan(uint16_t column) {
+    m_spans[m_spanCount++] = Span{static_cast<int16_t>(m_spec.x + m_spanStart), static_cast<int16_t>(m_spec.x + column),
+                                  static_cast<int16_t>(m_spec.y + m_maskRow), m_spec.color};
+    m_spanStart = -1;
+
+    if (m_spanCount == m_spans.size()) {
+        flushMaskSpans();
+    }
+}
+
+void BitmapStream::flushMaskSpans() {
+    DisplayManager::fillSpans(m_spans.data(), m_spanCount);
+    m_spanCount = 0;
+}
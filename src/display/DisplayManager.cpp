@@ -1,18 +1,30 @@
 #include <SPI.h>
 #include <Logger.h>
+#include <LittleFS.h>
 
 #include "project_version.h"
 #include "display/DisplayManager.h"
 #include "display/GeekMagicSPIBus.h"
+#include "display/BoardProfile.h"
+#include "display/ProfileSPIBus.h"
+#include "display/GeekMagicST7789.h"
+#include "display/Viewport.h"
+#include "display/Rgb565.h"
 #include "config/ConfigManager.h"
 #include "display/Gif.h"
+#include "display/GlyphCache.h"
+#include "display/Macro.h"
+#include "script/Script.h"
 
 static Gif s_gif;
+static Viewport s_viewport;
+static uint16_t s_backdrop = LCD_BLACK;
 
 extern ConfigManager configManager;
 
 static Arduino_DataBus* g_lcdBus = nullptr;
-static Arduino_GFX* g_lcd = nullptr;
+static void (*g_lcdBusDelete)(Arduino_DataBus*) = nullptr;
+static GeekMagicST7789* g_lcd = nullptr;
 static bool g_lcdReady = false;
 static bool g_lcdInitializing = false;
 static uint32_t g_lcdInitAttempts = 0;
@@ -22,6 +34,7 @@ static constexpr uint32_t LCD_HARDWARE_RESET_DELAY_MS = 100;
 static constexpr uint32_t LCD_BEGIN_DELAY_MS = 10;
 static constexpr int16_t DISPLAY_PADDING = 10;
 static constexpr int16_t DISPLAY_INFO_Y = 100;
+static constexpr int16_t LCD_MAX_SPAN = 320;
 
 // Screen cmd
 static constexpr uint8_t ST7789_SLEEP_DELAY_MS = 120;
@@ -60,7 +73,6 @@ static constexpr uint8_t ST7789_PORCH_PARAM_VBP = 0x33;
 
 // Simple params for commands
 static constexpr uint8_t ST7789_TEARING_PARAM_OFF = 0x00;
-static constexpr uint8_t ST7789_MADCTL_PARAM_DEFAULT = 0x00;
 static constexpr uint8_t ST7789_B7_PARAM_DEFAULT = 0x00;
 static constexpr uint8_t ST7789_BB_PARAM_VOLTAGE = 0x36;
 static constexpr uint8_t ST7789_C0_PARAM_1 = 0x2C;
@@ -92,6 +104,15 @@ static constexpr uint8_t ST7789_ADDR_END_LOW = 0xEF;
  */
 auto DisplayManager::getGfx() -> Arduino_GFX* { return g_lcd; }
 
+/**
+ * @brief Get the data bus the LCD is attached to
+ *
+ * Used by code that streams panel-order pixel buffers with writeBytes() after setting an address window
+ *
+ * @return Pointer to the Arduino_DataBus instance
+ */
+auto DisplayManager::getBus() -> Arduino_DataBus* { return g_lcdBus; }
+
 auto DisplayManager::screenWidth() -> int16_t {
     if (g_lcdReady && g_lcd != nullptr) {
         return static_cast<int16_t>(g_lcd->width());
@@ -135,6 +156,110 @@ static inline auto safeDrawRect(int16_t xPos, int16_t yPos, int16_t width, int16
     }
 }
 
+/**
+ * @brief Send panel-order pixels to an on-screen, already clipped rect
+ *
+ * Rows that are whole in the source go out as one address window and one transfer, otherwise each row gets its own
+ *
+ * @param x0 Left edge on screen
+ * @param y0 Top edge on screen
+ * @param span Width in pixels
+ * @param rows Height in pixels
+ * @param first First pixel to send
+ * @param stride Pixels from the start of one source row to the next
+ */
+static void lcdWritePixels(int32_t x0, int32_t y0, uint32_t span, uint32_t rows, const uint16_t* first,
+                           uint32_t stride) {
+    // writeBytes() only reads the buffer
+    auto* bytes = reinterpret_cast<uint8_t*>(const_cast<uint16_t*>(first));
+
+    g_lcd->startWrite();
+    if (span == stride) {
+        g_lcd->writeAddrWindow(static_cast<int16_t>(x0), static_cast<int16_t>(y0), static_cast<uint16_t>(span),
+                               static_cast<uint16_t>(rows));
+        g_lcdBus->writeBytes(bytes, span * rows * sizeof(uint16_t));
+    } else {
+        for (uint32_t row = 0; row < rows; ++row) {
+            g_lcd->writeAddrWindow(static_cast<int16_t>(x0), static_cast<int16_t>(y0 + row),
+                                   static_cast<uint16_t>(span), 1);
+            g_lcdBus->writeBytes(bytes + row * stride * sizeof(uint16_t), span * sizeof(uint16_t));
+        }
+    }
+    g_lcd->endWrite();
+}
+
+/**
+ * @brief Repaint a screen rect from the background layer, or fill it with a color when none is loaded
+ *
+ * Only the tiles under the rect are fetched (from the RAM cache or from flash) and each one is cut to the rect
+ * before it is sent. Whatever lies outside the background image gets the color
+ *
+ * @param x0 Left edge on screen
+ * @param y0 Top edge on screen
+ * @param x1 Right edge (exclusive)
+ * @param y1 Bottom edge (exclusive)
+ * @param color Fill color without a background layer
+ */
+static void lcdFillBackground(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color) {
+    const ClipRect& clip = s_viewport.clip();
+    x0 = std::max<int32_t>(x0, clip.x0);
+    y0 = std::max<int32_t>(y0, clip.y0);
+    x1 = std::min<int32_t>(x1, clip.x1);
+    y1 = std::min<int32_t>(y1, clip.y1);
+
+    if (!g_lcdReady || g_lcd == nullptr || x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    if (!Background::active()) {
+        g_lcd->fillRect(static_cast<int16_t>(x0), static_cast<int16_t>(y0), static_cast<int16_t>(x1 - x0),
+                        static_cast<int16_t>(y1 - y0), color);
+        return;
+    }
+
+    const uint32_t startUs = micros();
+    const BackgroundInfo layer = Background::info();
+    const int32_t imageX1 = std::min<int32_t>(x1, layer.width);
+    const int32_t imageY1 = std::min<int32_t>(y1, layer.height);
+
+    for (int32_t row = y0 / layer.tileSize; row * layer.tileSize < imageY1; ++row) {
+        for (int32_t column = x0 / layer.tileSize; column * layer.tileSize < imageX1; ++column) {
+            const BackgroundTile tile = Background::tile(static_cast<uint16_t>(column), static_cast<uint16_t>(row));
+            const int32_t left = std::max<int32_t>(x0, tile.x);
+            const int32_t top = std::max<int32_t>(y0, tile.y);
+            const int32_t right = std::min<int32_t>(imageX1, tile.x + tile.w);
+            const int32_t bottom = std::min<int32_t>(imageY1, tile.y + tile.h);
+
+            if (tile.pixels == nullptr) {
+                g_lcd->fillRect(static_cast<int16_t>(left), static_cast<int16_t>(top),
+                                static_cast<int16_t>(right - left), static_cast<int16_t>(bottom - top), color);
+                continue;
+            }
+            lcdWritePixels(left, top, static_cast<uint32_t>(right - left), static_cast<uint32_t>(bottom - top),
+                           tile.pixels + (top - tile.y) * tile.w + (left - tile.x), static_cast<uint32_t>(tile.w));
+        }
+    }
+
+    if (x1 > imageX1) {
+        const int32_t left = std::max<int32_t>(x0, imageX1);
+        g_lcd->fillRect(static_cast<int16_t>(left), static_cast<int16_t>(y0), static_cast<int16_t>(x1 - left),
+                        static_cast<int16_t>(y1 - y0), color);
+    }
+    if (y1 > imageY1 && imageX1 > x0) {
+        const int32_t top = std::max<int32_t>(y0, imageY1);
+        g_lcd->fillRect(static_cast<int16_t>(x0), static_cast<int16_t>(top), static_cast<int16_t>(imageX1 - x0),
+                        static_cast<int16_t>(y1 - top), color);
+    }
+
+    Background::recordRestore(micros() - startUs);
+}
+
+static inline auto safeFillBackground(int16_t xPos, int16_t yPos, int16_t width, int16_t height, uint16_t color)
+    -> void {
+    if (width > 0 && height > 0) {
+        lcdFillBackground(xPos, yPos, static_cast<int32_t>(xPos) + width, static_cast<int32_t>(yPos) + height, color);
+    }
+}
+
 auto DisplayManager::getStatusBarRect() -> UiRect {
     const int16_t width = DisplayManager::screenWidth();
     const int16_t height = DisplayManager::screenHeight();
@@ -175,7 +300,7 @@ static void drawWifiIcon(int16_t xRight, int16_t yTop, bool connected, int8_t ba
     const int16_t iconW = 14;
     const int16_t iconH = 10;
     const auto xLeft = static_cast<int16_t>(xRight - iconW);
-    safeFillRect(xLeft, yTop, iconW, iconH, bgColor);
+    safeFillBackground(xLeft, yTop, iconW, iconH, bgColor);
 
     const auto barsClamped = static_cast<int8_t>(clampI16(bars, 0, 4));
     const uint16_t colorOn = fgColor;  // disconnected indicated via outline
@@ -201,7 +326,7 @@ static void drawBatteryIcon(int16_t xRight, int16_t yTop, int8_t pct, bool charg
     const int16_t iconW = 20;
     const int16_t iconH = 10;
     const auto xLeft = static_cast<int16_t>(xRight - iconW);
-    safeFillRect(xLeft, yTop, iconW, iconH, bgColor);
+    safeFillBackground(xLeft, yTop, iconW, iconH, bgColor);
 
     const int16_t bodyW = 16;
     const int16_t bodyH = 10;
@@ -232,20 +357,87 @@ static void drawBatteryIcon(int16_t xRight, int16_t yTop, int8_t pct, bool charg
     }
 }
 
+/**
+ * @brief Display wiring and bus settings used during initialization
+ */
+struct LcdParams {
+    int8_t dcGpio;
+    int8_t csGpio;
+    int8_t rstGpio;
+    int8_t backlightGpio;
+    bool csActiveHigh;
+    bool backlightActiveLow;
+    uint32_t spiHz;
+    uint8_t spiMode;
+    int16_t width;
+    int16_t height;
+};
+
+/**
+ * @brief Build the display parameters of a compile-time board profile
+ *
+ * @return The profile parameters
+ */
+template <typename Profile>
+static constexpr auto lcdProfileParams() -> LcdParams {
+    return LcdParams{Profile::DC_GPIO,
+                     Profile::CS_GPIO,
+                     Profile::RST_GPIO,
+                     Profile::BACKLIGHT_GPIO,
+                     Profile::CS_ACTIVE_HIGH,
+                     Profile::BACKLIGHT_ACTIVE_LOW,
+                     Profile::SPI_HZ,
+                     Profile::SPI_MODE,
+                     Profile::WIDTH,
+                     Profile::HEIGHT};
+}
+
+/**
+ * @brief Build the display parameters from the runtime configuration (unknown boards)
+ *
+ * @return The configured parameters
+ */
+static auto lcdConfigParams() -> LcdParams {
+    return LcdParams{configManager.getLCDDcGpioSafe(),
+                     configManager.getLCDCsGpioSafe(),
+                     configManager.getLCDRstGpioSafe(),
+                     configManager.getLCDBacklightGpioSafe(),
+                     configManager.getLCDCsActiveHighSafe(),
+                     configManager.getLCDBacklightActiveLowSafe(),
+                     configManager.getLCDSpiHzSafe(),
+                     configManager.getLCDSpiModeSafe(),
+                     configManager.getLCDWidthSafe(),
+                     configManager.getLCDHeightSafe()};
+}
+
+/**
+ * @brief Create the display bus for a compile-time board profile
+ *
+ * @return The bus, owned by the caller and released through g_lcdBusDelete
+ */
+template <typename Profile>
+static auto lcdCreateProfileBus() -> Arduino_DataBus* {
+    g_lcdBusDelete = [](Arduino_DataBus* bus) { delete static_cast<ProfileSPIBus<Profile>*>(bus); };
+
+    return new ProfileSPIBus<Profile>();
+}
+
 /**
  * @brief Turn the LCD backlight on
  *
+ * @param params The display parameters
+ *
  * @return void
  */
-static inline void lcdBacklightOn() {
-    int8_t gpio = configManager.getLCDBacklightGpioSafe();
+static inline void lcdBacklightOn(const LcdParams& params) {
+    int8_t gpio = params.backlightGpio;
     if (gpio < 0) {
         Logger::warn("No backlight GPIO defined", "DisplayManager");
         return;
     }
 
     pinMode((uint8_t)gpio, OUTPUT);
-    digitalWrite((uint8_t)gpio, configManager.getLCDBacklightActiveLowSafe() ? LOW : HIGH);
+    digitalWrite((uint8_t)gpio, params.backlightActiveLow ? LOW : HIGH);
 }
 
 /**
@@ -301,9 +493,11 @@ static inline void ST7789_WriteData(uint8_t data) {
  *
  *  - Full window setup and RAMWR command (0x2A, 0x2B, 0x2C)
  *
+ * @param madctl The MADCTL value of the display transform
+ *
  * @return void
  */
-static void lcdRunVendorInit() {
+static void lcdRunVendorInit(uint8_t madctl) {
     if (g_lcdBus == nullptr) {
         Logger::error("No data bus for LCD", "DisplayManager");
 
@@ -329,7 +523,7 @@ static void lcdRunVendorInit() {
     yield();
 
     ST7789_WriteCommand(ST7789_MEMORY_ACCESS_CONTROL);
-    ST7789_WriteData(ST7789_MADCTL_PARAM_DEFAULT);
+    ST7789_WriteData(madctl);
     yield();
 
     ST7789_WriteCommand(ST7789_COLORMODE);
@@ -426,10 +620,12 @@ static void lcdRunVendorInit() {
  *
  * Toggles the RST GPIO if defined, with appropriate delays
  *
+ * @param params The display parameters
+ *
  * @return void
  */
-static void lcdHardReset() {
-    int8_t rst_gpio = configManager.getLCDRstGpioSafe();
+static void lcdHardReset(const LcdParams& params) {
+    int8_t rst_gpio = params.rstGpio;
     if (rst_gpio < 0) {
         Logger::warn("No reset GPIO defined", "DisplayManager");
         return;
@@ -444,6 +640,68 @@ static void lcdHardReset() {
     delay(LCD_HARDWARE_RESET_DELAY_MS);
 }
 
+/**
+ * @brief Push the viewport clip to the panel so that the rasterizer trims against it
+ *
+ * @return void
+ */
+static void lcdApplyClip() {
+    if (g_lcd == nullptr) {
+        return;
+    }
+
+    if (s_viewport.isClipped()) {
+        g_lcd->setClip(s_viewport.clip());
+    } else {
+        g_lcd->clearClip();
+    }
+}
+
+/**
+ * @brief Check that the display is ready and a translated bounding box is (at least partly) inside the clip
+ *
+ * @param x0 Left edge after translation
+ * @param y0 Top edge after translation
+ * @param x1 Right edge (exclusive) after translation
+ * @param y1 Bottom edge (exclusive) after translation
+ * @return true if the primitive has to be rasterized
+ */
+static auto lcdCanDraw(int32_t x0, int32_t y0, int32_t x1, int32_t y1) -> bool {
+    return g_lcdReady && g_lcd != nullptr && s_viewport.isVisible(x0, y0, x1, y1);
+}
+
+/**
+ * @brief Check a translated rect the way Arduino_GFX reads it (a negative size extends left/up)
+ */
+static auto lcdCanDrawRect(int32_t posX, int32_t posY, int32_t width, int32_t height) -> bool {
+    if (width < 0) {
+        posX += width + 1;
+        width = -width;
+    }
+    if (height < 0) {
+        posY += height + 1;
+        height = -height;
+    }
+
+    return lcdCanDraw(posX, posY, posX + width, posY + height);
+}
+
+/**
+ * @brief Resolve the configured display transform
+ *
+ * An explicit lcd_rotate/lcd_mirror_x/lcd_mirror_y setting wins, otherwise the legacy lcd_rotation is mapped
+ *
+ * @return The display transform
+ */
+static auto lcdConfigTransform() -> DisplayTransform {
+    if (configManager.hasLCDTransform()) {
+        return DisplayTransform{configManager.getLCDMirrorX(), configManager.getLCDMirrorY(),
+                                configManager.getLCDRotate()};
+    }
+
+    return transformFromRotation(configManager.getLCDRotationSafe());
+}
+
 /**
  * @brief Ensure the LCD is initialized and ready for drawing
  *
@@ -461,43 +719,66 @@ static void lcdEnsureInit() {
 
     Logger::info("Initialization started", "DisplayManager");
 
-    lcdBacklightOn();
-    lcdHardReset();
+    const BoardId board = boardFromName(configManager.getBoard());
+    LcdParams params{};
+
+    switch (board) {
+        case BoardId::HelloCubicLite:
+            params = lcdProfileParams<HelloCubicLiteProfile>();
+            break;
+        case BoardId::SmallTvUltra:
+            params = lcdProfileParams<SmallTvUltraProfile>();
+            break;
+        default:
+            params = lcdConfigParams();
+            break;
+    }
+
+    lcdBacklightOn(params);
+    lcdHardReset(params);
 
     if (g_lcd != nullptr) {
-        delete static_cast<Arduino_ST7789*>(g_lcd);
+        delete g_lcd;
         g_lcd = nullptr;
     }
-    if (g_lcdBus != nullptr) {
-        delete static_cast<GeekMagicSPIBus*>(g_lcdBus);
+    if (g_lcdBus != nullptr && g_lcdBusDelete != nullptr) {
+        g_lcdBusDelete(g_lcdBus);
         g_lcdBus = nullptr;
     }
 
-    SPI.begin();
+    const DisplayTransform transform = lcdConfigTransform();
 
-    int8_t dc_gpio = configManager.getLCDDcGpioSafe();
-    int8_t cs_gpio = configManager.getLCDCsGpioSafe();
-    bool cs_active_high = configManager.getLCDCsActiveHighSafe();
-    uint32_t spi_hz = configManager.getLCDSpiHzSafe();
-    uint8_t spi_mode = configManager.getLCDSpiModeSafe();
-    uint8_t rotation = configManager.getLCDRotationSafe();
-    int16_t lcd_w = configManager.getLCDWidthSafe();
-    int16_t lcd_h = configManager.getLCDHeightSafe();
+    switch (board) {
+        case BoardId::HelloCubicLite:
+            g_lcdBus = lcdCreateProfileBus<HelloCubicLiteProfile>();
+            Logger::info("Using compile-time profile hellocubic-lite", "DisplayManager");
+            break;
+        case BoardId::SmallTvUltra:
+            g_lcdBus = lcdCreateProfileBus<SmallTvUltraProfile>();
+            Logger::info("Using compile-time profile smalltv-ultra", "DisplayManager");
+            break;
+        default:
+            SPI.begin();
+            g_lcdBus = new GeekMagicSPIBus(params.dcGpio, params.csGpio, params.csActiveHigh, (int32_t)params.spiHz,
+                                           (int8_t)params.spiMode);
+            g_lcdBusDelete = [](Arduino_DataBus* bus) { delete static_cast<GeekMagicSPIBus*>(bus); };
+            break;
+    }
 
-    g_lcdBus = new GeekMagicSPIBus(dc_gpio, cs_gpio, cs_active_high, (int32_t)spi_hz, (int8_t)spi_mode);
-    g_lcd = new Arduino_ST7789(g_lcdBus, -1, rotation, true, lcd_w, lcd_h);
+    g_lcd = new GeekMagicST7789(g_lcdBus, params.width, params.height, transform);
 
-    g_lcdBus->begin((int32_t)spi_hz, (int8_t)spi_mode);
+    g_lcdBus->begin((int32_t)params.spiHz, (int8_t)params.spiMode);
 
     g_lcd->begin();
     delay(LCD_BEGIN_DELAY_MS);
 
-    lcdHardReset();
-    g_lcdBus->begin((int32_t)spi_hz, (int8_t)spi_mode);
+    lcdHardReset(params);
+    g_lcdBus->begin((int32_t)params.spiHz, (int8_t)params.spiMode);
 
-    lcdRunVendorInit();
+    lcdRunVendorInit(g_lcd->madctl());
 
-    g_lcd->setRotation(rotation);
+    g_lcd->setTransform(transform);
+    s_viewport.reset(static_cast<int16_t>(g_lcd->width()), static_cast<int16_t>(g_lcd->height()));
 
     g_lcdReady = true;
     g_lcdInitializing = false;
@@ -695,12 +976,16 @@ static void lcdDrawTextWrapped(int16_t startX, int16_t startY, const String& tex
 
     if (clearBg) {
         const auto heightPixels = static_cast<int16_t>(static_cast<int>(lines.size()) * static_cast<int>(charH));
-        g_lcd->fillRect(startX, startY, static_cast<int16_t>(screenW - startX), static_cast<int16_t>(heightPixels),
-                        bgColor);
+        lcdFillBackground(startX, startY, screenW, startY + heightPixels, bgColor);
     }
 
     g_lcd->setTextSize(textSize);
-    g_lcd->setTextColor(fgColor, bgColor);
+    if (Background::active()) {
+        // Glyph cells would cover the background layer with bgColor, draw the glyphs alone
+        g_lcd->setTextColor(fgColor);
+    } else {
+        g_lcd->setTextColor(fgColor, bgColor);
+    }
     for (size_t li = 0; li < lines.size(); ++li) {
         g_lcd->setCursor(startX, static_cast<int16_t>(startY + static_cast<int>(li) * static_cast<int>(charH)));
         g_lcd->print(lines[li]);
@@ -714,7 +999,15 @@ static void lcdDrawTextWrapped(int16_t startX, int16_t startY, const String& tex
  *
  * @return void
  */
-auto DisplayManager::begin() -> void { lcdEnsureInit(); }
+auto DisplayManager::begin() -> void {
+    lcdEnsureInit();
+
+    if (LittleFS.exists(BACKGROUND_PATH) && !Background::load(BACKGROUND_PATH)) {
+        Logger::warn("Stored background layer could not be loaded", "DisplayManager");
+    }
+
+    Macro::loadIndex();
+}
 
 /**
  * @brief Check if the display is ready for drawing
@@ -784,7 +1077,62 @@ auto DisplayManager::drawStartup(String currentIP) -> void {
  */
 void DisplayManager::drawTextWrapped(int16_t xPos, int16_t yPos, const String& text, uint8_t textSize, uint16_t fgColor,
                                      uint16_t bgColor, bool clearBg) {
-    lcdDrawTextWrapped(xPos, yPos, text, textSize, fgColor, bgColor, clearBg);
+    const auto startX = static_cast<int16_t>(xPos + s_viewport.dx());
+    const auto startY = static_cast<int16_t>(yPos + s_viewport.dy());
+
+    // Wrapped text may extend to the bottom-right corner of the screen
+    if (!lcdCanDraw(std::max<int32_t>(startX, 0), std::max<int32_t>(startY, 0), INT16_MAX, INT16_MAX)) {
+        return;
+    }
+
+    lcdDrawTextWrapped(startX, startY, text, textSize, fgColor, bgColor, clearBg);
+}
+
+/**
+ * @brief Draw one line of text in fixed cells, each glyph sent as one block from the glyph cache
+ *
+ * Over a background layer the cells are not filled with bgColor: each one is repainted from the layer and the
+ * glyph drawn over it by Arduino_GFX, as are the sizes the cache does not keep
+ *
+ * @param posX Left edge of the first cell
+ * @param posY Top edge of the cells
+ * @param text Characters to draw, no line breaks
+ * @param count Number of characters
+ * @param textSize Font size multiplier (integer)
+ * @param fgColor Glyph color (16-bit RGB565)
+ * @param bgColor Cell color (16-bit RGB565)
+ */
+void DisplayManager::drawGlyphs(int16_t posX, int16_t posY, const char* text, size_t count, uint8_t textSize,
+                                uint16_t fgColor, uint16_t bgColor) {
+    const auto cellW = static_cast<int16_t>(GLYPH_CELL_WIDTH * textSize);
+    const auto cellH = static_cast<int16_t>(GLYPH_CELL_HEIGHT * textSize);
+    const int32_t left = static_cast<int32_t>(posX) + s_viewport.dx();
+    const int32_t top = static_cast<int32_t>(posY) + s_viewport.dy();
+
+    if (text == nullptr || count == 0 || textSize == 0 ||
+        !lcdCanDraw(left, top, left + static_cast<int32_t>(count) * cellW, top + cellH)) {
+        return;
+    }
+
+    const bool overLayer = Background::active();
+    g_lcd->setTextSize(textSize);
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto cellX = static_cast<int16_t>(posX + static_cast<int32_t>(i) * cellW);
+        const uint16_t* cell = overLayer ? nullptr : GlyphCache::glyph(text[i], textSize, fgColor, bgColor);
+
+        if (cell != nullptr) {
+            blitPanel(cellX, posY, cellW, cellH, cell, cellW);
+            continue;
+        }
+
+        if (overLayer) {
+            fillBackground(cellX, posY, cellW, cellH, bgColor);
+        }
+        // A background equal to the glyph color makes Arduino_GFX leave the cell as it is
+        g_lcd->drawChar(static_cast<int16_t>(cellX + s_viewport.dx()), static_cast<int16_t>(top), text[i], fgColor,
+                        overLayer ? fgColor : bgColor);
+    }
 }
 
 /**
@@ -803,7 +1151,7 @@ void DisplayManager::drawLoadingBar(float progress, int yPos, int barWidth, int
         return;
     }
 
-    auto barXPos = (static_cast<int32_t>(configManager.getLCDWidthSafe()) - static_cast<int32_t>(barWidth)) / 2;
+    auto barXPos = (static_cast<int32_t>(DisplayManager::screenWidth()) - static_cast<int32_t>(barWidth)) / 2;
     auto barXPos16 = static_cast<int16_t>(barXPos);
     auto yPos16 = static_cast<int16_t>(yPos);
     auto barWidth16 = static_cast<int16_t>(barWidth);
@@ -833,7 +1181,7 @@ auto DisplayManager::drawStatusBar(const String& leftText, const String& rightTe
     }
 
     if (clearBg) {
-        safeFillRect(bar.x, bar.y, bar.w, bar.h, bgColor);
+        safeFillBackground(bar.x, bar.y, bar.w, bar.h, bgColor);
     }
 
     // Optional subtle separator
@@ -979,7 +1327,7 @@ auto DisplayManager::drawTrackerBar(int16_t waterCount, int16_t tomatoCount, int
     }
 
     if (clearBg) {
-        safeFillRect(bar.x, bar.y, bar.w, bar.h, bgColor);
+        safeFillBackground(bar.x, bar.y, bar.w, bar.h, bgColor);
     }
     safeFillRect(bar.x, static_cast<int16_t>(bar.y + bar.h - 1), bar.w, 1, UI_SEPARATOR_COLOR);
 
@@ -1072,7 +1420,7 @@ auto DisplayManager::drawBodyText(const String& text, uint8_t textSize, uint16_t
     const auto xPos = static_cast<int16_t>(body.x + UI_PADDING);
     const auto yPos = static_cast<int16_t>(body.y + UI_PADDING);
     if (clearBg) {
-        safeFillRect(body.x, body.y, body.w, body.h, bgColor);
+        safeFillBackground(body.x, body.y, body.w, body.h, bgColor);
     }
 
     DisplayManager::drawTextWrapped(xPos, yPos, text, textSize, fgColor, bgColor, false);
@@ -1082,20 +1430,38 @@ auto DisplayManager::drawBodyText(const String& text, uint8_t textSize, uint16_t
 /**
  * @brief Play a single GIF file in full screen mode (blocking)
  *
+ * A running effect is stopped. Without a transition the screen is cleared first. With one, the first frame is decoded right away and paced by
+ * the transition, the next frames follow from update()
+ *
  * @param path Path to the GIF file on LittleFS
  * @param timeMs Duration to play the GIF in milliseconds (0 = play full GIF)
+ * @param transition How the current content makes way for the GIF
  * @return true if played successfully, false on error
  */
-auto DisplayManager::playGifFullScreen(const String& path, uint32_t timeMs) -> bool {
+auto DisplayManager::playGifFullScreen(const String& path, uint32_t timeMs, const TransitionSpec& transition)
+    -> bool {
     if (!s_gif.begin()) {
         return false;
     }
+    Effects::stop();
+    Template::hide();
+    Script::stop();
 
-    DisplayManager::clearScreen();
+    if (transition.effect == TransitionEffect::None) {
+        DisplayManager::clearScreen();
+    } else {
+        beginTransition(transition);
+    }
 
     s_gif.setLoopEnabled(timeMs == 0);
 
     const bool started = s_gif.playOne(path);
+    if (Transition::active()) {
+        if (started) {
+            s_gif.update();
+        }
+        endTransition();
+    }
     if (!started) {
         return false;
     }
@@ -1126,6 +1492,28 @@ auto DisplayManager::playGifFullScreen(const String& path, uint32_t timeMs) -> b
     return true;
 }
 
+/**
+ * @brief Loop a GIF in full screen on the sync clock, in step with the devices given the same start
+ *
+ * @param path Path to the GIF file on LittleFS
+ * @param startUs Sync time (see TimeSync::now()) to show startFrame at
+ * @param startFrame Index of the frame to show at startUs
+ * @return true if playback started, false on error
+ */
+auto DisplayManager::playGifAt(const String& path, uint64_t startUs, uint16_t startFrame) -> bool {
+    if (!s_gif.begin()) {
+        return false;
+    }
+    Effects::stop();
+    Template::hide();
+    Script::stop();
+    DisplayManager::clearScreen();
+
+    s_gif.setLoopEnabled(true);
+
+    return s_gif.playAt(path, startUs, startFrame);
+}
+
 /**
  * @brief Stop GIF playback if playing
  *
@@ -1139,35 +1527,309 @@ auto DisplayManager::stopGif() -> bool {
     return true;
 }
 
-auto DisplayManager::update() -> void { s_gif.update(); }
+/**
+ * @brief Stop GIF playback and wait for the current frame to end, keeping the screen content
+ *
+ * Used before drawing images, which a playing GIF would otherwise paint over
+ */
+auto DisplayManager::stopGifPlayback() -> void {
+    s_gif.stop();
+    while (s_gif.isPlaying()) {
+        s_gif.update();
+        yield();
+    }
+}
+
+/**
+ * @brief Get the per-frame cost of the GIF currently (or last) played
+ *
+ * @return The GIF frame statistics
+ */
+auto DisplayManager::gifFrameStats() -> GifFrameStats { return s_gif.frameStats(); }
+
+/**
+ * @brief Get the frame deadlines met by the GIF played with playGifAt()
+ *
+ * @return The GIF sync statistics
+ */
+auto DisplayManager::gifSyncStats() -> GifSyncStats { return s_gif.syncStats(); }
+
+/**
+ * @brief Decode a JPEG file from LittleFS onto the screen
+ *
+ * A playing GIF or a running effect is stopped first, otherwise its next frame would paint over the image
+ *
+ * @param path Path to the JPEG file on LittleFS
+ * @param posX Left edge of the image
+ * @param posY Top edge of the image
+ * @param scale IDCT scale divisor (1, 2, 4, 8) or JPEG_SCALE_FIT
+ * @param transition How the current content makes way for the image, None draws it over the screen as it is
+ * @return The decode result, with its timing (transition pacing included)
+ */
+auto DisplayManager::drawJpeg(const String& path, int16_t posX, int16_t posY, uint8_t scale,
+                              const TransitionSpec& transition) -> JpegResult {
+    stopGifPlayback();
+    Effects::stop();
+    Template::hide();
+    Script::stop();
+
+    beginTransition(transition);
+    const JpegResult result = Jpeg::drawFile(path, posX, posY, scale);
+    endTransition();
+
+    return result;
+}
+
+/**
+ * @brief Get the decode cost of the JPEG images drawn so far
+ *
+ * @return The JPEG statistics
+ */
+auto DisplayManager::jpegStats() -> JpegStats { return Jpeg::stats(); }
+
+/**
+ * @brief Decode a QOI or R565 file from LittleFS onto the screen
+ *
+ * A playing GIF or a running effect is stopped first
+ * @param path Path to the image file on LittleFS
+ * @param posX Left edge of the image
+ * @param posY Top edge of the image
+ * @param transition How the current content makes way for the image, None draws it over the screen as it is
+ * @return The decode result, with its timing (transition pacing included)
+ */
+auto DisplayManager::drawStill(const String& path, int16_t posX, int16_t posY, const TransitionSpec& transition)
+    -> StillResult {
+    stopGifPlayback();
+    Effects::stop();
+    Template::hide();
+    Script::stop();
+
+    beginTransition(transition);
+    const StillResult result = Still::drawFile(path, posX, posY);
+    endTransition();
+
+    return result;
+}
+
+auto DisplayManager::update() -> void {
+    s_gif.update();
+    Animation::update(millis());
+    Effects::update(millis());
+}
+
+/**
+ * @brief Change the display orientation at runtime
+ *
+ * The transform is applied through MADCTL, so everything drawn afterwards follows it at no per-pixel cost. The
+ * screen is cleared because the frame memory content keeps its old orientation
+ *
+ * @param transform The new transform
+ * @return true if applied, false if the display is not ready
+ */
+auto DisplayManager::setTransform(const DisplayTransform& transform) -> bool {
+    if (!g_lcdReady || g_lcd == nullptr) {
+        return false;
+    }
+
+    g_lcd->setTransform(transform);
+    s_viewport.reset(static_cast<int16_t>(g_lcd->width()), static_cast<int16_t>(g_lcd->height()));
+    lcdApplyClip();
+    g_lcd->fillScreen(LCD_BLACK);
+
+    return true;
+}
+
+/**
+ * @brief Get the current display orientation
+ *
+ * @return The active transform, or the configured one when the display is not initialized
+ */
+auto DisplayManager::getTransform() -> DisplayTransform {
+    if (g_lcd != nullptr) {
+        return g_lcd->getTransform();
+    }
+
+    return lcdConfigTransform();
+}
 
 /**
- * @brief Clear the entire display to black
+ * @brief Clear the entire display to black, or to the background layer when one is loaded
  *
  * @return void
  */
 auto DisplayManager::clearScreen() -> void {
     if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->fillScreen(LCD_BLACK);
+        if (Background::active()) {
+            lcdFillBackground(0, 0, g_lcd->width(), g_lcd->height(), LCD_BLACK);
+        } else {
+            g_lcd->fillScreen(LCD_BLACK);
+        }
+        s_backdrop = LCD_BLACK;
+    }
+}
+
+/**
+ * @brief Start a transition from the current content to whatever is drawn until endTransition()
+ *
+ * The viewport is reset, the new content is laid out in screen coordinates. The effect None does nothing, the
+ * caller decides whether the screen is cleared
+ *
+ * @param spec Effect, easing, background color and duration
+ */
+auto DisplayManager::beginTransition(const TransitionSpec& spec) -> void {
+    if (!g_lcdReady || g_lcd == nullptr || spec.effect == TransitionEffect::None) {
+        return;
     }
+
+    resetViewport();
+    s_backdrop = spec.color;
+    Transition::begin(g_lcd, spec);
+}
+
+/**
+ * @brief Finish the running transition, if any
+ */
+auto DisplayManager::endTransition() -> void { Transition::end(); }
+
+/**
+ * @brief Get the frame timing of the transitions
+ *
+ * @return The transition statistics
+ */
+auto DisplayManager::transitionStats() -> TransitionStats { return Transition::stats(); }
+
+/**
+ * @brief Narrow the clip rect for the following primitives (coordinates are translated)
+ *
+ * @param posX Left edge
+ * @param posY Top edge
+ * @param width Width in pixels
+ * @param height Height in pixels
+ */
+auto DisplayManager::pushClip(int16_t posX, int16_t posY, int16_t width, int16_t height) -> void {
+    s_viewport.pushClip(posX, posY, width, height);
+    lcdApplyClip();
+}
+
+/**
+ * @brief Restore the clip rect and translation saved by the matching pushClip()
+ */
+auto DisplayManager::popClip() -> void {
+    s_viewport.popClip();
+    lcdApplyClip();
+}
+
+/**
+ * @brief Move the origin of the following primitives
+ *
+ * @param deltaX Horizontal offset in pixels
+ * @param deltaY Vertical offset in pixels
+ */
+auto DisplayManager::translate(int16_t deltaX, int16_t deltaY) -> void { s_viewport.translate(deltaX, deltaY); }
+
+/**
+ * @brief Drop every clip rect and translation
+ */
+auto DisplayManager::resetViewport() -> void {
+    s_viewport.reset(DisplayManager::screenWidth(), DisplayManager::screenHeight());
+    lcdApplyClip();
 }
 
 /**
- * @brief Fill the entire screen with a color
+ * @brief Fill the entire screen (the clip rect when one is pushed) with a color
  * @param color 16-bit RGB565 color
  */
 auto DisplayManager::fillScreen(uint16_t color) -> void {
     if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->fillScreen(color);
+        const ClipRect& clip = s_viewport.clip();
+        g_lcd->fillRect(clip.x0, clip.y0, static_cast<int16_t>(clip.x1 - clip.x0),
+                        static_cast<int16_t>(clip.y1 - clip.y0), color);
+
+        if (!s_viewport.isClipped()) {
+            s_backdrop = color;
+        }
     }
 }
 
+/**
+ * @brief Use a tiled R5TL image as the background layer and paint it on the whole screen
+ *
+ * Clears and erases (clearToBackground(), fillBackground(), text and UI helper backgrounds) then repaint from it
+ *
+ * @param path Path of the R5TL file on LittleFS
+ * @return true if the layer was loaded
+ */
+auto DisplayManager::setBackground(const String& path) -> bool {
+    if (!Background::load(path)) {
+        return false;
+    }
+
+    if (g_lcdReady && g_lcd != nullptr) {
+        lcdFillBackground(0, 0, g_lcd->width(), g_lcd->height(), s_backdrop);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Drop the background layer, clears and erases go back to flat colors
+ */
+auto DisplayManager::clearBackground() -> void { Background::unload(); }
+
+/**
+ * @brief Whether a background layer is loaded
+ */
+auto DisplayManager::hasBackground() -> bool { return Background::active(); }
+
+/**
+ * @brief Repaint a rectangle from the background layer, or fill it with a color when there is none
+ *
+ * @param posX Left edge (translated and clipped like fillRect())
+ * @param posY Top edge
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param color Fill color without a background layer
+ */
+auto DisplayManager::fillBackground(int16_t posX, int16_t posY, int16_t width, int16_t height, uint16_t color)
+    -> void {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    const int32_t left = static_cast<int32_t>(posX) + s_viewport.dx();
+    const int32_t top = static_cast<int32_t>(posY) + s_viewport.dy();
+    lcdFillBackground(left, top, left + width, top + height, color);
+}
+
+/**
+ * @brief Clear the screen (the clip rect when one is pushed) to the background layer, or to a color without one
+ *
+ * @param color Fill color without a background layer
+ */
+auto DisplayManager::clearToBackground(uint16_t color) -> void {
+    if (!Background::active()) {
+        DisplayManager::fillScreen(color);
+        return;
+    }
+
+    const ClipRect& clip = s_viewport.clip();
+    lcdFillBackground(clip.x0, clip.y0, clip.x1, clip.y1, color);
+}
+
+/**
+ * @brief Background repaints, tiles read from flash and tile cache hits
+ */
+auto DisplayManager::backgroundStats() -> BackgroundStats { return Background::stats(); }
+
 /**
  * @brief Draw a single pixel
  */
 auto DisplayManager::drawPixel(int16_t posX, int16_t posY, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->drawPixel(posX, posY, color);
+    const int32_t pixX = posX + s_viewport.dx();
+    const int32_t pixY = posY + s_viewport.dy();
+
+    if (lcdCanDraw(pixX, pixY, pixX + 1, pixY + 1)) {
+        g_lcd->drawPixel(static_cast<int16_t>(pixX), static_cast<int16_t>(pixY), color);
     }
 }
 
@@ -1175,8 +1837,13 @@ auto DisplayManager::drawPixel(int16_t posX, int16_t posY, uint16_t color) -> vo
  * @brief Draw a line between two points
  */
 auto DisplayManager::drawLine(int16_t startX, int16_t startY, int16_t endX, int16_t endY, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->drawLine(startX, startY, endX, endY, color);
+    const auto x0 = static_cast<int16_t>(startX + s_viewport.dx());
+    const auto y0 = static_cast<int16_t>(startY + s_viewport.dy());
+    const auto x1 = static_cast<int16_t>(endX + s_viewport.dx());
+    const auto y1 = static_cast<int16_t>(endY + s_viewport.dy());
+
+    if (lcdCanDraw(std::min(x0, x1), std::min(y0, y1), std::max(x0, x1) + 1, std::max(y0, y1) + 1)) {
+        g_lcd->drawLine(x0, y0, x1, y1, color);
     }
 }
 
@@ -1184,17 +1851,36 @@ auto DisplayManager::drawLine(int16_t startX, int16_t startY, int16_t endX, int1
  * @brief Draw a rectangle outline
  */
 auto DisplayManager::drawRect(int16_t posX, int16_t posY, int16_t width, int16_t height, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->drawRect(posX, posY, width, height, color);
+    const auto rectX = static_cast<int16_t>(posX + s_viewport.dx());
+    const auto rectY = static_cast<int16_t>(posY + s_viewport.dy());
+
+    if (lcdCanDrawRect(rectX, rectY, width, height)) {
+        g_lcd->drawRect(rectX, rectY, width, height, color);
     }
 }
 
 /**
- * @brief Draw a filled rectangle
+ * @brief Draw a filled rectangle, trimmed to the clip rect before it reaches the rasterizer
  */
 auto DisplayManager::fillRect(int16_t posX, int16_t posY, int16_t width, int16_t height, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->fillRect(posX, posY, width, height, color);
+    if (width < 0) {
+        posX = static_cast<int16_t>(posX + width + 1);
+        width = static_cast<int16_t>(-width);
+    }
+    if (height < 0) {
+        posY = static_cast<int16_t>(posY + height + 1);
+        height = static_cast<int16_t>(-height);
+    }
+
+    const ClipRect& clip = s_viewport.clip();
+    const int32_t x0 = std::max<int32_t>(posX + s_viewport.dx(), clip.x0);
+    const int32_t y0 = std::max<int32_t>(posY + s_viewport.dy(), clip.y0);
+    const int32_t x1 = std::min<int32_t>(static_cast<int32_t>(posX) + s_viewport.dx() + width, clip.x1);
+    const int32_t y1 = std::min<int32_t>(static_cast<int32_t>(posY) + s_viewport.dy() + height, clip.y1);
+
+    if (lcdCanDraw(x0, y0, x1, y1)) {
+        g_lcd->fillRect(static_cast<int16_t>(x0), static_cast<int16_t>(y0), static_cast<int16_t>(x1 - x0),
+                        static_cast<int16_t>(y1 - y0), color);
     }
 }
 
@@ -1202,8 +1888,11 @@ auto DisplayManager::fillRect(int16_t posX, int16_t posY, int16_t width, int16_t
  * @brief Draw a circle outline
  */
 auto DisplayManager::drawCircle(int16_t posX, int16_t posY, int16_t radius, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->drawCircle(posX, posY, radius, color);
+    const auto centerX = static_cast<int16_t>(posX + s_viewport.dx());
+    const auto centerY = static_cast<int16_t>(posY + s_viewport.dy());
+
+    if (lcdCanDraw(centerX - radius, centerY - radius, centerX + radius + 1, centerY + radius + 1)) {
+        g_lcd->drawCircle(centerX, centerY, radius, color);
     }
 }
 
@@ -1211,18 +1900,39 @@ auto DisplayManager::drawCircle(int16_t posX, int16_t posY, int16_t radius, uint
  * @brief Draw a filled circle
  */
 auto DisplayManager::fillCircle(int16_t posX, int16_t posY, int16_t radius, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->fillCircle(posX, posY, radius, color);
+    const auto centerX = static_cast<int16_t>(posX + s_viewport.dx());
+    const auto centerY = static_cast<int16_t>(posY + s_viewport.dy());
+
+    if (lcdCanDraw(centerX - radius, centerY - radius, centerX + radius + 1, centerY + radius + 1)) {
+        g_lcd->fillCircle(centerX, centerY, radius, color);
     }
 }
 
+/**
+ * @brief Bounding box test for a translated triangle
+ */
+static auto lcdCanDrawTriangle(int16_t vertX0, int16_t vertY0, int16_t vertX1, int16_t vertY1, int16_t vertX2,
+                               int16_t vertY2) -> bool {
+    return lcdCanDraw(std::min({vertX0, vertX1, vertX2}), std::min({vertY0, vertY1, vertY2}),
+                      std::max({vertX0, vertX1, vertX2}) + 1, std::max({vertY0, vertY1, vertY2}) + 1);
+}
+
 /**
  * @brief Draw a triangle outline
  */
 auto DisplayManager::drawTriangle(int16_t vertX0, int16_t vertY0, int16_t vertX1, int16_t vertY1, int16_t vertX2, int16_t vertY2,
                                    uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->drawTriangle(vertX0, vertY0, vertX1, vertY1, vertX2, vertY2, color);
+    const int16_t deltaX = s_viewport.dx();
+    const int16_t deltaY = s_viewport.dy();
+    const auto x0 = static_cast<int16_t>(vertX0 + deltaX);
+    const auto y0 = static_cast<int16_t>(vertY0 + deltaY);
+    const auto x1 = static_cast<int16_t>(vertX1 + deltaX);
+    const auto y1 = static_cast<int16_t>(vertY1 + deltaY);
+    const auto x2 = static_cast<int16_t>(vertX2 + deltaX);
+    const auto y2 = static_cast<int16_t>(vertY2 + deltaY);
+
+    if (lcdCanDrawTriangle(x0, y0, x1, y1, x2, y2)) {
+        g_lcd->drawTriangle(x0, y0, x1, y1, x2, y2, color);
     }
 }
 
@@ -1231,8 +1941,17 @@ auto DisplayManager::drawTriangle(int16_t vertX0, int16_t vertY0, int16_t vertX1
  */
 auto DisplayManager::fillTriangle(int16_t vertX0, int16_t vertY0, int16_t vertX1, int16_t vertY1, int16_t vertX2, int16_t vertY2,
                                    uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->fillTriangle(vertX0, vertY0, vertX1, vertY1, vertX2, vertY2, color);
+    const int16_t deltaX = s_viewport.dx();
+    const int16_t deltaY = s_viewport.dy();
+    const auto x0 = static_cast<int16_t>(vertX0 + deltaX);
+    const auto y0 = static_cast<int16_t>(vertY0 + deltaY);
+    const auto x1 = static_cast<int16_t>(vertX1 + deltaX);
+    const auto y1 = static_cast<int16_t>(vertY1 + deltaY);
+    const auto x2 = static_cast<int16_t>(vertX2 + deltaX);
+    const auto y2 = static_cast<int16_t>(vertY2 + deltaY);
+
+    if (lcdCanDrawTriangle(x0, y0, x1, y1, x2, y2)) {
+        g_lcd->fillTriangle(x0, y0, x1, y1, x2, y2, color);
     }
 }
 
@@ -1240,8 +1959,11 @@ auto DisplayManager::fillTriangle(int16_t vertX0, int16_t vertY0, int16_t vertX1
  * @brief Draw an ellipse outline
  */
 auto DisplayManager::drawEllipse(int16_t posX, int16_t posY, int16_t radiusX, int16_t radiusY, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->drawEllipse(posX, posY, radiusX, radiusY, color);
+    const auto centerX = static_cast<int16_t>(posX + s_viewport.dx());
+    const auto centerY = static_cast<int16_t>(posY + s_viewport.dy());
+
+    if (lcdCanDraw(centerX - radiusX, centerY - radiusY, centerX + radiusX + 1, centerY + radiusY + 1)) {
+        g_lcd->drawEllipse(centerX, centerY, radiusX, radiusY, color);
     }
 }
 
@@ -1249,8 +1971,11 @@ auto DisplayManager::drawEllipse(int16_t posX, int16_t posY, int16_t radiusX, in
  * @brief Draw a filled ellipse
  */
 auto DisplayManager::fillEllipse(int16_t posX, int16_t posY, int16_t radiusX, int16_t radiusY, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->fillEllipse(posX, posY, radiusX, radiusY, color);
+    const auto centerX = static_cast<int16_t>(posX + s_viewport.dx());
+    const auto centerY = static_cast<int16_t>(posY + s_viewport.dy());
+
+    if (lcdCanDraw(centerX - radiusX, centerY - radiusY, centerX + radiusX + 1, centerY + radiusY + 1)) {
+        g_lcd->fillEllipse(centerX, centerY, radiusX, radiusY, color);
     }
 }
 
@@ -1258,8 +1983,11 @@ auto DisplayManager::fillEllipse(int16_t posX, int16_t posY, int16_t radiusX, in
  * @brief Draw a rounded rectangle outline
  */
 auto DisplayManager::drawRoundRect(int16_t posX, int16_t posY, int16_t width, int16_t height, int16_t radius, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->drawRoundRect(posX, posY, width, height, radius, color);
+    const auto rectX = static_cast<int16_t>(posX + s_viewport.dx());
+    const auto rectY = static_cast<int16_t>(posY + s_viewport.dy());
+
+    if (lcdCanDrawRect(rectX, rectY, width, height)) {
+        g_lcd->drawRoundRect(rectX, rectY, width, height, radius, color);
     }
 }
 
@@ -1267,43 +1995,230 @@ auto DisplayManager::drawRoundRect(int16_t posX, int16_t posY, int16_t width, in
  * @brief Draw a filled rounded rectangle
  */
 auto DisplayManager::fillRoundRect(int16_t posX, int16_t posY, int16_t width, int16_t height, int16_t radius, uint16_t color) -> void {
-    if (g_lcdReady && g_lcd != nullptr) {
-        g_lcd->fillRoundRect(posX, posY, width, height, radius, color);
+    const auto rectX = static_cast<int16_t>(posX + s_viewport.dx());
+    const auto rectY = static_cast<int16_t>(posY + s_viewport.dy());
+
+    if (lcdCanDrawRect(rectX, rectY, width, height)) {
+        g_lcd->fillRoundRect(rectX, rectY, width, height, radius, color);
     }
 }
 
-// RGB565 conversion constants
-static constexpr uint8_t HEX_COLOR_LENGTH = 6;
-static constexpr uint8_t RED_SHIFT = 16;
-static constexpr uint8_t GREEN_SHIFT = 8;
-static constexpr uint8_t BYTE_MASK = 0xFF;
-static constexpr uint8_t RED_MASK_565 = 0xF8;
-static constexpr uint8_t GREEN_MASK_565 = 0xFC;
-static constexpr uint8_t RGB565_RED_SHIFT = 8;
-static constexpr uint8_t RGB565_GREEN_SHIFT = 3;
-static constexpr uint8_t RGB565_BLUE_SHIFT = 3;
-
 /**
- * @brief Convert hex color string to RGB565
- * @param hex Color string like "#ff0000" or "ff0000"
+ * @brief Color the last full-screen clear left behind, used as destination by the blended primitives
+ *
  * @return 16-bit RGB565 color
  */
-auto DisplayManager::hexToRgb565(const String& hex) -> uint16_t {
-    String colorStr = hex;
-    if (colorStr.startsWith("#")) {
-        colorStr = colorStr.substring(1);
+auto DisplayManager::backdropColor() -> uint16_t { return s_backdrop; }
+
+/**
+ * @brief Leave the backdrop a clear would leave, without drawing it (a clear the batch optimizer dropped)
+ *
+ * @param color The clear color
+ * @param fill false for a clear to the background layer, see clearToBackground()
+ */
+auto DisplayManager::setBackdrop(uint16_t color, bool fill) -> void {
+    if (g_lcdReady && g_lcd != nullptr && !s_viewport.isClipped() && (fill || !Background::active())) {
+        s_backdrop = color;
+    }
+}
+
+/**
+ * @brief Draw a translucent filled rectangle over a known backdrop color
+ *
+ * Over a solid backdrop the result is itself a solid color, so it is blended once and filled at full speed
+ *
+ * @param alpha Opacity, 0 transparent and 255 opaque
+ * @param backdrop The color under the rectangle
+ */
+auto DisplayManager::fillRectBlended(int16_t posX, int16_t posY, int16_t width, int16_t height, uint16_t color,
+                                     uint8_t alpha, uint16_t backdrop) -> void {
+    DisplayManager::fillRect(posX, posY, width, height, Rgb565::blend(color, backdrop, alpha));
+}
+
+/**
+ * @brief Draw a translucent filled rounded rectangle over a known backdrop color
+ *
+ * @param alpha Opacity, 0 transparent and 255 opaque
+ * @param backdrop The color under the rectangle
+ */
+auto DisplayManager::fillRoundRectBlended(int16_t posX, int16_t posY, int16_t width, int16_t height, int16_t radius,
+                                          uint16_t color, uint8_t alpha, uint16_t backdrop) -> void {
+    DisplayManager::fillRoundRect(posX, posY, width, height, radius, Rgb565::blend(color, backdrop, alpha));
+}
+
+/**
+ * @brief Composite a sprite over a known backdrop color
+ *
+ * Rows are blended two pixels per 32-bit operation (SWAR), converted to panel byte order in the same pass and
+ * streamed line by line. The sprite is translated and trimmed to the clip rect like the other primitives
+ *
+ * @param posX Left edge
+ * @param posY Top edge
+ * @param width Sprite width in pixels
+ * @param height Sprite height in pixels
+ * @param pixels Native RGB565 pixels, row-major
+ * @param alpha Opacity, 0 transparent and 255 opaque
+ * @param backdrop The color under the sprite
+ */
+auto DisplayManager::blitBlended(int16_t posX, int16_t posY, int16_t width, int16_t height, const uint16_t* pixels,
+                                 uint8_t alpha, uint16_t backdrop) -> void {
+    if (pixels == nullptr || width <= 0 || height <= 0) {
+        return;
+    }
+
+    const ClipRect& clip = s_viewport.clip();
+    const int32_t left = static_cast<int32_t>(posX) + s_viewport.dx();
+    const int32_t top = static_cast<int32_t>(posY) + s_viewport.dy();
+    const int32_t x0 = std::max<int32_t>(left, clip.x0);
+    const int32_t y0 = std::max<int32_t>(top, clip.y0);
+    const int32_t x1 = std::min<int32_t>({left + width, clip.x1, x0 + LCD_MAX_SPAN});
+    const int32_t y1 = std::min<int32_t>(top + height, clip.y1);
+
+    if (!lcdCanDraw(x0, y0, x1, y1)) {
+        return;
+    }
+
+    const auto span = static_cast<uint32_t>(x1 - x0);
+    const uint32_t weight = Rgb565::alpha32(alpha);
+    const uint32_t backdrop2 = static_cast<uint32_t>(backdrop) | (static_cast<uint32_t>(backdrop) << 16U);
+    std::array<uint32_t, (LCD_MAX_SPAN + 1) / 2> line{};
+
+    g_lcd->startWrite();
+    for (int32_t row = y0; row < y1; ++row) {
+        const uint16_t* src = pixels + (row - top) * width + (x0 - left);
+
+        for (uint32_t i = 0; i < (span + 1U) / 2U; ++i) {
+            const uint32_t second = (2U * i + 1U < span) ? src[2U * i + 1U] : backdrop;
+            const uint32_t pair = src[2U * i] | (second << 16U);
+
+            line[i] = Rgb565::swap2(weight >= Rgb565::SWAR_ALPHA_MAX ? pair : Rgb565::blend2(pair, backdrop2, weight));
+        }
+
+        g_lcd->writeAddrWindow(static_cast<int16_t>(x0), static_cast<int16_t>(row), static_cast<uint16_t>(span), 1);
+        g_lcdBus->writeBytes(reinterpret_cast<uint8_t*>(line.data()), span * sizeof(uint16_t));
+    }
+    g_lcd->endWrite();
+}
+
+/**
+ * @brief Fill horizontal spans, each with its own color
+ *
+ * Spans are translated and trimmed to the clip rect here, then written inside a single startWrite()/endWrite()
+ *
+ * @param spans The spans, in untranslated coordinates
+ * @param count Number of spans
+ */
+auto DisplayManager::fillSpans(const Span* spans, size_t count) -> void {
+    if (spans == nullptr || count == 0 || !g_lcdReady || g_lcd == nullptr) {
+        return;
+    }
+
+    const ClipRect& clip = s_viewport.clip();
+
+    g_lcd->startWrite();
+    for (size_t i = 0; i < count; ++i) {
+        const Span& span = spans[i];
+        const int32_t row = static_cast<int32_t>(span.y) + s_viewport.dy();
+        const int32_t x0 = std::max<int32_t>(static_cast<int32_t>(span.x0) + s_viewport.dx(), clip.x0);
+        const int32_t x1 = std::min<int32_t>(static_cast<int32_t>(span.x1) + s_viewport.dx(), clip.x1);
+
+        if (row >= clip.y0 && row < clip.y1 && x0 < x1) {
+            g_lcd->writeFillRectPreclipped(static_cast<int16_t>(x0), static_cast<int16_t>(row),
+                                           static_cast<int16_t>(x1 - x0), 1, span.color);
+        }
+    }
+    g_lcd->endWrite();
+}
+
+/**
+ * @brief Copy a block of panel-order RGB565 pixels to the screen
+ *
+ * The pixels are sent as they are, so decoders producing big-endian output skip any per-pixel work here. A block
+ * whose rows stay whole after clipping goes out as one address window and one transfer, otherwise each visible row
+ * gets its own window
+ *
+ * @param posX Left edge
+ * @param posY Top edge
+ * @param width Block width in pixels
+ * @param height Block height in pixels
+ * @param pixels Big-endian RGB565 pixels, row-major
+ * @param stride Pixels from the start of one row to the next (at least width)
+ */
+auto DisplayManager::blitPanel(int16_t posX, int16_t posY, int16_t width, int16_t height, const uint16_t* pixels,
+                               int16_t stride) -> void {
+    if (pixels == nullptr || width <= 0 || height <= 0 || stride < width) {
+        return;
     }
 
-    // Parse 6-char hex (RRGGBB)
-    if (colorStr.length() >= HEX_COLOR_LENGTH) {
-        uint32_t rgb = strtoul(colorStr.c_str(), nullptr, RED_SHIFT);  // base 16
-        uint8_t red = (rgb >> RED_SHIFT) & BYTE_MASK;
-        uint8_t green = (rgb >> GREEN_SHIFT) & BYTE_MASK;
-        uint8_t blue = rgb & BYTE_MASK;
+    const ClipRect& clip = s_viewport.clip();
+    const int32_t left = static_cast<int32_t>(posX) + s_viewport.dx();
+    const int32_t top = static_cast<int32_t>(posY) + s_viewport.dy();
+    const int32_t x0 = std::max<int32_t>(left, clip.x0);
+    const int32_t y0 = std::max<int32_t>(top, clip.y0);
+    const int32_t x1 = std::min<int32_t>(left + width, clip.x1);
+    const int32_t y1 = std::min<int32_t>(top + height, clip.y1);
 
-        // Convert to RGB565: 5 bits R, 6 bits G, 5 bits B
-        return ((red & RED_MASK_565) << RGB565_RED_SHIFT) | ((green & GREEN_MASK_565) << RGB565_GREEN_SHIFT) | (blue >> RGB565_BLUE_SHIFT);
+    if (!lcdCanDraw(x0, y0, x1, y1)) {
+        return;
     }
 
-    return LCD_WHITE;  // Default to white on parse error
+    lcdWritePixels(x0, y0, static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0),
+                   pixels + (y0 - top) * stride + (x0 - left), static_cast<uint32_t>(stride));
 }
+
+/**
+ * @brief Fill a rectangle with a gradient
+ *
+ * Each visible line is generated into a line buffer, already dithered and in panel byte order, and sent with one
+ * address window. The gradient is evaluated in the same (untranslated) coordinates as the rectangle
+ *
+ * @param posX Left edge
+ * @param posY Top edge
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param gradient The gradient to sample
+ */
+auto DisplayManager::fillGradient(int16_t posX, int16_t posY, int16_t width, int16_t height, const Gradient& gradient)
+    -> void {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    const ClipRect& clip = s_viewport.clip();
+    const int32_t left = static_cast<int32_t>(posX) + s_viewport.dx();
+    const int32_t top = static_cast<int32_t>(posY) + s_viewport.dy();
+    const int32_t x0 = std::max<int32_t>(left, clip.x0);
+    const int32_t y0 = std::max<int32_t>(top, clip.y0);
+    const int32_t x1 = std::min<int32_t>({left + width, clip.x1, x0 + LCD_MAX_SPAN});
+    const int32_t y1 = std::min<int32_t>(top + height, clip.y1);
+
+    if (!lcdCanDraw(x0, y0, x1, y1)) {
+        return;
+    }
+
+    const auto span = static_cast<uint16_t>(x1 - x0);
+    const auto localX = static_cast<int16_t>(x0 - s_viewport.dx());
+    std::array<uint16_t, LCD_MAX_SPAN> line{};
+
+    g_lcd->startWrite();
+    for (int32_t row = y0; row < y1; ++row) {
+        gradient.renderLine(line.data(), localX, static_cast<int16_t>(row - s_viewport.dy()), span);
+        g_lcd->writeAddrWindow(static_cast<int16_t>(x0), static_cast<int16_t>(row), span, 1);
+        g_lcdBus->writeBytes(reinterpret_cast<uint8_t*>(line.data()), span * sizeof(uint16_t));
+    }
+    g_lcd->endWrite();
+}
+
+/**
+ * @brief Convert hex color string to RGB565
+ * @param hex Color string like "#ff0000" or "ff0000"
+ * @return 16-bit RGB565 color (white on parse error)
+ */
+auto DisplayManager::hexToRgb565(const char* hex) -> uint16_t { return Rgb565::parseHex(hex, LCD_WHITE); }
+
+/**
+ * @brief Convert hex color string to RGB565
+ * @param hex Color string like "#ff0000" or "ff0000"
+ * @return 16-bit RGB565 color (white on parse error)
+ */
+auto DisplayManager::hexToRgb565(const String& hex) -> uint16_t { return Rgb565::parseHex(hex.c_str(), LCD_WHITE); }
@@ -0,0 +1,629 @@
+#include <Arduino.h>
+#include <Logger.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory>
+
+#include "display/DrawBatch.h"
+#include "display/DisplayManager.h"
+#include "display/Viewport.h"
+#include "display/Rgb565.h"
+#include "display/Shapes.h"
+
+// Only the largest opaque areas are kept as occluders, so culling stays linear in the batch size
+static constexpr size_t MAX_OCCLUDERS = 8;
+
+// Inscribed rect of a filled circle/ellipse: half-side = radius * 177/256 (slightly under 1/sqrt(2) so rasterization
+// rounding can never leave a hole in it)
+static constexpr int32_t INSCRIBED_NUM = 177;
+static constexpr int32_t INSCRIBED_SHIFT = 8;
+
+/**
+ * @brief Half-open pixel area [x0, x1) x [y0, y1)
+ */
+struct DrawArea {
+    int32_t x0;
+    int32_t y0;
+    int32_t x1;
+    int32_t y1;
+};
+
+/**
+ * @brief Clip and translation in effect for a command
+ */
+struct DrawView {
+    DrawArea clip;
+    int16_t dx;
+    int16_t dy;
+};
+
+static auto areaIsEmpty(const DrawArea& area) -> bool { return area.x0 >= area.x1 || area.y0 >= area.y1; }
+
+static auto areaPixels(const DrawArea& area) -> uint32_t {
+    return areaIsEmpty(area) ? 0 : static_cast<uint32_t>((area.x1 - area.x0) * (area.y1 - area.y0));
+}
+
+static auto areaContains(const DrawArea& outer, const DrawArea& inner) -> bool {
+    return !areaIsEmpty(outer) && inner.x0 >= outer.x0 && inner.y0 >= outer.y0 && inner.x1 <= outer.x1 &&
+           inner.y1 <= outer.y1;
+}
+
+static auto areaIntersect(const DrawArea& first, const DrawArea& second) -> DrawArea {
+    return DrawArea{std::max(first.x0, second.x0), std::max(first.y0, second.y0), std::min(first.x1, second.x1),
+                    std::min(first.y1, second.y1)};
+}
+
+static auto areaFromRect(int32_t posX, int32_t posY, int32_t width, int32_t height) -> DrawArea {
+    if (width < 0) {
+        posX += width + 1;
+        width = -width;
+    }
+    if (height < 0) {
+        posY += height + 1;
+        height = -height;
+    }
+
+    return DrawArea{posX, posY, posX + width, posY + height};
+}
+
+static auto areaFromPoints(const int16_t* args, uint8_t count) -> DrawArea {
+    DrawArea area{args[0], args[1], args[0], args[1]};
+
+    for (uint8_t i = 1; i < count; ++i) {
+        area.x0 = std::min<int32_t>(area.x0, args[2 * i]);
+        area.y0 = std::min<int32_t>(area.y0, args[2 * i + 1]);
+        area.x1 = std::max<int32_t>(area.x1, args[2 * i]);
+        area.y1 = std::max<int32_t>(area.y1, args[2 * i + 1]);
+    }
+    area.x1++;
+    area.y1++;
+
+    return area;
+}
+
+/**
+ * @brief Copy of a command with its coordinates moved to screen space
+ *
+ * @param cmd The command
+ * @param view The view in effect for the command
+ * @return The translated command
+ */
+static auto translated(const DrawCommand& cmd, const DrawView& view) -> DrawCommand {
+    DrawCommand out = cmd;
+    uint8_t points = 1;
+
+    if (cmd.op == DrawOp::Line || cmd.op == DrawOp::LineAA || cmd.op == DrawOp::ThickLine) {
+        points = 2;
+    } else if (cmd.op == DrawOp::Triangle) {
+        points = 3;
+    }
+
+    for (uint8_t i = 0; i < points; ++i) {
+        out.args[2 * i] = static_cast<int16_t>(out.args[2 * i] + view.dx);
+        out.args[2 * i + 1] = static_cast<int16_t>(out.args[2 * i + 1] + view.dy);
+    }
+
+    return out;
+}
+
+/**
+ * @brief Every pixel a command may write, clipped to the screen
+ *
+ * @param cmd The command, in screen coordinates
+ * @param screen The clip area
+ * @return The area (empty when the command draws nothing on screen)
+ */
+static auto commandArea(const DrawCommand& cmd, const DrawArea& screen) -> DrawArea {
+    const int16_t* args = cmd.args;
+    DrawArea area{0, 0, 0, 0};
+
+    switch (cmd.op) {
+        case DrawOp::Clear:
+            area = screen;
+            break;
+        case DrawOp::Rect:
+        case DrawOp::RoundRect:
+        case DrawOp::Gradient:
+        case DrawOp::Path:
+        case DrawOp::Sprite:
+            if (args[2] != 0 && args[3] != 0) {
+                area = areaFromRect(args[0], args[1], args[2], args[3]);
+            }
+            break;
+        case DrawOp::Circle:
+            area = DrawArea{args[0] - std::abs(args[2]), args[1] - std::abs(args[2]), args[0] + std::abs(args[2]) + 1,
+                            args[1] + std::abs(args[2]) + 1};
+            break;
+        case DrawOp::Ellipse:
+            area = DrawArea{args[0] - std::abs(args[2]), args[1] - std::abs(args[3]), args[0] + std::abs(args[2]) + 1,
+                            args[1] + std::abs(args[3]) + 1};
+            break;
+        case DrawOp::Line:
+            area = areaFromPoints(args, 2);
+            break;
+        case DrawOp::LineAA:
+        case DrawOp::ThickLine: {
+            // Wu lines touch one pixel beside the ideal line, thick lines reach half their width around it
+            const int32_t grow = (cmd.op == DrawOp::LineAA) ? 1 : std::max<int32_t>(args[4], 1) / 2 + 1;
+            area = areaFromPoints(args, 2);
+            area = DrawArea{area.x0 - grow, area.y0 - grow, area.x1 + grow, area.y1 + grow};
+            break;
+        }
+        case DrawOp::Arc:
+            area = DrawArea{args[0] - std::abs(args[2]), args[1] - std::abs(args[2]), args[0] + std::abs(args[2]) + 1,
+                            args[1] + std::abs(args[2]) + 1};
+            break;
+        case DrawOp::Pixel:
+            area = areaFromPoints(args, 1);
+            break;
+        case DrawOp::Triangle:
+            area = areaFromPoints(args, 3);
+            break;
+        case DrawOp::Text:
+            // Wrapped text (and its background) may extend to the bottom-right corner
+            area = DrawArea{std::max<int32_t>(args[0], 0), std::max<int32_t>(args[1], 0), screen.x1, screen.y1};
+            break;
+        default:
+            break;
+    }
+
+    return areaIntersect(area, screen);
+}
+
+/**
+ * @brief Pixels a command is guaranteed to paint with its colour, clipped to the screen
+ *
+ * @param cmd The command, in screen coordinates
+ * @param screen The clip area
+ * @return The area (empty for commands that are not solid fills)
+ */
+static auto opaqueArea(const DrawCommand& cmd, const DrawArea& screen) -> DrawArea {
+    const int16_t* args = cmd.args;
+    DrawArea area{0, 0, 0, 0};
+
+    switch (cmd.op) {
+        case DrawOp::Clear:
+            area = screen;
+            break;
+        case DrawOp::Rect:
+            if (cmd.fill && args[2] > 0 && args[3] > 0) {
+                area = areaFromRect(args[0], args[1], args[2], args[3]);
+            }
+            break;
+        case DrawOp::Gradient:
+            if (args[2] > 0 && args[3] > 0) {
+                area = areaFromRect(args[0], args[1], args[2], args[3]);
+            }
+            break;
+        case DrawOp::Sprite:
+            if (cmd.alpha == UINT8_MAX && args[2] > 0 && args[3] > 0) {
+                area = areaFromRect(args[0], args[1], args[2], args[3]);
+            }
+            break;
+        case DrawOp::RoundRect:
+            if (cmd.fill && args[2] > 0 && args[3] > 0) {
+                // The corners are cut, the full-width band between them is solid
+                const int32_t radius = std::min<int32_t>(std::max<int32_t>(args[4], 0), std::min(args[2], args[3]) / 2);
+                area = DrawArea{args[0], args[1] + radius, args[0] + args[2], args[1] + args[3] - radius};
+            }
+            break;
+        case DrawOp::Circle:
+            if (cmd.fill && args[2] > 0) {
+                const int32_t half = (args[2] * INSCRIBED_NUM) >> INSCRIBED_SHIFT;
+                area = DrawArea{args[0] - half, args[1] - half, args[0] + half + 1, args[1] + half + 1};
+            }
+            break;
+        case DrawOp::Ellipse:
+            if (cmd.fill && args[2] > 0 && args[3] > 0) {
+                const int32_t halfX = (args[2] * INSCRIBED_NUM) >> INSCRIBED_SHIFT;
+                const int32_t halfY = (args[3] * INSCRIBED_NUM) >> INSCRIBED_SHIFT;
+                area = DrawArea{args[0] - halfX, args[1] - halfY, args[0] + halfX + 1, args[1] + halfY + 1};
+            }
+            break;
+        default:
+            break;
+    }
+
+    return areaIntersect(area, screen);
+}
+
+/**
+ * @brief Whether a command writes nothing but its own colour (text also writes its background)
+ */
+static auto isSingleColor(const DrawCommand& cmd) -> bool {
+    if (cmd.alpha != UINT8_MAX) {
+        // The color actually drawn depends on the backdrop at execution time
+        return false;
+    }
+
+    switch (cmd.op) {
+        case DrawOp::Clear:
+            // A clear without a color repaints the background layer
+            return cmd.fill;
+        case DrawOp::None:
+        case DrawOp::Text:
+        case DrawOp::Gradient:
+        case DrawOp::Sprite:
+        case DrawOp::Backdrop:
+        case DrawOp::LineAA:
+        case DrawOp::PushClip:
+        case DrawOp::PopClip:
+        case DrawOp::Translate:
+            return false;
+        default:
+            return true;
+    }
+}
+
+static auto isViewportOp(const DrawCommand& cmd) -> bool {
+    return cmd.op == DrawOp::PushClip || cmd.op == DrawOp::PopClip || cmd.op == DrawOp::Translate;
+}
+
+/**
+ * @brief Pixels a command may write, in screen coordinates
+ */
+static auto viewArea(const DrawCommand& cmd, const DrawView& view) -> DrawArea {
+    return commandArea(translated(cmd, view), view.clip);
+}
+
+/**
+ * @brief Pixels a command is guaranteed to paint, in screen coordinates
+ */
+static auto viewOpaqueArea(const DrawCommand& cmd, const DrawView& view) -> DrawArea {
+    return opaqueArea(translated(cmd, view), view.clip);
+}
+
+static auto isFilledRect(const DrawCommand& cmd) -> bool {
+    return cmd.op == DrawOp::Rect && cmd.fill && cmd.alpha == UINT8_MAX && cmd.args[2] > 0 && cmd.args[3] > 0;
+}
+
+/**
+ * @brief Merge a filled rect into the previous one when their union is itself a rect
+ *
+ * Both rects share the same view, so the merge is done in their own coordinates
+ *
+ * @param prev The earlier rect, grown on success
+ * @param cmd The later rect
+ * @return true if merged
+ */
+static auto mergeRects(DrawCommand& prev, const DrawCommand& cmd) -> bool {
+    const DrawArea first = areaFromRect(prev.args[0], prev.args[1], prev.args[2], prev.args[3]);
+    const DrawArea second = areaFromRect(cmd.args[0], cmd.args[1], cmd.args[2], cmd.args[3]);
+
+    const bool sameRows = first.y0 == second.y0 && first.y1 == second.y1;
+    const bool sameCols = first.x0 == second.x0 && first.x1 == second.x1;
+    const bool touchX = first.x0 <= second.x1 && second.x0 <= first.x1;
+    const bool touchY = first.y0 <= second.y1 && second.y0 <= first.y1;
+
+    if (!((sameRows && touchX) || (sameCols && touchY))) {
+        return false;
+    }
+
+    const DrawArea merged{std::min(first.x0, second.x0), std::min(first.y0, second.y0), std::max(first.x1, second.x1),
+                          std::max(first.y1, second.y1)};
+    if (merged.x1 - merged.x0 > INT16_MAX || merged.y1 - merged.y0 > INT16_MAX) {
+        return false;
+    }
+
+    prev.args[0] = static_cast<int16_t>(merged.x0);
+    prev.args[1] = static_cast<int16_t>(merged.y0);
+    prev.args[2] = static_cast<int16_t>(merged.x1 - merged.x0);
+    prev.args[3] = static_cast<int16_t>(merged.y1 - merged.y0);
+
+    return true;
+}
+
+/**
+ * @brief Construct a new DrawBatch object
+ *
+ * @param capacity Number of commands to reserve room for
+ */
+DrawBatch::DrawBatch(size_t capacity) { m_commands.reserve(capacity); }
+
+/**
+ * @brief Append a command to the batch
+ *
+ * @param command The command
+ */
+auto DrawBatch::add(const DrawCommand& command) -> void { m_commands.push_back(command); }
+
+/**
+ * @brief Store a gradient for a later Gradient command
+ *
+ * @param spec The gradient definition
+ * @return The value to put in the command's ref
+ */
+auto DrawBatch::addGradient(const GradientSpec& spec) -> uint16_t {
+    m_gradients.push_back(spec);
+    return static_cast<uint16_t>(m_gradients.size() - 1);
+}
+
+/**
+ * @brief Store a path for a later Path command, its vertices must come from arena()
+ *
+ * @param spec The path
+ * @return The value to put in the command's ref
+ */
+auto DrawBatch::addPath(const PathSpec& spec) -> uint16_t {
+    m_paths.push_back(spec);
+    return static_cast<uint16_t>(m_paths.size() - 1);
+}
+
+/**
+ * @brief Store a sprite for a later Sprite command, its pixels must come from arena()
+ *
+ * @param spec The sprite
+ * @return The value to put in the command's ref
+ */
+auto DrawBatch::addSprite(const SpriteSpec& spec) -> uint16_t {
+    m_sprites.push_back(spec);
+    return static_cast<uint16_t>(m_sprites.size() - 1);
+}
+
+/**
+ * @brief Number of commands currently in the batch
+ *
+ * @return The command count
+ */
+auto DrawBatch::size() const -> size_t { return m_commands.size(); }
+
+/**
+ * @brief Remove the commands whose output would not survive and coalesce fills
+ *
+ * The first pass walks the batch backwards and drops commands lying entirely under the opaque area of a later
+ * command (clears included, so repeated clears collapse to the last one). The second pass walks forwards and drops
+ * same-colour repaints of the area the previous fill just painted, and merges edge-sharing same-colour rects.
+ * Dropped clears become Backdrop commands: the backdrop translucent commands blend over must not depend on culling
+ *
+ * @param screenW Screen width in pixels
+ * @param screenH Screen height in pixels
+ * @return What was removed
+ */
+auto DrawBatch::optimize(int16_t screenW, int16_t screenH) -> DrawBatchStats {
+    DrawBatchStats stats{0, 0, 0};
+
+    // Replay push_clip/pop_clip/translate the way DisplayManager will, to know where each command lands
+    std::vector<DrawView> views(m_commands.size());
+    Viewport viewport;
+    viewport.reset(screenW, screenH);
+
+    for (size_t i = 0; i < m_commands.size(); ++i) {
+        const ClipRect& clip = viewport.clip();
+        views[i] = DrawView{DrawArea{clip.x0, clip.y0, clip.x1, clip.y1}, viewport.dx(), viewport.dy()};
+
+        const DrawCommand& cmd = m_commands[i];
+        if (cmd.op == DrawOp::PushClip) {
+            viewport.pushClip(cmd.args[0], cmd.args[1], cmd.args[2], cmd.args[3]);
+        } else if (cmd.op == DrawOp::PopClip) {
+            viewport.popClip();
+        } else if (cmd.op == DrawOp::Translate) {
+            viewport.translate(cmd.args[0], cmd.args[1]);
+        }
+    }
+
+    std::array<DrawArea, MAX_OCCLUDERS> occluders{};
+    size_t occluderCount = 0;
+    std::vector<bool> keep(m_commands.size(), false);
+
+    for (size_t i = m_commands.size(); i-- > 0;) {
+        const DrawCommand& cmd = m_commands[i];
+        if (cmd.op == DrawOp::None) {
+            continue;
+        }
+        if (isViewportOp(cmd)) {
+            keep[i] = true;
+            continue;
+        }
+
+        const DrawArea area = viewArea(cmd, views[i]);
+        bool hidden = areaIsEmpty(area);
+
+        for (size_t o = 0; o < occluderCount && !hidden; ++o) {
+            hidden = areaContains(occluders[o], area);
+        }
+        if (hidden) {
+            stats.culled++;
+            stats.pixelsSaved += areaPixels(area);
+            if (cmd.op == DrawOp::Clear) {
+                m_commands[i].op = DrawOp::Backdrop;
+                keep[i] = true;
+            }
+            continue;
+        }
+
+        keep[i] = true;
+
+        const DrawArea opaque = viewOpaqueArea(cmd, views[i]);
+        if (areaIsEmpty(opaque)) {
+            continue;
+        }
+        if (occluderCount < MAX_OCCLUDERS) {
+            occluders[occluderCount++] = opaque;
+            continue;
+        }
+
+        size_t smallest = 0;
+        for (size_t o = 1; o < MAX_OCCLUDERS; ++o) {
+            if (areaPixels(occluders[o]) < areaPixels(occluders[smallest])) {
+                smallest = o;
+            }
+        }
+        if (areaPixels(opaque) > areaPixels(occluders[smallest])) {
+            occluders[smallest] = opaque;
+        }
+    }
+
+    size_t out = 0;
+    for (size_t i = 0; i < m_commands.size(); ++i) {
+        if (!keep[i]) {
+            continue;
+        }
+
+        DrawCommand cmd = m_commands[i];
+        const DrawView& view = views[i];
+        if (out > 0 && cmd.op != DrawOp::Backdrop) {
+            DrawCommand& prev = m_commands[out - 1];
+            const DrawView& prevView = views[out - 1];
+
+            if (isSingleColor(cmd) && isSingleColor(prev) && cmd.color == prev.color &&
+                areaContains(viewOpaqueArea(prev, prevView), viewArea(cmd, view))) {
+                stats.culled++;
+                stats.pixelsSaved += areaPixels(viewArea(cmd, view));
+                if (cmd.op != DrawOp::Clear) {
+                    continue;
+                }
+                cmd.op = DrawOp::Backdrop;
+            }
+
+            // Consecutive kept commands without a viewport op between them share the same view
+            const uint32_t overlap = areaPixels(areaIntersect(viewArea(prev, prevView), viewArea(cmd, view)));
+            if (isFilledRect(prev) && isFilledRect(cmd) && cmd.color == prev.color && mergeRects(prev, cmd)) {
+                stats.merged++;
+                stats.pixelsSaved += overlap;
+                continue;
+            }
+        }
+
+        m_commands[out] = cmd;
+        views[out] = view;
+        out++;
+    }
+    m_commands.resize(out);
+
+    return stats;
+}
+
+/**
+ * @brief Draw every command of the batch
+ *
+ * @return Number of commands drawn
+ */
+auto DrawBatch::execute() -> size_t {
+    size_t executed = 0;
+
+    // Clips and translations only live for the duration of the batch
+    DisplayManager::resetViewport();
+
+    for (const DrawCommand& cmd : m_commands) {
+        const int16_t* args = cmd.args;
+        const uint16_t backdrop = cmd.hasBg ? cmd.bg : DisplayManager::backdropColor();
+        const uint16_t color = (cmd.alpha == UINT8_MAX) ? cmd.color : Rgb565::blend(cmd.color, backdrop, cmd.alpha);
+
+        switch (cmd.op) {
+            case DrawOp::Clear:
+                if (cmd.fill) {
+                    DisplayManager::fillScreen(color);
+                } else {
+                    DisplayManager::clearToBackground(color);
+                }
+                break;
+            case DrawOp::Backdrop:
+                DisplayManager::setBackdrop(color, cmd.fill);
+                continue;
+            case DrawOp::Rect:
+                if (cmd.fill) {
+                    DisplayManager::fillRectBlended(args[0], args[1], args[2], args[3], cmd.color, cmd.alpha, backdrop);
+                } else {
+                    DisplayManager::drawRect(args[0], args[1], args[2], args[3], color);
+                }
+                break;
+            case DrawOp::Circle:
+                if (cmd.fill) {
+                    DisplayManager::fillCircle(args[0], args[1], args[2], color);
+                } else {
+                    DisplayManager::drawCircle(args[0], args[1], args[2], color);
+                }
+                break;
+            case DrawOp::Line:
+                DisplayManager::drawLine(args[0], args[1], args[2], args[3], color);
+                break;
+            case DrawOp::LineAA:
+                Shapes::drawLineAA(args[0], args[1], args[2], args[3], color, backdrop);
+                break;
+            case DrawOp::ThickLine:
+                Shapes::drawThickLine(args[0], args[1], args[2], args[3],
+                                      static_cast<uint8_t>(std::min<int16_t>(std::max<int16_t>(args[4], 1), UINT8_MAX)),
+                                      cmd.cap, color);
+                break;
+            case DrawOp::Arc:
+                Shapes::fillArc(args[0], args[1], args[2], args[3], args[4], args[5], cmd.cap, color);
+                break;
+            case DrawOp::Pixel:
+                DisplayManager::drawPixel(args[0], args[1], color);
+                break;
+            case DrawOp::Text:
+                DisplayManager::drawTextWrapped(args[0], args[1], String(cmd.text != nullptr ? cmd.text : ""),
+                                                cmd.size, color, cmd.bg, cmd.clearBg);
+                break;
+            case DrawOp::Triangle:
+                if (cmd.fill) {
+                    DisplayManager::fillTriangle(args[0], args[1], args[2], args[3], args[4], args[5], color);
+                } else {
+                    DisplayManager::drawTriangle(args[0], args[1], args[2], args[3], args[4], args[5], color);
+                }
+                break;
+            case DrawOp::Ellipse:
+                if (cmd.fill) {
+                    DisplayManager::fillEllipse(args[0], args[1], args[2], args[3], color);
+                } else {
+                    DisplayManager::drawEllipse(args[0], args[1], args[2], args[3], color);
+                }
+                break;
+            case DrawOp::RoundRect:
+                if (cmd.fill) {
+                    DisplayManager::fillRoundRectBlended(args[0], args[1], args[2], args[3], args[4], cmd.color,
+                                                         cmd.alpha, backdrop);
+                } else {
+                    DisplayManager::drawRoundRect(args[0], args[1], args[2], args[3], args[4], color);
+                }
+                break;
+            case DrawOp::Gradient: {
+                if (cmd.ref >= m_gradients.size()) {
+                    continue;
+                }
+                // The ramp is ~800 bytes, keep it off the stack
+                const std::unique_ptr<Gradient> gradient(new Gradient(m_gradients[cmd.ref]));
+                DisplayManager::fillGradient(args[0], args[1], args[2], args[3], *gradient);
+                break;
+            }
+            case DrawOp::Path:
+                if (cmd.ref >= m_paths.size()) {
+                    continue;
+                }
+                if (!Shapes::fillPath(m_paths[cmd.ref], color, m_arena)) {
+                    Logger::warn("Path skipped, batch arena full", "DrawBatch");
+                    continue;
+                }
+                break;
+            case DrawOp::Sprite: {
+                if (cmd.ref >= m_sprites.size()) {
+                    continue;
+                }
+                const SpriteSpec& sprite = m_sprites[cmd.ref];
+                DisplayManager::blitBlended(args[0], args[1], static_cast<int16_t>(sprite.width),
+                                            static_cast<int16_t>(sprite.height), sprite.pixels, cmd.alpha, backdrop);
+                break;
+            }
+            case DrawOp::PushClip:
+                DisplayManager::pushClip(args[0], args[1], args[2], args[3]);
+                continue;
+            case DrawOp::PopClip:
+                DisplayManager::popClip();
+                continue;
+            case DrawOp::Translate:
+                DisplayManager::translate(args[0], args[1]);
+                continue;
+            default:
+                continue;
+        }
+
+        executed++;
+        yield();  // Allow other tasks to run between commands
+    }
+
+    DisplayManager::resetViewport();
+
+    return executed;
+}
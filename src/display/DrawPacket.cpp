@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cstring>
+
+#include "display/DrawPacket.h"
+#include "display/DisplayManager.h"
+
+/**
+ * @brief How a packet command maps to a batch command
+ */
+struct PacketDraw {
+    PacketOp op;
+    DrawOp draw;
+    uint8_t args;
+};
+
+static constexpr std::array<PacketDraw, 15> PACKET_DRAWS = {{
+    {PacketOp::Clear, DrawOp::Clear, 0},
+    {PacketOp::Rect, DrawOp::Rect, 4},
+    {PacketOp::RoundRect, DrawOp::RoundRect, 5},
+    {PacketOp::Circle, DrawOp::Circle, 3},
+    {PacketOp::Ellipse, DrawOp::Ellipse, 4},
+    {PacketOp::Line, DrawOp::Line, 4},
+    {PacketOp::LineAA, DrawOp::LineAA, 4},
+    {PacketOp::ThickLine, DrawOp::ThickLine, 5},
+    {PacketOp::Arc, DrawOp::Arc, 6},
+    {PacketOp::Pixel, DrawOp::Pixel, 2},
+    {PacketOp::Triangle, DrawOp::Triangle, 6},
+    {PacketOp::Text, DrawOp::Text, 2},
+    {PacketOp::PushClip, DrawOp::PushClip, 4},
+    {PacketOp::PopClip, DrawOp::PopClip, 0},
+    {PacketOp::Translate, DrawOp::Translate, 2},
+}};
+
+/**
+ * @brief Bounds-checked little-endian reader over a packet
+ */
+class PacketReader {
+   public:
+    PacketReader(const uint8_t* data, size_t length) : m_data(data), m_length(length) {}
+
+    auto u8(uint8_t& value) -> bool {
+        if (m_pos + 1 > m_length) {
+            return false;
+        }
+        value = m_data[m_pos++];
+        return true;
+    }
+
+    auto u16(uint16_t& value) -> bool {
+        if (m_pos + 2 > m_length) {
+            return false;
+        }
+        value = static_cast<uint16_t>(m_data[m_pos] | (m_data[m_pos + 1] << 8U));
+        m_pos += 2;
+        return true;
+    }
+
+    auto u32(uint32_t& value) -> bool {
+        uint16_t low = 0;
+        uint16_t high = 0;
+        if (!u16(low) || !u16(high)) {
+            return false;
+        }
+        value = low | (static_cast<uint32_t>(high) << 16U);
+        return true;
+    }
+
+    // A NUL-terminated string inside the packet, nullptr when the terminator is missing
+    auto text() -> const char* {
+        const auto* start = reinterpret_cast<const char*>(m_data + m_pos);
+        const void* end = memchr(start, '\0', m_length - m_pos);
+        if (end == nullptr) {
+            return nullptr;
+        }
+        m_pos += static_cast<const char*>(end) - start + 1;
+        return start;
+    }
+
+    auto done() const -> bool { return m_pos == m_length; }
+
+   private:
+    const uint8_t* m_data;
+    size_t m_length;
+    size_t m_pos = 0;
+};
+
+static auto readHeader(PacketReader& reader, DrawPacketHeader& header) -> bool {
+    uint8_t magic0 = 0;
+    uint8_t magic1 = 0;
+    uint8_t version = 0;
+
+    return reader.u8(magic0) && reader.u8(magic1) && reader.u8(version) && magic0 == DRAW_PACKET_MAGIC[0] &&
+           magic1 == DRAW_PACKET_MAGIC[1] && version == DRAW_PACKET_VERSION && reader.u8(header.flags) &&
+           reader.u16(header.group) && reader.u32(header.sequence) && reader.u16(header.commands);
+}
+
+namespace DrawPacket {
+
+/**
+ * @brief Read the header of a packet
+ *
+ * @return false if it is not a draw packet of this version
+ */
+auto readHeader(const uint8_t* data, size_t length, DrawPacketHeader& header) -> bool {
+    PacketReader reader(data, length);
+    return ::readHeader(reader, header);
+}
+
+/**
+ * @brief Add the commands of a packet to a batch
+ *
+ * A truncated packet or an unknown command rejects the packet, the batch is then to be dropped without drawing
+ *
+ * @return nullptr when decoded, otherwise what is wrong
+ */
+auto decode(const uint8_t* data, size_t length, DrawBatch& batch) -> const char* {
+    PacketReader reader(data, length);
+    DrawPacketHeader header{};
+    if (!::readHeader(reader, header)) {
+        return "not a draw packet";
+    }
+
+    uint16_t color = LCD_WHITE;
+    for (uint16_t i = 0; i < header.commands; ++i) {
+        uint8_t code = 0;
+        uint8_t flags = 0;
+        if (!reader.u8(code) || !reader.u8(flags)) {
+            return "truncated packet";
+        }
+
+        const auto* entry = std::find_if(PACKET_DRAWS.begin(), PACKET_DRAWS.end(), [code](const PacketDraw& draw) {
+            return static_cast<uint8_t>(draw.op) == code;
+        });
+        if (entry == PACKET_DRAWS.end()) {
+            return "unknown command";
+        }
+
+        DrawCommand command{};
+        command.op = entry->draw;
+        command.fill = (flags & DRAW_PACKET_FILL) != 0;
+        command.clearBg = (flags & DRAW_PACKET_CLEAR_BG) != 0;
+        const auto cap = static_cast<uint8_t>((flags >> DRAW_PACKET_CAP_SHIFT) & DRAW_PACKET_CAP_MASK);
+        command.cap = static_cast<LineCap>(std::min(cap, static_cast<uint8_t>(LineCap::Round)));
+        command.alpha = UINT8_MAX;
+
+        bool valid = true;
+        for (uint8_t arg = 0; arg < entry->args && valid; ++arg) {
+            uint16_t value = 0;
+            valid = reader.u16(value);
+            command.args[arg] = static_cast<int16_t>(value);
+        }
+        if (valid && (flags & DRAW_PACKET_COLOR) != 0) {
+            valid = reader.u16(color);
+        }
+        command.color = color;
+        if (valid && (flags & DRAW_PACKET_BG) != 0) {
+            valid = reader.u16(command.bg);
+            command.hasBg = true;
+        }
+        if (valid && (flags & DRAW_PACKET_ALPHA) != 0) {
+            valid = reader.u8(command.alpha);
+        }
+        if (valid && entry->op == PacketOp::Text) {
+            valid = reader.u8(command.size);
+            command.size = std::clamp(command.size, DRAW_TEXT_SIZE_MIN, DRAW_TEXT_SIZE_MAX);
+            command.text = valid ? reader.text() : nullptr;
+            command.hasBg = true;  // black when not given, as in a JSON batch
+            valid = command.text != nullptr;
+        }
+        if (!valid) {
+            return "truncated packet";
+        }
+
+        batch.add(command);
+    }
+
+    if (!reader.done()) {
+        return "trailing bytes after the last command";
+    }
+    return nullptr;
+}
+
+}  // namespace DrawPacket
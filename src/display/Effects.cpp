@@ -0,0 +1,717 @@
+#include <Arduino.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "display/Effects.h"
+#include "display/DisplayManager.h"
+#include "display/FixedMath.h"
+#include "display/Rgb565.h"
+#include "display/Starfield.h"
+
+static constexpr uint32_t US_PER_SECOND = 1000000;
+static constexpr uint32_t MS_PER_SECOND = 1000;
+
+// Longest time an effect moves on in one frame, a stall (a file upload, say) must not make it jump
+static constexpr uint32_t MAX_FRAME_DT_MS = 100;
+
+static constexpr size_t LUT_SIZE = 256;
+static constexpr uint8_t LEVEL_MAX = 255;
+static constexpr int16_t MAX_SIDE = 320;
+
+// Frames in a row over the budget (or well under it) before the detail step changes
+static constexpr uint8_t STEP_UP_FRAMES = 2;
+static constexpr uint8_t STEP_DOWN_FRAMES = 8;
+// A finer step costs up to four times more, so it is only tried below a fifth of the budget
+static constexpr uint32_t STEP_DOWN_MARGIN = 5;
+
+static constexpr uint8_t PARAM_MAX = 16;
+static constexpr uint8_t PARAM_MIDDLE = 4;
+
+// Fire: the heat grid has one cell per FIRE_STEP x FIRE_STEP pixels, plus two fuel rows under the bottom edge
+static constexpr uint8_t FIRE_STEP = 4;
+static constexpr int32_t FIRE_FUEL_ROWS = 2;
+static constexpr uint8_t FIRE_FUEL_MIN = 192;
+static constexpr uint32_t FIRE_COOLING = 64;
+
+// Matrix: 5x7 glyphs in cells of 6x8 samples, one sample per MATRIX_STEP x MATRIX_STEP pixels
+static constexpr uint8_t MATRIX_STEP = 2;
+static constexpr int32_t MATRIX_CELL_W = 6;
+static constexpr int32_t MATRIX_CELL_H = 8;
+static constexpr int32_t MATRIX_GLYPH_W = 5;
+static constexpr int32_t MATRIX_GLYPH_H = 7;
+static constexpr size_t MATRIX_MAX_COLUMNS = MAX_SIDE / (MATRIX_STEP * MATRIX_CELL_W) + 1;
+static constexpr uint8_t MATRIX_TRAIL_PER_SCALE = 3;  // trail length in cells per scale unit
+static constexpr uint8_t MATRIX_GLYPH_SHIFT = 10;     // glyphs change about every second, each at its own time
+
+/**
+ * @brief One column of the matrix, head in 16.16 cell rows
+ */
+struct MatrixDrop {
+    int32_t head;
+    uint32_t speed;  // 16.16 cell rows per millisecond
+    bool falling;
+};
+
+/**
+ * @brief Everything a running effect needs, allocated when it starts and freed when it stops
+ */
+struct EffectState {
+    EffectParams params;
+    uint8_t step;
+    uint8_t minStep;
+    uint8_t maxStep;
+    int32_t columns;  // samples per line at the current step
+    int32_t rows;     // sample lines per frame at the current step
+    uint32_t rng;
+
+    std::unique_ptr<uint16_t[]> strip;
+    std::array<uint16_t, LUT_SIZE> palette;  // panel byte order
+
+    std::array<uint32_t, 5> phases;  // plasma: wave offsets and palette shift of the frame
+    std::array<uint8_t, MAX_SIDE> columnWave;
+
+    std::array<Star, EFFECT_MAX_STARS> stars;
+    std::array<StarSample, EFFECT_MAX_STARS> samples;
+
+    std::unique_ptr<uint8_t[]> heat;
+
+    std::array<MatrixDrop, MATRIX_MAX_COLUMNS> drops;
+    int32_t dropCount;
+
+    bool inFrame;
+    int32_t nextRow;  // next sample line of the frame being drawn
+    uint32_t timeMs;  // effect clock, frame to frame time capped at MAX_FRAME_DT_MS
+    uint32_t frameStartMs;
+    uint32_t busyUs;
+    uint32_t windowStartMs;
+    uint32_t windowFrames;
+    uint8_t overFrames;
+    uint8_t underFrames;
+};
+
+static std::unique_ptr<EffectState> s_state;
+static std::array<EffectStats, EFFECT_KIND_COUNT> s_stats{};
+
+// One turn of a sine in 256 steps, 0-255 around 128
+static std::array<uint8_t, LUT_SIZE> s_wave{};
+static bool s_waveReady = false;
+
+static void buildWave() {
+    if (s_waveReady) {
+        return;
+    }
+    for (size_t i = 0; i < LUT_SIZE; ++i) {
+        const int32_t sine = FixedMath::sin(static_cast<int32_t>(i) * (FixedMath::ANGLE_FULL / LUT_SIZE));
+        s_wave[i] = static_cast<uint8_t>(128 + ((sine * 127) >> FixedMath::ONE_SHIFT));
+    }
+    s_waveReady = true;
+}
+
+static auto wave(uint32_t index) -> uint8_t { return s_wave[index & (LUT_SIZE - 1)]; }
+
+static auto nextRandom(EffectState& state) -> uint32_t {
+    uint32_t value = state.rng;
+    value ^= value << 13U;
+    value ^= value >> 17U;
+    value ^= value << 5U;
+    state.rng = value;
+    return value;
+}
+
+// Integer hash, the matrix glyphs are a function of their cell and time
+static auto hash(uint32_t value) -> uint32_t {
+    value ^= value >> 16U;
+    value *= 0x7FEB352DU;
+    value ^= value >> 15U;
+    value *= 0x846CA68BU;
+    value ^= value >> 16U;
+    return value;
+}
+
+/**
+ * @brief Scale each channel of a native RGB565 color by level / 256
+ */
+static auto shade(uint16_t color, uint32_t level) -> uint16_t {
+    level += 1;
+    const uint32_t red = (((color >> 11U) & 0x1FU) * level) >> 8U;
+    const uint32_t green = (((color >> 5U) & 0x3FU) * level) >> 8U;
+    const uint32_t blue = ((color & 0x1FU) * level) >> 8U;
+    return static_cast<uint16_t>((red << 11U) | (green << 5U) | blue);
+}
+
+static auto paletteColor(const EffectParams& params, uint32_t index) -> uint16_t {
+    if (params.kind == EffectKind::Starfield || params.kind == EffectKind::Matrix) {
+        return shade(params.color, index);
+    }
+
+    switch (params.palette) {
+        case EffectPalette::Fire:
+            // Black, red, yellow, white
+            if (index < 64) {
+                return Rgb565::fromRgb(static_cast<uint8_t>(index * 4), 0, 0);
+            }
+            if (index < 128) {
+                return Rgb565::fromRgb(LEVEL_MAX, static_cast<uint8_t>((index - 64) * 4), 0);
+            }
+            if (index < 192) {
+                return Rgb565::fromRgb(LEVEL_MAX, LEVEL_MAX, static_cast<uint8_t>((index - 128) * 4));
+            }
+            return Rgb565::fromRgb(LEVEL_MAX, LEVEL_MAX, LEVEL_MAX);
+        case EffectPalette::Ocean:
+            return Rgb565::fromRgb(0, static_cast<uint8_t>(wave(index) / 2),
+                                   static_cast<uint8_t>(64 + wave(index + 64) * 3 / 4));
+        case EffectPalette::Mono:
+            // The plasma cycles through its palette, a ramp would show a seam where it wraps
+            return shade(params.color, params.kind == EffectKind::Plasma ? wave(index) : index);
+        default:
+            return Rgb565::fromRgb(wave(index), wave(index + 85), wave(index + 170));
+    }
+}
+
+static void buildPalette(EffectState& state) {
+    for (size_t i = 0; i < LUT_SIZE; ++i) {
+        state.palette[i] = Rgb565::swap(paletteColor(state.params, static_cast<uint32_t>(i)));
+    }
+}
+
+static void setStep(EffectState& state, uint8_t step) {
+    state.step = step;
+    state.columns = (state.params.w + step - 1) / step;
+    state.rows = (state.params.h + step - 1) / step;
+}
+
+// ============================================================================
+// Plasma
+// ============================================================================
+
+static void advancePlasma(EffectState& state) {
+    const uint32_t time = state.timeMs * state.params.speed;
+    state.phases = {time >> 4U, (time * 3) >> 6U, (time * 5) >> 7U, (time * 7) >> 8U, time >> 5U};
+
+    const uint32_t increment = static_cast<uint32_t>(state.step) * state.params.scale;
+    for (int32_t column = 0; column < state.columns; ++column) {
+        state.columnWave[column] = wave(static_cast<uint32_t>(column) * increment + state.phases[0]);
+    }
+}
+
+/**
+ * @brief Four waves: along x (per frame), along y (per line) and two slanted ones, in 8.8 fixed point
+ */
+static void plasmaRow(const EffectState& state, int32_t row, uint16_t* out) {
+    const auto posY = static_cast<uint32_t>(row * state.step);
+    const uint32_t scale = state.params.scale;
+    const uint32_t rowWave = wave(posY * scale + state.phases[1]);
+
+    uint32_t diagonal = ((posY * scale) << 7U) + (state.phases[2] << 8U);
+    uint32_t slant = (state.phases[3] << 8U) - posY * scale * 80;
+    const uint32_t diagonalStep = (scale * state.step) << 7U;
+    const uint32_t slantStep = scale * state.step * 200;
+    const uint32_t shift = state.phases[4];
+
+    for (int32_t column = 0; column < state.columns; ++column) {
+        const uint32_t sum = state.columnWave[column] + rowWave + wave(diagonal >> 8U) + wave(slant >> 8U);
+        out[column] = state.palette[((sum >> 2U) + shift) & (LUT_SIZE - 1)];
+        diagonal += diagonalStep;
+        slant += slantStep;
+    }
+}
+
+// ============================================================================
+// Starfield
+// ============================================================================
+
+static void throwStar(EffectState& state, Star& star, int32_t depth) {
+    star.x = static_cast<int16_t>(static_cast<int32_t>(nextRandom(state) % (2 * STAR_SPREAD)) - STAR_SPREAD);
+    star.y = static_cast<int16_t>(static_cast<int32_t>(nextRandom(state) % (2 * STAR_SPREAD)) - STAR_SPREAD);
+    star.z = static_cast<int16_t>(depth);
+}
+
+static void initStars(EffectState& state) {
+    for (Star& star : state.stars) {
+        throwStar(state, star, STAR_NEAR + static_cast<int32_t>(nextRandom(state) % (STAR_DEPTH - STAR_NEAR)));
+    }
+}
+
+static void advanceStars(EffectState& state, uint32_t deltaMs) {
+    const auto travel = static_cast<int32_t>(std::max<uint32_t>(1, state.params.speed * deltaMs / 8));
+    const int32_t width = state.params.w;
+    const int32_t height = state.params.h;
+
+    for (uint8_t i = 0; i < state.params.density; ++i) {
+        Star& star = state.stars[i];
+
+        star.z = static_cast<int16_t>(star.z - travel);
+        StarSample sample = projectStar(star, width, height, state.step);
+        if (sample.row == STAR_HIDDEN) {
+            // A star thrown back may still land off a non-square area, it stays hidden and is thrown again
+            throwStar(state, star, STAR_DEPTH);
+            sample = projectStar(star, width, height, state.step);
+        }
+
+        state.samples[i] = sample;
+    }
+}
+
+static void starRow(const EffectState& state, int32_t row, uint16_t* out) {
+    std::fill(out, out + state.columns, static_cast<uint16_t>(0));
+    for (uint8_t i = 0; i < state.params.density; ++i) {
+        const StarSample& sample = state.samples[i];
+        if (sample.row == row) {
+            out[sample.column] = state.palette[sample.level];
+        }
+    }
+}
+
+// ============================================================================
+// Fire
+// ============================================================================
+
+/**
+ * @brief Feed the fuel rows, then let every cell take the average of the three below it and the one under those,
+ * minus a random cooling that sets the flame height
+ */
+static void advanceFire(EffectState& state) {
+    const int32_t width = state.columns;
+    const int32_t height = state.rows + FIRE_FUEL_ROWS;
+    const uint32_t cooling = FIRE_COOLING / state.params.scale + 1;
+    uint8_t* heat = state.heat.get();
+    const int32_t steps = std::max(1, state.params.speed / PARAM_MIDDLE);
+
+    for (int32_t pass = 0; pass < steps; ++pass) {
+        for (int32_t cell = state.rows * width; cell < height * width; ++cell) {
+            heat[cell] = static_cast<uint8_t>(FIRE_FUEL_MIN + nextRandom(state) % (LEVEL_MAX + 1 - FIRE_FUEL_MIN));
+        }
+
+        for (int32_t row = 0; row < state.rows; ++row) {
+            const uint8_t* below = heat + (row + 1) * width;
+            const uint8_t* under = heat + (row + 2) * width;
+            uint8_t* line = heat + row * width;
+            for (int32_t column = 0; column < width; ++column) {
+                const uint32_t sum = below[std::max(column - 1, 0)] + below[column] +
+                                     below[std::min(column + 1, width - 1)] + under[column];
+                const uint32_t value = sum / 4;
+                const uint32_t cool = nextRandom(state) % cooling;
+                line[column] = static_cast<uint8_t>(value > cool ? value - cool : 0);
+            }
+        }
+    }
+}
+
+static void fireRow(const EffectState& state, int32_t row, uint16_t* out) {
+    const uint8_t* line = state.heat.get() + row * state.columns;
+    for (int32_t column = 0; column < state.columns; ++column) {
+        out[column] = state.palette[line[column]];
+    }
+}
+
+// ============================================================================
+// Matrix
+// ============================================================================
+
+static auto matrixTrail(const EffectState& state) -> int32_t {
+    return static_cast<int32_t>(state.params.scale) * MATRIX_TRAIL_PER_SCALE;
+}
+
+static void advanceMatrix(EffectState& state, uint32_t deltaMs) {
+    const int32_t cellRows = (state.rows + MATRIX_CELL_H - 1) / MATRIX_CELL_H;
+    const int32_t trail = matrixTrail(state);
+    // Cells per second: between 4 and 8 times the speed
+    const uint32_t base = static_cast<uint32_t>(state.params.speed) * 4;
+
+    for (int32_t column = 0; column < state.dropCount; ++column) {
+        MatrixDrop& drop = state.drops[column];
+        if (drop.falling) {
+            drop.head += static_cast<int32_t>(drop.speed * deltaMs);
+            if ((drop.head >> 16) - trail > cellRows) {
+                drop.falling = false;
+            }
+        } else if (nextRandom(state) % LUT_SIZE < state.params.density * 4U) {
+            const uint32_t cellsPerSecond = base + nextRandom(state) % (base + 1);
+            drop = MatrixDrop{0, (cellsPerSecond << 16U) / MS_PER_SECOND, true};
+        }
+    }
+}
+
+static void matrixRow(const EffectState& state, int32_t row, uint16_t* out) {
+    const int32_t cellRow = row / MATRIX_CELL_H;
+    const int32_t glyphRow = row % MATRIX_CELL_H;
+    std::fill(out, out + state.columns, static_cast<uint16_t>(0));
+    if (glyphRow >= MATRIX_GLYPH_H) {
+        return;
+    }
+
+    const int32_t trail = matrixTrail(state);
+    for (int32_t column = 0; column < state.dropCount; ++column) {
+        const MatrixDrop& drop = state.drops[column];
+        const int32_t distance = (drop.head >> 16) - cellRow;
+        if (!drop.falling || distance < 0 || distance >= trail) {
+            continue;
+        }
+
+        // The head is white, the trail fades out behind it
+        const uint16_t color = (distance == 0) ? LCD_WHITE : state.palette[LEVEL_MAX - distance * 224 / trail];
+        const auto cell = static_cast<uint32_t>((column << 8) | cellRow);
+        const uint32_t epoch = (state.timeMs + (hash(cell) & 0x3FFU)) >> MATRIX_GLYPH_SHIFT;
+        const uint32_t bits = hash((cell << 12U) ^ (epoch << 3U) ^ static_cast<uint32_t>(glyphRow));
+
+        uint16_t* glyph = out + column * MATRIX_CELL_W;
+        for (int32_t bit = 0; bit < MATRIX_GLYPH_W; ++bit) {
+            if ((bits >> bit) & 1U) {
+                glyph[bit] = color;
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Engine
+// ============================================================================
+
+static void advance(EffectState& state, uint32_t deltaMs) {
+    state.timeMs += deltaMs;
+
+    switch (state.params.kind) {
+        case EffectKind::Plasma:
+            advancePlasma(state);
+            break;
+        case EffectKind::Starfield:
+            advanceStars(state, deltaMs);
+            break;
+        case EffectKind::Fire:
+            advanceFire(state);
+            break;
+        case EffectKind::Matrix:
+            advanceMatrix(state, deltaMs);
+            break;
+    }
+}
+
+static void renderRow(const EffectState& state, int32_t row, uint16_t* out) {
+    switch (state.params.kind) {
+        case EffectKind::Plasma:
+            plasmaRow(state, row, out);
+            break;
+        case EffectKind::Starfield:
+            starRow(state, row, out);
+            break;
+        case EffectKind::Fire:
+            fireRow(state, row, out);
+            break;
+        case EffectKind::Matrix:
+            matrixRow(state, row, out);
+            break;
+    }
+}
+
+/**
+ * @brief Render the next strip of the frame and send it
+ *
+ * Each sample line is widened in place (from the right, so no sample is overwritten before it is read) and copied
+ * down to the step x step pixels it covers
+ */
+static void renderStrip(EffectState& state) {
+    const int32_t width = state.params.w;
+    const int32_t step = state.step;
+    const int32_t top = state.nextRow * step;
+    const int32_t height = std::min<int32_t>(EFFECT_STRIP_ROWS, state.params.h - top);
+    uint16_t* strip = state.strip.get();
+
+    for (int32_t line = 0; line < height && state.nextRow < state.rows; line += step) {
+        uint16_t* out = strip + line * width;
+        renderRow(state, state.nextRow++, out);
+
+        if (step > 1) {
+            for (int32_t sample = state.columns - 1; sample >= 0; --sample) {
+                const uint16_t color = out[sample];
+                std::fill(out + sample * step, out + std::min((sample + 1) * step, width), color);
+            }
+        }
+        for (int32_t copy = 1; copy < step && line + copy < height; ++copy) {
+            std::memcpy(out + copy * width, out, static_cast<size_t>(width) * sizeof(uint16_t));
+        }
+    }
+
+    DisplayManager::blitPanel(state.params.x, static_cast<int16_t>(state.params.y + top), state.params.w,
+                              static_cast<int16_t>(height), strip, state.params.w);
+}
+
+/**
+ * @brief Follow the budget: a coarser step after frames over it, a finer one after frames well under it
+ */
+static void adapt(EffectState& state) {
+    const uint32_t budgetUs = US_PER_SECOND / state.params.fps;
+
+    if (state.busyUs > budgetUs) {
+        state.underFrames = 0;
+        if (++state.overFrames >= STEP_UP_FRAMES && state.step < state.maxStep) {
+            setStep(state, static_cast<uint8_t>(state.step * 2));
+            state.overFrames = 0;
+        }
+    } else if (state.busyUs * STEP_DOWN_MARGIN < budgetUs) {
+        state.overFrames = 0;
+        if (++state.underFrames >= STEP_DOWN_FRAMES && state.step > state.minStep) {
+            setStep(state, static_cast<uint8_t>(state.step / 2));
+            state.underFrames = 0;
+        }
+    } else {
+        state.overFrames = 0;
+        state.underFrames = 0;
+    }
+}
+
+static void finishFrame(EffectState& state, uint32_t nowMs) {
+    EffectStats& stats = s_stats[static_cast<size_t>(state.params.kind)];
+    stats.frames++;
+    stats.frameUs = state.busyUs;
+    stats.maxFrameUs = std::max(stats.maxFrameUs, state.busyUs);
+
+    state.windowFrames++;
+    const uint32_t window = nowMs - state.windowStartMs;
+    if (window >= MS_PER_SECOND) {
+        stats.fps = static_cast<uint16_t>((state.windowFrames * MS_PER_SECOND + window / 2) / window);
+        state.windowFrames = 0;
+        state.windowStartMs = nowMs;
+    }
+
+    state.inFrame = false;
+    adapt(state);
+    stats.step = state.step;
+}
+
+/**
+ * @brief Clamp the settings to what the effect accepts and the area to the screen
+ *
+ * @return false when the area is empty
+ */
+static auto normalize(EffectParams& params) -> bool {
+    const int32_t screenW = DisplayManager::screenWidth();
+    const int32_t screenH = DisplayManager::screenHeight();
+    const int32_t left = std::clamp<int32_t>(params.x, 0, screenW);
+    const int32_t top = std::clamp<int32_t>(params.y, 0, screenH);
+    const int32_t right = std::min<int32_t>({params.x + params.w, screenW, left + MAX_SIDE});
+    const int32_t bottom = std::min<int32_t>({params.y + params.h, screenH, top + MAX_SIDE});
+    if (right <= left || bottom <= top) {
+        return false;
+    }
+
+    params.x = static_cast<int16_t>(left);
+    params.y = static_cast<int16_t>(top);
+    params.w = static_cast<int16_t>(right - left);
+    params.h = static_cast<int16_t>(bottom - top);
+    params.fps = std::clamp<uint8_t>(params.fps, 1, EFFECT_MAX_FPS);
+    params.speed = std::clamp<uint8_t>(params.speed, 1, PARAM_MAX);
+    params.scale = std::clamp<uint8_t>(params.scale, 1, PARAM_MAX);
+    params.density = std::clamp<uint8_t>(params.density, 1,
+                                         params.kind == EffectKind::Starfield ? EFFECT_MAX_STARS : PARAM_MAX);
+    return true;
+}
+
+namespace Effects {
+
+/**
+ * @brief Start an effect in place of the running one
+ *
+ * @param params Effect and settings
+ * @param nowMs Current time in milliseconds
+ * @return false if the area is empty or the memory is short
+ */
+auto start(const EffectParams& params, uint32_t nowMs) -> bool {
+    stop();
+
+    std::unique_ptr<EffectState> state(new (std::nothrow) EffectState());
+    if (!state) {
+        return false;
+    }
+    state->params = params;
+    if (!normalize(state->params)) {
+        return false;
+    }
+
+    switch (params.kind) {
+        case EffectKind::Plasma:
+            state->minStep = 1;
+            state->maxStep = EFFECT_MAX_STEP;
+            break;
+        case EffectKind::Starfield:
+            state->minStep = 1;
+            state->maxStep = 2;
+            break;
+        case EffectKind::Fire:
+            state->minStep = FIRE_STEP;
+            state->maxStep = FIRE_STEP;
+            break;
+        case EffectKind::Matrix:
+            state->minStep = MATRIX_STEP;
+            state->maxStep = MATRIX_STEP;
+            break;
+    }
+    setStep(*state, state->minStep);
+
+    state->strip.reset(new (std::nothrow) uint16_t[static_cast<size_t>(state->params.w) * EFFECT_STRIP_ROWS]);
+    if (!state->strip) {
+        return false;
+    }
+    if (params.kind == EffectKind::Fire) {
+        state->heat.reset(new (std::nothrow)
+                              uint8_t[static_cast<size_t>(state->columns) * (state->rows + FIRE_FUEL_ROWS)]());
+        if (!state->heat) {
+            return false;
+        }
+    }
+
+    buildWave();
+    buildPalette(*state);
+    state->rng = (nowMs ^ micros()) | 1U;
+    if (params.kind == EffectKind::Starfield) {
+        initStars(*state);
+    }
+    state->dropCount = std::min<int32_t>(state->columns / MATRIX_CELL_W, MATRIX_MAX_COLUMNS);
+
+    // The first frame is due at once
+    state->frameStartMs = nowMs - MS_PER_SECOND / state->params.fps;
+    state->windowStartMs = nowMs;
+
+    s_stats[static_cast<size_t>(params.kind)] = EffectStats{0, 0, 0, 0, state->step};
+    s_state = std::move(state);
+
+    return true;
+}
+
+/**
+ * @brief Change the settings of the running effect without restarting it
+ *
+ * Another effect or another area starts afresh
+ *
+ * @param params Effect and settings
+ * @param nowMs Current time in milliseconds
+ * @return false if the effect could not be started
+ */
+auto setParams(const EffectParams& params, uint32_t nowMs) -> bool {
+    EffectParams next = params;
+    if (!s_state || !normalize(next) || next.kind != s_state->params.kind || next.x != s_state->params.x ||
+        next.y != s_state->params.y || next.w != s_state->params.w || next.h != s_state->params.h) {
+        return start(params, nowMs);
+    }
+
+    s_state->params = next;
+    buildPalette(*s_state);
+    s_state->overFrames = 0;
+    s_state->underFrames = 0;
+
+    return true;
+}
+
+/**
+ * @brief Stop the running effect and free its memory, the screen keeps its last frame
+ */
+void stop() { s_state.reset(); }
+
+auto running() -> bool { return static_cast<bool>(s_state); }
+
+/**
+ * @brief Settings of the running effect (clamped as applied), or the defaults of the plasma
+ */
+auto params() -> EffectParams { return s_state ? s_state->params : defaults(EffectKind::Plasma); }
+
+/**
+ * @brief Settings an effect starts with when the request leaves them out
+ */
+auto defaults(EffectKind kind) -> EffectParams {
+    EffectParams params{};
+    params.kind = kind;
+    params.x = 0;
+    params.y = 0;
+    params.w = DisplayManager::screenWidth();
+    params.h = DisplayManager::screenHeight();
+    params.fps = EFFECT_DEFAULT_FPS;
+    params.speed = PARAM_MIDDLE;
+    params.scale = PARAM_MIDDLE;
+    params.density = (kind == EffectKind::Starfield) ? EFFECT_MAX_STARS / 2 : PARAM_MIDDLE;
+    params.color = (kind == EffectKind::Matrix) ? Rgb565::fromRgb(0, LEVEL_MAX, 64) : LCD_WHITE;
+    params.palette = (kind == EffectKind::Fire) ? EffectPalette::Fire : EffectPalette::Rainbow;
+    return params;
+}
+
+/**
+ * @brief Render the running effect: start a frame when one is due, then strips until it is done or the slice is
+ * used up
+ *
+ * @param nowMs Current time in milliseconds
+ */
+void update(uint32_t nowMs) {
+    if (!s_state) {
+        return;
+    }
+    EffectState& state = *s_state;
+
+    if (!state.inFrame) {
+        const uint32_t elapsed = nowMs - state.frameStartMs;
+        const uint32_t intervalMs = MS_PER_SECOND / state.params.fps;
+        if (elapsed < intervalMs) {
+            return;
+        }
+        // Keep the cadence when the loop comes a little late, start over after a longer stall
+        state.frameStartMs = (elapsed < 2 * intervalMs) ? state.frameStartMs + intervalMs : nowMs;
+        state.inFrame = true;
+        state.nextRow = 0;
+        state.busyUs = 0;
+
+        const uint32_t startUs = micros();
+        advance(state, std::min(elapsed, MAX_FRAME_DT_MS));
+        state.busyUs += micros() - startUs;
+    }
+
+    const uint32_t sliceUs = micros();
+    DisplayManager::resetViewport();
+    do {
+        renderStrip(state);
+    } while (state.nextRow < state.rows && micros() - sliceUs < EFFECT_SLICE_US);
+    state.busyUs += micros() - sliceUs;
+
+    if (state.nextRow >= state.rows) {
+        finishFrame(state, nowMs);
+    }
+}
+
+/**
+ * @brief Frame rate and detail of an effect, the running one or the last time it ran
+ */
+auto stats(EffectKind kind) -> EffectStats { return s_stats[static_cast<size_t>(kind)]; }
+
+/**
+ * @brief Name of an effect as used by the API
+ */
+auto kindName(EffectKind kind) -> const char* {
+    switch (kind) {
+        case EffectKind::Starfield:
+            return "starfield";
+        case EffectKind::Fire:
+            return "fire";
+        case EffectKind::Matrix:
+            return "matrix";
+        default:
+            return "plasma";
+    }
+}
+
+/**
+ * @brief Name of a palette as used by the API
+ */
+auto paletteName(EffectPalette palette) -> const char* {
+    switch (palette) {
+        case EffectPalette::Fire:
+            return "fire";
+        case EffectPalette::Ocean:
+            return "ocean";
+        case EffectPalette::Mono:
+            return "mono";
+        default:
+            return "rainbow";
+    }
+}
+
+}  // namespace Effects
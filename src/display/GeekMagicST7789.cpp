@@ -0,0 +1,328 @@
+#include "display/GeekMagicST7789.h"
+
+#include <algorithm>
+
+// MADCTL bits
+static constexpr uint8_t MADCTL_MY = 0x80;
+static constexpr uint8_t MADCTL_MX = 0x40;
+static constexpr uint8_t MADCTL_MV = 0x20;
+static constexpr uint8_t MADCTL_CMD = 0x36;
+
+// Vertical scrolling
+static constexpr uint8_t ST7789_NORON = 0x13;
+static constexpr uint8_t ST7789_VSCRDEF = 0x33;
+static constexpr uint8_t ST7789_VSCSAD = 0x37;
+
+// The ST7789 frame memory is 240x320, smaller panels are mapped at its origin
+static constexpr int16_t ST7789_GRAM_WIDTH = 240;
+static constexpr int16_t ST7789_GRAM_HEIGHT = 320;
+
+static constexpr uint16_t ROTATE_90 = 90;
+static constexpr uint16_t ROTATE_180 = 180;
+static constexpr uint16_t ROTATE_270 = 270;
+
+/**
+ * @brief Map a legacy Arduino_GFX rotation (0-7) to a display transform
+ *
+ * Rotations 4-7 are the mirrored variants Arduino_ST7789 provides (4 is the cube's mirrored orientation)
+ *
+ * @param rotation The Arduino_GFX rotation
+ * @return The equivalent transform
+ */
+auto transformFromRotation(uint8_t rotation) -> DisplayTransform {
+    switch (rotation & 7U) {
+        case 1:
+            return DisplayTransform{false, false, ROTATE_90};
+        case 2:
+            return DisplayTransform{false, false, ROTATE_180};
+        case 3:
+            return DisplayTransform{false, false, ROTATE_270};
+        case 4:
+            return DisplayTransform{true, false, 0};
+        case 5:
+            return DisplayTransform{true, false, ROTATE_90};
+        case 6:
+            return DisplayTransform{false, true, 0};
+        case 7:
+            return DisplayTransform{false, true, ROTATE_90};
+        default:
+            return DisplayTransform{false, false, 0};
+    }
+}
+
+/**
+ * @brief Check that a rotation in degrees is one the panel supports
+ *
+ * @param degrees The rotation
+ * @return true for 0, 90, 180 and 270
+ */
+auto isValidRotate(int degrees) -> bool {
+    return degrees == 0 || degrees == ROTATE_90 || degrees == ROTATE_180 || degrees == ROTATE_270;
+}
+
+/**
+ * @brief Construct a new GeekMagicST7789 object
+ *
+ * @param bus The data bus
+ * @param width Panel width in pixels
+ * @param height Panel height in pixels
+ * @param transform Initial orientation, applied by begin()
+ */
+GeekMagicST7789::GeekMagicST7789(Arduino_DataBus* bus, int16_t width, int16_t height,
+                                 const DisplayTransform& transform)
+    : Arduino_ST7789(bus, GFX_NOT_DEFINED, 0, true, width, height),
+      m_transform(transform),
+      m_panelW(width),
+      m_panelH(height) {}
+
+/**
+ * @brief Compute the MADCTL value of a transform
+ *
+ * @param transform The transform
+ * @return The MADCTL register value
+ */
+auto GeekMagicST7789::madctlFor(const DisplayTransform& transform) -> uint8_t {
+    uint8_t value = 0;
+
+    switch (transform.rotate) {
+        case ROTATE_90:
+            value = MADCTL_MX | MADCTL_MV;
+            break;
+        case ROTATE_180:
+            value = MADCTL_MX | MADCTL_MY;
+            break;
+        case ROTATE_270:
+            value = MADCTL_MY | MADCTL_MV;
+            break;
+        default:
+            break;
+    }
+
+    // With MV set, screen X runs along the memory rows, so the mirror bits swap roles
+    const bool exchanged = (value & MADCTL_MV) != 0;
+
+    if (transform.mirrorX) {
+        value ^= exchanged ? MADCTL_MY : MADCTL_MX;
+    }
+    if (transform.mirrorY) {
+        value ^= exchanged ? MADCTL_MX : MADCTL_MY;
+    }
+
+    return value;
+}
+
+/**
+ * @brief Legacy rotation entry point used by Arduino_GFX (begin() and setRotation())
+ *
+ * @param r The Arduino_GFX rotation (0-7)
+ */
+void GeekMagicST7789::setRotation(uint8_t r) {
+    // Arduino_TFT::begin() re-applies its constructor rotation, keep the configured transform instead
+    (void)r;
+    setTransform(m_transform);
+}
+
+/**
+ * @brief Apply a transform through MADCTL and the RAM address offsets
+ *
+ * @param transform The new transform
+ */
+auto GeekMagicST7789::setTransform(const DisplayTransform& transform) -> void {
+    m_transform = transform;
+
+    const uint8_t value = madctlFor(transform);
+    const bool exchanged = (value & MADCTL_MV) != 0;
+
+    // Sets the logical width/height and resets the cached address window
+    Arduino_TFT::setRotation(exchanged ? 1 : 0);
+
+    // A mirrored axis is addressed from the far end of the frame memory
+    const auto colOffset = static_cast<uint8_t>(((value & MADCTL_MX) != 0) ? ST7789_GRAM_WIDTH - m_panelW : 0);
+    const auto rowOffset = static_cast<uint8_t>(((value & MADCTL_MY) != 0) ? ST7789_GRAM_HEIGHT - m_panelH : 0);
+
+    _xStart = exchanged ? rowOffset : colOffset;
+    _yStart = exchanged ? colOffset : rowOffset;
+
+    _bus->beginWrite();
+    _bus->writeCommand(MADCTL_CMD);
+    _bus->write(value);
+    _bus->endWrite();
+}
+
+/**
+ * @brief Get the current transform
+ *
+ * @return The transform
+ */
+auto GeekMagicST7789::getTransform() const -> DisplayTransform { return m_transform; }
+
+/**
+ * @brief Get the MADCTL value of the current transform
+ *
+ * @return The MADCTL register value
+ */
+auto GeekMagicST7789::madctl() const -> uint8_t { return madctlFor(m_transform); }
+
+/**
+ * @brief Restrict every following drawing operation to a screen area
+ *
+ * @param clip The area, in screen coordinates
+ */
+auto GeekMagicST7789::setClip(const ClipRect& clip) -> void {
+    m_clip = clip;
+    m_clipped = true;
+}
+
+/**
+ * @brief Remove the clip rect
+ */
+auto GeekMagicST7789::clearClip() -> void { m_clipped = false; }
+
+/**
+ * @brief Install (or remove, with nullptr) the address window hook
+ *
+ * @param hook Function called before each address window is set
+ */
+auto GeekMagicST7789::setWindowHook(WindowHook hook) -> void { m_windowHook = hook; }
+
+/**
+ * @brief Address window funnel, every primitive, text, blit and GIF line sets its window here
+ */
+void GeekMagicST7789::writeAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) {
+    if (m_windowHook != nullptr) {
+        m_windowHook(x, y, w, h);
+    }
+
+    Arduino_ST7789::writeAddrWindow(x, y, w, h);
+}
+
+/**
+ * @brief Frame memory lines the panel does not show, which a vertical scroll brings into view
+ *
+ * @return The number of spare lines, 0 when screen rows are not frame memory lines (90 and 270 degree rotations)
+ */
+auto GeekMagicST7789::spareRows() const -> int16_t {
+    if ((madctl() & MADCTL_MV) != 0) {
+        return 0;
+    }
+
+    return static_cast<int16_t>(ST7789_GRAM_HEIGHT - m_panelH);
+}
+
+/**
+ * @brief Fill the frame memory lines the panel does not show
+ *
+ * The panel rows sit at one end of the frame memory (see setTransform()), the spare lines are the other end
+ *
+ * @param color Fill color
+ */
+auto GeekMagicST7789::fillSpareRows(uint16_t color) -> void {
+    const int16_t count = spareRows();
+    if (count <= 0) {
+        return;
+    }
+
+    const uint16_t first = (_yStart == 0) ? m_panelH : 0;
+
+    _bus->beginWrite();
+    _bus->writeC8D16D16(ST7789_CASET, _xStart, _xStart + m_panelW - 1);
+    _bus->writeC8D16D16(ST7789_RASET, first, first + count - 1);
+    _bus->writeCommand(ST7789_RAMWR);
+    _bus->writeRepeat(color, static_cast<uint32_t>(m_panelW) * count);
+    _bus->endWrite();
+
+    // The cached address window no longer matches the controller
+    _currentW = 0;
+    _currentH = 0;
+}
+
+/**
+ * @brief Scroll the whole frame memory so that the picture moves up by a number of lines
+ *
+ * Lines leaving the top come back at the bottom after the spare lines. With MY set the frame memory runs bottom to
+ * top, so the start address counts down instead
+ *
+ * @param lines Lines scrolled, modulo the frame memory height
+ */
+auto GeekMagicST7789::setScroll(uint16_t lines) -> void {
+    const uint16_t line = lines % ST7789_GRAM_HEIGHT;
+    const uint16_t start = ((madctl() & MADCTL_MY) != 0) ? (ST7789_GRAM_HEIGHT - line) % ST7789_GRAM_HEIGHT : line;
+
+    _bus->beginWrite();
+    if (!m_scrolling) {
+        // Whole frame memory as scroll area, no fixed top or bottom band
+        _bus->writeCommand(ST7789_VSCRDEF);
+        _bus->write16(0);
+        _bus->write16(ST7789_GRAM_HEIGHT);
+        _bus->write16(0);
+        m_scrolling = true;
+    }
+    _bus->writeCommand(ST7789_VSCSAD);
+    _bus->write16(start);
+    _bus->endWrite();
+}
+
+/**
+ * @brief Leave vertical scrolling mode, the frame memory is shown from its first line again
+ */
+auto GeekMagicST7789::endScroll() -> void {
+    if (!m_scrolling) {
+        return;
+    }
+
+    _bus->beginWrite();
+    _bus->writeCommand(ST7789_VSCSAD);
+    _bus->write16(0);
+    _bus->writeCommand(ST7789_NORON);
+    _bus->endWrite();
+    m_scrolling = false;
+}
+
+/**
+ * @brief Pixel write funnel, drops pixels outside the clip rect
+ */
+void GeekMagicST7789::writePixelPreclipped(int16_t x, int16_t y, uint16_t color) {
+    if (m_clipped && (x < m_clip.x0 || y < m_clip.y0 || x >= m_clip.x1 || y >= m_clip.y1)) {
+        return;
+    }
+
+    Arduino_TFT::writePixelPreclipped(x, y, color);
+}
+
+/**
+ * @brief Fill funnel (lines, spans, rects), trims the rect to the clip rect
+ */
+void GeekMagicST7789::writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (m_clipped) {
+        const int16_t right = static_cast<int16_t>(std::min<int32_t>(x + w, m_clip.x1));
+        const int16_t bottom = static_cast<int16_t>(std::min<int32_t>(y + h, m_clip.y1));
+
+        x = std::max(x, m_clip.x0);
+        y = std::max(y, m_clip.y0);
+        if (x >= right || y >= bottom) {
+            return;
+        }
+        w = static_cast<int16_t>(right - x);
+        h = static_cast<int16_t>(bottom - y);
+    }
+
+    Arduino_TFT::writeFillRectPreclipped(x, y, w, h, color);
+}
+
+/**
+ * @brief Characters straddling the clip edge use the generic per-pixel path so that they go through the funnels
+ */
+void GeekMagicST7789::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg) {
+    const int32_t right = x + 6 * static_cast<int32_t>(textsize_x);
+    const int32_t bottom = y + 8 * static_cast<int32_t>(textsize_y);
+
+    if (!m_clipped || (x >= m_clip.x0 && y >= m_clip.y0 && right <= m_clip.x1 && bottom <= m_clip.y1)) {
+        Arduino_ST7789::drawChar(x, y, c, color, bg);
+        return;
+    }
+    if (right <= m_clip.x0 || bottom <= m_clip.y0 || x >= m_clip.x1 || y >= m_clip.y1) {
+        return;
+    }
+
+    Arduino_GFX::drawChar(x, y, c, color, bg);
+}
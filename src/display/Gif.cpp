@@ -1,10 +1,14 @@
 #include "display/Gif.h"
 #include "display/DisplayManager.h"
+#include "display/Rgb565.h"
+#include "wireless/TimeSync.h"
 #include <Arduino_GFX_Library.h>
 #include <array>
 static constexpr uint32_t GIF_MAX_MS_PER_FILE = 20000U;
 static constexpr uint8_t GIF_TARGET_FPS = 30U;
 static constexpr uint32_t GIF_FRAME_MS = 1000U / GIF_TARGET_FPS;
+// A synced frame due within this is waited for in place rather than on a later update()
+static constexpr int64_t GIF_SYNC_SPIN_US = 2000;
 
 Gif* Gif::s_instance = nullptr;
 
@@ -159,6 +163,25 @@ auto Gif::gifSeekFile(GIFFILE* pFile, int32_t iPosition) -> int32_t {
     return iPosition;
 }
 
+/**
+ * @brief Push one line of panel-order RGB565 pixels into an address window
+ *
+ * The palette is requested big-endian from AnimatedGIF so the line buffer is already in the byte order the ST7789
+ * expects and can be sent as raw bytes, skipping the per-pixel swap done by writePixels()
+ *
+ * @param tft The TFT the address window is set on
+ * @param bus The data bus the pixels are streamed through
+ * @param xPos X coordinate of the first pixel
+ * @param yPos Y coordinate of the line
+ * @param pixels Big-endian RGB565 pixels
+ * @param len Number of pixels
+ */
+static inline void gifWriteLine(Arduino_TFT* tft, Arduino_DataBus* bus, int xPos, int yPos, uint16_t* pixels,
+                                int len) {
+    tft->writeAddrWindow(static_cast<int16_t>(xPos), static_cast<int16_t>(yPos), static_cast<uint16_t>(len), 1);
+    bus->writeBytes(reinterpret_cast<uint8_t*>(pixels), static_cast<uint32_t>(len) * sizeof(uint16_t));
+}
+
 /**
  * @brief Draw a frame of the GIF
  *
@@ -177,6 +200,11 @@ auto Gif::gifDraw(GIFDRAW* pDraw) -> void  // NOLINT(readability-function-cognit
         return;
     }
 
+    auto* bus = DisplayManager::getBus();
+    if (bus == nullptr) {
+        return;
+    }
+
     auto* tft = reinterpret_cast<Arduino_TFT*>(gfx);
     if (pDraw->y == 0) {
         tft->startWrite();
@@ -214,7 +242,7 @@ auto Gif::gifDraw(GIFDRAW* pDraw) -> void  // NOLINT(readability-function-cognit
         s_instance->m_curY = static_cast<int16_t>(pDraw->iY + s_instance->m_offsetY);
         s_instance->m_curW = static_cast<int16_t>(pDraw->iWidth);
         s_instance->m_curH = static_cast<int16_t>(pDraw->iHeight);
-        s_instance->m_curBg = LCD_BLACK;
+        s_instance->m_curBg = Rgb565::swap(LCD_BLACK);
     }
 
     const auto xPos = static_cast<int>(rawX + (s_instance != nullptr ? s_instance->m_offsetX : 0));
@@ -309,9 +337,7 @@ auto Gif::gifDraw(GIFDRAW* pDraw) -> void  // NOLINT(readability-function-cognit
                     lineBuf[static_cast<size_t>(i)] = fillBg;
                 }
 
-                tft->writeAddrWindow(static_cast<int16_t>(uStart), static_cast<int16_t>(yPos),
-                                     static_cast<uint16_t>(uLen), 1);
-                tft->writePixels(reinterpret_cast<uint16_t*>(lineBuf.data()), static_cast<uint32_t>(uLen));
+                gifWriteLine(tft, bus, uStart, yPos, lineBuf.data(), uLen);
 
             } else {
                 if (pDraw->ucHasTransparency == 0) {
@@ -330,9 +356,7 @@ auto Gif::gifDraw(GIFDRAW* pDraw) -> void  // NOLINT(readability-function-cognit
                         }
                     }
 
-                    tft->writeAddrWindow(static_cast<int16_t>(uStart), static_cast<int16_t>(yPos),
-                                         static_cast<uint16_t>(uLen), 1);
-                    tft->writePixels(reinterpret_cast<uint16_t*>(lineBuf.data()), static_cast<uint32_t>(uLen));
+                    gifWriteLine(tft, bus, uStart, yPos, lineBuf.data(), uLen);
                 } else {
                     if (needClearLine) {
                         for (int i = 0; i < uLen; i++) {
@@ -355,9 +379,7 @@ auto Gif::gifDraw(GIFDRAW* pDraw) -> void  // NOLINT(readability-function-cognit
                             }
                         }
 
-                        tft->writeAddrWindow(static_cast<int16_t>(uStart), static_cast<int16_t>(yPos),
-                                             static_cast<uint16_t>(uLen), 1);
-                        tft->writePixels(reinterpret_cast<uint16_t*>(lineBuf.data()), static_cast<uint32_t>(uLen));
+                        gifWriteLine(tft, bus, uStart, yPos, lineBuf.data(), uLen);
                     } else {
                         const auto transparentIndex = static_cast<uint8_t>(pDraw->ucTransparent);
                         const auto* const sPtr = src + visStart;
@@ -382,10 +404,7 @@ auto Gif::gifDraw(GIFDRAW* pDraw) -> void  // NOLINT(readability-function-cognit
 
                             const auto dstX = static_cast<int>(xPos + visStart + (idx - runLen));
 
-                            tft->writeAddrWindow(static_cast<int16_t>(dstX), static_cast<int16_t>(yPos),
-                                                 static_cast<uint16_t>(runLen), 1);
-                            tft->writePixels(reinterpret_cast<uint16_t*>(lineBuf.data()),
-                                             static_cast<uint32_t>(runLen));
+                            gifWriteLine(tft, bus, dstX, yPos, lineBuf.data(), runLen);
                         }
                     }
                 }
@@ -434,7 +453,7 @@ auto Gif::playOne(const String& path) -> bool {
     m_offsetY = 0;
     m_centered = false;
 
-    m_gif->begin(GIF_PALETTE_RGB565_LE);
+    m_gif->begin(GIF_PALETTE_RGB565_BE);
 
     if (m_gif->open(path.c_str(), gifOpenFile, gifCloseFile, gifReadFile, gifSeekFile, gifDraw) <= 0) {
         return false;
@@ -442,6 +461,11 @@ auto Gif::playOne(const String& path) -> bool {
 
     m_currentPath = path;
 
+    m_statFrames = 0;
+    m_statCycles = 0;
+    m_statMaxCycles = 0;
+    m_synced = false;
+
     m_stopRequested = false;
     m_playRequested = true;
     m_playing = true;
@@ -454,6 +478,77 @@ auto Gif::playOne(const String& path) -> bool {
     return true;
 }
 
+/**
+ * @brief Play a GIF on the sync clock, so devices given the same start show the same frame at the same time
+ *
+ * The frames before startFrame are decoded and drawn as fast as possible (later frames only hold the changes), then
+ * startFrame is shown at startUs and each next frame when the previous one's delay has elapsed on the sync clock.
+ * Deadlines run on across loops. A late frame is not dropped, it is shown right away and the next ones follow back
+ * to back until the deadlines are met again. A start frame past the end starts from the first one
+ *
+ * @param path The path to the GIF file
+ * @param startUs Sync time (see TimeSync::now()) to show startFrame at
+ * @param startFrame Index of the frame to show at startUs
+ *
+ * @return true if playback started successfully false otherwise
+ */
+auto Gif::playAt(const String& path, uint64_t startUs, uint16_t startFrame) -> bool {
+    if (!playOne(path)) {
+        return false;
+    }
+
+    m_synced = true;
+    m_deadlineUs = startUs;
+    m_syncStartUs = startUs;
+    m_syncStartFrame = startFrame;
+    m_startFrame = startFrame;
+    m_syncFrames = 0;
+    m_syncLate = 0;
+    m_syncLateSumUs = 0;
+    m_syncMaxLateUs = 0;
+
+    return true;
+}
+
+/**
+ * @brief Whether the next synced frame is due, waiting for it when it is close
+ *
+ * @return true when the frame is to be shown now
+ */
+auto Gif::waitForDeadline() -> bool {
+    const auto remainingUs = static_cast<int64_t>(m_deadlineUs - TimeSync::now());
+    if (remainingUs > GIF_SYNC_SPIN_US) {
+        return false;
+    }
+    if (remainingUs > 0) {
+        delayMicroseconds(static_cast<unsigned int>(remainingUs));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Account a synced frame and move the deadline to the next one
+ *
+ * @param shownUs Sync time the frame started to be drawn
+ * @param slotMs How long the frame stays on screen
+ */
+auto Gif::recordDeadline(uint64_t shownUs, uint32_t slotMs) -> void {
+    const auto lateUs = static_cast<int64_t>(shownUs - m_deadlineUs);
+    const uint64_t slotUs = static_cast<uint64_t>(slotMs) * 1000U;
+
+    m_syncFrames++;
+    m_syncLateSumUs += lateUs;
+    if (lateUs >= static_cast<int64_t>(slotUs)) {
+        m_syncLate++;
+    }
+    if (m_syncFrames == 1 || lateUs > m_syncMaxLateUs) {
+        m_syncMaxLateUs = static_cast<int32_t>(lateUs < INT32_MAX ? lateUs : INT32_MAX);
+    }
+
+    m_deadlineUs += slotUs;
+}
+
 /**
  * @brief Update the GIF playback, should be called regularly
  *
@@ -473,17 +568,41 @@ auto Gif::update() -> void {
     }
 
     const uint32_t now = millis();
-    if (m_targetMs > 0) {
+    const bool timed = m_synced && m_frameCount >= m_startFrame;
+    if (timed) {
+        if (!waitForDeadline()) {
+            return;
+        }
+    } else if (!m_synced && m_targetMs > 0) {
         if ((now - m_lastFrameMs) < m_targetMs) {
             return;
         }
     }
 
+    const uint64_t shownUs = timed ? TimeSync::now() : 0;
     int delayMsFromGif = 0;
+    const uint32_t startCycles = ESP.getCycleCount();  // NOLINT(readability-static-accessed-through-instance)
     const int result = m_gif->playFrame(false, &delayMsFromGif, nullptr);
+    const uint32_t frameCycles = ESP.getCycleCount() - startCycles;  // NOLINT(readability-static-accessed-through-instance)
     m_frameCount++;
+
+    if (result >= 0) {
+        m_statFrames++;
+        m_statCycles += frameCycles;
+        if (frameCycles > m_statMaxCycles) {
+            m_statMaxCycles = frameCycles;
+        }
+    }
     m_lastFrameMs = now;
 
+    uint32_t targetMs = GIF_FRAME_MS;
+    if (delayMsFromGif > 0 && static_cast<uint32_t>(delayMsFromGif) > targetMs) {
+        targetMs = static_cast<uint32_t>(delayMsFromGif);
+    }
+    if (timed && result >= 0) {
+        recordDeadline(shownUs, targetMs);
+    }
+
     if (result <= 0) {
         if (m_loopEnabled && !m_stopRequested && !m_currentPath.isEmpty()) {
             m_gif->close();
@@ -499,6 +618,7 @@ auto Gif::update() -> void {
             m_lastFrameMs = millis();
             m_startMs = millis();
             m_frameCount = 0;
+            m_startFrame = 0;
 
             return;
         }
@@ -510,14 +630,10 @@ auto Gif::update() -> void {
         return;
     }
 
-    uint32_t targetMs = GIF_FRAME_MS;
-    if (delayMsFromGif > 0 && static_cast<uint32_t>(delayMsFromGif) > targetMs) {
-        targetMs = static_cast<uint32_t>(delayMsFromGif);
-    }
-
     m_targetMs = targetMs;
 
-    if ((millis() - m_startMs) > GIF_MAX_MS_PER_FILE) {
+    // A synced pass also waits for its start time, its end is set by the deadlines
+    if (!m_synced && (millis() - m_startMs) > GIF_MAX_MS_PER_FILE) {
         m_gif->close();
         m_playing = false;
         m_playRequested = false;
@@ -551,7 +667,7 @@ auto Gif::playAllFromLittleFS() -> bool {
         return false;
     }
 
-    m_gif->begin(LITTLE_ENDIAN_PIXELS);
+    m_gif->begin(GIF_PALETTE_RGB565_BE);
 
     Dir dir = LittleFS.openDir("/gifs");
 
@@ -610,3 +726,50 @@ auto Gif::isPlaying() const -> bool { return m_playing; }
  * @param enabled true to enable looping false to disable
  */
 auto Gif::setLoopEnabled(bool enabled) -> void { m_loopEnabled = enabled; }
+
+/**
+ * @brief Get the decode and push cost per frame of the current GIF
+ *
+ * Cycles are measured around AnimatedGIF::playFrame(), so they include LZW decoding and the SPI transfer of every
+ * line written by gifDraw()
+ *
+ * @return The accumulated frame statistics since the last playOne()
+ */
+auto Gif::frameStats() const -> GifFrameStats {
+    GifFrameStats stats{};
+
+    stats.frames = m_statFrames;
+    stats.maxCycles = m_statMaxCycles;
+
+    if (m_statFrames > 0) {
+        stats.avgCycles = static_cast<uint32_t>(m_statCycles / m_statFrames);
+        stats.avgUs = stats.avgCycles / ESP.getCpuFreqMHz();  // NOLINT(readability-static-accessed-through-instance)
+    }
+
+    return stats;
+}
+
+/**
+ * @brief Get how well a synced playback (see playAt()) meets its frame deadlines
+ *
+ * The lateness is measured on the sync clock when the frame starts to be drawn, so the same figures on two devices
+ * plus their TimeSync error bounds give how far apart they show a frame
+ *
+ * @return The deadline statistics since the last playAt()
+ */
+auto Gif::syncStats() const -> GifSyncStats {
+    GifSyncStats stats{};
+
+    stats.active = m_synced && m_playing;
+    stats.startUs = m_syncStartUs;
+    stats.startFrame = m_syncStartFrame;
+    stats.frames = m_syncFrames;
+    stats.late = m_syncLate;
+    stats.maxLateUs = m_syncMaxLateUs;
+
+    if (m_syncFrames > 0) {
+        stats.avgLateUs = static_cast<int32_t>(m_syncLateSumUs / static_cast<int64_t>(m_syncFrames));
+    }
+
+    return stats;
+}
@@ -0,0 +1,121 @@
+#include <Arduino.h>
+#include <font/glcdfont.h>
+
+#include <array>
+#include <memory>
+#include <new>
+
+#include "display/GlyphCache.h"
+#include "display/Rgb565.h"
+
+// Columns of a glyph in the font table, the sixth column of the cell is spacing
+static constexpr uint8_t FONT_COLUMNS = 5;
+// Arduino_GFX skips one glyph of the table from this code on unless it is in CP437 mode, its default is off
+static constexpr uint8_t FONT_CP437_SKIP = 176;
+
+struct GlyphEntry {
+    uint16_t fgColor;
+    uint16_t bgColor;
+    char chr;
+    uint8_t size;
+    uint16_t offset;  // in pixels from the start of the pool
+};
+
+static std::unique_ptr<uint16_t[]> s_pool;
+static size_t s_used = 0;  // pixels
+static std::array<GlyphEntry, GLYPH_CACHE_ENTRIES> s_entries{};
+static size_t s_count = 0;
+static GlyphCacheStats s_stats{};
+
+/**
+ * @brief Render one glyph into a cell the way Arduino_GFX::drawChar() draws it with a background color
+ */
+static void renderGlyph(uint16_t* cell, char chr, uint8_t size, uint16_t fgColor, uint16_t bgColor) {
+    auto code = static_cast<uint8_t>(chr);
+    if (code >= FONT_CP437_SKIP) {
+        code++;
+    }
+
+    const int16_t width = GLYPH_CELL_WIDTH * size;
+    const uint16_t fg = Rgb565::swap(fgColor);
+    const uint16_t bg = Rgb565::swap(bgColor);
+
+    for (int16_t column = 0; column < GLYPH_CELL_WIDTH; ++column) {
+        const uint8_t bits = column < FONT_COLUMNS ? pgm_read_byte(&font[code * FONT_COLUMNS + column]) : 0;
+
+        for (int16_t row = 0; row < GLYPH_CELL_HEIGHT; ++row) {
+            const uint16_t color = (bits >> row) & 1U ? fg : bg;
+            uint16_t* out = cell + (row * size) * width + column * size;
+
+            for (uint8_t dy = 0; dy < size; ++dy, out += width) {
+                for (uint8_t dx = 0; dx < size; ++dx) {
+                    out[dx] = color;
+                }
+            }
+        }
+    }
+}
+
+namespace GlyphCache {
+
+/**
+ * @brief Get a rendered glyph, rendering it on a miss
+ *
+ * @param chr Character
+ * @param size Text size, 1 to GLYPH_CACHE_MAX_SIZE
+ * @param fgColor Glyph color
+ * @param bgColor Cell color
+ * @return The cell (GLYPH_CELL_WIDTH * size pixels wide), valid until the next call; nullptr when the size is not
+ * cached or memory is short, the caller draws the glyph itself then
+ */
+auto glyph(char chr, uint8_t size, uint16_t fgColor, uint16_t bgColor) -> const uint16_t* {
+    if (size == 0 || size > GLYPH_CACHE_MAX_SIZE) {
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < s_count; ++i) {
+        const GlyphEntry& entry = s_entries[i];
+        if (entry.chr == chr && entry.size == size && entry.fgColor == fgColor && entry.bgColor == bgColor) {
+            s_stats.hits++;
+            return s_pool.get() + entry.offset;
+        }
+    }
+
+    if (!s_pool) {
+        s_pool.reset(new (std::nothrow) uint16_t[GLYPH_CACHE_BYTES / sizeof(uint16_t)]);
+        if (!s_pool) {
+            return nullptr;
+        }
+    }
+
+    const size_t pixels = static_cast<size_t>(GLYPH_CELL_WIDTH * size) * (GLYPH_CELL_HEIGHT * size);
+    if (s_count == s_entries.size() || s_used + pixels > GLYPH_CACHE_BYTES / sizeof(uint16_t)) {
+        s_count = 0;
+        s_used = 0;
+        s_stats.flushes++;
+    }
+
+    s_stats.misses++;
+    s_entries[s_count++] = GlyphEntry{fgColor, bgColor, chr, size, static_cast<uint16_t>(s_used)};
+    uint16_t* cell = s_pool.get() + s_used;
+    s_used += pixels;
+    s_stats.bytes = static_cast<uint32_t>(s_used * sizeof(uint16_t));
+
+    renderGlyph(cell, chr, size, fgColor, bgColor);
+
+    return cell;
+}
+
+/**
+ * @brief Drop every glyph and give the memory back
+ */
+void clear() {
+    s_pool.reset();
+    s_count = 0;
+    s_used = 0;
+    s_stats.bytes = 0;
+}
+
+auto stats() -> GlyphCacheStats { return s_stats; }
+
+}  // namespace GlyphCache
@@ -0,0 +1,203 @@
+#include <algorithm>
+
+#include "display/Gradient.h"
+#include "display/Rgb565.h"
+
+// 4x4 ordered-dither thresholds (0..15)
+static constexpr std::array<std::array<uint8_t, 4>, 4> BAYER_4X4 = {{
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+}};
+
+// Threshold used when dithering is off: half a step, i.e. round to nearest
+static constexpr uint8_t NO_DITHER_THRESHOLD = 8;
+
+// Linear ramp position is 12.20 fixed point, the ramp index is its top 8 fractional bits
+static constexpr uint8_t LINEAR_FRACTION_BITS = 20;
+static constexpr uint8_t LINEAR_INDEX_SHIFT = LINEAR_FRACTION_BITS - 8;
+static constexpr int64_t LINEAR_POSITION_LIMIT = INT64_C(1) << 30;
+
+// Color interpolation steps along the ramp are 16.16 fixed point
+static constexpr uint8_t RAMP_FRACTION_BITS = 16;
+
+/**
+ * @brief Convert a ramp index to a panel-order pixel
+ *
+ * @param red Pre-scaled red (0..248)
+ * @param green Pre-scaled green (0..252)
+ * @param blue Pre-scaled blue (0..248)
+ * @param threshold Dither threshold 0..15
+ */
+static inline auto ditherPixel(uint8_t red, uint8_t green, uint8_t blue, uint8_t threshold) -> uint16_t {
+    const uint8_t fine = threshold >> 1U;    // 0..7 below a 5-bit step
+    const uint8_t coarse = threshold >> 2U;  // 0..3 below a 6-bit step
+    const auto color = static_cast<uint16_t>(((red + fine) >> 3U) << 11U | ((green + coarse) >> 2U) << 5U |
+                                             ((blue + fine) >> 3U));
+
+    return Rgb565::swap(color);
+}
+
+/**
+ * @brief Construct a new Gradient object
+ *
+ * @param spec The gradient definition, stops do not need to be sorted
+ */
+Gradient::Gradient(const GradientSpec& spec) : m_kind(spec.kind), m_dither(spec.dither) {
+    buildRamp(spec);
+
+    if (m_kind == GradientKind::Linear) {
+        m_startX = spec.startX;
+        m_startY = spec.startY;
+        m_axisX = static_cast<int32_t>(spec.endX) - spec.startX;
+        m_axisY = static_cast<int32_t>(spec.endY) - spec.startY;
+        m_axisLength2 = static_cast<int64_t>(m_axisX) * m_axisX + static_cast<int64_t>(m_axisY) * m_axisY;
+        if (m_axisLength2 == 0) {
+            m_axisLength2 = 1;
+        }
+        m_stepX = static_cast<int32_t>((static_cast<int64_t>(m_axisX) << LINEAR_FRACTION_BITS) / m_axisLength2);
+        return;
+    }
+
+    m_centerX = spec.centerX;
+    m_centerY = spec.centerY;
+
+    // Index k starts at distance k * radius / 256, compared squared so the per-pixel test needs no square root
+    const int64_t radius = std::max<int16_t>(spec.radius, 1);
+    m_thresholds.resize(RAMP_SIZE);
+    for (uint16_t k = 0; k < RAMP_SIZE; ++k) {
+        const int64_t scaled = static_cast<int64_t>(k) * radius;
+        constexpr int64_t SCALE2 = static_cast<int64_t>(RAMP_SIZE) * RAMP_SIZE;
+        m_thresholds[k] = static_cast<uint32_t>((scaled * scaled + SCALE2 - 1) / SCALE2);
+    }
+}
+
+/**
+ * @brief Expand the stops into the 256-entry ramp
+ *
+ * Channels are interpolated with fixed-point steps, one division per stop segment
+ *
+ * @param spec The gradient definition
+ */
+void Gradient::buildRamp(const GradientSpec& spec) {
+    std::array<GradientStop, GRADIENT_MAX_STOPS> stops = spec.stops;
+    const uint8_t count = std::min(std::max(spec.stopCount, static_cast<uint8_t>(1)), GRADIENT_MAX_STOPS);
+    std::stable_sort(stops.begin(), stops.begin() + count,
+                     [](const GradientStop& first, const GradientStop& second) { return first.pos < second.pos; });
+
+    uint8_t segment = 0;
+    int32_t channel[3] = {0, 0, 0};
+    int32_t step[3] = {0, 0, 0};
+    bool segmentReady = false;
+
+    for (uint16_t i = 0; i < RAMP_SIZE; ++i) {
+        while (segment + 1U < count && i >= stops[segment + 1U].pos) {
+            segment++;
+            segmentReady = false;
+        }
+
+        uint32_t rgb = 0;
+        if (i <= stops[0].pos || segment + 1U >= count) {
+            rgb = (i <= stops[0].pos) ? stops[0].rgb : stops[count - 1U].rgb;
+        } else {
+            const GradientStop& from = stops[segment];
+            const GradientStop& to = stops[segment + 1U];
+
+            if (!segmentReady) {
+                const int32_t span = to.pos - from.pos;
+                for (uint8_t c = 0; c < 3; ++c) {
+                    const uint8_t shift = 16U - 8U * c;
+                    const auto start = static_cast<int32_t>((from.rgb >> shift) & 0xFFU);
+                    const auto end = static_cast<int32_t>((to.rgb >> shift) & 0xFFU);
+
+                    step[c] = ((end - start) * (1 << RAMP_FRACTION_BITS)) / span;
+                    channel[c] = (start << RAMP_FRACTION_BITS) + step[c] * (i - from.pos) +
+                                 (1 << (RAMP_FRACTION_BITS - 1));
+                }
+                segmentReady = true;
+            }
+
+            for (uint8_t c = 0; c < 3; ++c) {
+                const int32_t value = std::min(std::max(channel[c] >> RAMP_FRACTION_BITS, 0), 255);
+                rgb = (rgb << 8U) | static_cast<uint32_t>(value);
+                channel[c] += step[c];
+            }
+        }
+
+        // Leave headroom for the dither threshold: 255 maps to 248 (5-bit) / 252 (6-bit)
+        const auto red = static_cast<uint8_t>(rgb >> 16U);
+        const auto green = static_cast<uint8_t>(rgb >> 8U);
+        const auto blue = static_cast<uint8_t>(rgb);
+        m_red[i] = static_cast<uint8_t>(red - (red >> 5U));
+        m_green[i] = static_cast<uint8_t>(green - (green >> 6U));
+        m_blue[i] = static_cast<uint8_t>(blue - (blue >> 5U));
+    }
+}
+
+/**
+ * @brief Generate one horizontal run of the gradient
+ *
+ * @param out Receives count pixels in panel byte order
+ * @param posX Left edge, in the coordinates of the spec
+ * @param posY Row, in the coordinates of the spec
+ * @param count Number of pixels
+ */
+void Gradient::renderLine(uint16_t* out, int16_t posX, int16_t posY, uint16_t count) const {
+    if (out == nullptr || count == 0) {
+        return;
+    }
+
+    if (m_kind == GradientKind::Linear) {
+        renderLinear(out, posX, posY, count);
+    } else {
+        renderRadial(out, posX, posY, count);
+    }
+}
+
+void Gradient::renderLinear(uint16_t* out, int16_t posX, int16_t posY, uint16_t count) const {
+    const int64_t dot = (static_cast<int64_t>(posX) - m_startX) * m_axisX +
+                        (static_cast<int64_t>(posY) - m_startY) * m_axisY;
+
+    // A start this far outside [0, 1] cannot come back into range within one line, so saturating it is exact
+    int64_t start = (dot * (INT64_C(1) << LINEAR_FRACTION_BITS)) / m_axisLength2;
+    start = std::min(std::max(start, -LINEAR_POSITION_LIMIT), LINEAR_POSITION_LIMIT);
+
+    auto position = static_cast<int32_t>(start);
+    const std::array<uint8_t, 4>& bayer = BAYER_4X4[posY & 3];
+
+    for (uint16_t i = 0; i < count; ++i) {
+        const int32_t index = std::min<int32_t>(std::max<int32_t>(position >> LINEAR_INDEX_SHIFT, 0), RAMP_SIZE - 1);
+        const uint8_t threshold = m_dither ? bayer[(posX + i) & 3] : NO_DITHER_THRESHOLD;
+
+        out[i] = ditherPixel(m_red[index], m_green[index], m_blue[index], threshold);
+        position += m_stepX;
+    }
+}
+
+void Gradient::renderRadial(uint16_t* out, int16_t posX, int16_t posY, uint16_t count) const {
+    int32_t deltaX = static_cast<int32_t>(posX) - m_centerX;
+    const int32_t deltaY = static_cast<int32_t>(posY) - m_centerY;
+    uint32_t distance2 = static_cast<uint32_t>(deltaX * deltaX) + static_cast<uint32_t>(deltaY * deltaY);
+
+    // Walking a line moves the distance a little at a time, so the index is found once and then nudged
+    auto index = static_cast<uint16_t>(std::upper_bound(m_thresholds.begin(), m_thresholds.end(), distance2) -
+                                       m_thresholds.begin() - 1);
+    const std::array<uint8_t, 4>& bayer = BAYER_4X4[posY & 3];
+
+    for (uint16_t i = 0; i < count; ++i) {
+        while (index + 1U < RAMP_SIZE && distance2 >= m_thresholds[index + 1U]) {
+            index++;
+        }
+        while (index > 0 && distance2 < m_thresholds[index]) {
+            index--;
+        }
+
+        const uint8_t threshold = m_dither ? bayer[(posX + i) & 3] : NO_DITHER_THRESHOLD;
+        out[i] = ditherPixel(m_red[index], m_green[index], m_blue[index], threshold);
+
+        // (dx + 1)^2 = dx^2 + 2dx + 1
+        distance2 += static_cast<uint32_t>(2 * deltaX + 1);
+        deltaX++;
+    }
+}
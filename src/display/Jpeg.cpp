@@ -0,0 +1,266 @@
+#include <JPEGDEC.h>
+#include <LittleFS.h>
+#include <Logger.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <new>
+
+#include "display/Jpeg.h"
+#include "display/DisplayManager.h"
+
+// IDCT scale divisors JPEGDEC supports, smallest reduction first
+static constexpr std::array<uint8_t, 4> JPEG_SCALE_DIVISORS = {1, 2, 4, 8};
+
+/**
+ * @brief Right and bottom edge of the image being drawn
+ *
+ * MCU blocks are padded to 8 or 16 pixels; what lies past the image edge is not drawn
+ */
+struct JpegTarget {
+    int32_t right;
+    int32_t bottom;
+};
+
+static JpegTarget s_target{0, 0};
+
+static uint32_t s_statImages = 0;
+static uint64_t s_statTotalUs = 0;
+static uint32_t s_statLastUs = 0;
+static uint32_t s_statMaxUs = 0;
+
+/**
+ * @brief Open a JPEG file from LittleFS
+ *
+ * @param fname The filename to open
+ * @param pSize Pointer to store the size of the file
+ * @return void* Handle to the opened file, nullptr on error
+ */
+static auto jpegOpenFile(const char* fname, int32_t* pSize) -> void* {
+    auto* filePtr = new (std::nothrow) File();
+
+    if (filePtr == nullptr) {
+        return nullptr;
+    }
+
+    *filePtr = LittleFS.open(fname, "r");
+
+    if (!(*filePtr)) {
+        delete filePtr;
+
+        return nullptr;
+    }
+
+    *pSize = static_cast<int32_t>(filePtr->size());
+
+    return reinterpret_cast<void*>(filePtr);
+}
+
+/**
+ * @brief Close the JPEG file
+ *
+ * @param pHandle Handle to the file to close
+ */
+static auto jpegCloseFile(void* pHandle) -> void {
+    auto* filePtr = reinterpret_cast<File*>(pHandle);
+
+    if (filePtr == nullptr) {
+        return;
+    }
+
+    if (*filePtr) {
+        filePtr->close();
+    }
+
+    delete filePtr;
+}
+
+/**
+ * @brief Refill JPEGDEC's input buffer from the file
+ *
+ * @param pFile Pointer to the JPEGFILE structure
+ * @param pBuf Buffer to read data into
+ * @param iLen Number of bytes to read
+ * @return int32_t Number of bytes read
+ */
+static auto jpegReadFile(JPEGFILE* pFile, uint8_t* pBuf, int32_t iLen) -> int32_t {
+    auto* filePtr = reinterpret_cast<File*>(pFile->fHandle);
+
+    if (filePtr == nullptr || !(*filePtr)) {
+        return 0;
+    }
+
+    const int32_t bytesToRead = std::min(iLen, pFile->iSize - pFile->iPos);
+
+    if (bytesToRead <= 0) {
+        return 0;
+    }
+
+    const auto bytesRead = static_cast<int32_t>(filePtr->read(pBuf, static_cast<size_t>(bytesToRead)));
+
+    if (bytesRead > 0) {
+        pFile->iPos += bytesRead;
+    }
+
+    return bytesRead;
+}
+
+/**
+ * @brief Seek to a position in the JPEG file
+ *
+ * @param pFile Pointer to the JPEGFILE structure
+ * @param iPosition Position to seek to
+ * @return int32_t New position after seeking
+ */
+static auto jpegSeekFile(JPEGFILE* pFile, int32_t iPosition) -> int32_t {
+    auto* filePtr = reinterpret_cast<File*>(pFile->fHandle);
+
+    if (filePtr == nullptr || !(*filePtr)) {
+        return 0;
+    }
+
+    iPosition = std::min(std::max<int32_t>(iPosition, 0), pFile->iSize);
+    pFile->iPos = iPosition;
+    (void)filePtr->seek(static_cast<uint32_t>(iPosition), SeekSet);
+
+    return iPosition;
+}
+
+/**
+ * @brief Send one decoded block (a row of MCUs) to the panel
+ *
+ * @param pDraw The block, big-endian RGB565, iWidth pixels per row
+ * @return 1 to keep decoding
+ */
+static auto jpegDraw(JPEGDRAW* pDraw) -> int {
+    const int32_t width = std::min<int32_t>(pDraw->iWidth, s_target.right - pDraw->x);
+    const int32_t height = std::min<int32_t>(pDraw->iHeight, s_target.bottom - pDraw->y);
+
+    if (width > 0 && height > 0) {
+        DisplayManager::blitPanel(static_cast<int16_t>(pDraw->x), static_cast<int16_t>(pDraw->y),
+                                  static_cast<int16_t>(width), static_cast<int16_t>(height), pDraw->pPixels,
+                                  static_cast<int16_t>(pDraw->iWidth));
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Pick the IDCT scale divisor
+ *
+ * @param scale Requested divisor, or JPEG_SCALE_FIT
+ * @param width Image width
+ * @param height Image height
+ * @return 1, 2, 4 or 8 (unsupported requests round up to the next supported divisor)
+ */
+static auto chooseScale(uint8_t scale, int32_t width, int32_t height) -> uint8_t {
+    for (const uint8_t divisor : JPEG_SCALE_DIVISORS) {
+        if (scale == JPEG_SCALE_FIT) {
+            if ((width + divisor - 1) / divisor <= DisplayManager::screenWidth() &&
+                (height + divisor - 1) / divisor <= DisplayManager::screenHeight()) {
+                return divisor;
+            }
+        } else if (divisor >= scale) {
+            return divisor;
+        }
+    }
+
+    return JPEG_SCALE_DIVISORS.back();
+}
+
+/**
+ * @brief JPEGDEC option flag for a scale divisor
+ */
+static auto scaleOption(uint8_t divisor) -> int {
+    switch (divisor) {
+        case 2:
+            return JPEG_SCALE_HALF;
+        case 4:
+            return JPEG_SCALE_QUARTER;
+        case 8:
+            return JPEG_SCALE_EIGHTH;
+        default:
+            return 0;
+    }
+}
+
+namespace Jpeg {
+
+/**
+ * @brief Decode a baseline JPEG from LittleFS straight to the screen
+ *
+ * @param path Path of the file on LittleFS
+ * @param posX Left edge of the image (viewport translation and clip apply)
+ * @param posY Top edge of the image
+ * @param scale 1, 2, 4, 8 or JPEG_SCALE_FIT
+ * @return Drawn size, scale and decode time; ok is false if the file could not be decoded
+ */
+auto drawFile(const String& path, int16_t posX, int16_t posY, uint8_t scale) -> JpegResult {
+    JpegResult result{false, 0, 0, 1, 0, JPEG_SUCCESS};
+    const std::unique_ptr<JPEGDEC> decoder(new (std::nothrow) JPEGDEC());
+
+    if (!decoder) {
+        result.error = JPEG_ERROR_MEMORY;
+        Logger::error("Not enough memory for the JPEG decoder", "Jpeg");
+        return result;
+    }
+
+    const uint32_t startUs = micros();
+
+    if (decoder->open(path.c_str(), jpegOpenFile, jpegCloseFile, jpegReadFile, jpegSeekFile, jpegDraw) == 0) {
+        result.error = decoder->getLastError();
+        Logger::error((String("Cannot open JPEG ") + path).c_str(), "Jpeg");
+        return result;
+    }
+
+    if (decoder->getJPEGType() != JPEG_MODE_BASELINE) {
+        decoder->close();
+        result.error = JPEG_UNSUPPORTED_FEATURE;
+        Logger::error((String("Not a baseline JPEG: ") + path).c_str(), "Jpeg");
+        return result;
+    }
+
+    result.scale = chooseScale(scale, decoder->getWidth(), decoder->getHeight());
+    result.width = static_cast<int16_t>((decoder->getWidth() + result.scale - 1) / result.scale);
+    result.height = static_cast<int16_t>((decoder->getHeight() + result.scale - 1) / result.scale);
+    s_target = JpegTarget{static_cast<int32_t>(posX) + result.width, static_cast<int32_t>(posY) + result.height};
+
+    decoder->setPixelType(RGB565_BIG_ENDIAN);
+    result.ok = decoder->decode(posX, posY, scaleOption(result.scale)) != 0;
+    result.error = decoder->getLastError();
+    decoder->close();
+
+    result.decodeUs = micros() - startUs;
+
+    if (result.ok) {
+        s_statImages++;
+        s_statTotalUs += result.decodeUs;
+        s_statLastUs = result.decodeUs;
+        s_statMaxUs = std::max(s_statMaxUs, result.decodeUs);
+    }
+
+    Logger::info((path + " " + String(result.width) + "x" + String(result.height) + " (1/" + String(result.scale) +
+                  ") in " + String(result.decodeUs) + " us")
+                     .c_str(),
+                 "Jpeg");
+
+    return result;
+}
+
+/**
+ * @brief Decode cost of the images drawn so far
+ *
+ * @return Count, last, average and worst decode time
+ */
+auto stats() -> JpegStats {
+    JpegStats stats{s_statImages, s_statLastUs, 0, s_statMaxUs};
+
+    if (s_statImages > 0) {
+        stats.avgUs = static_cast<uint32_t>(s_statTotalUs / s_statImages);
+    }
+
+    return stats;
+}
+
+}  // namespace Jpeg
@@ -0,0 +1,462 @@
+#include <LittleFS.h>
+#include <Logger.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "display/Macro.h"
+
+// Files hold the structures as laid out by this firmware, the version changes with them
+static constexpr std::array<char, 4> MACRO_MAGIC = {'H', 'M', 'A', 'C'};
+static constexpr uint8_t MACRO_FORMAT_VERSION = 1;
+static constexpr const char* MACRO_EXTENSION = ".mac";
+
+// Vertices a macro can keep, about the most a batch arena holds
+static constexpr size_t MACRO_MAX_VERTICES = DRAW_BATCH_ARENA_SIZE / sizeof(PathVertex) / 2;
+
+// A command binds each of its fields to one parameter at most and holds at most one gradient or path
+static constexpr size_t MACRO_MAX_BINDINGS = MACRO_MAX_COMMANDS * MACRO_MAX_PARAMS;
+
+/**
+ * @brief Start of a macro file, followed by the parameter names, commands, bindings, gradients, paths, vertices
+ * and the text pool
+ */
+struct MacroFileHeader {
+    std::array<char, 4> magic;
+    uint8_t version;
+    uint8_t params;
+    uint16_t commands;
+    uint16_t bindings;
+    uint16_t gradients;
+    uint16_t paths;
+    uint16_t vertices;
+    uint16_t textBytes;
+};
+
+static std::vector<MacroInfo> s_index;
+static MacroStats s_stats{};
+
+template <typename T>
+static auto writeArray(File& file, const std::vector<T>& items) -> bool {
+    const size_t bytes = items.size() * sizeof(T);
+    return bytes == 0 || file.write(reinterpret_cast<const uint8_t*>(items.data()), bytes) == bytes;
+}
+
+template <typename T>
+static auto readArray(File& file, std::vector<T>& items, size_t count) -> bool {
+    items.resize(count);
+    const size_t bytes = count * sizeof(T);
+    return bytes == 0 || file.read(reinterpret_cast<uint8_t*>(items.data()), bytes) == bytes;
+}
+
+static auto readHeader(File& file, MacroFileHeader& header) -> bool {
+    return file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+           header.magic == MACRO_MAGIC && header.version == MACRO_FORMAT_VERSION;
+}
+
+/**
+ * @brief Add a parameter slot
+ *
+ * @param name Parameter name (without the $)
+ * @return Its index, -1 when the name is too long or the macro has MACRO_MAX_PARAMS already
+ */
+auto MacroProgram::addParam(const char* name) -> int {
+    const size_t length = strlen(name);
+    if (length == 0 || length >= MACRO_PARAM_NAME_MAX || m_params.size() >= MACRO_MAX_PARAMS) {
+        return -1;
+    }
+
+    std::array<char, MACRO_PARAM_NAME_MAX> entry{};
+    memcpy(entry.data(), name, length);
+    m_params.push_back(entry);
+
+    return static_cast<int>(m_params.size() - 1);
+}
+
+/**
+ * @brief Index of a parameter, -1 when the macro has no such parameter
+ */
+auto MacroProgram::findParam(const char* name) const -> int {
+    for (size_t i = 0; i < m_params.size(); ++i) {
+        if (strcmp(m_params[i].data(), name) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Append a command, its text is copied into the text pool
+ *
+ * The ref of a Gradient or Path command must come from addGradient() / addPath()
+ *
+ * @return false when the macro has MACRO_MAX_COMMANDS already or the text pool is full
+ */
+auto MacroProgram::addCommand(const DrawCommand& command) -> bool {
+    if (m_commands.size() >= MACRO_MAX_COMMANDS) {
+        return false;
+    }
+
+    MacroCommand stored{command.op,    command.fill,  command.clearBg, command.size, command.alpha, command.hasBg,
+                        command.cap,   command.color, command.bg,      {},           MACRO_NO_TEXT, command.ref};
+    std::copy(command.args, command.args + DRAW_COMMAND_ARGS, stored.args);
+
+    if (command.text != nullptr) {
+        const size_t length = strlen(command.text) + 1;
+        if (m_text.size() + length > MACRO_MAX_TEXT_BYTES) {
+            return false;
+        }
+        stored.text = static_cast<uint16_t>(m_text.size());
+        m_text.insert(m_text.end(), command.text, command.text + length);
+    }
+
+    m_commands.push_back(stored);
+    return true;
+}
+
+/**
+ * @brief Let a parameter override one field of the last command added
+ */
+auto MacroProgram::bind(MacroField field, uint8_t param) -> void {
+    if (!m_commands.empty()) {
+        m_bindings.push_back(MacroBinding{static_cast<uint16_t>(m_commands.size() - 1), field, param});
+    }
+}
+
+auto MacroProgram::addGradient(const GradientSpec& spec) -> uint16_t {
+    m_gradients.push_back(spec);
+    return static_cast<uint16_t>(m_gradients.size() - 1);
+}
+
+/**
+ * @brief Copy a path (and its vertices) into the macro
+ *
+ * @return The value to put in the command's ref
+ */
+auto MacroProgram::addPath(const PathSpec& spec) -> uint16_t {
+    m_paths.push_back(MacroPath{static_cast<uint16_t>(m_vertices.size()), spec.count, spec.rule, spec.boundsX0,
+                                spec.boundsY0, spec.boundsX1, spec.boundsY1});
+    m_vertices.insert(m_vertices.end(), spec.vertices, spec.vertices + spec.count);
+    return static_cast<uint16_t>(m_paths.size() - 1);
+}
+
+/**
+ * @brief How the fields bound to a parameter read its value (MacroUse bits)
+ */
+auto MacroProgram::paramUses(size_t index) const -> uint8_t {
+    uint8_t uses = 0;
+    for (const MacroBinding& binding : m_bindings) {
+        if (binding.param != index) {
+            continue;
+        }
+        switch (binding.field) {
+            case MacroField::Color:
+            case MacroField::Bg:
+                uses |= MACRO_USE_COLOR;
+                break;
+            case MacroField::Text:
+                uses |= MACRO_USE_TEXT;
+                break;
+            default:
+                uses |= MACRO_USE_NUMBER;
+                break;
+        }
+    }
+    return uses;
+}
+
+/**
+ * @brief Append the commands to a batch, with the parameter values given
+ *
+ * @param batch The batch to fill
+ * @param args One value per parameter (paramCount() entries)
+ * @return false if the batch arena could not hold the path vertices (the paths are dropped)
+ */
+auto MacroProgram::expand(DrawBatch& batch, const MacroArg* args) const -> bool {
+    bool complete = true;
+    auto binding = m_bindings.begin();
+
+    for (size_t index = 0; index < m_commands.size(); ++index) {
+        const MacroCommand& stored = m_commands[index];
+        DrawCommand command{stored.op,    stored.fill, stored.clearBg, stored.size, stored.alpha, stored.hasBg,
+                            stored.color, stored.bg,   {},             nullptr,     stored.ref,   stored.cap};
+        std::copy(stored.args, stored.args + DRAW_COMMAND_ARGS, command.args);
+        command.text = (stored.text == MACRO_NO_TEXT) ? nullptr : m_text.data() + stored.text;
+
+        for (; binding != m_bindings.end() && binding->command == index; ++binding) {
+            const MacroArg& arg = args[binding->param];
+            if (!arg.set) {
+                continue;
+            }
+            switch (binding->field) {
+                case MacroField::Color:
+                    command.color = arg.color;
+                    break;
+                case MacroField::Bg:
+                    command.bg = arg.color;
+                    command.hasBg = true;
+                    break;
+                case MacroField::Text:
+                    command.text = (arg.text != nullptr) ? arg.text : command.text;
+                    break;
+                case MacroField::Size:
+                    command.size =
+                        static_cast<uint8_t>(std::clamp<int16_t>(arg.number, DRAW_TEXT_SIZE_MIN, DRAW_TEXT_SIZE_MAX));
+                    break;
+                case MacroField::Alpha:
+                    command.alpha = static_cast<uint8_t>(std::clamp<int16_t>(arg.number, 0, UINT8_MAX));
+                    break;
+                default:
+                    command.args[static_cast<uint8_t>(binding->field)] = arg.number;
+                    break;
+            }
+        }
+
+        if (command.op == DrawOp::Gradient) {
+            command.ref = batch.addGradient(m_gradients[stored.ref]);
+        } else if (command.op == DrawOp::Path) {
+            const MacroPath& path = m_paths[stored.ref];
+            auto* vertices = batch.arena().allocate<PathVertex>(path.count);
+            if (vertices == nullptr) {
+                complete = false;
+                continue;
+            }
+            std::copy(m_vertices.begin() + path.first, m_vertices.begin() + path.first + path.count, vertices);
+            command.ref = batch.addPath(PathSpec{vertices, path.count, path.rule, path.boundsX0, path.boundsY0,
+                                                 path.boundsX1, path.boundsY1});
+        }
+
+        batch.add(command);
+    }
+
+    return complete;
+}
+
+/**
+ * @brief Write the compiled macro to a file
+ */
+auto MacroProgram::save(File& file) const -> bool {
+    const MacroFileHeader header{MACRO_MAGIC,
+                                 MACRO_FORMAT_VERSION,
+                                 static_cast<uint8_t>(m_params.size()),
+                                 static_cast<uint16_t>(m_commands.size()),
+                                 static_cast<uint16_t>(m_bindings.size()),
+                                 static_cast<uint16_t>(m_gradients.size()),
+                                 static_cast<uint16_t>(m_paths.size()),
+                                 static_cast<uint16_t>(m_vertices.size()),
+                                 static_cast<uint16_t>(m_text.size())};
+
+    return file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+           writeArray(file, m_params) && writeArray(file, m_commands) && writeArray(file, m_bindings) &&
+           writeArray(file, m_gradients) && writeArray(file, m_paths) && writeArray(file, m_vertices) &&
+           writeArray(file, m_text);
+}
+
+/**
+ * @brief Read a compiled macro back, checking every index it holds
+ *
+ * @return false if the file is truncated, from another firmware layout or inconsistent
+ */
+auto MacroProgram::load(File& file) -> bool {
+    MacroFileHeader header{};
+    if (!readHeader(file, header) || header.params > MACRO_MAX_PARAMS || header.commands > MACRO_MAX_COMMANDS ||
+        header.bindings > MACRO_MAX_BINDINGS || header.gradients > header.commands ||
+        header.paths > header.commands || header.vertices > MACRO_MAX_VERTICES ||
+        header.textBytes > MACRO_MAX_TEXT_BYTES) {
+        return false;
+    }
+
+    if (!readArray(file, m_params, header.params) || !readArray(file, m_commands, header.commands) ||
+        !readArray(file, m_bindings, header.bindings) || !readArray(file, m_gradients, header.gradients) ||
+        !readArray(file, m_paths, header.paths) || !readArray(file, m_vertices, header.vertices) ||
+        !readArray(file, m_text, header.textBytes)) {
+        return false;
+    }
+
+    if (!m_text.empty() && m_text.back() != '\0') {
+        return false;
+    }
+    for (const MacroCommand& command : m_commands) {
+        const bool badText = command.text != MACRO_NO_TEXT && command.text >= m_text.size();
+        // Sprite pixels live in the batch that parsed them, a macro cannot hold one
+        const bool badRef = (command.op == DrawOp::Gradient && command.ref >= m_gradients.size()) ||
+                            (command.op == DrawOp::Path && command.ref >= m_paths.size()) ||
+                            command.op >= DrawOp::Sprite;
+        if (badText || badRef) {
+            return false;
+        }
+    }
+    for (const MacroBinding& binding : m_bindings) {
+        if (binding.command >= m_commands.size() || binding.param >= m_params.size() ||
+            binding.field > MacroField::Alpha) {
+            return false;
+        }
+    }
+    for (const MacroPath& path : m_paths) {
+        if (path.first + path.count > m_vertices.size()) {
+            return false;
+        }
+    }
+    for (auto& name : m_params) {
+        name.back() = '\0';
+    }
+
+    return true;
+}
+
+static auto macroPath(const char* name) -> String { return String(MACRO_DIR) + "/" + name + MACRO_EXTENSION; }
+
+static auto findEntry(const char* name) -> std::vector<MacroInfo>::iterator {
+    return std::find_if(s_index.begin(), s_index.end(),
+                        [name](const MacroInfo& info) { return strcmp(info.name.data(), name) == 0; });
+}
+
+namespace Macro {
+
+/**
+ * @brief Build the RAM index from the macro files, done once at boot
+ *
+ * Only the file headers are read. Files of another firmware layout are left out (upload them again)
+ */
+void loadIndex() {
+    s_index.clear();
+    if (!LittleFS.exists(MACRO_DIR)) {
+        return;
+    }
+
+    Dir dir = LittleFS.openDir(MACRO_DIR);
+    while (dir.next() && s_index.size() < MACRO_MAX_STORED) {
+        String fileName = dir.fileName();
+        if (!fileName.endsWith(MACRO_EXTENSION)) {
+            continue;
+        }
+        const String name = fileName.substring(0, fileName.length() - strlen(MACRO_EXTENSION));
+        if (!validName(name.c_str())) {
+            continue;
+        }
+
+        File file = dir.openFile("r");
+        MacroFileHeader header{};
+        if (!file || !readHeader(file, header)) {
+            Logger::warn(("Macro " + name + " skipped, stored by another firmware").c_str(), "Macro");
+            continue;
+        }
+
+        MacroInfo info{{}, header.commands, header.params, static_cast<uint32_t>(file.size())};
+        strncpy(info.name.data(), name.c_str(), info.name.size() - 1);
+        s_index.push_back(info);
+    }
+}
+
+/**
+ * @brief Whether a macro name is accepted: 1 to MACRO_NAME_MAX - 1 letters, digits, '_' or '-'
+ */
+auto validName(const char* name) -> bool {
+    const size_t length = strlen(name);
+    if (length == 0 || length >= MACRO_NAME_MAX) {
+        return false;
+    }
+    return std::all_of(name, name + length, [](char chr) { return isalnum(chr) != 0 || chr == '_' || chr == '-'; });
+}
+
+/**
+ * @brief Store a compiled macro, replacing one with the same name
+ *
+ * @return false if the name is invalid, the index is full or the file could not be written
+ */
+auto store(const char* name, const MacroProgram& program) -> bool {
+    auto entry = findEntry(name);
+    if (!validName(name) || (entry == s_index.end() && s_index.size() >= MACRO_MAX_STORED)) {
+        return false;
+    }
+    if (!LittleFS.exists(MACRO_DIR) && !LittleFS.mkdir(MACRO_DIR)) {
+        return false;
+    }
+
+    const String path = macroPath(name);
+    File file = LittleFS.open(path, "w");
+    if (!file) {
+        return false;
+    }
+    const bool written = program.save(file);
+    const auto bytes = static_cast<uint32_t>(file.size());
+    file.close();
+
+    if (!written) {
+        LittleFS.remove(path);
+        if (entry != s_index.end()) {
+            s_index.erase(entry);
+        }
+        return false;
+    }
+
+    MacroInfo info{{}, static_cast<uint16_t>(program.commandCount()), static_cast<uint8_t>(program.paramCount()),
+                   bytes};
+    strncpy(info.name.data(), name, info.name.size() - 1);
+    if (entry != s_index.end()) {
+        *entry = info;
+    } else {
+        s_index.push_back(info);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Delete a stored macro
+ *
+ * @return false if there is no macro with this name
+ */
+auto remove(const char* name) -> bool {
+    auto entry = findEntry(name);
+    if (entry == s_index.end()) {
+        return false;
+    }
+
+    LittleFS.remove(macroPath(name));
+    s_index.erase(entry);
+    return true;
+}
+
+/**
+ * @brief Read a compiled macro for an invocation
+ *
+ * An unknown name is answered from the index, without touching the file system
+ *
+ * @return The program, nullptr if there is no such macro or its file is unreadable
+ */
+auto load(const char* name) -> std::unique_ptr<MacroProgram> {
+    if (findEntry(name) == s_index.end()) {
+        s_stats.misses++;
+        return nullptr;
+    }
+
+    const uint32_t startUs = micros();
+    File file = LittleFS.open(macroPath(name), "r");
+    std::unique_ptr<MacroProgram> program(new (std::nothrow) MacroProgram());
+    if (!file || !program || !program->load(file)) {
+        Logger::warn(("Macro " + String(name) + " could not be read").c_str(), "Macro");
+        return nullptr;
+    }
+
+    s_stats.lastLoadUs = micros() - startUs;
+    return program;
+}
+
+/**
+ * @brief Stored macros, as kept in RAM
+ */
+auto index() -> const std::vector<MacroInfo>& { return s_index; }
+
+/**
+ * @brief Count an invocation and the time its expansion into a batch took
+ */
+void recordExpand(uint32_t elapsedUs) {
+    s_stats.invocations++;
+    s_stats.lastExpandUs = elapsedUs;
+}
+
+auto stats() -> MacroStats { return s_stats; }
+
+}  // namespace Macro
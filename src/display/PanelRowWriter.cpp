@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cstring>
+
+#include "display/PanelRowWriter.h"
+#include "display/DisplayManager.h"
+
+/**
+ * @brief Start a new image
+ *
+ * @param posX Left edge of the image
+ * @param posY Top edge of the image
+ * @param width Image width, at least 1
+ * @param height Image height
+ */
+void PanelRowWriter::begin(int16_t posX, int16_t posY, uint16_t width, uint16_t height) {
+    m_posX = posX;
+    m_posY = posY;
+    m_width = std::max<uint16_t>(width, 1);
+    m_height = height;
+    m_fill = 0;
+    m_row = 0;
+    m_column = 0;
+    updateLimit();
+}
+
+/**
+ * @brief Append count copies of a pixel
+ */
+void PanelRowWriter::pushRun(uint16_t color, uint32_t count) {
+    while (count > 0 && m_limit > 0) {
+        const uint32_t chunk = std::min(count, m_limit - m_fill);
+
+        std::fill_n(m_buffer.data() + m_fill, chunk, color);
+        m_fill += chunk;
+        count -= chunk;
+
+        if (m_fill == m_limit) {
+            flush();
+        }
+    }
+}
+
+/**
+ * @brief Append pixels that are already in panel byte order, copied as bytes
+ */
+void PanelRowWriter::pushBytes(const uint8_t* src, uint32_t count) {
+    while (count > 0 && m_limit > 0) {
+        const uint32_t chunk = std::min(count, m_limit - m_fill);
+
+        std::memcpy(m_buffer.data() + m_fill, src, chunk * sizeof(uint16_t));
+        m_fill += chunk;
+        src += chunk * sizeof(uint16_t);
+        count -= chunk;
+
+        if (m_fill == m_limit) {
+            flush();
+        }
+    }
+}
+
+/**
+ * @brief Send the buffered rows (or row segment) to the panel
+ */
+void PanelRowWriter::flush() {
+    if (m_fill == 0) {
+        return;
+    }
+
+    if (m_width <= PANEL_ROW_BUFFER_PIXELS) {
+        const auto rows = static_cast<uint16_t>(m_fill / m_width);
+
+        DisplayManager::blitPanel(m_posX, static_cast<int16_t>(m_posY + m_row), static_cast<int16_t>(m_width),
+                                  static_cast<int16_t>(rows), m_buffer.data(), static_cast<int16_t>(m_width));
+        m_row += rows;
+    } else {
+        DisplayManager::blitPanel(static_cast<int16_t>(m_posX + m_column), static_cast<int16_t>(m_posY + m_row),
+                                  static_cast<int16_t>(m_fill), 1, m_buffer.data(), static_cast<int16_t>(m_fill));
+        m_column += m_fill;
+        if (m_column == m_width) {
+            m_column = 0;
+            m_row++;
+        }
+    }
+
+    m_fill = 0;
+    updateLimit();
+}
+
+/**
+ * @brief Fill level of the next flush: as many whole rows as fit, or the rest of a wide row
+ */
+void PanelRowWriter::updateLimit() {
+    if (m_width <= PANEL_ROW_BUFFER_PIXELS) {
+        const uint32_t rows = std::min<uint32_t>(PANEL_ROW_BUFFER_PIXELS / m_width, m_height - m_row);
+        m_limit = rows * m_width;
+    } else {
+        m_limit = m_row < m_height ? std::min<uint32_t>(PANEL_ROW_BUFFER_PIXELS, m_width - m_column) : 0;
+    }
+}
@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "display/Path.h"
+#include "display/FixedMath.h"
+
+// Curves are split until the chord error is below 1/4 pixel, with at most this many segments
+static constexpr int32_t QUAD_MAX_SEGMENTS = 32;
+
+// Coordinates are clamped so that every vertex fits 12.4 fixed point
+static constexpr int32_t PATH_COORD_LIMIT = INT16_MAX;
+
+static auto clampCoord(int32_t value) -> int16_t {
+    return static_cast<int16_t>(std::min(std::max(value, -PATH_COORD_LIMIT), PATH_COORD_LIMIT));
+}
+
+/**
+ * @brief Construct a new PathBuilder object
+ *
+ * @param arena Arena receiving the vertices
+ * @param maxVertices Vertex budget of the path (contour breaks included)
+ */
+PathBuilder::PathBuilder(Arena& arena, uint16_t maxVertices) : m_arena(arena), m_maxVertices(maxVertices) {}
+
+/**
+ * @brief Append one vertex, the vertices must stay contiguous in the arena
+ */
+auto PathBuilder::append(PathVertex vertex) -> bool {
+    if (!m_ok || m_count >= m_maxVertices) {
+        m_ok = false;
+        return false;
+    }
+
+    auto* slot = m_arena.allocate<PathVertex>(1);
+    if (slot == nullptr || (m_vertices != nullptr && slot != m_vertices + m_count)) {
+        m_ok = false;
+        return false;
+    }
+
+    if (m_vertices == nullptr) {
+        m_vertices = slot;
+    }
+    *slot = vertex;
+    m_count++;
+
+    if (vertex.x != PATH_CONTOUR_BREAK.x || vertex.y != PATH_CONTOUR_BREAK.y) {
+        m_minX = std::min<int32_t>(m_minX, vertex.x);
+        m_minY = std::min<int32_t>(m_minY, vertex.y);
+        m_maxX = std::max<int32_t>(m_maxX, vertex.x);
+        m_maxY = std::max<int32_t>(m_maxY, vertex.y);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Start a new contour (the previous one is closed implicitly)
+ */
+auto PathBuilder::moveTo(int32_t posX, int32_t posY) -> bool {
+    if (m_contourOpen && !append(PATH_CONTOUR_BREAK)) {
+        return false;
+    }
+
+    m_startX = m_lastX = posX;
+    m_startY = m_lastY = posY;
+    m_contourOpen = true;
+
+    return append(PathVertex{clampCoord(posX), clampCoord(posY)});
+}
+
+/**
+ * @brief Straight segment from the current point
+ */
+auto PathBuilder::lineTo(int32_t posX, int32_t posY) -> bool {
+    if (!m_contourOpen) {
+        return moveTo(posX, posY);
+    }
+
+    m_lastX = posX;
+    m_lastY = posY;
+
+    return append(PathVertex{clampCoord(posX), clampCoord(posY)});
+}
+
+/**
+ * @brief Quadratic Bezier segment from the current point, flattened into lines
+ *
+ * The segment count comes from the second difference d = |p0 - 2p1 + p2|: the chord error of n segments is at most
+ * d / (4 n^2), so n = sqrt(d) / 2 keeps it within a quarter pixel (4 units of 1/16 pixel)
+ */
+auto PathBuilder::quadTo(int32_t controlX, int32_t controlY, int32_t posX, int32_t posY) -> bool {
+    if (!m_contourOpen) {
+        moveTo(m_lastX, m_lastY);
+    }
+
+    const int32_t startX = m_lastX;
+    const int32_t startY = m_lastY;
+    const int32_t bendX = std::abs(startX - 2 * controlX + posX);
+    const int32_t bendY = std::abs(startY - 2 * controlY + posY);
+    const auto bend = static_cast<uint32_t>(std::max(bendX, bendY));
+    const int32_t segments =
+        std::min<int32_t>(std::max<int32_t>(static_cast<int32_t>(FixedMath::isqrt(bend) / 2), 1), QUAD_MAX_SEGMENTS);
+    const int32_t total = segments * segments;
+
+    for (int32_t i = 1; i <= segments; ++i) {
+        const int32_t rest = segments - i;
+        // B(t) = p0 (1-t)^2 + 2 p1 t (1-t) + p2 t^2, with t = i / segments
+        const auto pointX = static_cast<int32_t>(
+            (static_cast<int64_t>(startX) * rest * rest + static_cast<int64_t>(2) * controlX * i * rest +
+             static_cast<int64_t>(posX) * i * i) /
+            total);
+        const auto pointY = static_cast<int32_t>(
+            (static_cast<int64_t>(startY) * rest * rest + static_cast<int64_t>(2) * controlY * i * rest +
+             static_cast<int64_t>(posY) * i * i) /
+            total);
+
+        if (!append(PathVertex{clampCoord(pointX), clampCoord(pointY)})) {
+            return false;
+        }
+    }
+
+    m_lastX = posX;
+    m_lastY = posY;
+
+    return true;
+}
+
+/**
+ * @brief Close the current contour, the next segment starts from its first point
+ */
+auto PathBuilder::close() -> bool {
+    m_lastX = m_startX;
+    m_lastY = m_startY;
+
+    if (m_contourOpen) {
+        m_contourOpen = false;
+        return append(PATH_CONTOUR_BREAK);
+    }
+
+    return m_ok;
+}
+
+/**
+ * @brief The path built so far
+ *
+ * @param rule Fill rule to attach
+ * @return The path, with count 0 if building failed
+ */
+auto PathBuilder::finish(FillRule rule) const -> PathSpec {
+    PathSpec spec{m_vertices, m_ok ? m_count : static_cast<uint16_t>(0), rule, 0, 0, 0, 0};
+
+    if (spec.count > 0 && m_minX <= m_maxX) {
+        // Pixel boxes of the sample points (pixel centers) inside the vertex bounds
+        spec.boundsX0 = static_cast<int16_t>(FixedMath::floorDiv(m_minX, PATH_SUBPIXEL_ONE));
+        spec.boundsY0 = static_cast<int16_t>(FixedMath::floorDiv(m_minY, PATH_SUBPIXEL_ONE));
+        spec.boundsX1 = static_cast<int16_t>(FixedMath::ceilDiv(m_maxX, PATH_SUBPIXEL_ONE) + 1);
+        spec.boundsY1 = static_cast<int16_t>(FixedMath::ceilDiv(m_maxY, PATH_SUBPIXEL_ONE) + 1);
+    }
+
+    return spec;
+}
+
+static auto skipSeparators(const char* cursor) -> const char* {
+    while (*cursor == ' ' || *cursor == ',' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r') {
+        ++cursor;
+    }
+    return cursor;
+}
+
+/**
+ * @brief Read a decimal number as 12.4 fixed point, without floating point
+ *
+ * @param cursor Parse position, advanced past the number
+ * @param value Receives the number in 1/16 pixel
+ * @return false if no number starts at the cursor
+ */
+static auto parseFixed(const char*& cursor, int32_t& value) -> bool {
+    const char* pos = skipSeparators(cursor);
+    bool negative = false;
+
+    if (*pos == '-' || *pos == '+') {
+        negative = (*pos == '-');
+        ++pos;
+    }
+    if ((*pos < '0' || *pos > '9') && *pos != '.') {
+        return false;
+    }
+
+    int32_t whole = 0;
+    while (*pos >= '0' && *pos <= '9') {
+        whole = std::min<int32_t>(whole * 10 + (*pos - '0'), PATH_COORD_LIMIT);
+        ++pos;
+    }
+
+    int32_t fraction = 0;  // in 1/16, rounded
+    if (*pos == '.') {
+        ++pos;
+        int32_t scale = 1;
+        int32_t digits = 0;
+        while (*pos >= '0' && *pos <= '9') {
+            if (scale < 100000) {
+                digits = digits * 10 + (*pos - '0');
+                scale *= 10;
+            }
+            ++pos;
+        }
+        fraction = (digits * PATH_SUBPIXEL_ONE + scale / 2) / scale;
+    }
+
+    const int32_t magnitude = whole * PATH_SUBPIXEL_ONE + fraction;
+    value = negative ? -magnitude : magnitude;
+    cursor = pos;
+
+    return true;
+}
+
+/**
+ * @brief Parse SVG-style path data into a builder
+ *
+ * Supports M/L/Q/Z and their relative forms m/l/q/z, with implicit repetition (extra pairs after M are lines).
+ * Numbers may be fractional
+ *
+ * @param data The path string, e.g. "M 10 10 L 100 10 Q 120 60 60 100 Z"
+ * @param builder The path receiving the segments
+ * @return false on a syntax error or when the vertex budget is exceeded
+ */
+auto parsePathData(const char* data, PathBuilder& builder) -> bool {
+    if (data == nullptr) {
+        return false;
+    }
+
+    const char* cursor = skipSeparators(data);
+    char command = 0;
+    int32_t currentX = 0;
+    int32_t currentY = 0;
+    int32_t startX = 0;
+    int32_t startY = 0;
+
+    while (*cursor != '\0') {
+        if ((*cursor >= 'A' && *cursor <= 'Z') || (*cursor >= 'a' && *cursor <= 'z')) {
+            command = *cursor++;
+        } else if (command == 0) {
+            return false;
+        }
+
+        const bool relative = (command >= 'a' && command <= 'z');
+        const int32_t baseX = relative ? currentX : 0;
+        const int32_t baseY = relative ? currentY : 0;
+        int32_t values[4] = {0, 0, 0, 0};
+
+        switch (command) {
+            case 'Z':
+            case 'z':
+                builder.close();
+                currentX = startX;
+                currentY = startY;
+                command = 0;
+                break;
+            case 'M':
+            case 'm':
+            case 'L':
+            case 'l':
+                if (!parseFixed(cursor, values[0]) || !parseFixed(cursor, values[1])) {
+                    return false;
+                }
+                currentX = baseX + values[0];
+                currentY = baseY + values[1];
+                if (command == 'M' || command == 'm') {
+                    builder.moveTo(currentX, currentY);
+                    startX = currentX;
+                    startY = currentY;
+                    command = relative ? 'l' : 'L';
+                } else {
+                    builder.lineTo(currentX, currentY);
+                }
+                break;
+            case 'Q':
+            case 'q':
+                for (int32_t& value : values) {
+                    if (!parseFixed(cursor, value)) {
+                        return false;
+                    }
+                }
+                builder.quadTo(baseX + values[0], baseY + values[1], baseX + values[2], baseY + values[3]);
+                currentX = baseX + values[2];
+                currentY = baseY + values[3];
+                break;
+            default:
+                return false;
+        }
+
+        if (!builder.ok()) {
+            return false;
+        }
+        cursor = skipSeparators(cursor);
+    }
+
+    return builder.ok();
+}
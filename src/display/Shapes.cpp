@@ -0,0 +1,550 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+#include "display/Shapes.h"
+#include "display/DisplayManager.h"
+#include "display/FixedMath.h"
+#include "display/Rgb565.h"
+
+// Spans are handed to the panel in groups, one bus transaction each
+static constexpr size_t SPAN_BUFFER_SIZE = 32;
+
+// Thick-line geometry is computed in 24.8 fixed point
+static constexpr uint8_t SUBPIXEL_SHIFT = 8;
+static constexpr int32_t SUBPIXEL_ONE = 1 << SUBPIXEL_SHIFT;
+
+// Line lengths are 28.4 fixed point
+static constexpr uint8_t LENGTH_SHIFT = 4;
+
+/**
+ * @brief Collects spans and flushes them to DisplayManager::fillSpans() when full
+ */
+class SpanWriter {
+   public:
+    SpanWriter() = default;
+    SpanWriter(const SpanWriter&) = delete;
+    auto operator=(const SpanWriter&) -> SpanWriter& = delete;
+    ~SpanWriter() { flush(); }
+
+    void add(int32_t x0, int32_t x1, int32_t row, uint16_t color) {
+        if (x0 >= x1 || row < INT16_MIN || row > INT16_MAX) {
+            return;
+        }
+
+        m_spans[m_count++] = Span{static_cast<int16_t>(std::max<int32_t>(x0, INT16_MIN)),
+                                  static_cast<int16_t>(std::min<int32_t>(x1, INT16_MAX)), static_cast<int16_t>(row),
+                                  color};
+        if (m_count == SPAN_BUFFER_SIZE) {
+            flush();
+        }
+    }
+
+    void plot(int32_t posX, int32_t posY, uint16_t color) { add(posX, posX + 1, posY, color); }
+
+    void flush() {
+        if (m_count == 0) {
+            return;
+        }
+        DisplayManager::fillSpans(m_spans.data(), m_count);
+        m_count = 0;
+    }
+
+   private:
+    std::array<Span, SPAN_BUFFER_SIZE> m_spans{};
+    size_t m_count = 0;
+};
+
+/**
+ * @brief Inclusive range of x, empty when lo > hi
+ */
+struct XRange {
+    int32_t lo;
+    int32_t hi;
+};
+
+static constexpr XRange RANGE_ALL{INT32_MIN, INT32_MAX};
+static constexpr XRange RANGE_NONE{1, 0};
+
+static auto rangeIntersect(const XRange& first, const XRange& second) -> XRange {
+    return XRange{std::max(first.lo, second.lo), std::min(first.hi, second.hi)};
+}
+
+/**
+ * @brief Solve factor * x <= bound for integer x
+ */
+static auto solveLessEqual(int32_t factor, int32_t bound) -> XRange {
+    if (factor > 0) {
+        return XRange{INT32_MIN, FixedMath::floorDiv(bound, factor)};
+    }
+    if (factor < 0) {
+        return XRange{FixedMath::ceilDiv(bound, factor), INT32_MAX};
+    }
+    return bound >= 0 ? RANGE_ALL : RANGE_NONE;
+}
+
+/**
+ * @brief Draw an anti-aliased hairline (Xiaolin Wu)
+ *
+ * A 16-bit error accumulator tracks the fractional position along the minor axis, its top 8 bits weight the two
+ * pixels straddling the ideal line. One division per line
+ *
+ * @param color Line color
+ * @param backdrop The color under the line
+ */
+void Shapes::drawLineAA(int16_t startX, int16_t startY, int16_t endX, int16_t endY, uint16_t color,
+                        uint16_t backdrop) {
+    int32_t x0 = startX;
+    int32_t y0 = startY;
+    int32_t x1 = endX;
+    int32_t y1 = endY;
+
+    if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    const int32_t stepX = (x1 >= x0) ? 1 : -1;
+    int32_t deltaX = std::abs(x1 - x0);
+    int32_t deltaY = y1 - y0;
+    SpanWriter writer;
+
+    // Axis-aligned and 45-degree lines need no blending
+    if (deltaY == 0) {
+        writer.add(std::min(x0, x1), std::max(x0, x1) + 1, y0, color);
+        return;
+    }
+    if (deltaX == 0 || deltaX == deltaY) {
+        for (int32_t i = 0; i <= deltaY; ++i) {
+            writer.plot(x0 + stepX * (deltaX == 0 ? 0 : i), y0 + i, color);
+        }
+        return;
+    }
+
+    writer.plot(x0, y0, color);
+
+    uint16_t error = 0;
+    if (deltaY > deltaX) {
+        // y-major: one pixel pair per row
+        const auto adjust = static_cast<uint16_t>((static_cast<uint32_t>(deltaX) << 16U) / deltaY);
+        while (--deltaY > 0) {
+            const uint16_t previous = error;
+            error = static_cast<uint16_t>(error + adjust);
+            if (error <= previous) {
+                x0 += stepX;
+            }
+            y0++;
+
+            const auto weight = static_cast<uint8_t>(error >> 8U);
+            writer.plot(x0, y0, Rgb565::blend(color, backdrop, static_cast<uint8_t>(UINT8_MAX - weight)));
+            if (weight != 0) {
+                writer.plot(x0 + stepX, y0, Rgb565::blend(color, backdrop, weight));
+            }
+        }
+    } else {
+        // x-major: one pixel pair per column
+        const auto adjust = static_cast<uint16_t>((static_cast<uint32_t>(deltaY) << 16U) / deltaX);
+        while (--deltaX > 0) {
+            const uint16_t previous = error;
+            error = static_cast<uint16_t>(error + adjust);
+            if (error <= previous) {
+                y0++;
+            }
+            x0 += stepX;
+
+            const auto weight = static_cast<uint8_t>(error >> 8U);
+            writer.plot(x0, y0, Rgb565::blend(color, backdrop, static_cast<uint8_t>(UINT8_MAX - weight)));
+            if (weight != 0) {
+                writer.plot(x0, y0 + 1, Rgb565::blend(color, backdrop, weight));
+            }
+        }
+    }
+
+    writer.plot(x1, y1, color);
+}
+
+/**
+ * @brief Length of a vector in 28.4 fixed point
+ */
+static auto vectorLength(int32_t deltaX, int32_t deltaY) -> int64_t {
+    const uint64_t length2 = static_cast<uint64_t>(static_cast<int64_t>(deltaX) * deltaX +
+                                                   static_cast<int64_t>(deltaY) * deltaY);
+
+    if (length2 <= (UINT32_MAX >> (2U * LENGTH_SHIFT))) {
+        return FixedMath::isqrt(static_cast<uint32_t>(length2 << (2U * LENGTH_SHIFT)));
+    }
+    // Long lines (mostly off screen) lose the fractional bits only
+    return static_cast<int64_t>(FixedMath::isqrt(static_cast<uint32_t>(std::min<uint64_t>(length2, UINT32_MAX))))
+           << LENGTH_SHIFT;
+}
+
+/**
+ * @brief Fill a convex quadrilateral given in 24.8 fixed point, pixel centers on integer coordinates
+ */
+static void fillConvexQuad(const std::array<int32_t, 8>& corners, uint16_t color, SpanWriter& writer) {
+    int32_t top = INT32_MAX;
+    int32_t bottom = INT32_MIN;
+    for (uint8_t i = 0; i < 4; ++i) {
+        top = std::min(top, corners[2 * i + 1]);
+        bottom = std::max(bottom, corners[2 * i + 1]);
+    }
+
+    const int32_t firstRow = FixedMath::ceilDiv(top, SUBPIXEL_ONE);
+    const int32_t lastRow = FixedMath::floorDiv(bottom, SUBPIXEL_ONE);
+
+    for (int32_t row = firstRow; row <= lastRow; ++row) {
+        const int32_t scanY = row * SUBPIXEL_ONE;
+        int32_t left = INT32_MAX;
+        int32_t right = INT32_MIN;
+
+        for (uint8_t i = 0; i < 4; ++i) {
+            const int32_t ax = corners[2 * i];
+            const int32_t ay = corners[2 * i + 1];
+            const int32_t bx = corners[(2 * i + 2) % 8];
+            const int32_t by = corners[(2 * i + 3) % 8];
+
+            if (ay == by || scanY < std::min(ay, by) || scanY > std::max(ay, by)) {
+                continue;
+            }
+
+            const auto crossX =
+                static_cast<int32_t>(ax + (static_cast<int64_t>(scanY - ay) * (bx - ax)) / (by - ay));
+            left = std::min(left, crossX);
+            right = std::max(right, crossX);
+        }
+
+        if (left <= right) {
+            writer.add(FixedMath::ceilDiv(left, SUBPIXEL_ONE), FixedMath::floorDiv(right, SUBPIXEL_ONE) + 1, row,
+                       color);
+        }
+    }
+}
+
+/**
+ * @brief Draw a line of any width as a filled quadrilateral with caps
+ *
+ * The half-width normal is found with one integer square root per line, the body is then filled span by span
+ *
+ * @param width Line width in pixels (1 falls back to a plain line)
+ * @param cap End finish
+ * @param color Line color
+ */
+void Shapes::drawThickLine(int16_t startX, int16_t startY, int16_t endX, int16_t endY, uint8_t width, LineCap cap,
+                           uint16_t color) {
+    if (width <= 1) {
+        DisplayManager::drawLine(startX, startY, endX, endY, color);
+        return;
+    }
+
+    const int32_t deltaX = static_cast<int32_t>(endX) - startX;
+    const int32_t deltaY = static_cast<int32_t>(endY) - startY;
+    const auto radius = static_cast<int16_t>((width - 1) / 2);
+
+    const int64_t length = vectorLength(deltaX, deltaY);
+
+    if (length == 0) {
+        if (cap == LineCap::Round) {
+            DisplayManager::fillCircle(startX, startY, radius, color);
+        } else {
+            DisplayManager::fillRect(static_cast<int16_t>(startX - radius), static_cast<int16_t>(startY - radius),
+                                     static_cast<int16_t>(2 * radius + 1), static_cast<int16_t>(2 * radius + 1), color);
+        }
+        return;
+    }
+
+    // Half-width along the normal and along the line, 24.8 (the length is 28.4)
+    const int64_t half = (static_cast<int64_t>(width) << (SUBPIXEL_SHIFT + LENGTH_SHIFT)) / 2;
+    const auto normalX = static_cast<int32_t>(-deltaY * half / length);
+    const auto normalY = static_cast<int32_t>(deltaX * half / length);
+    const auto extendX = static_cast<int32_t>((cap == LineCap::Square) ? deltaX * half / length : 0);
+    const auto extendY = static_cast<int32_t>((cap == LineCap::Square) ? deltaY * half / length : 0);
+
+    const int32_t ax = (static_cast<int32_t>(startX) << SUBPIXEL_SHIFT) - extendX;
+    const int32_t ay = (static_cast<int32_t>(startY) << SUBPIXEL_SHIFT) - extendY;
+    const int32_t bx = (static_cast<int32_t>(endX) << SUBPIXEL_SHIFT) + extendX;
+    const int32_t by = (static_cast<int32_t>(endY) << SUBPIXEL_SHIFT) + extendY;
+
+    {
+        SpanWriter writer;
+        fillConvexQuad({ax + normalX, ay + normalY, bx + normalX, by + normalY, bx - normalX, by - normalY,
+                        ax - normalX, ay - normalY},
+                       color, writer);
+    }
+
+    if (cap == LineCap::Round) {
+        DisplayManager::fillCircle(startX, startY, radius, color);
+        DisplayManager::fillCircle(endX, endY, radius, color);
+    }
+}
+
+/**
+ * @brief Fill an arc of a ring, a full ring or a pie slice
+ *
+ * Angles are in degrees, clockwise from 12 o'clock. Each row of the ring is cut by the two radii bounding the
+ * sweep: both are half-planes, so a row keeps one or two x ranges found with a division per row, and the pixels
+ * are never tested one by one. Directions come from the sine table
+ *
+ * @param radius Outer radius
+ * @param thickness Ring thickness in pixels, radius or more gives a pie slice
+ * @param startDeg Start angle
+ * @param sweepDeg Sweep, negative for counter-clockwise, 360 or more for a full ring
+ * @param cap End finish (Round adds half discs, the others cut the ends radially)
+ * @param color Fill color
+ */
+void Shapes::fillArc(int16_t centerX, int16_t centerY, int16_t radius, int16_t thickness, int16_t startDeg,
+                     int16_t sweepDeg, LineCap cap, uint16_t color) {
+    constexpr int32_t DEGREES_FULL = 360;
+    constexpr int32_t DEGREES_HALF = 180;
+
+    if (radius <= 0 || thickness <= 0 || sweepDeg == 0) {
+        return;
+    }
+
+    int32_t start = startDeg;
+    int32_t sweep = sweepDeg;
+    if (sweep < 0) {
+        start += sweep;
+        sweep = -sweep;
+    }
+    const bool full = sweep >= DEGREES_FULL;
+
+    const int32_t outer = radius;
+    const int32_t inner = std::max<int32_t>(outer - thickness + 1, 0);
+
+    // Bounding radii as (sin, -cos): screen y grows downwards, so clockwise is a positive cross product
+    const int32_t startAngle = FixedMath::fromDegrees(start);
+    const int32_t endAngle = FixedMath::fromDegrees(start + sweep);
+    const int32_t startDirX = FixedMath::sin(startAngle);
+    const int32_t startDirY = -FixedMath::cos(startAngle);
+    const int32_t endDirX = FixedMath::sin(endAngle);
+    const int32_t endDirY = -FixedMath::cos(endAngle);
+
+    {
+        SpanWriter writer;
+
+        for (int32_t dy = -outer; dy <= outer; ++dy) {
+            // Ring pixels satisfy (inner - 1/2)^2 <= d^2 <= (outer + 1/2)^2
+            const int32_t outer2 = outer * outer + outer - dy * dy;
+            if (outer2 < 0) {
+                continue;
+            }
+
+            const auto outerX = static_cast<int32_t>(FixedMath::isqrt(static_cast<uint32_t>(outer2)));
+            const int32_t inner2 = inner * inner - inner - dy * dy;
+            const int32_t holeX =
+                (inner2 > 0) ? static_cast<int32_t>(FixedMath::isqrt(static_cast<uint32_t>(inner2 - 1))) : -1;
+
+            std::array<XRange, 2> ring{};
+            uint8_t ringCount = 0;
+            if (holeX < 0) {
+                ring[ringCount++] = XRange{-outerX, outerX};
+            } else {
+                ring[ringCount++] = XRange{-outerX, -holeX - 1};
+                ring[ringCount++] = XRange{holeX + 1, outerX};
+            }
+
+            std::array<XRange, 2> sector{RANGE_ALL, RANGE_NONE};
+            if (!full) {
+                // cross(start, p) >= 0 and cross(p, end) >= 0, with p = (x, dy)
+                const XRange afterStart = solveLessEqual(startDirY, startDirX * dy);
+                const XRange beforeEnd = solveLessEqual(-endDirY, -endDirX * dy);
+
+                if (sweep <= DEGREES_HALF) {
+                    sector[0] = rangeIntersect(afterStart, beforeEnd);
+                } else {
+                    sector[0] = afterStart;
+                    sector[1] = beforeEnd;
+                }
+            }
+
+            for (uint8_t r = 0; r < ringCount; ++r) {
+                const XRange first = rangeIntersect(ring[r], sector[0]);
+                const XRange second = rangeIntersect(ring[r], sector[1]);
+
+                if (first.lo <= first.hi && second.lo <= second.hi && second.lo <= first.hi + 1 &&
+                    first.lo <= second.hi + 1) {
+                    // Overlapping pieces of a wide sweep: one span
+                    writer.add(centerX + std::min(first.lo, second.lo), centerX + std::max(first.hi, second.hi) + 1,
+                               centerY + dy, color);
+                    continue;
+                }
+                if (first.lo <= first.hi) {
+                    writer.add(centerX + first.lo, centerX + first.hi + 1, centerY + dy, color);
+                }
+                if (second.lo <= second.hi) {
+                    writer.add(centerX + second.lo, centerX + second.hi + 1, centerY + dy, color);
+                }
+            }
+        }
+    }
+
+    if (cap == LineCap::Round && !full && outer > inner) {
+        // Half discs centred on the mid radius at both ends
+        const int32_t middle = outer + inner;  // twice the mid radius
+        const auto capRadius = static_cast<int16_t>((outer - inner) / 2);
+        const int32_t roundShift = FixedMath::ONE_SHIFT + 1;
+
+        DisplayManager::fillCircle(static_cast<int16_t>(centerX + ((middle * startDirX) >> roundShift)),
+                                   static_cast<int16_t>(centerY + ((middle * startDirY) >> roundShift)), capRadius,
+                                   color);
+        DisplayManager::fillCircle(static_cast<int16_t>(centerX + ((middle * endDirX) >> roundShift)),
+                                   static_cast<int16_t>(centerY + ((middle * endDirY) >> roundShift)), capRadius,
+                                   color);
+    }
+}
+
+/**
+ * @brief Edge of a path, stepped one row at a time
+ */
+struct PathEdge {
+    int32_t x;     // crossing of the current row's sample line, 16.16 pixels
+    int32_t step;  // change of x per row, 16.16
+    int16_t firstRow;
+    int16_t endRow;  // exclusive
+    int8_t winding;  // +1 downwards, -1 upwards
+};
+
+/**
+ * @brief Turn the contours of a path into edges, horizontal edges are dropped
+ *
+ * Rows are sampled through pixel centers (y + 1/2), so a row crosses an edge when the edge spans its center line
+ *
+ * @return Number of edges written
+ */
+static auto buildPathEdges(const PathSpec& path, PathEdge* edges) -> uint16_t {
+    constexpr int32_t HALF = PATH_SUBPIXEL_ONE / 2;
+    constexpr uint8_t TO_16_16 = 16 - PATH_SUBPIXEL_SHIFT;
+    uint16_t count = 0;
+    uint16_t contourStart = 0;
+
+    for (uint16_t i = 0; i <= path.count; ++i) {
+        const bool atEnd = (i == path.count) || (path.vertices[i].x == PATH_CONTOUR_BREAK.x &&
+                                                 path.vertices[i].y == PATH_CONTOUR_BREAK.y);
+        if (!atEnd) {
+            continue;
+        }
+
+        // Edges of the contour [contourStart, i), closed back to its first vertex
+        for (uint16_t v = contourStart; v < i; ++v) {
+            const PathVertex& from = path.vertices[v];
+            const PathVertex& to = path.vertices[(v + 1U < i) ? v + 1U : contourStart];
+            if (from.y == to.y) {
+                continue;
+            }
+
+            const bool down = from.y < to.y;
+            const PathVertex& top = down ? from : to;
+            const PathVertex& bottom = down ? to : from;
+            const int32_t firstRow = FixedMath::ceilDiv(top.y - HALF, PATH_SUBPIXEL_ONE);
+            const int32_t endRow = FixedMath::ceilDiv(bottom.y - HALF, PATH_SUBPIXEL_ONE);
+            if (firstRow >= endRow) {
+                continue;
+            }
+
+            const int64_t spanX = static_cast<int64_t>(bottom.x - top.x) << TO_16_16;
+            const int32_t spanY = bottom.y - top.y;
+            const int32_t sampleY = firstRow * PATH_SUBPIXEL_ONE + HALF;
+
+            PathEdge& edge = edges[count++];
+            edge.x =
+                static_cast<int32_t>((static_cast<int64_t>(top.x) << TO_16_16) + spanX * (sampleY - top.y) / spanY);
+            edge.step = static_cast<int32_t>(spanX * PATH_SUBPIXEL_ONE / spanY);
+            edge.firstRow = static_cast<int16_t>(firstRow);
+            edge.endRow = static_cast<int16_t>(endRow);
+            edge.winding = down ? 1 : -1;
+        }
+
+        contourStart = i + 1U;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Fill a path with an active-edge-table scanline rasterizer
+ *
+ * Edges are sorted by their first row once. Each row adds the edges starting there, drops the finished ones,
+ * keeps the active list sorted by x (insertion sort, the order barely changes between rows) and emits the spans
+ * inside the path under the fill rule. Pixels are covered when their center is inside, so adjacent paths sharing an
+ * edge never overlap. Edge tables are taken from the scratch arena and given back before returning
+ *
+ * @param path The flattened path
+ * @param color Fill color
+ * @param scratch Arena for the edge tables
+ * @return false if the arena could not hold the edge tables
+ */
+auto Shapes::fillPath(const PathSpec& path, uint16_t color, Arena& scratch) -> bool {
+    if (path.vertices == nullptr || path.count < 3) {
+        return true;
+    }
+
+    const size_t mark = scratch.mark();
+    auto* edges = scratch.allocate<PathEdge>(path.count);
+    auto* active = scratch.allocate<uint16_t>(path.count);
+    if (edges == nullptr || active == nullptr) {
+        scratch.rewind(mark);
+        return false;
+    }
+
+    const uint16_t edgeCount = buildPathEdges(path, edges);
+    std::sort(edges, edges + edgeCount,
+              [](const PathEdge& first, const PathEdge& second) { return first.firstRow < second.firstRow; });
+
+    int32_t lastRow = INT32_MIN;
+    for (uint16_t e = 0; e < edgeCount; ++e) {
+        lastRow = std::max<int32_t>(lastRow, edges[e].endRow);
+    }
+
+    {
+        SpanWriter writer;
+        uint16_t next = 0;
+        uint16_t activeCount = 0;
+
+        for (int32_t row = (edgeCount > 0) ? edges[0].firstRow : 0; row < lastRow; ++row) {
+            // Retire finished edges, then admit the ones starting on this row
+            uint16_t kept = 0;
+            for (uint16_t a = 0; a < activeCount; ++a) {
+                if (edges[active[a]].endRow > row) {
+                    active[kept++] = active[a];
+                }
+            }
+            activeCount = kept;
+            while (next < edgeCount && edges[next].firstRow == row) {
+                active[activeCount++] = next++;
+            }
+
+            for (uint16_t a = 1; a < activeCount; ++a) {
+                const uint16_t moving = active[a];
+                uint16_t b = a;
+                while (b > 0 && edges[active[b - 1U]].x > edges[moving].x) {
+                    active[b] = active[b - 1U];
+                    b--;
+                }
+                active[b] = moving;
+            }
+
+            // Walk the crossings left to right, a span is emitted whenever the fill rule says "inside"
+            int32_t winding = 0;
+            for (uint16_t a = 0; a + 1U < activeCount; ++a) {
+                const PathEdge& edge = edges[active[a]];
+                winding += (path.rule == FillRule::EvenOdd) ? 1 : edge.winding;
+
+                const bool inside = (path.rule == FillRule::EvenOdd) ? (winding & 1) != 0 : winding != 0;
+                if (inside) {
+                    // First and last pixel whose center lies in [x, nextX)
+                    constexpr int32_t HALF_PIXEL = 1 << 15;
+                    const int32_t x0 = (edge.x - HALF_PIXEL + 0xFFFF) >> 16;
+                    const int32_t x1 = (edges[active[a + 1U]].x - HALF_PIXEL + 0xFFFF) >> 16;
+                    writer.add(x0, x1, row, color);
+                }
+            }
+
+            for (uint16_t a = 0; a < activeCount; ++a) {
+                edges[active[a]].x += edges[active[a]].step;
+            }
+        }
+    }
+
+    scratch.rewind(mark);
+    return true;
+}
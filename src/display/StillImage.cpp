@@ -0,0 +1,431 @@
+#include <LittleFS.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "display/StillImage.h"
+#include "display/DisplayManager.h"
+#include "display/Rgb565.h"
+
+// QOI ops: two 8-bit tags, four 2-bit tags with a 6-bit payload
+static constexpr uint8_t QOI_OP_RGB = 0xFE;
+static constexpr uint8_t QOI_OP_RGBA = 0xFF;
+static constexpr uint8_t QOI_OP_INDEX = 0x00;
+static constexpr uint8_t QOI_OP_DIFF = 0x40;
+static constexpr uint8_t QOI_OP_LUMA = 0x80;
+static constexpr uint8_t QOI_TAG_MASK = 0xC0;
+static constexpr uint8_t QOI_PAYLOAD_MASK = 0x3F;
+static constexpr uint8_t QOI_INDEX_MASK = 63;
+static constexpr size_t QOI_HEADER_SIZE = 14;
+
+static constexpr size_t R565_HEADER_SIZE = 12;
+static constexpr uint8_t R565_ENCODING_RAW = 0;
+static constexpr uint8_t R565_ENCODING_RLE = 1;
+static constexpr uint8_t RLE_RUN_FLAG = 0x80;
+static constexpr uint8_t RLE_RUN_BIAS = 126;
+static constexpr size_t RLE_RUN_SIZE = 3;
+
+static constexpr size_t STILL_MAGIC_SIZE = 4;
+static constexpr size_t STILL_FILE_CHUNK = 512;
+
+static auto readBe16(const uint8_t* src) -> uint32_t { return (static_cast<uint32_t>(src[0]) << 8U) | src[1]; }
+
+static auto readBe32(const uint8_t* src) -> uint32_t { return (readBe16(src) << 16U) | readBe16(src + 2); }
+
+// Bytes of a big-endian pixel, unchanged, as they must reach the panel
+static auto loadPanelPixel(const uint8_t* src) -> uint16_t {
+    uint16_t pixel = 0;
+    std::memcpy(&pixel, src, sizeof(pixel));
+    return pixel;
+}
+
+static auto formatFromMagic(const uint8_t* magic) -> StillFormat {
+    if (std::memcmp(magic, "qoif", STILL_MAGIC_SIZE) == 0) {
+        return StillFormat::Qoi;
+    }
+    if (std::memcmp(magic, "R565", STILL_MAGIC_SIZE) == 0) {
+        return StillFormat::Rgb565;
+    }
+    return StillFormat::None;
+}
+
+/**
+ * @brief Construct a new StillDecoder object
+ *
+ * @param posX Left edge of the image (viewport translation and clip apply)
+ * @param posY Top edge of the image
+ */
+StillDecoder::StillDecoder(int16_t posX, int16_t posY) : m_posX(posX), m_posY(posY) {}
+
+/**
+ * @brief Decode the next piece of the image
+ *
+ * @param data Next bytes of the file
+ * @param len Number of bytes
+ * @return false once the data turned out not to be a valid QOI or R565 image
+ */
+auto StillDecoder::feed(const uint8_t* data, size_t len) -> bool {
+    const uint32_t startUs = micros();
+
+    while (len > 0 && m_state != State::Done && m_state != State::Error) {
+        if (m_carryLen > 0) {
+            // Complete the unit cut by the previous chunk, then continue in place
+            const size_t take = std::min(len, STILL_CARRY_MAX - m_carryLen);
+            std::memcpy(m_carry.data() + m_carryLen, data, take);
+
+            const size_t used = consume(m_carry.data(), m_carryLen + take);
+            if (used < m_carryLen) {
+                m_carryLen += take;
+                data += take;
+                len -= take;
+                if (m_carryLen == STILL_CARRY_MAX) {
+                    m_state = State::Error;
+                }
+                continue;
+            }
+
+            data += used - m_carryLen;
+            len -= used - m_carryLen;
+            m_carryLen = 0;
+            continue;
+        }
+
+        const size_t used = consume(data, len);
+        data += used;
+        len -= used;
+
+        if (used == 0 && m_state != State::Done && m_state != State::Error) {
+            // Only the start of a unit is left
+            if (len >= STILL_CARRY_MAX) {
+                m_state = State::Error;
+                break;
+            }
+            std::memcpy(m_carry.data(), data, len);
+            m_carryLen = len;
+            len = 0;
+        }
+    }
+
+    m_busyUs += micros() - startUs;
+
+    return m_state != State::Error;
+}
+
+/**
+ * @brief Size, format and decode time so far; ok once every pixel was decoded
+ */
+auto StillDecoder::result() const -> StillResult {
+    return StillResult{m_state == State::Done, m_format, static_cast<int16_t>(m_width), static_cast<int16_t>(m_height),
+                       m_busyUs};
+}
+
+/**
+ * @brief Decode the complete units at the start of data
+ *
+ * @return Number of bytes used, the rest starts with an incomplete unit
+ */
+auto StillDecoder::consume(const uint8_t* data, size_t len) -> size_t {
+    size_t used = 0;
+
+    switch (m_state) {
+        case State::Header:
+            return consumeHeader(data, len);
+        case State::Qoi:
+            used = consumeQoi(data, len);
+            break;
+        case State::Raw:
+            used = consumeRaw(data, len);
+            break;
+        case State::Rle:
+            used = consumeRle(data, len);
+            break;
+        default:
+            return 0;
+    }
+
+    if (m_remaining == 0) {
+        m_state = State::Done;
+    }
+
+    return used;
+}
+
+auto StillDecoder::consumeHeader(const uint8_t* data, size_t len) -> size_t {
+    if (len < STILL_MAGIC_SIZE) {
+        return 0;
+    }
+
+    switch (formatFromMagic(data)) {
+        case StillFormat::Qoi:
+            if (len < QOI_HEADER_SIZE) {
+                return 0;
+            }
+            return start(StillFormat::Qoi, readBe32(data + 4), readBe32(data + 8), State::Qoi) ? QOI_HEADER_SIZE : 0;
+        case StillFormat::Rgb565:
+            if (len < R565_HEADER_SIZE) {
+                return 0;
+            }
+            if (data[8] != R565_ENCODING_RAW && data[8] != R565_ENCODING_RLE) {
+                m_state = State::Error;
+                return 0;
+            }
+            return start(StillFormat::Rgb565, readBe16(data + 4), readBe16(data + 6),
+                         data[8] == R565_ENCODING_RLE ? State::Rle : State::Raw)
+                       ? R565_HEADER_SIZE
+                       : 0;
+        default:
+            m_state = State::Error;
+            return 0;
+    }
+}
+
+/**
+ * @brief Set up the output for the image size read from the header
+ */
+auto StillDecoder::start(StillFormat format, uint32_t width, uint32_t height, State body) -> bool {
+    if (width == 0 || height == 0 || width > STILL_MAX_SIDE || height > STILL_MAX_SIDE) {
+        m_state = State::Error;
+        return false;
+    }
+
+    m_format = format;
+    m_width = static_cast<uint16_t>(width);
+    m_height = static_cast<uint16_t>(height);
+    m_remaining = width * height;
+    m_backdrop = DisplayManager::backdropColor();
+    m_previousColor = qoiColor(m_previous);
+    m_state = body;
+    m_output.begin(m_posX, m_posY, m_width, m_height);
+
+    return true;
+}
+
+/**
+ * @brief Decode QOI ops, following the reference decoder (the index is updated after every op)
+ */
+auto StillDecoder::consumeQoi(const uint8_t* data, size_t len) -> size_t {
+    size_t pos = 0;
+
+    while (m_remaining > 0 && pos < len) {
+        const uint8_t op = data[pos];
+        size_t size = 1;
+
+        if (op == QOI_OP_RGB) {
+            size = 4;
+        } else if (op == QOI_OP_RGBA) {
+            size = 5;
+        } else if ((op & QOI_TAG_MASK) == QOI_OP_LUMA) {
+            size = 2;
+        }
+        if (pos + size > len) {
+            break;
+        }
+
+        QoiPixel pixel = m_previous;
+        uint32_t run = 1;
+
+        if (op == QOI_OP_RGB || op == QOI_OP_RGBA) {
+            pixel.r = data[pos + 1];
+            pixel.g = data[pos + 2];
+            pixel.b = data[pos + 3];
+            if (op == QOI_OP_RGBA) {
+                pixel.a = data[pos + 4];
+            }
+        } else {
+            switch (op & QOI_TAG_MASK) {
+                case QOI_OP_INDEX:
+                    pixel = m_index[op];
+                    break;
+                case QOI_OP_DIFF:
+                    pixel.r = static_cast<uint8_t>(pixel.r + ((op >> 4U) & 0x03U) - 2);
+                    pixel.g = static_cast<uint8_t>(pixel.g + ((op >> 2U) & 0x03U) - 2);
+                    pixel.b = static_cast<uint8_t>(pixel.b + (op & 0x03U) - 2);
+                    break;
+                case QOI_OP_LUMA: {
+                    const int32_t deltaG = static_cast<int32_t>(op & QOI_PAYLOAD_MASK) - 32;
+                    const uint8_t second = data[pos + 1];
+                    pixel.r = static_cast<uint8_t>(pixel.r + deltaG - 8 + (second >> 4U));
+                    pixel.g = static_cast<uint8_t>(pixel.g + deltaG);
+                    pixel.b = static_cast<uint8_t>(pixel.b + deltaG - 8 + (second & 0x0FU));
+                    break;
+                }
+                default:  // run: 11xxxxxx
+                    run = (op & QOI_PAYLOAD_MASK) + 1U;
+                    break;
+            }
+        }
+        pos += size;
+
+        m_index[(pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) & QOI_INDEX_MASK] = pixel;
+        if (std::memcmp(&pixel, &m_previous, sizeof(pixel)) != 0) {
+            m_previous = pixel;
+            m_previousColor = qoiColor(pixel);
+        }
+
+        run = std::min(run, m_remaining);
+        m_output.pushRun(m_previousColor, run);
+        m_remaining -= run;
+    }
+
+    return pos;
+}
+
+auto StillDecoder::consumeRaw(const uint8_t* data, size_t len) -> size_t {
+    const auto count = std::min(static_cast<uint32_t>(len / sizeof(uint16_t)), m_remaining);
+
+    m_output.pushBytes(data, count);
+    m_remaining -= count;
+
+    return count * sizeof(uint16_t);
+}
+
+auto StillDecoder::consumeRle(const uint8_t* data, size_t len) -> size_t {
+    size_t pos = 0;
+
+    while (m_remaining > 0) {
+        if (m_literalLeft > 0) {
+            const auto count = std::min({m_literalLeft, static_cast<uint32_t>((len - pos) / sizeof(uint16_t)),
+                                         m_remaining});
+            if (count == 0) {
+                break;
+            }
+            m_output.pushBytes(data + pos, count);
+            pos += count * sizeof(uint16_t);
+            m_literalLeft -= count;
+            m_remaining -= count;
+            continue;
+        }
+
+        if (pos >= len) {
+            break;
+        }
+
+        const uint8_t control = data[pos];
+        if ((control & RLE_RUN_FLAG) == 0) {
+            m_literalLeft = control + 1U;
+            pos++;
+            continue;
+        }
+        if (pos + RLE_RUN_SIZE > len) {
+            break;
+        }
+
+        const uint32_t count = std::min(static_cast<uint32_t>(control - RLE_RUN_BIAS), m_remaining);
+        m_output.pushRun(loadPanelPixel(data + pos + 1), count);
+        pos += RLE_RUN_SIZE;
+        m_remaining -= count;
+    }
+
+    return pos;
+}
+
+/**
+ * @brief Panel-order color of a QOI pixel, blended over the backdrop when translucent
+ */
+auto StillDecoder::qoiColor(const QoiPixel& pixel) const -> uint16_t {
+    uint16_t color = Rgb565::fromRgb(pixel.r, pixel.g, pixel.b);
+
+    if (pixel.a != UINT8_MAX) {
+        color = Rgb565::blend(color, m_backdrop, pixel.a);
+    }
+
+    return Rgb565::swap(color);
+}
+
+namespace Still {
+
+static std::array<StillStats, 3> s_stats{};
+
+/**
+ * @brief Format of a file on LittleFS, from its magic bytes
+ *
+ * @param path Path of the file
+ * @return The format, StillFormat::None for anything else (JPEG, GIF, missing file)
+ */
+auto probeFile(const String& path) -> StillFormat {
+    File file = LittleFS.open(path, "r");
+    std::array<uint8_t, STILL_MAGIC_SIZE> magic{};
+
+    if (!file) {
+        return StillFormat::None;
+    }
+
+    const bool complete = file.read(magic.data(), magic.size()) == magic.size();
+    file.close();
+
+    return complete ? formatFromMagic(magic.data()) : StillFormat::None;
+}
+
+/**
+ * @brief Decode a QOI or R565 file from LittleFS straight to the screen
+ *
+ * @param path Path of the file
+ * @param posX Left edge of the image
+ * @param posY Top edge of the image
+ * @return Size, format and decode time (file reads included)
+ */
+auto drawFile(const String& path, int16_t posX, int16_t posY) -> StillResult {
+    StillResult result{false, StillFormat::None, 0, 0, 0};
+    const std::unique_ptr<StillDecoder> decoder(new (std::nothrow) StillDecoder(posX, posY));
+    File file = LittleFS.open(path, "r");
+
+    if (!decoder || !file) {
+        return result;
+    }
+
+    const uint32_t startUs = micros();
+    std::array<uint8_t, STILL_FILE_CHUNK> chunk{};
+
+    while (!decoder->done()) {
+        const size_t bytesRead = file.read(chunk.data(), chunk.size());
+        if (bytesRead == 0 || !decoder->feed(chunk.data(), bytesRead)) {
+            break;
+        }
+    }
+    file.close();
+
+    result = decoder->result();
+    result.decodeUs = micros() - startUs;
+    record(result);
+
+    return result;
+}
+
+/**
+ * @brief Add a completed decode to the statistics of its format
+ */
+void record(const StillResult& result) {
+    if (!result.ok) {
+        return;
+    }
+
+    StillStats& stats = s_stats[static_cast<size_t>(result.format)];
+
+    stats.images++;
+    stats.lastUs = result.decodeUs;
+    stats.pixels += static_cast<uint64_t>(result.width) * static_cast<uint64_t>(result.height);
+    stats.totalUs += result.decodeUs;
+}
+
+/**
+ * @brief Images decoded, pixels and time spent for one format
+ */
+auto stats(StillFormat format) -> StillStats { return s_stats[static_cast<size_t>(format)]; }
+
+/**
+ * @brief Name of a format as reported by the API
+ */
+auto formatName(StillFormat format) -> const char* {
+    switch (format) {
+        case StillFormat::Qoi:
+            return "qoi";
+        case StillFormat::Rgb565:
+            return "rgb565";
+        default:
+            return "none";
+    }
+}
+
+}  // namespace Still
@@ -0,0 +1,461 @@
+#include <Arduino.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#include "display/DisplayManager.h"
+#include "display/Effects.h"
+#include "display/GlyphCache.h"
+#include "display/Rgb565.h"
+#include "display/Template.h"
+#include "script/Script.h"
+
+struct TemplateEntry {
+    std::array<char, TEMPLATE_NAME_MAX> name;
+    std::unique_ptr<TemplateScreen> screen;
+};
+
+static std::vector<TemplateEntry> s_templates;
+static TemplateScreen* s_shown = nullptr;
+static TemplateStats s_stats{};
+
+template <size_t N>
+static void copyText(std::array<char, N>& out, const char* text) {
+    const size_t length = std::min(strlen(text), N - 1);
+    memcpy(out.data(), text, length);
+    out[length] = '\0';
+}
+
+static auto regionRect(TemplateRegion region) -> UiRect {
+    switch (region) {
+        case TemplateRegion::Status:
+            return DisplayManager::getStatusBarRect();
+        case TemplateRegion::Body:
+            return DisplayManager::getBodyRect();
+        case TemplateRegion::Footer:
+            return DisplayManager::getFooterRect();
+        default:
+            return UiRect{0, 0, DisplayManager::screenWidth(), DisplayManager::screenHeight()};
+    }
+}
+
+static void fillSpan(int16_t posX, int16_t posY, int16_t width, int16_t height, uint16_t color) {
+    if (width > 0 && height > 0) {
+        DisplayManager::fillRect(posX, posY, width, height, color);
+    }
+}
+
+static auto isText(TemplateWidgetKind kind) -> bool {
+    return kind == TemplateWidgetKind::Label || kind == TemplateWidgetKind::Text;
+}
+
+/**
+ * @brief Find a variable, adding it when the template does not have it yet
+ *
+ * @return Its index, -1 when the name is too long or the template has TEMPLATE_MAX_VARS already
+ */
+auto TemplateScreen::addVar(const char* name) -> int {
+    const int found = findVar(name);
+    if (found >= 0) {
+        return found;
+    }
+
+    const size_t length = strlen(name);
+    if (length == 0 || length >= TEMPLATE_VAR_NAME_MAX || m_vars.size() >= TEMPLATE_MAX_VARS) {
+        return -1;
+    }
+
+    Var var{};
+    copyText(var.name, name);
+    m_vars.push_back(var);
+
+    return static_cast<int>(m_vars.size() - 1);
+}
+
+/**
+ * @brief Index of a variable, -1 when the template has no such variable
+ */
+auto TemplateScreen::findVar(const char* name) const -> int {
+    for (size_t i = 0; i < m_vars.size(); ++i) {
+        if (strcmp(m_vars[i].name.data(), name) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Lay a widget out in its region and add it
+ *
+ * The widget is clipped to its region; a text widget is at least one line high
+ *
+ * @return false when the template is full or the widget lies outside its region
+ */
+auto TemplateScreen::addWidget(const TemplateWidget& widget) -> bool {
+    if (m_widgets.size() >= TEMPLATE_MAX_WIDGETS || widget.size == 0 ||
+        (widget.var != TEMPLATE_NO_VAR && widget.var >= m_vars.size())) {
+        return false;
+    }
+
+    const UiRect rect = regionRect(widget.region);
+    const int16_t left = std::max<int16_t>(widget.x, 0);
+    const int16_t top = std::max<int16_t>(widget.y, 0);
+    const int16_t spaceW = static_cast<int16_t>(rect.w - left);
+    const int16_t spaceH = static_cast<int16_t>(rect.h - top);
+    const int16_t lineH = static_cast<int16_t>(GLYPH_CELL_HEIGHT * widget.size);
+
+    Placed placed{};
+    placed.spec = widget;
+    placed.spec.x = static_cast<int16_t>(rect.x + left);
+    placed.spec.y = static_cast<int16_t>(rect.y + top);
+    placed.spec.w = widget.w > 0 ? std::min(widget.w, spaceW) : spaceW;
+    if (isText(widget.kind)) {
+        placed.spec.h = std::max(std::min(widget.h > 0 ? widget.h : lineH, spaceH), lineH);
+    } else {
+        placed.spec.h = widget.h > 0 ? std::min(widget.h, spaceH) : spaceH;
+    }
+    placed.shownFill = -1;
+
+    if (placed.spec.w <= 0 || spaceH <= 0 || placed.spec.h <= 0) {
+        return false;
+    }
+
+    m_widgets.push_back(placed);
+
+    return true;
+}
+
+/**
+ * @brief Set the value of a variable
+ *
+ * @param var Variable index
+ * @param value New value, cut to TEMPLATE_VALUE_MAX - 1 characters
+ * @return true when it differs from the current value, the widgets bound to it are drawn by the next render()
+ */
+auto TemplateScreen::setValue(size_t var, const char* value) -> bool {
+    Var& entry = m_vars[var];
+
+    std::array<char, TEMPLATE_VALUE_MAX> next{};
+    copyText(next, value);
+    if (next == entry.value) {
+        return false;
+    }
+
+    entry.value = next;
+    entry.changed = true;
+
+    return true;
+}
+
+/**
+ * @brief Draw a line of text over the one the widget shows
+ *
+ * Only the cells whose character changed are sent; the part of the old text the new one does not cover is erased
+ * to the widget background
+ */
+auto TemplateScreen::drawText(Placed& widget, const char* line, TemplateStats& stats) const -> void {
+    const TemplateWidget& spec = widget.spec;
+    const auto cellW = static_cast<int16_t>(GLYPH_CELL_WIDTH * spec.size);
+    const auto cellH = static_cast<int16_t>(GLYPH_CELL_HEIGHT * spec.size);
+
+    const size_t length = std::min<size_t>(strlen(line), static_cast<size_t>(spec.w / cellW));
+    const auto textW = static_cast<int16_t>(length * cellW);
+    auto left = spec.x;
+    if (spec.align == TemplateAlign::Center) {
+        left = static_cast<int16_t>(left + (spec.w - textW) / 2);
+    } else if (spec.align == TemplateAlign::Right) {
+        left = static_cast<int16_t>(left + spec.w - textW);
+    }
+
+    // A cell keeps its glyph when the old text had the same character at the same place, which holds for
+    // right-aligned numbers too as long as the text moved by whole cells
+    const size_t shownLength = strlen(widget.shown.data());
+    const int16_t shift = static_cast<int16_t>(left - widget.shownX);
+    const bool aligned = shownLength > 0 && shift % cellW == 0;
+    const int cellShift = shift / cellW;
+    auto unchanged = [&](size_t index) {
+        const int old = static_cast<int>(index) + cellShift;
+        return aligned && old >= 0 && old < static_cast<int>(shownLength) && widget.shown[old] == line[index];
+    };
+
+    size_t start = 0;
+    while (start < length) {
+        if (unchanged(start)) {
+            stats.glyphsSkipped++;
+            start++;
+            continue;
+        }
+
+        size_t end = start + 1;
+        while (end < length && !unchanged(end)) {
+            end++;
+        }
+        DisplayManager::drawGlyphs(static_cast<int16_t>(left + start * cellW), spec.y, line + start, end - start,
+                                   spec.size, spec.color, spec.bg);
+        stats.glyphsDrawn += end - start;
+        start = end;
+    }
+
+    if (shownLength > 0) {
+        const auto shownRight = static_cast<int16_t>(widget.shownX + shownLength * cellW);
+        const auto right = static_cast<int16_t>(left + textW);
+
+        if (widget.shownX < left) {
+            DisplayManager::fillBackground(widget.shownX, spec.y,
+                                           static_cast<int16_t>(std::min(left, shownRight) - widget.shownX), cellH,
+                                           spec.bg);
+        }
+        if (shownRight > right) {
+            const int16_t from = std::max(right, widget.shownX);
+            DisplayManager::fillBackground(from, spec.y, static_cast<int16_t>(shownRight - from), cellH, spec.bg);
+        }
+    }
+
+    memcpy(widget.shown.data(), line, length);
+    widget.shown[length] = '\0';
+    widget.shownX = left;
+}
+
+/**
+ * @brief Paint the span between the fill a bar shows and the one its value asks for
+ */
+auto TemplateScreen::drawBar(Placed& widget) const -> void {
+    const TemplateWidget& spec = widget.spec;
+    const int32_t range = std::max<int32_t>(spec.max - spec.min, 1);
+    const int32_t number = std::clamp<int32_t>(strtol(m_vars[spec.var].value.data(), nullptr, 10), spec.min, spec.max);
+    const auto fill = static_cast<int16_t>((number - spec.min) * spec.w / range);
+
+    if (widget.shownFill < 0) {
+        fillSpan(spec.x, spec.y, fill, spec.h, spec.color);
+        fillSpan(static_cast<int16_t>(spec.x + fill), spec.y, static_cast<int16_t>(spec.w - fill), spec.h, spec.bg);
+    } else if (fill > widget.shownFill) {
+        fillSpan(static_cast<int16_t>(spec.x + widget.shownFill), spec.y,
+                 static_cast<int16_t>(fill - widget.shownFill), spec.h, spec.color);
+    } else if (fill < widget.shownFill) {
+        fillSpan(static_cast<int16_t>(spec.x + fill), spec.y, static_cast<int16_t>(widget.shownFill - fill), spec.h,
+                 spec.bg);
+    }
+
+    widget.shownFill = fill;
+}
+
+/**
+ * @brief Draw the template
+ *
+ * @param all true draws the whole template on a cleared screen, false only the widgets bound to a variable that
+ * changed since the last render
+ * @param stats Counters to add the work to
+ */
+auto TemplateScreen::render(bool all, TemplateStats& stats) -> void {
+    if (all) {
+        DisplayManager::clearToBackground(m_bg);
+    }
+
+    std::array<char, TEMPLATE_LINE_MAX> line{};
+
+    for (Placed& widget : m_widgets) {
+        const TemplateWidget& spec = widget.spec;
+        const bool bound = spec.var != TEMPLATE_NO_VAR;
+
+        if (all) {
+            widget.shown[0] = '\0';
+            widget.shownFill = -1;
+            if (isText(spec.kind) && spec.bg != m_bg) {
+                DisplayManager::fillBackground(spec.x, spec.y, spec.w, spec.h, spec.bg);
+            }
+        } else if (!bound || !m_vars[spec.var].changed) {
+            stats.widgetsSkipped += bound ? 1 : 0;
+            continue;
+        } else {
+            stats.widgetsDrawn++;
+        }
+
+        switch (spec.kind) {
+            case TemplateWidgetKind::Label:
+                drawText(widget, spec.text.data(), stats);
+                break;
+            case TemplateWidgetKind::Text: {
+                // The format is split at its {}, the value goes in between
+                const char* format = spec.text.data();
+                const char* slot = strstr(format, "{}");
+                const size_t prefix = slot != nullptr ? static_cast<size_t>(slot - format) : strlen(format);
+                snprintf(line.data(), line.size(), "%.*s%s%s", static_cast<int>(prefix), format,
+                         m_vars[spec.var].value.data(), slot != nullptr ? slot + 2 : "");
+                drawText(widget, line.data(), stats);
+                break;
+            }
+            case TemplateWidgetKind::Bar:
+                drawBar(widget);
+                break;
+            case TemplateWidgetKind::Fill:
+                fillSpan(spec.x, spec.y, spec.w, spec.h, Rgb565::parseHex(m_vars[spec.var].value.data(), spec.bg));
+                break;
+        }
+    }
+
+    for (Var& var : m_vars) {
+        var.changed = false;
+    }
+}
+
+static auto findEntry(const char* name) -> std::vector<TemplateEntry>::iterator {
+    return std::find_if(s_templates.begin(), s_templates.end(),
+                        [name](const TemplateEntry& entry) { return strcmp(entry.name.data(), name) == 0; });
+}
+
+namespace Template {
+
+/**
+ * @brief Whether a name can be used for a template: 1 to 15 letters, digits, '-' or '_'
+ */
+auto validName(const char* name) -> bool {
+    const size_t length = strlen(name);
+    return length > 0 && length < TEMPLATE_NAME_MAX &&
+           std::all_of(name, name + length,
+                       [](char chr) { return isalnum(static_cast<unsigned char>(chr)) || chr == '-' || chr == '_'; });
+}
+
+/**
+ * @brief Add a template, or replace the one with the same name (drawn again when it is shown)
+ *
+ * @return false when TEMPLATE_MAX templates are held already
+ */
+auto define(const char* name, std::unique_ptr<TemplateScreen> screen) -> bool {
+    auto entry = findEntry(name);
+
+    if (entry == s_templates.end()) {
+        if (s_templates.size() >= TEMPLATE_MAX) {
+            return false;
+        }
+        TemplateEntry added{};
+        copyText(added.name, name);
+        added.screen = std::move(screen);
+        s_templates.push_back(std::move(added));
+        return true;
+    }
+
+    const bool wasShown = entry->screen.get() == s_shown;
+    entry->screen = std::move(screen);
+    if (wasShown) {
+        s_shown = entry->screen.get();
+        s_shown->render(true, s_stats);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Drop a template, what it drew stays on the screen
+ *
+ * @return false when there is no template with this name
+ */
+auto remove(const char* name) -> bool {
+    auto entry = findEntry(name);
+    if (entry == s_templates.end()) {
+        return false;
+    }
+
+    if (entry->screen.get() == s_shown) {
+        hide();
+    }
+    s_templates.erase(entry);
+
+    return true;
+}
+
+/**
+ * @brief Template with this name, nullptr when there is none
+ */
+auto find(const char* name) -> TemplateScreen* {
+    auto entry = findEntry(name);
+    return entry != s_templates.end() ? entry->screen.get() : nullptr;
+}
+
+/**
+ * @brief Draw a template on the whole screen, value posts to it then update the screen
+ *
+ * A playing GIF or a running effect is stopped first
+ */
+auto show(const char* name) -> bool {
+    TemplateScreen* screen = find(name);
+    if (screen == nullptr) {
+        return false;
+    }
+
+    DisplayManager::stopGifPlayback();
+    Effects::stop();
+    Script::stop();
+
+    const uint32_t startUs = micros();
+    s_shown = screen;
+    s_shown->render(true, s_stats);
+    s_stats.lastRenderUs = micros() - startUs;
+
+    return true;
+}
+
+/**
+ * @brief Other content took the screen: value posts only update the templates until one is shown again
+ */
+void hide() {
+    if (s_shown != nullptr) {
+        s_shown = nullptr;
+        GlyphCache::clear();
+    }
+}
+
+/**
+ * @brief Name of the template on the screen, nullptr when none is
+ */
+auto shown() -> const char* {
+    for (const TemplateEntry& entry : s_templates) {
+        if (entry.screen.get() == s_shown) {
+            return entry.name.data();
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Draw what a value post changed, when the template is on the screen
+ *
+ * @param screen The template the values were set on
+ * @param changed Number of values that changed
+ * @return Widgets drawn
+ */
+auto refresh(TemplateScreen& screen, uint32_t changed) -> uint32_t {
+    s_stats.updates++;
+    s_stats.valuesChanged += changed;
+
+    if (&screen != s_shown || changed == 0) {
+        return 0;
+    }
+
+    const uint32_t startUs = micros();
+    const uint32_t before = s_stats.widgetsDrawn;
+    screen.render(false, s_stats);
+    s_stats.lastRenderUs = micros() - startUs;
+
+    return s_stats.widgetsDrawn - before;
+}
+
+/**
+ * @brief Names of the templates held, in the order they were defined
+ */
+auto names() -> std::vector<const char*> {
+    std::vector<const char*> out;
+    out.reserve(s_templates.size());
+    for (const TemplateEntry& entry : s_templates) {
+        out.push_back(entry.name.data());
+    }
+
+    return out;
+}
+
+auto stats() -> TemplateStats { return s_stats; }
+
+}  // namespace Template
@@ -0,0 +1,295 @@
+#include <Arduino.h>
+
+#include <algorithm>
+#include <numeric>
+
+#include "display/Transition.h"
+#include "display/DisplayManager.h"
+#include "display/GeekMagicST7789.h"
+
+static constexpr uint8_t FRACTION_BITS = 16;
+static constexpr uint32_t US_PER_MS = 1000;
+
+// Rows the content skipped are repainted in bands of this height as the effect reaches them
+static constexpr int32_t REVEAL_ROWS = 8;
+
+static GeekMagicST7789* s_panel = nullptr;
+static TransitionSpec s_spec{};
+static TransitionSpec s_defaults{TransitionEffect::None, Easing::InOut, LCD_BLACK, TRANSITION_DEFAULT_MS};
+static TransitionStats s_stats{};
+static bool s_active = false;
+static bool s_filling = false;  // the transition is drawing, its own address windows pass straight through
+
+static int32_t s_width = 0;
+static int32_t s_height = 0;
+static int32_t s_spare = 0;     // slide: frame memory lines the panel does not show
+static int32_t s_travel = 0;    // where the effect ends: lines scrolled, rows wiped or squares dissolved
+static int32_t s_position = 0;  // where the effect is
+static int32_t s_pending = 0;   // first row the new content has not written yet
+
+static uint32_t s_startMs = 0;
+static uint32_t s_frameUs = 0;  // when the effect last moved
+static uint64_t s_frameTotalUs = 0;
+
+/**
+ * @brief Where the effect should be by now, following the easing curve
+ */
+static auto target() -> int32_t {
+    const uint32_t elapsed = millis() - s_startMs;
+    if (elapsed >= s_spec.durationMs) {
+        return s_travel;
+    }
+
+    const auto progress = static_cast<uint32_t>((static_cast<uint64_t>(elapsed) << FRACTION_BITS) / s_spec.durationMs);
+    const uint32_t eased = Animation::ease(s_spec.easing, progress);
+
+    return std::min(s_travel, static_cast<int32_t>((static_cast<uint64_t>(eased) * s_travel) >> FRACTION_BITS));
+}
+
+/**
+ * @brief Furthest the effect may go: a slide must not scroll rows the content has not written back into view
+ */
+static auto limit() -> int32_t {
+    return (s_spec.effect == TransitionEffect::Slide) ? std::min(s_travel, s_pending + s_spare) : s_travel;
+}
+
+/**
+ * @brief Move the effect on to where time says it should be, at most once per TRANSITION_FRAME_MS
+ */
+static void step() {
+    const uint32_t nowUs = micros();
+    if (nowUs - s_frameUs < TRANSITION_FRAME_MS * US_PER_MS) {
+        return;
+    }
+
+    const int32_t next = std::min(target(), limit());
+    if (next <= s_position) {
+        return;
+    }
+
+    if (s_spec.effect == TransitionEffect::Slide) {
+        s_panel->setScroll(static_cast<uint16_t>(next));
+    }
+    s_position = next;
+
+    const uint32_t frameUs = nowUs - s_frameUs;
+    s_frameUs = nowUs;
+    s_stats.frames++;
+    s_stats.maxFrameUs = std::max(s_stats.maxFrameUs, frameUs);
+    s_frameTotalUs += frameUs;
+}
+
+/**
+ * @brief Hold the caller back until rows up to bottom (exclusive) may be written
+ *
+ * For a slide that is once they have scrolled out of view (the position is past them), for a wipe once the edge
+ * has reached them
+ */
+static void waitFor(int32_t bottom) {
+    bottom = std::min(bottom, limit());
+
+    step();
+    while (s_position < bottom) {
+        yield();
+        step();
+    }
+}
+
+static void fillBackground(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    x0 = std::max<int32_t>(x0, 0);
+    x1 = std::min(x1, s_width);
+    if (x0 < x1 && y0 < y1) {
+        DisplayManager::fillBackground(static_cast<int16_t>(x0), static_cast<int16_t>(y0),
+                                       static_cast<int16_t>(x1 - x0), static_cast<int16_t>(y1 - y0), s_spec.color);
+    }
+}
+
+/**
+ * @brief Paint whole rows with the background as the effect reaches them, the content left them out
+ */
+static void reveal(int32_t top, int32_t bottom) {
+    while (top < bottom) {
+        const int32_t band = std::min(bottom, top + REVEAL_ROWS);
+        waitFor(band);
+        fillBackground(0, top, s_width, band);
+        top = band;
+        s_pending = std::max(s_pending, band);
+    }
+}
+
+/**
+ * @brief Address window hook: pace the new content and cover what it leaves out
+ *
+ * The first window reaching new rows decides their margins, the decoders always write full image rows
+ */
+static void onWindow(int16_t posX, int16_t posY, uint16_t width, uint16_t height) {
+    if (s_filling) {
+        return;
+    }
+    s_filling = true;
+
+    const int32_t bottom = std::min<int32_t>(posY + height, s_height);
+    if (bottom > s_pending) {
+        reveal(s_pending, posY);
+
+        const int32_t top = std::max<int32_t>(posY, s_pending);
+        waitFor(bottom);
+        fillBackground(0, top, posX, bottom);
+        fillBackground(posX + width, top, s_width, bottom);
+        s_pending = bottom;
+    } else {
+        step();
+    }
+
+    s_filling = false;
+}
+
+/**
+ * @brief Visit every square once in a scattered order, (i * stride) % count with a stride coprime with count
+ */
+static void dissolve() {
+    const int32_t columns = (s_width + TRANSITION_DISSOLVE_BLOCK - 1) / TRANSITION_DISSOLVE_BLOCK;
+    const int32_t rows = (s_height + TRANSITION_DISSOLVE_BLOCK - 1) / TRANSITION_DISSOLVE_BLOCK;
+    const auto count = static_cast<uint32_t>(columns * rows);
+
+    // About 5/8 of the way round each time, which lands far from the previous square
+    uint32_t stride = (count * 5 / 8) | 1U;
+    while (std::gcd(stride, count) != 1) {
+        stride += 2;
+    }
+
+    uint32_t cleared = 0;
+    s_travel = static_cast<int32_t>(count);
+    while (cleared < count) {
+        step();
+        for (; cleared < static_cast<uint32_t>(s_position); ++cleared) {
+            const uint32_t square = static_cast<uint32_t>((static_cast<uint64_t>(cleared) * stride) % count);
+            const int32_t left = static_cast<int32_t>(square % columns) * TRANSITION_DISSOLVE_BLOCK;
+            const int32_t top = static_cast<int32_t>(square / columns) * TRANSITION_DISSOLVE_BLOCK;
+            fillBackground(left, top, left + TRANSITION_DISSOLVE_BLOCK,
+                           std::min(top + TRANSITION_DISSOLVE_BLOCK, s_height));
+        }
+        yield();
+    }
+}
+
+namespace Transition {
+
+/**
+ * @brief Start a transition, the content drawn until end() is paced by it
+ *
+ * A slide needs spare frame memory lines along the screen rows; on a panel rotated by 90 or 270 degrees (or one as
+ * tall as the frame memory) it runs as a wipe. A dissolve runs entirely here, the content then draws at full speed
+ *
+ * @param panel The panel driver
+ * @param spec Effect, easing, background color and duration
+ */
+void begin(GeekMagicST7789* panel, const TransitionSpec& spec) {
+    end();
+
+    s_panel = panel;
+    s_spec = spec;
+    s_spec.durationMs = std::max<uint32_t>(s_spec.durationMs, 1);
+    s_width = panel->width();
+    s_height = panel->height();
+    s_spare = panel->spareRows();
+    s_position = 0;
+    s_pending = 0;
+
+    if (s_spec.effect == TransitionEffect::Slide && s_spare <= 0) {
+        s_spec.effect = TransitionEffect::Wipe;
+    }
+
+    s_stats.frames = 0;
+    s_stats.maxFrameUs = 0;
+    s_frameTotalUs = 0;
+    s_startMs = millis();
+    s_frameUs = micros();
+    s_active = true;
+
+    switch (s_spec.effect) {
+        case TransitionEffect::Slide:
+            // The spare lines scroll in first, between the old content and the new one
+            s_travel = s_height + s_spare;
+            panel->fillSpareRows(s_spec.color);
+            panel->setScroll(0);
+            panel->setWindowHook(onWindow);
+            break;
+        case TransitionEffect::Wipe:
+            s_travel = s_height;
+            panel->setWindowHook(onWindow);
+            break;
+        case TransitionEffect::Dissolve:
+            dissolve();
+            break;
+        default:
+            s_active = false;
+            break;
+    }
+}
+
+/**
+ * @brief Finish the transition once the new content is drawn
+ *
+ * Rows the content did not reach get the background, the effect then runs to its end
+ */
+void end() {
+    if (!s_active) {
+        return;
+    }
+
+    s_filling = true;
+    if (s_spec.effect == TransitionEffect::Slide || s_spec.effect == TransitionEffect::Wipe) {
+        reveal(s_pending, s_height);
+        while (s_position < s_travel) {
+            step();
+            yield();
+        }
+        s_panel->setWindowHook(nullptr);
+    }
+    if (s_spec.effect == TransitionEffect::Slide) {
+        s_panel->endScroll();
+    }
+    s_filling = false;
+    s_active = false;
+
+    s_stats.transitions++;
+    s_stats.lastEffect = s_spec.effect;
+    s_stats.lastMs = millis() - s_startMs;
+    s_stats.avgFrameUs = s_stats.frames > 0 ? static_cast<uint32_t>(s_frameTotalUs / s_stats.frames) : 0;
+}
+
+/**
+ * @brief Whether a transition is pacing the drawing
+ */
+auto active() -> bool { return s_active; }
+
+/**
+ * @brief Transition used by content switches that do not ask for one
+ */
+auto defaults() -> TransitionSpec { return s_defaults; }
+
+void setDefaults(const TransitionSpec& spec) { s_defaults = spec; }
+
+/**
+ * @brief Transitions run since boot and the frame timing of the last one
+ */
+auto stats() -> TransitionStats { return s_stats; }
+
+/**
+ * @brief Name of an effect as used by the API
+ */
+auto effectName(TransitionEffect effect) -> const char* {
+    switch (effect) {
+        case TransitionEffect::Slide:
+            return "slide";
+        case TransitionEffect::Wipe:
+            return "wipe";
+        case TransitionEffect::Dissolve:
+            return "dissolve";
+        default:
+            return "none";
+    }
+}
+
+}  // namespace Transition
@@ -7,7 +7,12 @@
 #include "project_version.h"
 #include "config/ConfigManager.h"
 #include "wireless/WiFiManager.h"
+#include "wireless/Mqtt.h"
+#include "wireless/DataSource.h"
+#include "wireless/Broadcast.h"
+#include "wireless/TimeSync.h"
 #include "display/DisplayManager.h"
+#include "script/Script.h"
 #include "web/Webserver.h"
 #include "web/Api.h"
 
@@ -76,6 +81,9 @@ void setup() {
     step++;
 
     registerApiEndpoints(webserver);
+    startMqtt();
+    startBroadcast();
+    startTimeSync();
 
     webserver->serveStatic("/", "/web/index.html", "text/html");
     webserver->serveStatic("/header.html", "/web/header.html", "text/html");
@@ -104,4 +112,9 @@ void loop() {
         webserver->handleClient();
     }
     DisplayManager::update();
+    Script::update(millis());
+    Mqtt::update(millis());
+    DataSource::update(millis());
+    Broadcast::update(millis());
+    TimeSync::update(millis());
 }
@@ -0,0 +1,314 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+#include <Logger.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "display/DisplayManager.h"
+#include "display/DrawBatch.h"
+#include "display/Effects.h"
+#include "display/Template.h"
+#include "script/Script.h"
+#include "wireless/WiFiManager.h"
+
+static constexpr const char* SCRIPT_EXTENSION = ".hsc";
+static constexpr uint32_t MS_PER_SECOND = 1000;
+static constexpr long RANDOM_LIMIT = 32768;
+
+static ScriptVm s_vm;
+static std::array<char, SCRIPT_NAME_MAX> s_name{};
+static std::array<int32_t, SCRIPT_COUNTERS> s_counters{};
+static ScriptStats s_stats{};
+static uint32_t s_lastTickMs = 0;
+
+static auto scriptPath(const char* name) -> String { return String(SCRIPT_DIR) + "/" + name + SCRIPT_EXTENSION; }
+
+/**
+ * @class DeviceHost
+ * @brief What a script runs against on the device: live state for its inputs, a draw batch for its commands
+ */
+class DeviceHost final : public ScriptHost {
+   public:
+    explicit DeviceHost(uint32_t nowMs) : m_nowMs(nowMs) {}
+
+    auto input(ScriptInput input) -> int32_t override {
+        switch (input) {
+            case ScriptInput::Millis:
+                return static_cast<int32_t>(m_nowMs);
+            case ScriptInput::Uptime:
+                return static_cast<int32_t>(m_nowMs / MS_PER_SECOND);
+            case ScriptInput::Wifi:
+                return WiFiManager::isConnected() ? 1 : 0;
+            case ScriptInput::Rssi:
+                return WiFiManager::isConnected() ? WiFi.RSSI() : 0;
+            case ScriptInput::FreeHeap:
+                return static_cast<int32_t>(ESP.getFreeHeap());  // NOLINT(readability-static-accessed-through-instance)
+            case ScriptInput::Width:
+                return DisplayManager::screenWidth();
+            case ScriptInput::Height:
+                return DisplayManager::screenHeight();
+            case ScriptInput::Random:
+                return static_cast<int32_t>(random(RANDOM_LIMIT));
+            case ScriptInput::Ticks:
+                return static_cast<int32_t>(s_stats.ticks);
+            default:
+                return s_counters[static_cast<size_t>(input) - static_cast<size_t>(ScriptInput::Counter0)];
+        }
+    }
+
+    auto draw(const DrawCommand& command) -> void override {
+        if (batch() == nullptr) {
+            return;
+        }
+        m_batch->add(command);
+        if (m_batch->size() >= SCRIPT_FLUSH_COMMANDS) {
+            flush();
+        }
+    }
+
+    auto allocateText(size_t bytes) -> char* override {
+        return batch() != nullptr ? m_batch->arena().allocate<char>(bytes) : nullptr;
+    }
+
+    /**
+     * @brief Send the commands collected so far
+     */
+    auto flush() -> void {
+        if (!m_batch) {
+            return;
+        }
+
+        const uint32_t startUs = micros();
+        m_batch->optimize(DisplayManager::screenWidth(), DisplayManager::screenHeight());
+        s_stats.draws += m_batch->execute();
+        m_drawUs += micros() - startUs;
+        m_batch.reset();
+    }
+
+    auto drawUs() const -> uint32_t { return m_drawUs; }
+
+   private:
+    auto batch() -> DrawBatch* {
+        if (!m_batch) {
+            m_batch.reset(new (std::nothrow) DrawBatch(SCRIPT_FLUSH_COMMANDS));
+        }
+        return m_batch.get();
+    }
+
+    uint32_t m_nowMs;
+    uint32_t m_drawUs = 0;
+    std::unique_ptr<DrawBatch> m_batch;
+};
+
+namespace Script {
+
+/**
+ * @brief Whether a script name is accepted: 1 to SCRIPT_NAME_MAX - 1 letters, digits, '_' or '-'
+ */
+auto validName(const char* name) -> bool {
+    const size_t length = strlen(name);
+    if (length == 0 || length >= SCRIPT_NAME_MAX) {
+        return false;
+    }
+    return std::all_of(name, name + length, [](char chr) { return isalnum(chr) != 0 || chr == '_' || chr == '-'; });
+}
+
+/**
+ * @brief Verify a bytecode file and store it, replacing a script with the same name
+ *
+ * A running script with this name keeps running the code it was started with
+ *
+ * @return nullptr when stored, otherwise what is wrong
+ */
+auto store(const char* name, const uint8_t* image, size_t bytes) -> const char* {
+    if (!validName(name)) {
+        return "invalid name";
+    }
+
+    const std::unique_ptr<ScriptVm> check(new (std::nothrow) ScriptVm());
+    if (!check) {
+        return "out of memory";
+    }
+    const char* error = check->load(image, bytes);
+    if (error != nullptr) {
+        return error;
+    }
+
+    if (!LittleFS.exists(SCRIPT_DIR) && !LittleFS.mkdir(SCRIPT_DIR)) {
+        return "could not write the script";
+    }
+    const String path = scriptPath(name);
+    File file = LittleFS.open(path, "w");
+    if (!file) {
+        return "could not write the script";
+    }
+    const bool written = file.write(image, bytes) == bytes;
+    file.close();
+
+    if (!written) {
+        LittleFS.remove(path);
+        return "could not write the script";
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Delete a stored script, stopping it if it runs
+ */
+auto remove(const char* name) -> bool {
+    if (!validName(name) || !LittleFS.exists(scriptPath(name))) {
+        return false;
+    }
+    if (running() != nullptr && strcmp(s_name.data(), name) == 0) {
+        stop();
+    }
+
+    return LittleFS.remove(scriptPath(name));
+}
+
+/**
+ * @brief Names of the stored scripts
+ */
+auto names() -> std::vector<String> {
+    std::vector<String> list;
+    if (!LittleFS.exists(SCRIPT_DIR)) {
+        return list;
+    }
+
+    Dir dir = LittleFS.openDir(SCRIPT_DIR);
+    while (dir.next()) {
+        const String fileName = dir.fileName();
+        if (fileName.endsWith(SCRIPT_EXTENSION)) {
+            list.push_back(fileName.substring(0, fileName.length() - strlen(SCRIPT_EXTENSION)));
+        }
+    }
+
+    return list;
+}
+
+/**
+ * @brief Start a stored script from its beginning
+ *
+ * A playing GIF, a running effect and a shown template are stopped first, the script owns the screen until
+ * something else is drawn
+ *
+ * @return nullptr when started, otherwise what went wrong
+ */
+auto run(const char* name) -> const char* {
+    if (!validName(name)) {
+        return "invalid name";
+    }
+
+    File file = LittleFS.open(scriptPath(name), "r");
+    if (!file) {
+        return "no script with this name";
+    }
+    const size_t bytes = file.size();
+    if (bytes > SCRIPT_FILE_MAX) {
+        return "script too large";
+    }
+
+    const std::unique_ptr<uint8_t[]> image(new (std::nothrow) uint8_t[bytes]);
+    if (!image) {
+        return "out of memory";
+    }
+    if (file.read(image.get(), bytes) != bytes) {
+        return "could not read the script";
+    }
+    file.close();
+
+    DisplayManager::stopGifPlayback();
+    Effects::stop();
+    Template::hide();
+
+    const char* error = s_vm.load(image.get(), bytes);
+    if (error != nullptr) {
+        Logger::warn(("Script " + String(name) + " not started: " + error).c_str(), "Script");
+        return error;
+    }
+
+    strncpy(s_name.data(), name, s_name.size() - 1);
+    s_stats = ScriptStats{};
+    s_lastTickMs = millis() - SCRIPT_TICK_MS;
+
+    return nullptr;
+}
+
+/**
+ * @brief Stop the running script, what it drew stays on the screen
+ */
+void stop() { s_vm.stop(); }
+
+/**
+ * @brief Name of the running (or sleeping) script, nullptr when none is
+ */
+auto running() -> const char* {
+    const ScriptState state = s_vm.state();
+    return state == ScriptState::Running || state == ScriptState::Sleeping ? s_name.data() : nullptr;
+}
+
+/**
+ * @brief The VM of the current (or last) script, for its status
+ */
+auto vm() -> const ScriptVm& { return s_vm; }
+
+auto setCounter(size_t index, int32_t value) -> bool {
+    if (index >= s_counters.size()) {
+        return false;
+    }
+    s_counters[index] = value;
+    return true;
+}
+
+auto counter(size_t index) -> int32_t { return s_counters[index]; }
+
+/**
+ * @brief Run one tick of the script, called from loop()
+ *
+ * @param nowMs Current time
+ */
+void update(uint32_t nowMs) {
+    if (running() == nullptr || nowMs - s_lastTickMs < SCRIPT_TICK_MS) {
+        return;
+    }
+    s_lastTickMs = nowMs;
+
+    const uint32_t startUs = micros();
+    DeviceHost host(nowMs);
+    s_stats.instructions += s_vm.run(host, nowMs, SCRIPT_TICK_BUDGET);
+    host.flush();
+    const uint32_t drawUs = host.drawUs();
+    const uint32_t tickUs = micros() - startUs;
+
+    s_stats.ticks++;
+    s_stats.vmUs += tickUs - drawUs;
+    s_stats.lastTickUs = tickUs;
+    s_stats.maxTickUs = std::max(s_stats.maxTickUs, tickUs);
+
+    if (s_vm.state() == ScriptState::Faulted) {
+        Logger::warn(("Script " + String(s_name.data()) + " stopped: " + faultName(s_vm.fault())).c_str(),
+                     "Script");
+    }
+}
+
+auto stats() -> ScriptStats { return s_stats; }
+
+auto stateName(ScriptState state) -> const char* {
+    static constexpr std::array<const char*, 5> NAMES = {"stopped", "running", "sleeping", "halted", "faulted"};
+    return NAMES[static_cast<size_t>(state)];
+}
+
+auto faultName(ScriptFault fault) -> const char* {
+    static constexpr std::array<const char*, 7> NAMES = {
+        "none", "stack overflow", "stack underflow", "call overflow", "call underflow", "divide by zero",
+        "out of memory"};
+    return NAMES[static_cast<size_t>(fault)];
+}
+
+}  // namespace Script
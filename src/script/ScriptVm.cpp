@@ -0,0 +1,511 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "script/ScriptVm.h"
+
+// Largest text size a script can set
+static constexpr uint8_t SCRIPT_TEXT_SIZE_MAX = 8;
+// Room for a 32-bit value in decimal, sign and terminator included
+static constexpr size_t SCRIPT_NUMBER_TEXT = 12;
+static constexpr uint32_t SHIFT_MASK = 31;
+
+/**
+ * @brief How a draw instruction maps to a batch command
+ */
+struct ScriptDraw {
+    ScriptOp op;
+    DrawOp draw;
+    uint8_t args;
+    bool fill;
+};
+
+static constexpr std::array<ScriptDraw, 18> SCRIPT_DRAWS = {{
+    {ScriptOp::Clear, DrawOp::Clear, 0, true},
+    {ScriptOp::Rect, DrawOp::Rect, 4, false},
+    {ScriptOp::FillRect, DrawOp::Rect, 4, true},
+    {ScriptOp::Circle, DrawOp::Circle, 3, false},
+    {ScriptOp::FillCircle, DrawOp::Circle, 3, true},
+    {ScriptOp::Line, DrawOp::Line, 4, false},
+    {ScriptOp::LineAA, DrawOp::LineAA, 4, false},
+    {ScriptOp::ThickLine, DrawOp::ThickLine, 5, false},
+    {ScriptOp::Pixel, DrawOp::Pixel, 2, false},
+    {ScriptOp::Triangle, DrawOp::Triangle, 6, false},
+    {ScriptOp::FillTriangle, DrawOp::Triangle, 6, true},
+    {ScriptOp::Ellipse, DrawOp::Ellipse, 4, false},
+    {ScriptOp::FillEllipse, DrawOp::Ellipse, 4, true},
+    {ScriptOp::RoundRect, DrawOp::RoundRect, 5, false},
+    {ScriptOp::FillRoundRect, DrawOp::RoundRect, 5, true},
+    {ScriptOp::Arc, DrawOp::Arc, 6, false},
+    {ScriptOp::Text, DrawOp::Text, 2, false},
+    {ScriptOp::Number, DrawOp::Text, 2, false},
+}};
+
+/**
+ * @brief Operand size of an opcode
+ *
+ * @return 0, 1, 2 or 4 bytes; -1 for an unknown opcode
+ */
+static auto operandBytes(uint8_t code) -> int {
+    const auto op = static_cast<ScriptOp>(code);
+    switch (op) {
+        case ScriptOp::Push8:
+        case ScriptOp::Load:
+        case ScriptOp::Store:
+        case ScriptOp::TimerSet:
+        case ScriptOp::TimerDue:
+        case ScriptOp::Input:
+            return 1;
+        case ScriptOp::Push16:
+        case ScriptOp::Jmp:
+        case ScriptOp::Jz:
+        case ScriptOp::Jnz:
+        case ScriptOp::Call:
+        case ScriptOp::Text:
+            return 2;
+        case ScriptOp::Push32:
+            return 4;
+        default:
+            break;
+    }
+
+    const auto within = [code](ScriptOp first, ScriptOp last) {
+        return code >= static_cast<uint8_t>(first) && code <= static_cast<uint8_t>(last);
+    };
+    const bool plain = within(ScriptOp::Halt, ScriptOp::Over) || within(ScriptOp::Add, ScriptOp::LNot) ||
+                       op == ScriptOp::Ret || op == ScriptOp::Yield || op == ScriptOp::Sleep ||
+                       within(ScriptOp::Color, ScriptOp::Size) || within(ScriptOp::Clear, ScriptOp::Number);
+    return plain ? 0 : -1;
+}
+
+static auto clampArg(int32_t value) -> int16_t {
+    return static_cast<int16_t>(std::clamp<int32_t>(value, INT16_MIN, INT16_MAX));
+}
+
+/**
+ * @brief Verify a bytecode image and get ready to run it from the start
+ *
+ * @param image The file: header, code, string pool
+ * @param bytes Size of the file
+ * @return nullptr when the script is loaded, otherwise what is wrong with it (the VM is stopped then)
+ */
+auto ScriptVm::load(const uint8_t* image, size_t bytes) -> const char* {
+    m_state = ScriptState::Stopped;
+
+    ScriptHeader header{};
+    if (bytes < sizeof(header)) {
+        return "file too short";
+    }
+    memcpy(&header, image, sizeof(header));
+    if (header.magic != SCRIPT_MAGIC || header.version != SCRIPT_FORMAT_VERSION) {
+        return "not a script for this firmware version";
+    }
+    if (header.codeBytes == 0 || header.codeBytes > SCRIPT_MAX_CODE || header.stringBytes > SCRIPT_MAX_STRINGS ||
+        header.globals > SCRIPT_MAX_GLOBALS) {
+        return "script too large";
+    }
+    if (bytes != sizeof(header) + header.codeBytes + header.stringBytes) {
+        return "file size does not match its header";
+    }
+
+    const uint8_t* code = image + sizeof(header);
+    if (header.stringBytes > 0 && code[header.codeBytes + header.stringBytes - 1] != '\0') {
+        return "string pool not terminated";
+    }
+
+    // One pass over the code: every operand is checked here so that run() does not have to
+    std::vector<bool> starts(header.codeBytes, false);
+    std::vector<uint16_t> targets;
+    for (size_t pc = 0; pc < header.codeBytes;) {
+        starts[pc] = true;
+        const auto op = static_cast<ScriptOp>(code[pc]);
+        const int size = operandBytes(code[pc]);
+        if (size < 0) {
+            return "unknown opcode";
+        }
+        if (pc + 1 + size > header.codeBytes) {
+            return "instruction cut by the end of the code";
+        }
+
+        const uint8_t byte = code[pc + 1];
+        uint16_t word = 0;
+        if (size == 2) {
+            memcpy(&word, code + pc + 1, sizeof(word));
+        }
+
+        if ((op == ScriptOp::Load || op == ScriptOp::Store) && byte >= header.globals) {
+            return "global out of range";
+        }
+        if ((op == ScriptOp::TimerSet || op == ScriptOp::TimerDue) && byte >= SCRIPT_TIMERS) {
+            return "timer out of range";
+        }
+        if (op == ScriptOp::Input && byte >= SCRIPT_INPUT_COUNT) {
+            return "unknown input";
+        }
+        if (op == ScriptOp::Jmp || op == ScriptOp::Jz || op == ScriptOp::Jnz || op == ScriptOp::Call) {
+            if (word >= header.codeBytes) {
+                return "jump out of the code";
+            }
+            targets.push_back(word);
+        }
+        if (op == ScriptOp::Text && word >= header.stringBytes) {
+            return "string out of range";
+        }
+
+        pc += 1 + size;
+    }
+    for (const uint16_t target : targets) {
+        if (!starts[target]) {
+            return "jump into the middle of an instruction";
+        }
+    }
+
+    m_code.assign(code, code + header.codeBytes + header.stringBytes);
+    m_codeBytes = header.codeBytes;
+    m_globalCount = header.globals;
+
+    m_fault = ScriptFault::None;
+    m_pc = 0;
+    m_sp = 0;
+    m_csp = 0;
+    m_globals.fill(0);
+    m_timerPeriod.fill(0);
+    m_timerDue.fill(0);
+    m_color = 0xFFFF;
+    m_bg = 0x0000;
+    m_size = 2;
+    m_state = ScriptState::Running;
+
+    return nullptr;
+}
+
+/**
+ * @brief Stop the script where it is, a new load() is needed to run again
+ */
+auto ScriptVm::stop() -> void {
+    if (m_state != ScriptState::Faulted) {
+        m_state = ScriptState::Stopped;
+    }
+}
+
+auto ScriptVm::raise(ScriptFault fault) -> void {
+    m_fault = fault;
+    m_state = ScriptState::Faulted;
+}
+
+auto ScriptVm::push(int32_t value) -> void {
+    if (m_sp == m_stack.size()) {
+        raise(ScriptFault::StackOverflow);
+        return;
+    }
+    m_stack[m_sp++] = value;
+}
+
+auto ScriptVm::pop() -> int32_t {
+    if (m_sp == 0) {
+        raise(ScriptFault::StackUnderflow);
+        return 0;
+    }
+    return m_stack[--m_sp];
+}
+
+auto ScriptVm::operand8() -> uint8_t { return m_code[m_pc++]; }
+
+auto ScriptVm::operand16() -> uint16_t {
+    uint16_t value = 0;
+    memcpy(&value, &m_code[m_pc], sizeof(value));
+    m_pc += sizeof(value);
+    return value;
+}
+
+auto ScriptVm::operand32() -> uint32_t {
+    uint32_t value = 0;
+    memcpy(&value, &m_code[m_pc], sizeof(value));
+    m_pc += sizeof(value);
+    return value;
+}
+
+/**
+ * @brief Binary operators and comparisons, with the wrap-around of 32-bit hardware instead of overflow
+ */
+auto ScriptVm::arithmetic(ScriptOp op) -> void {
+    const int32_t rhs = pop();
+    const int32_t lhs = pop();
+    const auto ulhs = static_cast<uint32_t>(lhs);
+    const auto urhs = static_cast<uint32_t>(rhs);
+
+    int32_t result = 0;
+    switch (op) {
+        case ScriptOp::Add:
+            result = static_cast<int32_t>(ulhs + urhs);
+            break;
+        case ScriptOp::Sub:
+            result = static_cast<int32_t>(ulhs - urhs);
+            break;
+        case ScriptOp::Mul:
+            result = static_cast<int32_t>(ulhs * urhs);
+            break;
+        case ScriptOp::Div:
+        case ScriptOp::Mod:
+            if (rhs == 0) {
+                raise(ScriptFault::DivideByZero);
+                return;
+            }
+            if (rhs == -1) {
+                // INT32_MIN / -1 overflows
+                result = op == ScriptOp::Div ? static_cast<int32_t>(0U - ulhs) : 0;
+            } else {
+                result = op == ScriptOp::Div ? lhs / rhs : lhs % rhs;
+            }
+            break;
+        case ScriptOp::And:
+            result = lhs & rhs;
+            break;
+        case ScriptOp::Or:
+            result = lhs | rhs;
+            break;
+        case ScriptOp::Xor:
+            result = lhs ^ rhs;
+            break;
+        case ScriptOp::Shl:
+            result = static_cast<int32_t>(ulhs << (urhs & SHIFT_MASK));
+            break;
+        case ScriptOp::Shr:
+            result = lhs >> (urhs & SHIFT_MASK);
+            break;
+        case ScriptOp::Eq:
+            result = lhs == rhs ? 1 : 0;
+            break;
+        case ScriptOp::Ne:
+            result = lhs != rhs ? 1 : 0;
+            break;
+        case ScriptOp::Lt:
+            result = lhs < rhs ? 1 : 0;
+            break;
+        case ScriptOp::Le:
+            result = lhs <= rhs ? 1 : 0;
+            break;
+        case ScriptOp::Gt:
+            result = lhs > rhs ? 1 : 0;
+            break;
+        case ScriptOp::Ge:
+            result = lhs >= rhs ? 1 : 0;
+            break;
+        case ScriptOp::Min:
+            result = std::min(lhs, rhs);
+            break;
+        case ScriptOp::Max:
+            result = std::max(lhs, rhs);
+            break;
+        default:
+            break;
+    }
+
+    push(result);
+}
+
+/**
+ * @brief Whether a timer period elapsed, each period is reported once (missed ones are dropped)
+ */
+auto ScriptVm::timerDue(uint8_t timer) -> bool {
+    const uint32_t period = m_timerPeriod[timer];
+    if (period == 0 || static_cast<int32_t>(m_nowMs - m_timerDue[timer]) < 0) {
+        return false;
+    }
+
+    m_timerDue[timer] += period;
+    if (static_cast<int32_t>(m_nowMs - m_timerDue[timer]) >= 0) {
+        m_timerDue[timer] = m_nowMs + period;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Pop the arguments of a draw instruction and hand the command to the host
+ */
+auto ScriptVm::emit(ScriptHost& host, ScriptOp op) -> void {
+    const auto* entry = std::find_if(SCRIPT_DRAWS.begin(), SCRIPT_DRAWS.end(),
+                                     [op](const ScriptDraw& draw) { return draw.op == op; });
+
+    DrawCommand command{};
+    command.op = entry->draw;
+    command.fill = entry->fill;
+    command.size = m_size;
+    command.alpha = UINT8_MAX;
+    command.color = m_color;
+    command.bg = m_bg;
+
+    for (int i = entry->args - 1; i >= 0; --i) {
+        command.args[i] = clampArg(pop());
+    }
+
+    if (op == ScriptOp::Text) {
+        command.text = reinterpret_cast<const char*>(&m_code[m_codeBytes + operand16()]);
+        command.hasBg = true;
+    } else if (op == ScriptOp::Number) {
+        const int32_t value = pop();
+        char* text = host.allocateText(SCRIPT_NUMBER_TEXT);
+        if (text == nullptr) {
+            raise(ScriptFault::OutOfMemory);
+            return;
+        }
+        snprintf(text, SCRIPT_NUMBER_TEXT, "%ld", static_cast<long>(value));
+        command.text = text;
+        command.hasBg = true;
+    }
+
+    if (m_state != ScriptState::Faulted) {
+        host.draw(command);
+    }
+}
+
+/**
+ * @brief Run the script for one tick
+ *
+ * @param host Device state and draw sink
+ * @param nowMs Current time
+ * @param budget Most instructions to execute in this tick
+ * @return Instructions executed
+ */
+auto ScriptVm::run(ScriptHost& host, uint32_t nowMs, uint32_t budget) -> uint32_t {
+    if (m_state == ScriptState::Sleeping && static_cast<int32_t>(nowMs - m_wakeMs) >= 0) {
+        m_state = ScriptState::Running;
+    }
+    m_nowMs = nowMs;
+
+    uint32_t executed = 0;
+    while (m_state == ScriptState::Running && executed < budget) {
+        if (m_pc >= m_codeBytes) {
+            m_state = ScriptState::Halted;
+            break;
+        }
+
+        const auto op = static_cast<ScriptOp>(m_code[m_pc++]);
+        executed++;
+
+        switch (op) {
+            case ScriptOp::Halt:
+                m_state = ScriptState::Halted;
+                break;
+            case ScriptOp::Nop:
+                break;
+            case ScriptOp::Push8:
+                push(static_cast<int8_t>(operand8()));
+                break;
+            case ScriptOp::Push16:
+                push(static_cast<int16_t>(operand16()));
+                break;
+            case ScriptOp::Push32:
+                push(static_cast<int32_t>(operand32()));
+                break;
+            case ScriptOp::Load:
+                push(m_globals[operand8()]);
+                break;
+            case ScriptOp::Store: {
+                const uint8_t index = operand8();
+                m_globals[index] = pop();
+                break;
+            }
+            case ScriptOp::Dup: {
+                const int32_t value = pop();
+                push(value);
+                push(value);
+                break;
+            }
+            case ScriptOp::Drop:
+                pop();
+                break;
+            case ScriptOp::Swap: {
+                const int32_t top = pop();
+                const int32_t below = pop();
+                push(top);
+                push(below);
+                break;
+            }
+            case ScriptOp::Over: {
+                const int32_t top = pop();
+                const int32_t below = pop();
+                push(below);
+                push(top);
+                push(below);
+                break;
+            }
+            case ScriptOp::Neg:
+                push(static_cast<int32_t>(0U - static_cast<uint32_t>(pop())));
+                break;
+            case ScriptOp::Not:
+                push(~pop());
+                break;
+            case ScriptOp::LNot:
+                push(pop() == 0 ? 1 : 0);
+                break;
+            case ScriptOp::Jmp:
+                m_pc = operand16();
+                break;
+            case ScriptOp::Jz:
+            case ScriptOp::Jnz: {
+                const uint16_t target = operand16();
+                if ((pop() == 0) == (op == ScriptOp::Jz)) {
+                    m_pc = target;
+                }
+                break;
+            }
+            case ScriptOp::Call: {
+                const uint16_t target = operand16();
+                if (m_csp == m_calls.size()) {
+                    raise(ScriptFault::CallOverflow);
+                    break;
+                }
+                m_calls[m_csp++] = m_pc;
+                m_pc = target;
+                break;
+            }
+            case ScriptOp::Ret:
+                if (m_csp == 0) {
+                    raise(ScriptFault::CallUnderflow);
+                    break;
+                }
+                m_pc = m_calls[--m_csp];
+                break;
+            case ScriptOp::Yield:
+                return executed;
+            case ScriptOp::Sleep:
+                m_wakeMs = nowMs + static_cast<uint32_t>(std::max<int32_t>(pop(), 0));
+                if (m_state == ScriptState::Running) {
+                    m_state = ScriptState::Sleeping;
+                }
+                return executed;
+            case ScriptOp::TimerSet: {
+                const uint8_t timer = operand8();
+                m_timerPeriod[timer] = static_cast<uint32_t>(std::max<int32_t>(pop(), 0));
+                m_timerDue[timer] = nowMs + m_timerPeriod[timer];
+                break;
+            }
+            case ScriptOp::TimerDue:
+                push(timerDue(operand8()) ? 1 : 0);
+                break;
+            case ScriptOp::Input:
+                push(host.input(static_cast<ScriptInput>(operand8())));
+                break;
+            case ScriptOp::Color:
+                m_color = static_cast<uint16_t>(pop());
+                break;
+            case ScriptOp::Bg:
+                m_bg = static_cast<uint16_t>(pop());
+                break;
+            case ScriptOp::Size:
+                m_size = static_cast<uint8_t>(std::clamp<int32_t>(pop(), 1, SCRIPT_TEXT_SIZE_MAX));
+                break;
+            default:
+                if (op >= ScriptOp::Clear) {
+                    emit(host, op);
+                } else {
+                    arithmetic(op);
+                }
+                break;
+        }
+    }
+
+    return executed;
+}
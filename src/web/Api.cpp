@@ -3,13 +3,31 @@
 #include <ArduinoJson.h>
 #include <ESP8266HTTPUpdateServer.h>
 #include <Updater.h>
+#include <uri/UriBraces.h>
+
+#include <array>
+#include <memory>
+#include <new>
+#include <utility>
 
 #include "web/Webserver.h"
 #include "web/Api.h"
 #include "display/DisplayManager.h"
+#include "display/BitmapStream.h"
+#include "display/DrawBatch.h"
+#include "display/Macro.h"
+#include "display/Template.h"
+#include "display/GlyphCache.h"
+#include "display/ColorCache.h"
+#include "display/DrawPacket.h"
+#include "script/Script.h"
 
 #include "config/ConfigManager.h"
 #include "wireless/WiFiManager.h"
+#include "wireless/Mqtt.h"
+#include "wireless/DataSource.h"
+#include "wireless/Broadcast.h"
+#include "wireless/TimeSync.h"
 
 extern ConfigManager configManager;
 extern WiFiManager* wifiManager;
@@ -37,6 +55,19 @@ void registerApiEndpoints(Webserver* webserver) {
     webserver->raw().on("/api/v1/wifi/status", HTTP_GET, [webserver]() { handleWifiStatus(webserver); });
 
     webserver->raw().on("/api/v1/reboot", HTTP_POST, [webserver]() { handleReboot(webserver); });
+    webserver->raw().on("/api/v1/metrics", HTTP_GET, [webserver]() { handleMetrics(webserver); });
+
+    webserver->raw().on("/api/v1/config/display", HTTP_GET, [webserver]() { handleGetDisplayConfig(webserver); });
+    webserver->raw().on("/api/v1/config/display", HTTP_POST, [webserver]() { handleSetDisplayConfig(webserver); });
+    webserver->raw().on("/api/v1/config/mqtt", HTTP_GET, [webserver]() { handleGetMqttConfig(webserver); });
+    webserver->raw().on("/api/v1/config/mqtt", HTTP_POST, [webserver]() { handleSetMqttConfig(webserver); });
+    webserver->raw().on("/api/v1/config/broadcast", HTTP_GET, [webserver]() { handleGetBroadcastConfig(webserver); });
+    webserver->raw().on("/api/v1/config/broadcast", HTTP_POST, [webserver]() { handleSetBroadcastConfig(webserver); });
+    webserver->raw().on("/api/v1/config/sync", HTTP_GET, [webserver]() { handleGetSyncConfig(webserver); });
+    webserver->raw().on("/api/v1/config/sync", HTTP_POST, [webserver]() { handleSetSyncConfig(webserver); });
+    webserver->raw().on("/api/v1/config/transition", HTTP_GET, [webserver]() { handleGetTransitionConfig(webserver); });
+    webserver->raw().on("/api/v1/config/transition", HTTP_POST,
+                        [webserver]() { handleSetTransitionConfig(webserver); });
 
     // Just in case for now the old updater endpoint is still here
     httpUpdater.setup(&webserver->raw(), "/legacyupdate");
@@ -54,9 +85,24 @@ void registerApiEndpoints(Webserver* webserver) {
 
     webserver->raw().on("/api/v1/gif/play", HTTP_POST, [webserver]() { handlePlayGif(webserver); });
     webserver->raw().on("/api/v1/gif/stop", HTTP_POST, [webserver]() { handleStopGif(webserver); });
+    webserver->raw().on("/api/v1/sync", HTTP_GET, [webserver]() { handleGetSync(webserver); });
 
     webserver->raw().on("/api/v1/gif", HTTP_GET, [webserver]() { handleListGifs(webserver); });
 
+    webserver->raw().on(
+        "/api/v1/image", HTTP_POST, [webserver]() { handleImageUploaded(webserver); },
+        [webserver]() { handleImageUpload(webserver); });
+    webserver->raw().on("/api/v1/image/play", HTTP_POST, [webserver]() { handlePlayImage(webserver); });
+    webserver->raw().on(
+        "/api/v1/image/stream", HTTP_POST, [webserver]() { handleImageStreamed(webserver); },
+        [webserver]() { handleImageStream(webserver); });
+
+    webserver->raw().on(
+        "/api/v1/background", HTTP_POST, [webserver]() { handleBackgroundUploaded(webserver); },
+        [webserver]() { handleBackgroundUpload(webserver); });
+    webserver->raw().on("/api/v1/background", HTTP_GET, [webserver]() { handleGetBackground(webserver); });
+    webserver->raw().on("/api/v1/background/remove", HTTP_POST, [webserver]() { handleRemoveBackground(webserver); });
+
     // Drawing API endpoints
     webserver->raw().on("/api/v1/draw/clear", HTTP_POST, [webserver]() { handleDrawClear(webserver); });
     webserver->raw().on("/api/v1/draw/text", HTTP_POST, [webserver]() { handleDrawText(webserver); });
@@ -67,7 +113,45 @@ void registerApiEndpoints(Webserver* webserver) {
     webserver->raw().on("/api/v1/draw/triangle", HTTP_POST, [webserver]() { handleDrawTriangle(webserver); });
     webserver->raw().on("/api/v1/draw/ellipse", HTTP_POST, [webserver]() { handleDrawEllipse(webserver); });
     webserver->raw().on("/api/v1/draw/roundrect", HTTP_POST, [webserver]() { handleDrawRoundRect(webserver); });
+    webserver->raw().on("/api/v1/draw/gradient", HTTP_POST, [webserver]() { handleDrawGradient(webserver); });
+    webserver->raw().on(
+        "/api/v1/draw/bitmap", HTTP_POST, [webserver]() { handleDrawBitmap(webserver); },
+        [webserver]() { handleDrawBitmapStream(webserver); });
     webserver->raw().on("/api/v1/draw/batch", HTTP_POST, [webserver]() { handleDrawBatch(webserver); });
+    webserver->raw().on("/api/v1/macro", HTTP_POST, [webserver]() { handleStoreMacro(webserver); });
+    webserver->raw().on("/api/v1/macro", HTTP_GET, [webserver]() { handleListMacros(webserver); });
+    webserver->raw().on("/api/v1/macro/delete", HTTP_POST, [webserver]() { handleDeleteMacro(webserver); });
+
+    // Longer template routes first: a trailing {} takes the rest of the path
+    webserver->raw().on(UriBraces("/api/v1/template/{}/values"), HTTP_POST,
+                        [webserver]() { handleTemplateValues(webserver); });
+    webserver->raw().on(UriBraces("/api/v1/template/{}/show"), HTTP_POST,
+                        [webserver]() { handleShowTemplate(webserver); });
+    webserver->raw().on(UriBraces("/api/v1/template/{}/delete"), HTTP_POST,
+                        [webserver]() { handleDeleteTemplate(webserver); });
+    webserver->raw().on(UriBraces("/api/v1/template/{}"), HTTP_POST, [webserver]() { handleDefineTemplate(webserver); });
+    webserver->raw().on("/api/v1/template", HTTP_GET, [webserver]() { handleListTemplates(webserver); });
+
+    webserver->raw().on(
+        "/api/v1/script", HTTP_POST, [webserver]() { handleStoreScript(webserver); },
+        [webserver]() { handleScriptUpload(webserver); });
+    webserver->raw().on("/api/v1/script", HTTP_GET, [webserver]() { handleGetScript(webserver); });
+    webserver->raw().on("/api/v1/script/run", HTTP_POST, [webserver]() { handleRunScript(webserver); });
+    webserver->raw().on("/api/v1/script/stop", HTTP_POST, [webserver]() { handleStopScript(webserver); });
+    webserver->raw().on("/api/v1/script/delete", HTTP_POST, [webserver]() { handleDeleteScript(webserver); });
+    webserver->raw().on("/api/v1/script/counters", HTTP_POST, [webserver]() { handleScriptCounters(webserver); });
+
+    webserver->raw().on("/api/v1/source", HTTP_POST, [webserver]() { handleDefineSource(webserver); });
+    webserver->raw().on("/api/v1/source", HTTP_GET, [webserver]() { handleListSources(webserver); });
+    webserver->raw().on("/api/v1/source/delete", HTTP_POST, [webserver]() { handleDeleteSource(webserver); });
+    webserver->raw().on("/api/v1/source/poll", HTTP_POST, [webserver]() { handlePollSource(webserver); });
+
+    webserver->raw().on("/api/v1/animate", HTTP_POST, [webserver]() { handleAnimate(webserver); });
+    webserver->raw().on("/api/v1/animate/stop", HTTP_POST, [webserver]() { handleStopAnimation(webserver); });
+
+    webserver->raw().on("/api/v1/effect", HTTP_POST, [webserver]() { handleStartEffect(webserver); });
+    webserver->raw().on("/api/v1/effect", HTTP_GET, [webserver]() { handleGetEffect(webserver); });
+    webserver->raw().on("/api/v1/effect/stop", HTTP_POST, [webserver]() { handleStopEffect(webserver); });
 }
 
 /**
@@ -401,8 +485,22 @@ void handleOtaFinished(Webserver* webserver) {
     }
 }
 
+// Defined with the transition handlers
+static auto parseTransition(const JsonObject& obj, TransitionSpec& spec) -> const char*;
+
+// Defined with the drawing handlers
+static auto sendErrorResponse(Webserver* webserver, const char* message) -> void;
+
+// A synced start this far in the past still plays, its first frames a little late. An older one is refused: every
+// deadline up to now would already be missed and the frames would be shown back to back until they caught up
+static constexpr int64_t GIF_SYNC_MAX_PAST_US = 100000;
+
 /**
  * @brief Play a GIF from LittleFS full screen
+ * Body: {"name": "cat.gif", "transition": "slide"} (transition is optional, see /api/v1/config/transition)
+ * Synced: {"name": "cat.gif", "at": 1234567890, "frame": 0} loops the GIF showing frame "frame" at sync time "at"
+ * (microseconds, see /api/v1/sync), devices given the same "at" show the same frames together. "at" must not be more
+ * than GIF_SYNC_MAX_PAST_US in the past
  *
  * @param webserver Pointer to the Webserver instance
  *
@@ -467,7 +565,42 @@ void handlePlayGif(Webserver* webserver) {
         return;
     }
 
-    bool playOk = DisplayManager::playGifFullScreen(foundPath);
+    if (doc.containsKey("at")) {
+        const uint64_t startUs = doc["at"] | static_cast<uint64_t>(0);
+        const uint16_t startFrame = doc["frame"] | static_cast<uint16_t>(0);
+        if (startUs == 0) {
+            sendErrorResponse(webserver, "at must be a sync time in microseconds");
+            return;
+        }
+        if (static_cast<int64_t>(startUs - TimeSync::now()) < -GIF_SYNC_MAX_PAST_US) {
+            sendErrorResponse(webserver, "at is in the past, give a time ahead of nowUs (see /api/v1/sync)");
+            return;
+        }
+
+        const bool playOk = DisplayManager::playGifAt(foundPath, startUs, startFrame);
+
+        JsonDocument resp;
+        resp["status"] = playOk ? "playing" : "error";
+        resp["file"] = foundPath;
+        resp["at"] = startUs;
+        resp["frame"] = startFrame;
+        resp["leadUs"] = static_cast<int64_t>(startUs - TimeSync::now());
+        resp["synced"] = TimeSync::stats().synced;
+
+        String jsonOut;
+        serializeJson(resp, jsonOut);
+        webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+        return;
+    }
+
+    TransitionSpec transition{};
+    const char* transitionError = parseTransition(doc.as<JsonObject>(), transition);
+    if (transitionError != nullptr) {
+        sendErrorResponse(webserver, transitionError);
+        return;
+    }
+
+    bool playOk = DisplayManager::playGifFullScreen(foundPath, 0, transition);
 
     JsonDocument resp;
 
@@ -594,6 +727,187 @@ void handleWifiStatus(Webserver* webserver) {
     webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
 }
 
+/**
+ * @brief Runtime metrics (heap and display pipeline cost)
+ * GET /api/v1/metrics
+ */
+void handleMetrics(Webserver* webserver) {
+    JsonDocument resp;
+
+    resp["heapFree"] = ESP.getFreeHeap();              // NOLINT(readability-static-accessed-through-instance)
+    resp["heapMaxBlock"] = ESP.getMaxFreeBlockSize();  // NOLINT(readability-static-accessed-through-instance)
+    resp["cpuMHz"] = ESP.getCpuFreqMHz();              // NOLINT(readability-static-accessed-through-instance)
+
+    const GifFrameStats gifStats = DisplayManager::gifFrameStats();
+    JsonObject gif = resp["gif"].to<JsonObject>();
+
+    gif["frames"] = gifStats.frames;
+    gif["avgCycles"] = gifStats.avgCycles;
+    gif["maxCycles"] = gifStats.maxCycles;
+    gif["avgUs"] = gifStats.avgUs;
+
+    const JpegStats jpegStats = DisplayManager::jpegStats();
+    JsonObject jpeg = resp["jpeg"].to<JsonObject>();
+
+    jpeg["images"] = jpegStats.images;
+    jpeg["lastUs"] = jpegStats.lastUs;
+    jpeg["avgUs"] = jpegStats.avgUs;
+    jpeg["maxUs"] = jpegStats.maxUs;
+
+    JsonObject still = resp["still"].to<JsonObject>();
+    for (const StillFormat format : {StillFormat::Qoi, StillFormat::Rgb565}) {
+        const StillStats stats = Still::stats(format);
+        JsonObject entry = still[Still::formatName(format)].to<JsonObject>();
+
+        entry["images"] = stats.images;
+        entry["lastUs"] = stats.lastUs;
+        entry["avgUs"] = stats.images > 0 ? static_cast<uint32_t>(stats.totalUs / stats.images) : 0;
+        entry["kpixPerSec"] = stats.totalUs > 0 ? static_cast<uint32_t>(stats.pixels * 1000U / stats.totalUs) : 0;
+    }
+
+    const BackgroundStats backgroundStats = DisplayManager::backgroundStats();
+    JsonObject background = resp["background"].to<JsonObject>();
+
+    background["restores"] = backgroundStats.restores;
+    background["lastUs"] = backgroundStats.lastUs;
+    background["tileReads"] = backgroundStats.tileReads;
+    background["cacheHits"] = backgroundStats.cacheHits;
+    background["cachedTiles"] = Background::info().cacheSlots;
+
+    const AnimationStats animationStats = Animation::stats();
+    JsonObject animation = resp["animation"].to<JsonObject>();
+
+    animation["active"] = Animation::activeCount();
+    animation["ticks"] = animationStats.ticks;
+    animation["lastTickUs"] = animationStats.lastTickUs;
+    animation["maxTickUs"] = animationStats.maxTickUs;
+    animation["rejected"] = animationStats.rejected;
+
+    const TransitionStats transitionStats = DisplayManager::transitionStats();
+    JsonObject transition = resp["transition"].to<JsonObject>();
+
+    transition["count"] = transitionStats.transitions;
+    transition["effect"] = Transition::effectName(transitionStats.lastEffect);
+    transition["lastMs"] = transitionStats.lastMs;
+    transition["frames"] = transitionStats.frames;
+    transition["avgFrameUs"] = transitionStats.avgFrameUs;
+    transition["maxFrameUs"] = transitionStats.maxFrameUs;
+
+    const MacroStats macroStats = Macro::stats();
+    JsonObject macro = resp["macro"].to<JsonObject>();
+
+    macro["stored"] = Macro::index().size();
+    macro["invocations"] = macroStats.invocations;
+    macro["misses"] = macroStats.misses;
+    macro["lastLoadUs"] = macroStats.lastLoadUs;
+    macro["lastExpandUs"] = macroStats.lastExpandUs;
+
+    const TemplateStats templateStats = Template::stats();
+    const GlyphCacheStats glyphStats = GlyphCache::stats();
+    JsonObject templates = resp["templates"].to<JsonObject>();
+
+    templates["defined"] = Template::names().size();
+    templates["shown"] = Template::shown() != nullptr ? Template::shown() : "none";
+    templates["updates"] = templateStats.updates;
+    templates["valuesChanged"] = templateStats.valuesChanged;
+    templates["widgetsDrawn"] = templateStats.widgetsDrawn;
+    templates["widgetsSkipped"] = templateStats.widgetsSkipped;
+    templates["glyphsDrawn"] = templateStats.glyphsDrawn;
+    templates["glyphsSkipped"] = templateStats.glyphsSkipped;
+    templates["lastRenderUs"] = templateStats.lastRenderUs;
+    templates["glyphCacheHits"] = glyphStats.hits;
+    templates["glyphCacheMisses"] = glyphStats.misses;
+    templates["glyphCacheFlushes"] = glyphStats.flushes;
+    templates["glyphCacheBytes"] = glyphStats.bytes;
+
+    const ScriptStats scriptStats = Script::stats();
+    JsonObject script = resp["script"].to<JsonObject>();
+
+    script["running"] = Script::running() != nullptr ? Script::running() : "none";
+    script["state"] = Script::stateName(Script::vm().state());
+    script["ticks"] = scriptStats.ticks;
+    script["instructions"] = scriptStats.instructions;
+    script["draws"] = scriptStats.draws;
+    script["vmUs"] = scriptStats.vmUs;
+    script["lastTickUs"] = scriptStats.lastTickUs;
+    script["maxTickUs"] = scriptStats.maxTickUs;
+
+    const MqttStats mqttStats = Mqtt::stats();
+    JsonObject mqtt = resp["mqtt"].to<JsonObject>();
+
+    mqtt["connected"] = Mqtt::connected();
+    mqtt["connects"] = mqttStats.connects;
+    mqtt["failures"] = mqttStats.failures;
+    mqtt["messages"] = mqttStats.messages;
+    mqtt["drawn"] = mqttStats.drawn;
+    mqtt["rejected"] = mqttStats.rejected;
+    mqtt["bytes"] = mqttStats.bytes;
+    mqtt["lastDrawUs"] = mqttStats.lastDrawUs;
+    mqtt["maxDrawUs"] = mqttStats.maxDrawUs;
+
+    const BroadcastStats broadcastStats = Broadcast::stats();
+    JsonObject broadcast = resp["broadcast"].to<JsonObject>();
+
+    broadcast["listening"] = Broadcast::listening();
+    broadcast["received"] = broadcastStats.received;
+    broadcast["applied"] = broadcastStats.applied;
+    broadcast["ignored"] = broadcastStats.ignored;
+    broadcast["invalid"] = broadcastStats.invalid;
+    broadcast["duplicates"] = broadcastStats.duplicates;
+    broadcast["reordered"] = broadcastStats.reordered;
+    broadcast["nacks"] = broadcastStats.nacks;
+    broadcast["recovered"] = broadcastStats.recovered;
+    broadcast["lost"] = broadcastStats.lost;
+    broadcast["lastApplyUs"] = broadcastStats.lastApplyUs;
+
+    const TimeSyncStats syncStats = TimeSync::stats();
+    const GifSyncStats gifSync = DisplayManager::gifSyncStats();
+    JsonObject sync = resp["sync"].to<JsonObject>();
+
+    sync["synced"] = syncStats.synced;
+    sync["offsetUs"] = syncStats.offsetUs;
+    sync["skewPpb"] = syncStats.skewPpb;
+    sync["errorUs"] = syncStats.errorUs;
+    sync["samples"] = syncStats.samples;
+    sync["gifFrames"] = gifSync.frames;
+    sync["gifLate"] = gifSync.late;
+    sync["gifAvgLateUs"] = gifSync.avgLateUs;
+
+    JsonObject sources = resp["sources"].to<JsonObject>();
+    uint32_t sourcePolls = 0;
+    uint32_t sourceNotModified = 0;
+    uint32_t sourceErrors = 0;
+    for (size_t i = 0; i < DataSource::count(); ++i) {
+        const DataSourceStats stats = DataSource::stats(i);
+        sourcePolls += stats.polls;
+        sourceNotModified += stats.notModified;
+        sourceErrors += stats.errors;
+    }
+    sources["defined"] = DataSource::count();
+    sources["polls"] = sourcePolls;
+    sources["notModified"] = sourceNotModified;
+    sources["errors"] = sourceErrors;
+
+    JsonObject effects = resp["effects"].to<JsonObject>();
+    effects["running"] = Effects::running() ? Effects::kindName(Effects::params().kind) : "none";
+    for (size_t i = 0; i < EFFECT_KIND_COUNT; ++i) {
+        const auto kind = static_cast<EffectKind>(i);
+        const EffectStats stats = Effects::stats(kind);
+        JsonObject entry = effects[Effects::kindName(kind)].to<JsonObject>();
+
+        entry["frames"] = stats.frames;
+        entry["fps"] = stats.fps;
+        entry["frameUs"] = stats.frameUs;
+        entry["maxFrameUs"] = stats.maxFrameUs;
+        entry["step"] = stats.step;
+    }
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
 // ============================================================================
 // Drawing API Handlers
 // ============================================================================
@@ -607,11 +921,14 @@ static constexpr int16_t DEFAULT_SIZE_LARGE = 50;
 static constexpr int16_t DEFAULT_CORNER_RADIUS = 5;
 static constexpr int16_t SCREEN_SIZE = 240;
 static constexpr uint8_t DEFAULT_TEXT_SIZE = 2;
+static constexpr int16_t DEFAULT_ARC_SWEEP = 90;
+static constexpr int16_t DEFAULT_RING_THICKNESS = 10;
+static constexpr int16_t FULL_TURN_DEGREES = 360;
 
 // Helper to get color from JSON, returns LCD_WHITE if not present
 static auto getColorFromJson(const JsonVariant& obj, const char* key = "color") -> uint16_t {
     if (obj.containsKey(key)) {
-        return DisplayManager::hexToRgb565(obj[key].as<String>());
+        return DisplayManager::hexToRgb565(obj[key].as<const char*>());
     }
     return LCD_WHITE;
 }
@@ -638,21 +955,22 @@ static auto sendErrorResponse(Webserver* webserver, const char* message) -> void
 /**
  * @brief Clear the screen
  * POST /api/v1/draw/clear
- * Body: {"color": "#000000"} (optional, defaults to black)
+ * Body: {"color": "#000000"} (optional: without a color the background layer is restored, or black without one)
  */
 void handleDrawClear(Webserver* webserver) {
     String body = webserver->raw().arg("plain");
     JsonDocument doc;
-    uint16_t color = LCD_BLACK;
 
     if (body.length() > 0) {
         DeserializationError err = deserializeJson(doc, body);
         if (!err && doc.containsKey("color")) {
-            color = DisplayManager::hexToRgb565(doc["color"].as<String>());
+            DisplayManager::fillScreen(DisplayManager::hexToRgb565(doc["color"].as<const char*>()));
+            sendSuccessResponse(webserver);
+            return;
         }
     }
 
-    DisplayManager::fillScreen(color);
+    DisplayManager::clearToBackground(LCD_BLACK);
     sendSuccessResponse(webserver);
 }
 
@@ -679,7 +997,7 @@ void handleDrawText(Webserver* webserver) {
     uint16_t bgColor = LCD_BLACK;
 
     if (doc.containsKey("bg")) {
-        bgColor = DisplayManager::hexToRgb565(doc["bg"].as<String>());
+        bgColor = DisplayManager::hexToRgb565(doc["bg"].as<const char*>());
     }
 
     bool clearBg = doc["clear"] | false;
@@ -897,99 +1215,465 @@ static auto getBool(const JsonObject& obj, const char* key, bool defaultVal) ->
     return obj.containsKey(key) ? (obj[key].as<int>() != 0) : defaultVal;
 }
 
-// Helper functions for batch processing to reduce cognitive complexity
-static auto processBatchRect(const JsonObject& cmd, uint16_t color) -> void {
-    int16_t posX = getInt16(cmd, "x", DEFAULT_POS);
-    int16_t posY = getInt16(cmd, "y", DEFAULT_POS);
-    int16_t width = getInt16(cmd, "w", DEFAULT_SIZE_SMALL);
-    int16_t height = getInt16(cmd, "h", DEFAULT_SIZE_SMALL);
-    bool shouldFill = getBool(cmd, "fill", true);
-    if (shouldFill) {
-        DisplayManager::fillRect(posX, posY, width, height, color);
-    } else {
-        DisplayManager::drawRect(posX, posY, width, height, color);
+// Largest palette a batch can declare
+static constexpr size_t BATCH_PALETTE_MAX = 64;
+
+// Colors of one batch: the optional "palette" (colors referenced by index) and a cache for inline "#rrggbb" strings
+struct BatchColors {
+    std::array<uint16_t, BATCH_PALETTE_MAX> palette{};
+    size_t paletteSize = 0;
+    ColorCache<> cache;
+
+    auto loadPalette(const JsonArray& entries) -> void {
+        for (JsonVariant entry : entries) {
+            if (paletteSize >= BATCH_PALETTE_MAX) {
+                break;
+            }
+            palette[paletteSize++] = cache.lookup(entry.as<const char*>(), LCD_WHITE);
+        }
     }
+
+    auto resolve(const JsonVariant& value, uint16_t fallback) -> uint16_t {
+        if (value.is<int>()) {
+            const int index = value.as<int>();
+            return (index >= 0 && static_cast<size_t>(index) < paletteSize) ? palette[index] : fallback;
+        }
+        return cache.lookup(value.as<const char*>(), fallback);
+    }
+
+    // Same as resolve() but keeps the full 8 bits per channel of inline strings (gradient stops are dithered)
+    auto resolveRgb(const JsonVariant& value, uint32_t fallback) const -> uint32_t {
+        if (value.is<int>()) {
+            const int index = value.as<int>();
+            return (index >= 0 && static_cast<size_t>(index) < paletteSize) ? Rgb565::toRgb(palette[index]) : fallback;
+        }
+        return Rgb565::parseHexRgb(value.as<const char*>(), fallback);
+    }
+};
+
+// Helper functions for batch parsing to reduce cognitive complexity
+static auto parseBatchRect(const JsonObject& cmd, DrawCommand& out) -> void {
+    out.args[0] = getInt16(cmd, "x", DEFAULT_POS);
+    out.args[1] = getInt16(cmd, "y", DEFAULT_POS);
+    out.args[2] = getInt16(cmd, "w", DEFAULT_SIZE_SMALL);
+    out.args[3] = getInt16(cmd, "h", DEFAULT_SIZE_SMALL);
+    out.fill = getBool(cmd, "fill", true);
 }
 
-static auto processBatchCircle(const JsonObject& cmd, uint16_t color) -> void {
-    int16_t posX = getInt16(cmd, "x", DEFAULT_CENTER);
-    int16_t posY = getInt16(cmd, "y", DEFAULT_CENTER);
-    int16_t radius = getInt16(cmd, "r", DEFAULT_SIZE_LARGE);
-    bool shouldFill = getBool(cmd, "fill", true);
-    if (shouldFill) {
-        DisplayManager::fillCircle(posX, posY, radius, color);
-    } else {
-        DisplayManager::drawCircle(posX, posY, radius, color);
+static auto parseBatchCircle(const JsonObject& cmd, DrawCommand& out) -> void {
+    out.args[0] = getInt16(cmd, "x", DEFAULT_CENTER);
+    out.args[1] = getInt16(cmd, "y", DEFAULT_CENTER);
+    out.args[2] = getInt16(cmd, "r", DEFAULT_SIZE_LARGE);
+    out.fill = getBool(cmd, "fill", true);
+}
+
+static auto parseBatchLine(const JsonObject& cmd, DrawCommand& out) -> void {
+    out.args[0] = getInt16(cmd, "x0", DEFAULT_POS);
+    out.args[1] = getInt16(cmd, "y0", DEFAULT_POS);
+    out.args[2] = getInt16(cmd, "x1", SCREEN_SIZE);
+    out.args[3] = getInt16(cmd, "y1", SCREEN_SIZE);
+}
+
+// "butt" (default), "square" or "round"
+static auto parseLineCap(const JsonObject& cmd) -> LineCap {
+    const char* cap = cmd["cap"] | "butt";
+
+    if (strcmp(cap, "round") == 0) {
+        return LineCap::Round;
+    }
+    if (strcmp(cap, "square") == 0) {
+        return LineCap::Square;
     }
+    return LineCap::Butt;
 }
 
-static auto processBatchLine(const JsonObject& cmd, uint16_t color) -> void {
-    int16_t startX = getInt16(cmd, "x0", DEFAULT_POS);
-    int16_t startY = getInt16(cmd, "y0", DEFAULT_POS);
-    int16_t endX = getInt16(cmd, "x1", SCREEN_SIZE);
-    int16_t endY = getInt16(cmd, "y1", SCREEN_SIZE);
-    DisplayManager::drawLine(startX, startY, endX, endY, color);
+// A line with "width" > 1 is a thick line, "aa": true makes a hairline anti-aliased
+static auto parseBatchStyledLine(const JsonObject& cmd, DrawCommand& out) -> void {
+    parseBatchLine(cmd, out);
+    out.args[4] = getInt16(cmd, "width", 1);
+    out.cap = parseLineCap(cmd);
+
+    if (out.args[4] > 1) {
+        out.op = DrawOp::ThickLine;
+    } else if (getBool(cmd, "aa", false)) {
+        out.op = DrawOp::LineAA;
+    }
 }
 
-static auto processBatchPixel(const JsonObject& cmd, uint16_t color) -> void {
-    int16_t posX = getInt16(cmd, "x", DEFAULT_POS);
-    int16_t posY = getInt16(cmd, "y", DEFAULT_POS);
-    DisplayManager::drawPixel(posX, posY, color);
+static auto parseBatchArc(const JsonObject& cmd, DrawCommand& out, int16_t thickness, int16_t sweep) -> void {
+    out.args[0] = getInt16(cmd, "x", DEFAULT_CENTER);
+    out.args[1] = getInt16(cmd, "y", DEFAULT_CENTER);
+    out.args[2] = getInt16(cmd, "r", DEFAULT_SIZE_LARGE);
+    out.args[3] = getInt16(cmd, "thickness", thickness);
+    out.args[4] = getInt16(cmd, "start", 0);
+    out.args[5] = getInt16(cmd, "sweep", sweep);
+    out.cap = parseLineCap(cmd);
 }
 
-static auto processBatchText(const JsonObject& cmd, uint16_t color) -> void {
-    int16_t posX = getInt16(cmd, "x", DEFAULT_POS);
-    int16_t posY = getInt16(cmd, "y", DEFAULT_POS);
-    String text = cmd.containsKey("text") ? cmd["text"].as<String>() : "";
-    uint8_t textSize = cmd.containsKey("size") ? static_cast<uint8_t>(cmd["size"].as<int>()) : DEFAULT_TEXT_SIZE;
-    uint16_t bgColor = LCD_BLACK;
-    if (cmd.containsKey("bg")) {
-        bgColor = DisplayManager::hexToRgb565(cmd["bg"].as<String>());
+static auto parseBatchPixel(const JsonObject& cmd, DrawCommand& out) -> void {
+    out.args[0] = getInt16(cmd, "x", DEFAULT_POS);
+    out.args[1] = getInt16(cmd, "y", DEFAULT_POS);
+}
+
+static auto parseBatchText(const JsonObject& cmd, DrawCommand& out, BatchColors& colors) -> void {
+    out.args[0] = getInt16(cmd, "x", DEFAULT_POS);
+    out.args[1] = getInt16(cmd, "y", DEFAULT_POS);
+    out.text = cmd["text"] | "";
+    out.size = static_cast<uint8_t>(
+        std::clamp<int>(cmd["size"] | static_cast<int>(DEFAULT_TEXT_SIZE), DRAW_TEXT_SIZE_MIN, DRAW_TEXT_SIZE_MAX));
+    out.bg = colors.resolve(cmd["bg"], LCD_BLACK);
+    out.hasBg = true;
+    out.clearBg = getBool(cmd, "clear", false);
+}
+
+static auto parseBatchTriangle(const JsonObject& cmd, DrawCommand& out) -> void {
+    out.args[0] = getInt16(cmd, "x0", DEFAULT_POS);
+    out.args[1] = getInt16(cmd, "y0", DEFAULT_POS);
+    out.args[2] = getInt16(cmd, "x1", DEFAULT_POS);
+    out.args[3] = getInt16(cmd, "y1", DEFAULT_POS);
+    out.args[4] = getInt16(cmd, "x2", DEFAULT_POS);
+    out.args[5] = getInt16(cmd, "y2", DEFAULT_POS);
+    out.fill = getBool(cmd, "fill", true);
+}
+
+static auto parseBatchEllipse(const JsonObject& cmd, DrawCommand& out) -> void {
+    out.args[0] = getInt16(cmd, "x", DEFAULT_CENTER);
+    out.args[1] = getInt16(cmd, "y", DEFAULT_CENTER);
+    out.args[2] = getInt16(cmd, "rx", DEFAULT_SIZE_LARGE);
+    out.args[3] = getInt16(cmd, "ry", DEFAULT_SIZE_MEDIUM);
+    out.fill = getBool(cmd, "fill", true);
+}
+
+static auto parseBatchRoundRect(const JsonObject& cmd, DrawCommand& out) -> void {
+    out.args[0] = getInt16(cmd, "x", DEFAULT_POS);
+    out.args[1] = getInt16(cmd, "y", DEFAULT_POS);
+    out.args[2] = getInt16(cmd, "w", DEFAULT_SIZE_LARGE);
+    out.args[3] = getInt16(cmd, "h", DEFAULT_SIZE_MEDIUM);
+    out.args[4] = getInt16(cmd, "r", DEFAULT_CORNER_RADIUS);
+    out.fill = getBool(cmd, "fill", true);
+}
+
+/**
+ * @brief Parse the gradient of a "gradient" command filling the rect (x, y, w, h)
+ *
+ * "stops" holds 2-4 colors, evenly spaced, or {"at": 0.0-1.0, "color": ...} objects. Linear gradients default to
+ * left-to-right across the rect, radial ones to the rect center out to half its largest side
+ *
+ * @return false if the stops are invalid
+ */
+static auto parseGradientSpec(const JsonObject& cmd, const BatchColors& colors, const int16_t* rect,
+                              GradientSpec& spec) -> bool {
+    constexpr uint32_t DEFAULT_RGB = 0xFFFFFF;
+    JsonArray stops = cmd["stops"].as<JsonArray>();
+    const size_t count = stops.size();
+
+    if (count < GRADIENT_MIN_STOPS || count > GRADIENT_MAX_STOPS) {
+        return false;
+    }
+
+    spec = GradientSpec{};
+    spec.stopCount = static_cast<uint8_t>(count);
+    uint8_t i = 0;
+    for (JsonVariant stop : stops) {
+        const auto evenPos = static_cast<uint8_t>((i * UINT8_MAX) / (count - 1));
+
+        if (stop.is<JsonObject>()) {
+            const float at = stop["at"] | (static_cast<float>(evenPos) / UINT8_MAX);
+            spec.stops[i].pos = static_cast<uint8_t>(std::min(std::max(at, 0.0F), 1.0F) * UINT8_MAX + 0.5F);
+            spec.stops[i].rgb = colors.resolveRgb(stop["color"], DEFAULT_RGB);
+        } else {
+            spec.stops[i].pos = evenPos;
+            spec.stops[i].rgb = colors.resolveRgb(stop, DEFAULT_RGB);
+        }
+        i++;
     }
-    bool clearBg = getBool(cmd, "clear", false);
-    DisplayManager::drawTextWrapped(posX, posY, text, textSize, color, bgColor, clearBg);
+
+    const char* kind = cmd["kind"] | "linear";
+    const int16_t centerY = static_cast<int16_t>(rect[1] + rect[3] / 2);
+
+    spec.kind = (strcmp(kind, "radial") == 0) ? GradientKind::Radial : GradientKind::Linear;
+    spec.startX = getInt16(cmd, "x0", rect[0]);
+    spec.startY = getInt16(cmd, "y0", centerY);
+    spec.endX = getInt16(cmd, "x1", static_cast<int16_t>(rect[0] + rect[2] - 1));
+    spec.endY = getInt16(cmd, "y1", centerY);
+    spec.centerX = getInt16(cmd, "cx", static_cast<int16_t>(rect[0] + rect[2] / 2));
+    spec.centerY = getInt16(cmd, "cy", centerY);
+    spec.radius = getInt16(cmd, "r", static_cast<int16_t>(std::max(rect[2], rect[3]) / 2));
+    spec.dither = getBool(cmd, "dither", true);
+
+    return true;
 }
 
-static auto processBatchTriangle(const JsonObject& cmd, uint16_t color) -> void {
-    int16_t vertX0 = getInt16(cmd, "x0", DEFAULT_POS);
-    int16_t vertY0 = getInt16(cmd, "y0", DEFAULT_POS);
-    int16_t vertX1 = getInt16(cmd, "x1", DEFAULT_POS);
-    int16_t vertY1 = getInt16(cmd, "y1", DEFAULT_POS);
-    int16_t vertX2 = getInt16(cmd, "x2", DEFAULT_POS);
-    int16_t vertY2 = getInt16(cmd, "y2", DEFAULT_POS);
-    bool shouldFill = getBool(cmd, "fill", true);
-    if (shouldFill) {
-        DisplayManager::fillTriangle(vertX0, vertY0, vertX1, vertY1, vertX2, vertY2, color);
-    } else {
-        DisplayManager::drawTriangle(vertX0, vertY0, vertX1, vertY1, vertX2, vertY2, color);
+static auto parseBatchGradient(const JsonObject& cmd, DrawCommand& out, const BatchColors& colors, DrawBatch& batch)
+    -> void {
+    GradientSpec spec{};
+
+    parseBatchRect(cmd, out);
+    if (parseGradientSpec(cmd, colors, out.args, spec)) {
+        out.op = DrawOp::Gradient;
+        out.ref = batch.addGradient(spec);
     }
 }
 
-static auto processBatchEllipse(const JsonObject& cmd, uint16_t color) -> void {
-    int16_t posX = getInt16(cmd, "x", DEFAULT_CENTER);
-    int16_t posY = getInt16(cmd, "y", DEFAULT_CENTER);
-    int16_t radiusX = getInt16(cmd, "rx", DEFAULT_SIZE_LARGE);
-    int16_t radiusY = getInt16(cmd, "ry", DEFAULT_SIZE_MEDIUM);
-    bool shouldFill = getBool(cmd, "fill", true);
-    if (shouldFill) {
-        DisplayManager::fillEllipse(posX, posY, radiusX, radiusY, color);
+// Vertex budget of one polygon/path (curves count their flattened segments)
+static constexpr uint16_t BATCH_PATH_MAX_VERTICES = 256;
+
+/**
+ * @brief Parse a "polygon" ("points": [[x, y], ...]) or "path" ("d": "M 10 10 L 50 10 Q 60 40 30 50 Z") command
+ *
+ * The vertices are stored in the batch arena, the command carries the bounding box. "rule" is "nonzero" (default)
+ * or "evenodd". A shape over budget is dropped whole
+ */
+static auto parseBatchPath(const JsonObject& cmd, DrawCommand& out, DrawBatch& batch, bool isPolygon) -> void {
+    PathBuilder builder(batch.arena(), BATCH_PATH_MAX_VERTICES);
+    bool valid = true;
+
+    if (isPolygon) {
+        bool first = true;
+        for (JsonArray point : cmd["points"].as<JsonArray>()) {
+            const auto posX = static_cast<int32_t>(point[0].as<float>() * PATH_SUBPIXEL_ONE);
+            const auto posY = static_cast<int32_t>(point[1].as<float>() * PATH_SUBPIXEL_ONE);
+            valid = first ? builder.moveTo(posX, posY) : builder.lineTo(posX, posY);
+            first = false;
+            if (!valid) {
+                break;
+            }
+        }
     } else {
-        DisplayManager::drawEllipse(posX, posY, radiusX, radiusY, color);
+        valid = parsePathData(cmd["d"] | "", builder);
+    }
+
+    const char* rule = cmd["rule"] | "nonzero";
+    const PathSpec spec = builder.finish(strcmp(rule, "evenodd") == 0 ? FillRule::EvenOdd : FillRule::NonZero);
+    if (!valid || spec.count == 0) {
+        Logger::warn("Invalid or oversized path skipped", "API");
+        return;
     }
+
+    out.op = DrawOp::Path;
+    out.args[0] = spec.boundsX0;
+    out.args[1] = spec.boundsY0;
+    out.args[2] = static_cast<int16_t>(spec.boundsX1 - spec.boundsX0);
+    out.args[3] = static_cast<int16_t>(spec.boundsY1 - spec.boundsY0);
+    out.ref = batch.addPath(spec);
 }
 
-static auto processBatchRoundRect(const JsonObject& cmd, uint16_t color) -> void {
-    int16_t posX = getInt16(cmd, "x", DEFAULT_POS);
-    int16_t posY = getInt16(cmd, "y", DEFAULT_POS);
-    int16_t width = getInt16(cmd, "w", DEFAULT_SIZE_LARGE);
-    int16_t height = getInt16(cmd, "h", DEFAULT_SIZE_MEDIUM);
-    int16_t radius = getInt16(cmd, "r", DEFAULT_CORNER_RADIUS);
-    bool shouldFill = getBool(cmd, "fill", true);
-    if (shouldFill) {
-        DisplayManager::fillRoundRect(posX, posY, width, height, radius, color);
-    } else {
-        DisplayManager::drawRoundRect(posX, posY, width, height, radius, color);
+// Hex digits of one sprite pixel
+static constexpr size_t SPRITE_HEX_PER_PIXEL = 4;
+
+/**
+ * @brief Parse a "sprite" command: "w" x "h" pixels in "data", 4 hex digits of RGB565 each ("f800" is red), row-major
+ *
+ * The pixels are decoded into the batch arena, so a sprite holds at most 4096 pixels. Invalid or oversized sprites
+ * are dropped whole
+ */
+static auto parseBatchSprite(const JsonObject& cmd, DrawCommand& out, DrawBatch& batch) -> void {
+    const int width = cmd["w"] | 0;
+    const int height = cmd["h"] | 0;
+    const char* data = cmd["data"] | "";
+    const size_t count = (width > 0 && height > 0) ? static_cast<size_t>(width) * static_cast<size_t>(height) : 0;
+
+    uint16_t* pixels = nullptr;
+    if (count > 0 && width <= INT16_MAX && height <= INT16_MAX && strlen(data) == count * SPRITE_HEX_PER_PIXEL) {
+        pixels = batch.arena().allocate<uint16_t>(count);
+    }
+    for (size_t i = 0; pixels != nullptr && i < count; ++i) {
+        uint16_t pixel = 0;
+        for (size_t digit = 0; digit < SPRITE_HEX_PER_PIXEL; ++digit) {
+            const int8_t value = Rgb565::hexDigit(*data++);
+            if (value < 0) {
+                pixels = nullptr;
+                break;
+            }
+            pixel = static_cast<uint16_t>((pixel << 4U) | static_cast<uint16_t>(value));
+        }
+        if (pixels != nullptr) {
+            pixels[i] = pixel;
+        }
+    }
+    if (pixels == nullptr) {
+        Logger::warn("Invalid or oversized sprite skipped", "API");
+        return;
+    }
+
+    out.op = DrawOp::Sprite;
+    out.args[0] = getInt16(cmd, "x", 0);
+    out.args[1] = getInt16(cmd, "y", 0);
+    out.args[2] = static_cast<int16_t>(width);
+    out.args[3] = static_cast<int16_t>(height);
+    out.ref = batch.addSprite(SpriteSpec{pixels, static_cast<uint16_t>(width), static_cast<uint16_t>(height)});
+}
+
+// Parse one batch command, unknown types give DrawOp::None
+static auto parseBatchCommand(const JsonObject& cmd, BatchColors& colors, DrawBatch& batch) -> DrawCommand {
+    DrawCommand out{};
+    const char* cmdType = cmd["type"] | "";
+
+    out.color = colors.resolve(cmd["color"], LCD_WHITE);
+    out.alpha = static_cast<uint8_t>(std::min(std::max(cmd["alpha"] | static_cast<int>(UINT8_MAX), 0),
+                                              static_cast<int>(UINT8_MAX)));
+    if (cmd.containsKey("bg")) {
+        // Backdrop of a translucent shape (text reads it again as its own background)
+        out.bg = colors.resolve(cmd["bg"], LCD_BLACK);
+        out.hasBg = true;
+    }
+
+    if (strcmp(cmdType, "clear") == 0) {
+        out.op = DrawOp::Clear;
+        out.fill = !cmd["color"].isNull();
+    } else if (strcmp(cmdType, "rect") == 0) {
+        out.op = DrawOp::Rect;
+        parseBatchRect(cmd, out);
+    } else if (strcmp(cmdType, "circle") == 0) {
+        out.op = DrawOp::Circle;
+        parseBatchCircle(cmd, out);
+    } else if (strcmp(cmdType, "line") == 0) {
+        out.op = DrawOp::Line;
+        parseBatchStyledLine(cmd, out);
+    } else if (strcmp(cmdType, "arc") == 0) {
+        out.op = DrawOp::Arc;
+        parseBatchArc(cmd, out, 1, DEFAULT_ARC_SWEEP);
+    } else if (strcmp(cmdType, "ring") == 0) {
+        out.op = DrawOp::Arc;
+        parseBatchArc(cmd, out, DEFAULT_RING_THICKNESS, FULL_TURN_DEGREES);
+    } else if (strcmp(cmdType, "pixel") == 0) {
+        out.op = DrawOp::Pixel;
+        parseBatchPixel(cmd, out);
+    } else if (strcmp(cmdType, "text") == 0) {
+        out.op = DrawOp::Text;
+        parseBatchText(cmd, out, colors);
+    } else if (strcmp(cmdType, "triangle") == 0) {
+        out.op = DrawOp::Triangle;
+        parseBatchTriangle(cmd, out);
+    } else if (strcmp(cmdType, "ellipse") == 0) {
+        out.op = DrawOp::Ellipse;
+        parseBatchEllipse(cmd, out);
+    } else if (strcmp(cmdType, "roundrect") == 0) {
+        out.op = DrawOp::RoundRect;
+        parseBatchRoundRect(cmd, out);
+    } else if (strcmp(cmdType, "push_clip") == 0) {
+        out.op = DrawOp::PushClip;
+        parseBatchRect(cmd, out);
+    } else if (strcmp(cmdType, "pop_clip") == 0) {
+        out.op = DrawOp::PopClip;
+    } else if (strcmp(cmdType, "translate") == 0) {
+        out.op = DrawOp::Translate;
+        parseBatchPixel(cmd, out);
+    } else if (strcmp(cmdType, "gradient") == 0) {
+        parseBatchGradient(cmd, out, colors, batch);
+    } else if (strcmp(cmdType, "polygon") == 0 || strcmp(cmdType, "path") == 0) {
+        parseBatchPath(cmd, out, batch, strcmp(cmdType, "polygon") == 0);
+    } else if (strcmp(cmdType, "sprite") == 0) {
+        parseBatchSprite(cmd, out, batch);
+    }
+
+    return out;
+}
+
+/**
+ * @brief Compiled macros loaded by one batch, each read once however often the batch invokes it
+ */
+struct BatchMacros {
+    std::vector<std::pair<const char*, std::unique_ptr<MacroProgram>>> programs;
+    size_t invocations = 0;
+
+    auto get(const char* name) -> const MacroProgram* {
+        for (const auto& entry : programs) {
+            if (strcmp(entry.first, name) == 0) {
+                return entry.second.get();
+            }
+        }
+
+        std::unique_ptr<MacroProgram> program = Macro::load(name);
+        if (!program) {
+            return nullptr;
+        }
+        programs.emplace_back(name, std::move(program));
+        return programs.back().second.get();
+    }
+};
+
+/**
+ * @brief Expand a {"type": "macro", "name": "header", "args": {"x": 10, "text": "Hi"}} batch command
+ *
+ * Each argument is read once, as the number, color and/or text its slots need
+ *
+ * @return false if there is no macro with this name
+ */
+static auto expandMacro(const JsonObject& cmd, BatchColors& colors, DrawBatch& batch, BatchMacros& macros) -> bool {
+    const MacroProgram* program = macros.get(cmd["name"] | "");
+    if (program == nullptr) {
+        return false;
+    }
+
+    const uint32_t startUs = micros();
+    const JsonObject values = cmd["args"];
+    std::array<MacroArg, MACRO_MAX_PARAMS> args{};
+
+    for (size_t i = 0; i < program->paramCount(); ++i) {
+        const JsonVariant value = values[program->paramName(i)];
+        if (value.isNull()) {
+            continue;
+        }
+
+        const uint8_t uses = program->paramUses(i);
+        args[i].set = true;
+        if ((uses & MACRO_USE_NUMBER) != 0) {
+            args[i].number = static_cast<int16_t>(value.as<int>());
+        }
+        if ((uses & MACRO_USE_COLOR) != 0) {
+            args[i].color = colors.resolve(value, LCD_WHITE);
+        }
+        if ((uses & MACRO_USE_TEXT) != 0) {
+            args[i].text = value.as<const char*>();
+        }
+    }
+
+    if (!program->expand(batch, args.data())) {
+        Logger::warn("Macro paths skipped, batch arena full", "API");
+    }
+    macros.invocations++;
+    Macro::recordExpand(micros() - startUs);
+
+    return true;
+}
+
+/**
+ * @brief What drawing a batch did
+ */
+struct BatchReport {
+    size_t processed;
+    size_t executed;
+    DrawBatchStats stats;
+    size_t macros;
+};
+
+// Parse, optimize and draw a batch document, returns an error message or nullptr
+static auto drawBatchDocument(JsonDocument& doc, BatchReport& report) -> const char* {
+    JsonArray commands = doc["commands"].as<JsonArray>();
+    DrawBatch batch(commands.size());
+    BatchColors colors;
+
+    colors.loadPalette(doc["palette"].as<JsonArray>());
+    BatchMacros macros;
+    for (JsonObject cmd : commands) {
+        if (strcmp(cmd["type"] | "", "macro") != 0) {
+            batch.add(parseBatchCommand(cmd, colors, batch));
+        } else if (!expandMacro(cmd, colors, batch, macros)) {
+            return "unknown macro";
+        }
+    }
+
+    report.stats = DrawBatchStats{0, 0, 0};
+    if (doc["optimize"] | true) {
+        report.stats = batch.optimize(DisplayManager::screenWidth(), DisplayManager::screenHeight());
     }
+
+    report.processed = commands.size();
+    report.executed = batch.execute();
+    report.macros = macros.invocations;
+
+    return nullptr;
 }
 
 /**
@@ -1002,6 +1686,26 @@ static auto processBatchRoundRect(const JsonObject& cmd, uint16_t color) -> void
  *   {"type": "circle", "x": 180, "y": 60, "r": 30, "color": "#00ff00", "fill": true},
  *   {"type": "line", "x0": 0, "y0": 0, "x1": 240, "y1": 240, "color": "#0000ff"}
  * ]}
+ * "alpha": 0-255 makes a command translucent, it is blended over "bg" or over the last clear color
+ * "palette": ["#000000", "#ff0000"] declares colors once, "color"/"bg" may then be a palette index instead of a string
+ * Viewport commands (scoped to the batch, clip coordinates are translated):
+ *   {"type": "push_clip", "x": 0, "y": 0, "w": 120, "h": 60}, {"type": "translate", "x": 10, "y": 10},
+ *   {"type": "pop_clip"} restores the clip and translation saved by the matching push_clip
+ * Lines take "width" and "cap" ("butt", "square", "round") for thick lines, or "aa": true for an anti-aliased hairline
+ * Arcs: {"type": "arc", "x": 120, "y": 120, "r": 100, "thickness": 12, "start": -120, "sweep": 240, "cap": "round"}
+ *   angles in degrees clockwise from 12 o'clock, "ring" is the same with a full 360 sweep by default
+ * Filled shapes: {"type": "polygon", "points": [[10, 10], [60, 20], [30, 70]]} or
+ *   {"type": "path", "d": "M 10 10 L 100 10 Q 120 60 60 100 Z"} (M/L/Q/Z, lowercase relative), "rule": "evenodd"
+ * Gradient fill (linear or radial, 2-4 stops, always opaque):
+ *   {"type": "gradient", "x": 0, "y": 0, "w": 240, "h": 240, "kind": "linear", "x0": 0, "y0": 0, "x1": 0, "y1": 239,
+ *    "stops": ["#000040", {"at": 0.7, "color": "#4080ff"}, "#ffffff"], "dither": true}
+ *   radial gradients take "cx", "cy" and "r" instead of the x0..y1 axis
+ * Sprites: {"type": "sprite", "x": 10, "y": 10, "w": 2, "h": 1, "data": "f80007e0", "alpha": 128}, 4 hex digits of
+ *   RGB565 per pixel, composited over "bg" or the last clear color like the other translucent commands
+ * Stored macros: {"type": "macro", "name": "header", "args": {"title": "Hi"}} replays a macro from its compiled form,
+ *   "args" override its parameters (see /api/v1/macro). An unknown macro fails the whole batch before anything is drawn
+ * Commands hidden by later opaque fills are dropped and same-colour rects are merged before drawing, the response
+ * reports how many commands were culled/merged and the pixels saved. "optimize": false disables the pre-pass
  */
 void handleDrawBatch(Webserver* webserver) {
     String body = webserver->raw().arg("plain");
@@ -1013,42 +1717,2167 @@ void handleDrawBatch(Webserver* webserver) {
         return;
     }
 
-    JsonArray commands = doc["commands"].as<JsonArray>();
-    int processed = 0;
+    BatchReport report{};
+    const char* error = drawBatchDocument(doc, report);
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
 
-    for (JsonObject cmd : commands) {
-        String cmdType = cmd.containsKey("type") ? cmd["type"].as<String>() : "";
-        uint16_t color = getColorFromJson(cmd);
-
-        if (cmdType == "clear") {
-            DisplayManager::fillScreen(color);
-        } else if (cmdType == "rect") {
-            processBatchRect(cmd, color);
-        } else if (cmdType == "circle") {
-            processBatchCircle(cmd, color);
-        } else if (cmdType == "line") {
-            processBatchLine(cmd, color);
-        } else if (cmdType == "pixel") {
-            processBatchPixel(cmd, color);
-        } else if (cmdType == "text") {
-            processBatchText(cmd, color);
-        } else if (cmdType == "triangle") {
-            processBatchTriangle(cmd, color);
-        } else if (cmdType == "ellipse") {
-            processBatchEllipse(cmd, color);
-        } else if (cmdType == "roundrect") {
-            processBatchRoundRect(cmd, color);
+    JsonDocument resp;
+    resp["status"] = "ok";
+    resp["processed"] = report.processed;
+    resp["executed"] = report.executed;
+    resp["culled"] = report.stats.culled;
+    resp["merged"] = report.stats.merged;
+    resp["pixelsSaved"] = report.stats.pixelsSaved;
+    resp["macros"] = report.macros;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Fill a rectangle with a linear or radial gradient
+ * POST /api/v1/draw/gradient
+ * Body: {"x": 0, "y": 0, "w": 240, "h": 240, "kind": "radial", "cx": 120, "cy": 120, "r": 120,
+ *        "stops": ["#ffffff", "#000000"], "dither": true}
+ * Same fields as the batch "gradient" command
+ */
+void handleDrawGradient(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, body);
+
+    if (err) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    JsonObject cmd = doc.as<JsonObject>();
+    BatchColors colors;
+    DrawCommand rect{};
+    GradientSpec spec{};
+
+    parseBatchRect(cmd, rect);
+    if (!parseGradientSpec(cmd, colors, rect.args, spec)) {
+        sendErrorResponse(webserver, "stops must hold 2 to 4 colors");
+        return;
+    }
+
+    const std::unique_ptr<Gradient> gradient(new Gradient(spec));
+    DisplayManager::fillGradient(rect.args[0], rect.args[1], rect.args[2], rect.args[3], *gradient);
+    sendSuccessResponse(webserver);
+}
+
+// Bitmap being streamed to /api/v1/draw/bitmap, and why it was refused if it was
+static std::unique_ptr<BitmapStream> s_bitmapStream;
+static const char* s_bitmapError = nullptr;
+
+// Read the placement and layout of a raw bitmap from the query string, returns an error message or nullptr
+static auto parseBitmapSpec(Webserver* webserver, BitmapSpec& spec) -> const char* {
+    ESP8266WebServer& server = webserver->raw();
+    const long width = server.arg("w").toInt();
+    const long height = server.arg("h").toInt();
+
+    if (width < 1 || height < 1 || width > BITMAP_MAX_SIDE || height > BITMAP_MAX_SIDE) {
+        return "w and h must be between 1 and 1024";
+    }
+
+    const String format = server.arg("format");
+    if (format.isEmpty() || format == "rgb565") {
+        spec.format = BitmapFormat::Rgb565;
+    } else if (format == "rgb565le") {
+        spec.format = BitmapFormat::Rgb565Le;
+    } else if (format == "mask") {
+        spec.format = BitmapFormat::Mask;
+    } else if (format == "indexed") {
+        spec.format = BitmapFormat::Indexed;
+    } else {
+        return "format must be rgb565, rgb565le, mask or indexed";
+    }
+
+    spec.x = static_cast<int16_t>(server.arg("x").toInt());
+    spec.y = static_cast<int16_t>(server.arg("y").toInt());
+    spec.width = static_cast<uint16_t>(width);
+    spec.height = static_cast<uint16_t>(height);
+    spec.color = Rgb565::parseHex(server.arg("color").c_str(), LCD_WHITE);
+    spec.transparent = !server.hasArg("bg");
+    spec.background = Rgb565::parseHex(server.arg("bg").c_str(), LCD_BLACK);
+
+    const long colors = server.hasArg("colors") ? server.arg("colors").toInt() : BITMAP_PALETTE_MAX;
+    if (colors < 1 || colors > BITMAP_PALETTE_MAX) {
+        return "colors must be between 1 and 256";
+    }
+    spec.paletteSize = static_cast<uint16_t>(colors);
+
+    return nullptr;
+}
+
+/**
+ * @brief Write a raw bitmap body to the panel while it is received
+ *
+ * The body goes through PanelRowWriter's row buffer, it is never held in full
+ */
+void handleDrawBitmapStream(Webserver* webserver) {
+    HTTPRaw& body = webserver->raw().raw();
+
+    switch (body.status) {
+        case RAW_START: {
+            BitmapSpec spec{};
+
+            s_bitmapStream.reset();
+            s_bitmapError = parseBitmapSpec(webserver, spec);
+            if (s_bitmapError == nullptr) {
+                DisplayManager::stopGifPlayback();
+                s_bitmapStream.reset(new (std::nothrow) BitmapStream(spec));
+            }
+            break;
         }
+        case RAW_WRITE:
+            if (s_bitmapStream) {
+                s_bitmapStream->feed(body.buf, body.currentSize);
+            }
+            break;
+        case RAW_ABORTED:
+            s_bitmapStream.reset();
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Draw a raw bitmap streamed as the request body
+ * POST /api/v1/draw/bitmap?x=0&y=0&w=240&h=240&format=rgb565 (Content-Type: application/octet-stream)
+ * format: rgb565 (big-endian, the default), rgb565le, mask (1 bit per pixel, "color" for 1 bits, "bg" for 0 bits
+ * or transparent without it) or indexed ("colors" big-endian RGB565 palette entries, then 1 byte per pixel)
+ */
+void handleDrawBitmap(Webserver* webserver) {
+    const char* error = s_bitmapError;
+    s_bitmapError = nullptr;
 
-        processed++;
-        yield();  // Allow other tasks to run between commands
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
+    if (!s_bitmapStream) {
+        sendErrorResponse(webserver, "missing bitmap body");
+        return;
     }
 
+    s_bitmapStream->finish();
+
     JsonDocument resp;
-    resp["status"] = "ok";
-    resp["processed"] = processed;
+    const bool complete = s_bitmapStream->done();
+    resp["status"] = complete ? "ok" : "error";
+    if (!complete) {
+        resp["message"] = "incomplete bitmap body";
+    }
+    resp["pixels"] = s_bitmapStream->pixelsWritten();
+    resp["decodeUs"] = s_bitmapStream->busyUs();
+    s_bitmapStream.reset();
 
     String jsonOut;
     serializeJson(resp, jsonOut);
-    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
-}
\ No newline at end of file
+    webserver->raw().send(complete ? HTTP_CODE_OK : HTTP_CODE_INTERNAL_ERROR, "application/json", jsonOut);
+}
+
+// ============================================================================
+// Macro API Handlers
+// ============================================================================
+
+/**
+ * @brief Keys a parameter may stand for in one command type, the DrawCommand arguments in order
+ */
+struct MacroArgKeys {
+    const char* type;
+    std::array<const char*, DRAW_COMMAND_ARGS> keys;
+};
+
+static constexpr std::array<MacroArgKeys, 12> MACRO_ARG_KEYS = {{
+    {"rect", {"x", "y", "w", "h"}},
+    {"push_clip", {"x", "y", "w", "h"}},
+    {"roundrect", {"x", "y", "w", "h", "r"}},
+    {"circle", {"x", "y", "r"}},
+    {"ellipse", {"x", "y", "rx", "ry"}},
+    {"line", {"x0", "y0", "x1", "y1"}},
+    {"arc", {"x", "y", "r", "thickness", "start", "sweep"}},
+    {"ring", {"x", "y", "r", "thickness", "start", "sweep"}},
+    {"pixel", {"x", "y"}},
+    {"translate", {"x", "y"}},
+    {"text", {"x", "y"}},
+    {"triangle", {"x0", "y0", "x1", "y1", "x2", "y2"}},
+}};
+
+/**
+ * @brief Field of a compiled command a key is written to
+ *
+ * Keys that change the shape of a command (fill, width, cap, gradient stops, path data) cannot be parameters, their
+ * default decides how the command is compiled
+ *
+ * @return false if the key cannot be a parameter for this command type
+ */
+static auto macroField(const char* type, const char* key, MacroField& field) -> bool {
+    if (strcmp(key, "color") == 0) {
+        field = MacroField::Color;
+        return true;
+    }
+    if (strcmp(key, "bg") == 0) {
+        field = MacroField::Bg;
+        return true;
+    }
+    if (strcmp(key, "alpha") == 0) {
+        field = MacroField::Alpha;
+        return true;
+    }
+    if (strcmp(type, "text") == 0 && strcmp(key, "text") == 0) {
+        field = MacroField::Text;
+        return true;
+    }
+    if (strcmp(type, "text") == 0 && strcmp(key, "size") == 0) {
+        field = MacroField::Size;
+        return true;
+    }
+
+    for (const MacroArgKeys& entry : MACRO_ARG_KEYS) {
+        if (strcmp(entry.type, type) != 0) {
+            continue;
+        }
+        for (uint8_t i = 0; i < DRAW_COMMAND_ARGS; ++i) {
+            if (entry.keys[i] != nullptr && strcmp(entry.keys[i], key) == 0) {
+                field = static_cast<MacroField>(static_cast<uint8_t>(MacroField::Arg0) + i);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Compile the commands of a macro upload
+ *
+ * Every "$name" value must be declared in "params" with its default. The default is put in its place and the
+ * command goes through the batch parser, so the compiled command is exactly what the batch would draw; the key
+ * is then recorded as a slot the invocation may override
+ *
+ * @return An error message, nullptr on success
+ */
+static auto compileMacro(const JsonObject& doc, MacroProgram& program) -> const char* {
+    const JsonObject params = doc["params"];
+    for (JsonPair param : params) {
+        if (program.addParam(param.key().c_str()) < 0) {
+            return "at most 16 parameters, names up to 15 characters";
+        }
+    }
+
+    DrawBatch scratch;
+    BatchColors colors;
+    colors.loadPalette(doc["palette"].as<JsonArray>());
+
+    for (JsonObject cmd : doc["commands"].as<JsonArray>()) {
+        std::array<std::pair<const char*, uint8_t>, MACRO_MAX_PARAMS> slots{};
+        size_t slotCount = 0;
+
+        for (JsonPair pair : cmd) {
+            const char* value = pair.value().as<const char*>();
+            if (value == nullptr || value[0] != '$') {
+                continue;
+            }
+            const int param = program.findParam(value + 1);
+            if (param < 0) {
+                return "parameter used but not declared in params";
+            }
+            if (slotCount == slots.size()) {
+                return "too many parameters in one command";
+            }
+            slots[slotCount++] = {pair.key().c_str(), static_cast<uint8_t>(param)};
+        }
+        for (size_t i = 0; i < slotCount; ++i) {
+            cmd[slots[i].first] = params[program.paramName(slots[i].second)];
+        }
+
+        const char* type = cmd["type"] | "";
+        if (strcmp(type, "macro") == 0) {
+            return "macros cannot invoke macros";
+        }
+
+        DrawCommand out = parseBatchCommand(cmd, colors, scratch);
+        if (out.op == DrawOp::None) {
+            return "unknown or invalid command";
+        }
+        if (out.op == DrawOp::Sprite) {
+            return "sprites cannot be stored in a macro";
+        }
+        if (out.op == DrawOp::Gradient) {
+            out.ref = program.addGradient(scratch.gradient(out.ref));
+        } else if (out.op == DrawOp::Path) {
+            out.ref = program.addPath(scratch.path(out.ref));
+        }
+        if (!program.addCommand(out)) {
+            return "macro too large (128 commands, 2 KB of text)";
+        }
+
+        for (size_t i = 0; i < slotCount; ++i) {
+            MacroField field = MacroField::Arg0;
+            if (!macroField(type, slots[i].first, field)) {
+                return "this key cannot be a parameter";
+            }
+            program.bind(field, slots[i].second);
+        }
+    }
+
+    return program.commandCount() > 0 ? nullptr : "missing commands";
+}
+
+/**
+ * @brief Compile and store a draw macro
+ * POST /api/v1/macro
+ * Body: {"name": "header", "params": {"title": "Home", "color": "#ffffff"}, "palette": [...],
+ *        "commands": [{"type": "rect", "x": 0, "y": 0, "w": 240, "h": 40, "color": "#202040"},
+ *                     {"type": "text", "x": 10, "y": 12, "text": "$title", "size": 2, "color": "$color"}]}
+ * The commands are the batch commands; a "$name" value is a parameter slot, declared with its default in
+ * "params". Coordinates, color, bg, alpha, and the text and size of text commands can be parameters. The macro is
+ * validated and compiled now and replayed from its compiled form by {"type": "macro"} batch commands
+ */
+void handleStoreMacro(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    const char* name = doc["name"] | "";
+    if (!Macro::validName(name)) {
+        sendErrorResponse(webserver, "name must be 1 to 23 letters, digits, '_' or '-'");
+        return;
+    }
+
+    MacroProgram program;
+    const char* error = compileMacro(doc.as<JsonObject>(), program);
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
+    if (!Macro::store(name, program)) {
+        sendErrorResponse(webserver, "macro could not be stored (32 macros at most)");
+        return;
+    }
+
+    JsonDocument resp;
+    resp["status"] = "ok";
+    resp["name"] = name;
+    resp["commands"] = program.commandCount();
+    resp["params"] = program.paramCount();
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief List the stored macros (from the RAM index)
+ * GET /api/v1/macro
+ */
+void handleListMacros(Webserver* webserver) {
+    JsonDocument resp;
+    JsonArray list = resp["macros"].to<JsonArray>();
+
+    for (const MacroInfo& info : Macro::index()) {
+        JsonObject entry = list.add<JsonObject>();
+        entry["name"] = info.name.data();
+        entry["commands"] = info.commands;
+        entry["params"] = info.params;
+        entry["bytes"] = info.bytes;
+    }
+    resp["max"] = MACRO_MAX_STORED;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Delete a stored macro
+ * POST /api/v1/macro/delete
+ * Body: {"name": "header"}
+ */
+void handleDeleteMacro(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+    if (!Macro::remove(doc["name"] | "")) {
+        sendErrorResponse(webserver, "no macro with this name");
+        return;
+    }
+
+    sendSuccessResponse(webserver);
+}
+
+// ============================================================================
+// Template API Handlers
+// ============================================================================
+
+// Largest text size of a template widget
+static constexpr uint8_t TEMPLATE_TEXT_SIZE_MAX = 8;
+static constexpr int32_t TEMPLATE_BAR_MAX = 100;
+
+static constexpr std::array<std::pair<const char*, TemplateWidgetKind>, 4> TEMPLATE_WIDGET_KINDS = {{
+    {"label", TemplateWidgetKind::Label},
+    {"text", TemplateWidgetKind::Text},
+    {"bar", TemplateWidgetKind::Bar},
+    {"fill", TemplateWidgetKind::Fill},
+}};
+
+static constexpr std::array<std::pair<const char*, TemplateRegion>, 4> TEMPLATE_REGIONS = {{
+    {"screen", TemplateRegion::Screen},
+    {"status", TemplateRegion::Status},
+    {"body", TemplateRegion::Body},
+    {"footer", TemplateRegion::Footer},
+}};
+
+static constexpr std::array<std::pair<const char*, TemplateAlign>, 3> TEMPLATE_ALIGNS = {{
+    {"left", TemplateAlign::Left},
+    {"center", TemplateAlign::Center},
+    {"right", TemplateAlign::Right},
+}};
+
+// Look a name up in one of the tables above, false when it is not there
+template <typename T, size_t N>
+static auto lookupName(const std::array<std::pair<const char*, T>, N>& names, const char* name, T& out) -> bool {
+    for (const auto& entry : names) {
+        if (strcmp(entry.first, name) == 0) {
+            out = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Read a value as text: strings as they are, numbers and booleans as JSON writes them
+static auto templateValue(const JsonVariantConst& value, std::array<char, TEMPLATE_VALUE_MAX>& out) -> const char* {
+    if (value.is<const char*>()) {
+        return value.as<const char*>();
+    }
+    const size_t length = serializeJson(value, out.data(), out.size() - 1);
+    out[length] = '\0';
+    return out.data();
+}
+
+// Parse one widget into the template, returns an error message or nullptr
+static auto parseTemplateWidget(const JsonObject& obj, uint16_t background, TemplateScreen& screen) -> const char* {
+    TemplateWidget widget{};
+    if (!lookupName(TEMPLATE_WIDGET_KINDS, obj["type"] | "", widget.kind)) {
+        return "unknown widget type";
+    }
+    if (!lookupName(TEMPLATE_REGIONS, obj["region"] | "screen", widget.region)) {
+        return "unknown region (screen, status, body or footer)";
+    }
+    if (!lookupName(TEMPLATE_ALIGNS, obj["align"] | "left", widget.align)) {
+        return "unknown align (left, center or right)";
+    }
+
+    widget.x = getInt16(obj, "x", DEFAULT_POS);
+    widget.y = getInt16(obj, "y", DEFAULT_POS);
+    widget.w = getInt16(obj, "w", 0);
+    widget.h = getInt16(obj, "h", 0);
+    widget.size = static_cast<uint8_t>(std::clamp<int>(obj["size"] | static_cast<int>(DEFAULT_TEXT_SIZE), 1, TEMPLATE_TEXT_SIZE_MAX));
+    widget.color = getColorFromJson(obj);
+    widget.bg = obj.containsKey("bg") ? getColorFromJson(obj, "bg") : background;
+    widget.min = obj["min"] | 0;
+    widget.max = obj["max"] | TEMPLATE_BAR_MAX;
+    widget.var = TEMPLATE_NO_VAR;
+
+    const char* text = widget.kind == TemplateWidgetKind::Label ? obj["text"] | "" : obj["format"] | "{}";
+    if (strlen(text) >= widget.text.size()) {
+        return "widget text too long (23 characters at most)";
+    }
+    strcpy(widget.text.data(), text);
+
+    if (widget.kind != TemplateWidgetKind::Label) {
+        const int var = screen.addVar(obj["var"] | "");
+        if (var < 0) {
+            return "missing var, or more than 16 variables or names over 15 characters";
+        }
+        widget.var = static_cast<uint8_t>(var);
+    }
+    if (widget.kind == TemplateWidgetKind::Bar && widget.max <= widget.min) {
+        return "bar max must be above min";
+    }
+
+    return screen.addWidget(widget) ? nullptr : "too many widgets, or widget outside its region";
+}
+
+// Helper to report what a template holds
+static auto describeTemplate(const JsonObject& out, const char* name, const TemplateScreen& screen) -> void {
+    out["name"] = name;
+    out["widgets"] = screen.widgetCount();
+    out["shown"] = Template::shown() != nullptr && strcmp(Template::shown(), name) == 0;
+
+    JsonObject values = out["values"].to<JsonObject>();
+    for (size_t i = 0; i < screen.varCount(); ++i) {
+        values[screen.varName(i)] = screen.value(i);
+    }
+}
+
+/**
+ * @brief Define a template, or replace the one with the same name
+ * POST /api/v1/template/<name>
+ * Body: {"background": "#000000", "values": {"temp": "--"},
+ *        "widgets": [{"type": "label", "region": "status", "x": 10, "y": 24, "text": "Office", "size": 2},
+ *                    {"type": "text", "region": "body", "x": 10, "y": 20, "w": 220, "var": "temp",
+ *                     "format": "{} C", "size": 4, "align": "right", "color": "#ffc040"},
+ *                    {"type": "bar", "region": "footer", "x": 10, "y": 20, "w": 220, "h": 12, "var": "cpu",
+ *                     "min": 0, "max": 100, "color": "#40ff80", "bg": "#202020"},
+ *                    {"type": "fill", "region": "status", "x": 210, "y": 22, "w": 20, "h": 20, "var": "state"}]}
+ * Positions are relative to the region (the layout rectangles of DisplayManager), w and h default to the rest of
+ * it. Variables are declared by the widgets bound to them, "values" gives their first values. Templates are kept in
+ * RAM (4 at most) until the next reboot
+ */
+void handleDefineTemplate(Webserver* webserver) {
+    const String name = webserver->raw().pathArg(0);
+    if (!Template::validName(name.c_str())) {
+        sendErrorResponse(webserver, "invalid name (1-15 letters, digits, - or _)");
+        return;
+    }
+
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    const uint16_t background = doc.containsKey("background") ? getColorFromJson(doc, "background") : LCD_BLACK;
+    std::unique_ptr<TemplateScreen> screen(new (std::nothrow) TemplateScreen(background));
+    if (!screen) {
+        sendErrorResponse(webserver, "out of memory");
+        return;
+    }
+
+    JsonArray widgets = doc["widgets"].as<JsonArray>();
+    if (widgets.size() == 0) {
+        sendErrorResponse(webserver, "missing widgets");
+        return;
+    }
+    for (JsonObject widget : widgets) {
+        const char* error = parseTemplateWidget(widget, background, *screen);
+        if (error != nullptr) {
+            sendErrorResponse(webserver, error);
+            return;
+        }
+    }
+
+    std::array<char, TEMPLATE_VALUE_MAX> scratch{};
+    for (JsonPairConst value : doc["values"].as<JsonObjectConst>()) {
+        const int var = screen->findVar(value.key().c_str());
+        if (var >= 0) {
+            screen->setValue(static_cast<size_t>(var), templateValue(value.value(), scratch));
+        }
+    }
+
+    TemplateScreen& defined = *screen;
+    if (!Template::define(name.c_str(), std::move(screen))) {
+        sendErrorResponse(webserver, "too many templates (4 at most)");
+        return;
+    }
+
+    JsonDocument resp;
+    resp["status"] = "ok";
+    describeTemplate(resp.as<JsonObject>(), name.c_str(), defined);
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Set template variables, the widgets bound to a changed one are drawn again
+ * POST /api/v1/template/<name>/values
+ * Body: {"temp": 21.5, "cpu": 42, "state": "#00ff00"}
+ * Unknown keys are ignored. Values are texts (numbers are written as JSON writes them); a value equal to the one
+ * the template holds costs nothing. When the template is not shown, the values are kept for when it is
+ */
+void handleTemplateValues(Webserver* webserver) {
+    TemplateScreen* screen = Template::find(webserver->raw().pathArg(0).c_str());
+    if (screen == nullptr) {
+        sendErrorResponse(webserver, "no template with this name");
+        return;
+    }
+
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    std::array<char, TEMPLATE_VALUE_MAX> scratch{};
+    uint32_t changed = 0;
+    uint32_t unknown = 0;
+    for (JsonPairConst value : doc.as<JsonObjectConst>()) {
+        const int var = screen->findVar(value.key().c_str());
+        if (var < 0) {
+            unknown++;
+        } else if (screen->setValue(static_cast<size_t>(var), templateValue(value.value(), scratch))) {
+            changed++;
+        }
+    }
+
+    const uint32_t drawn = Template::refresh(*screen, changed);
+
+    JsonDocument resp;
+    resp["status"] = "ok";
+    resp["changed"] = changed;
+    resp["unknown"] = unknown;
+    resp["drawn"] = drawn;
+    resp["renderUs"] = drawn > 0 ? Template::stats().lastRenderUs : 0;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Draw a template on the whole screen, later value posts update it in place
+ * POST /api/v1/template/<name>/show
+ * A playing GIF or a running effect is stopped first
+ */
+void handleShowTemplate(Webserver* webserver) {
+    if (!Template::show(webserver->raw().pathArg(0).c_str())) {
+        sendErrorResponse(webserver, "no template with this name");
+        return;
+    }
+
+    JsonDocument resp;
+    resp["status"] = "ok";
+    resp["renderUs"] = Template::stats().lastRenderUs;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Drop a template, what it drew stays on the screen
+ * POST /api/v1/template/<name>/delete
+ */
+void handleDeleteTemplate(Webserver* webserver) {
+    if (!Template::remove(webserver->raw().pathArg(0).c_str())) {
+        sendErrorResponse(webserver, "no template with this name");
+        return;
+    }
+
+    sendSuccessResponse(webserver);
+}
+
+/**
+ * @brief List the templates with their current values
+ * GET /api/v1/template
+ */
+void handleListTemplates(Webserver* webserver) {
+    JsonDocument resp;
+    JsonArray list = resp["templates"].to<JsonArray>();
+
+    for (const char* name : Template::names()) {
+        describeTemplate(list.add<JsonObject>(), name, *Template::find(name));
+    }
+    resp["max"] = TEMPLATE_MAX;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+// ============================================================================
+// Script API Handlers
+// ============================================================================
+
+// Bytecode being received by /api/v1/script
+static std::unique_ptr<uint8_t[]> s_scriptUpload;
+static size_t s_scriptUploadBytes = 0;
+static const char* s_scriptUploadError = nullptr;
+
+static auto sendScriptState(Webserver* webserver) -> void {
+    JsonDocument resp;
+    const ScriptVm& vm = Script::vm();
+    const ScriptStats stats = Script::stats();
+    const char* running = Script::running();
+
+    resp["status"] = "ok";
+    resp["running"] = running != nullptr ? running : "none";
+    resp["state"] = Script::stateName(vm.state());
+    resp["fault"] = Script::faultName(vm.fault());
+    resp["pc"] = vm.pc();
+    resp["ticks"] = stats.ticks;
+    resp["instructions"] = stats.instructions;
+    resp["draws"] = stats.draws;
+    resp["vmUs"] = stats.vmUs;
+    resp["lastTickUs"] = stats.lastTickUs;
+    resp["maxTickUs"] = stats.maxTickUs;
+    resp["budget"] = SCRIPT_TICK_BUDGET;
+
+    JsonArray globals = resp["globals"].to<JsonArray>();
+    for (size_t i = 0; i < vm.globalCount(); ++i) {
+        globals.add(vm.global(i));
+    }
+    JsonArray counters = resp["counters"].to<JsonArray>();
+    for (size_t i = 0; i < SCRIPT_COUNTERS; ++i) {
+        counters.add(Script::counter(i));
+    }
+    JsonArray stored = resp["stored"].to<JsonArray>();
+    for (const String& name : Script::names()) {
+        stored.add(name);
+    }
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Collect a bytecode body while it is received, the file is small enough to be held in full
+ */
+void handleScriptUpload(Webserver* webserver) {
+    HTTPRaw& body = webserver->raw().raw();
+
+    switch (body.status) {
+        case RAW_START:
+            s_scriptUploadBytes = 0;
+            s_scriptUploadError = nullptr;
+            s_scriptUpload.reset(new (std::nothrow) uint8_t[SCRIPT_FILE_MAX]);
+            if (!s_scriptUpload) {
+                s_scriptUploadError = "out of memory";
+            }
+            break;
+        case RAW_WRITE:
+            if (!s_scriptUpload) {
+                break;
+            }
+            if (s_scriptUploadBytes + body.currentSize > SCRIPT_FILE_MAX) {
+                s_scriptUpload.reset();
+                s_scriptUploadError = "script too large";
+                break;
+            }
+            memcpy(s_scriptUpload.get() + s_scriptUploadBytes, body.buf, body.currentSize);
+            s_scriptUploadBytes += body.currentSize;
+            break;
+        case RAW_ABORTED:
+            s_scriptUpload.reset();
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Store a compiled script, and start it with run=1
+ * POST /api/v1/script?name=clock&run=1 (Content-Type: application/octet-stream, body: the bytecode file)
+ * The bytecode is verified before it is stored, see examples/holoscript.py for the assembler
+ */
+void handleStoreScript(Webserver* webserver) {
+    const std::unique_ptr<uint8_t[]> image = std::move(s_scriptUpload);
+    const char* error = s_scriptUploadError;
+    s_scriptUploadError = nullptr;
+
+    if (error == nullptr && !image) {
+        error = "missing script body";
+    }
+    const String name = webserver->raw().arg("name");
+    if (error == nullptr) {
+        error = Script::store(name.c_str(), image.get(), s_scriptUploadBytes);
+    }
+    if (error == nullptr && webserver->raw().arg("run") == "1") {
+        error = Script::run(name.c_str());
+    }
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
+
+    sendScriptState(webserver);
+}
+
+/**
+ * @brief Start a stored script from its beginning
+ * POST /api/v1/script/run
+ * Body: {"name": "clock"}
+ * A playing GIF, a running effect or a shown template is stopped first
+ */
+void handleRunScript(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    const char* error = Script::run(doc["name"] | "");
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
+
+    sendScriptState(webserver);
+}
+
+/**
+ * @brief Stop the running script, what it drew stays on the screen
+ * POST /api/v1/script/stop
+ */
+void handleStopScript(Webserver* webserver) {
+    Script::stop();
+    sendScriptState(webserver);
+}
+
+/**
+ * @brief Delete a stored script
+ * POST /api/v1/script/delete
+ * Body: {"name": "clock"}
+ */
+void handleDeleteScript(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+    if (!Script::remove(doc["name"] | "")) {
+        sendErrorResponse(webserver, "no script with this name");
+        return;
+    }
+
+    sendSuccessResponse(webserver);
+}
+
+/**
+ * @brief Set the counters scripts read with the Input instruction
+ * POST /api/v1/script/counters
+ * Body: {"counters": [3, 12]} (counter 0 onwards, null leaves a counter as it is)
+ */
+void handleScriptCounters(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    JsonArray counters = doc["counters"].as<JsonArray>();
+    if (counters.size() > SCRIPT_COUNTERS) {
+        sendErrorResponse(webserver, "too many counters (8 at most)");
+        return;
+    }
+
+    size_t index = 0;
+    for (JsonVariant value : counters) {
+        if (!value.isNull()) {
+            Script::setCounter(index, value.as<int32_t>());
+        }
+        index++;
+    }
+
+    sendSuccessResponse(webserver);
+}
+
+/**
+ * @brief State of the running (or last) script
+ * GET /api/v1/script
+ */
+void handleGetScript(Webserver* webserver) { sendScriptState(webserver); }
+
+// ============================================================================
+// Data Source API Handlers
+// ============================================================================
+
+/**
+ * @brief Define a JSON endpoint the device polls, its values go to the variables of a template
+ * POST /api/v1/source
+ * Body: {"name": "weather", "url": "http://10.0.0.2/now.json", "interval": 60, "template": "home",
+ *        "bind": {"temp": "current.temp", "cpu": "hosts[0].cpu"}}
+ * interval is in seconds (5 at least). A source with the same name is replaced
+ */
+void handleDefineSource(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    const char* name = doc["name"] | "";
+    const char* templateName = doc["template"] | "";
+    if (name[0] == '\0' || strlen(name) >= DATA_SOURCE_NAME_MAX) {
+        sendErrorResponse(webserver, "name must be 1 to 15 characters");
+        return;
+    }
+    if (Template::find(templateName) == nullptr) {
+        sendErrorResponse(webserver, "no template with this name");
+        return;
+    }
+
+    DataSourceSpec spec{};
+    strlcpy(spec.name.data(), name, spec.name.size());
+    strlcpy(spec.templateName.data(), templateName, spec.templateName.size());
+    spec.url = doc["url"] | "";
+    spec.intervalMs = (doc["interval"] | 60U) * 1000U;
+
+    for (JsonPairConst bind : doc["bind"].as<JsonObjectConst>()) {
+        DataSourceBinding binding{};
+        if (strlen(bind.key().c_str()) >= binding.var.size() ||
+            !DataSource::parsePath(bind.value() | "", binding.path)) {
+            sendErrorResponse(webserver, "invalid binding, expected {\"var\": \"key.key[index]\"}");
+            return;
+        }
+        strlcpy(binding.var.data(), bind.key().c_str(), binding.var.size());
+        spec.bindings.push_back(std::move(binding));
+    }
+
+    const char* error = DataSource::define(spec);
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
+
+    sendSuccessResponse(webserver);
+}
+
+/**
+ * @brief List the data sources with their poll counters
+ * GET /api/v1/source
+ */
+void handleListSources(Webserver* webserver) {
+    JsonDocument resp;
+    JsonArray list = resp["sources"].to<JsonArray>();
+
+    for (size_t i = 0; i < DataSource::count(); ++i) {
+        const DataSourceSpec& spec = DataSource::spec(i);
+        const DataSourceStats stats = DataSource::stats(i);
+        JsonObject source = list.add<JsonObject>();
+
+        source["name"] = spec.name.data();
+        source["url"] = spec.url;
+        source["interval"] = spec.intervalMs / 1000;
+        source["template"] = spec.templateName.data();
+        source["bindings"] = spec.bindings.size();
+        source["polls"] = stats.polls;
+        source["notModified"] = stats.notModified;
+        source["errors"] = stats.errors;
+        source["valuesChanged"] = stats.valuesChanged;
+        source["lastStatus"] = stats.lastStatus;
+        source["lastPollMs"] = stats.lastPollMs;
+    }
+    resp["max"] = DATA_SOURCE_MAX;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Stop polling a source
+ * POST /api/v1/source/delete
+ * Body: {"name": "weather"}
+ */
+void handleDeleteSource(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    if (!DataSource::remove(doc["name"] | "")) {
+        sendErrorResponse(webserver, "no source with this name");
+        return;
+    }
+
+    sendSuccessResponse(webserver);
+}
+
+/**
+ * @brief Poll a source at the next chance instead of waiting for its interval
+ * POST /api/v1/source/poll
+ * Body: {"name": "weather"}
+ */
+void handlePollSource(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    if (!DataSource::pollSoon(doc["name"] | "")) {
+        sendErrorResponse(webserver, "no source with this name");
+        return;
+    }
+
+    sendSuccessResponse(webserver);
+}
+
+// ============================================================================
+// Animation API Handlers
+// ============================================================================
+
+static constexpr uint32_t DEFAULT_ANIMATION_MS = 500;
+static constexpr uint32_t MAX_ANIMATION_MS = 600000;
+
+static constexpr std::array<std::pair<const char*, Easing>, 6> EASING_NAMES = {{
+    {"easeIn", Easing::In},
+    {"easeOut", Easing::Out},
+    {"easeInOut", Easing::InOut},
+    {"easeInCubic", Easing::InCubic},
+    {"easeOutCubic", Easing::OutCubic},
+    {"easeInOutCubic", Easing::InOutCubic},
+}};
+
+// Read an easing name, linear when missing or unknown
+static auto parseEasing(const char* name) -> Easing {
+    for (const auto& entry : EASING_NAMES) {
+        if (strcmp(name, entry.first) == 0) {
+            return entry.second;
+        }
+    }
+    return Easing::Linear;
+}
+
+static auto easingName(Easing easing) -> const char* {
+    for (const auto& entry : EASING_NAMES) {
+        if (entry.second == easing) {
+            return entry.first;
+        }
+    }
+    return "linear";
+}
+
+// Read x, y, w, h, r and color, keeping base for the missing keys
+static auto parseAnimationState(const JsonObject& obj, const AnimationState& base) -> AnimationState {
+    return AnimationState{getInt16(obj, "x", base.x),
+                          getInt16(obj, "y", base.y),
+                          getInt16(obj, "w", base.w),
+                          getInt16(obj, "h", base.h),
+                          getInt16(obj, "r", base.r),
+                          obj.containsKey("color") ? getColorFromJson(obj) : base.color};
+}
+
+// Parse one animation, returns an error message or nullptr
+static auto parseAnimationSpec(const JsonObject& obj, AnimationSpec& spec) -> const char* {
+    const char* shape = obj["shape"] | "rect";
+
+    if (strcmp(shape, "rect") == 0) {
+        spec.shape = AnimationShape::Rect;
+    } else if (strcmp(shape, "roundrect") == 0) {
+        spec.shape = AnimationShape::RoundRect;
+    } else if (strcmp(shape, "circle") == 0) {
+        spec.shape = AnimationShape::Circle;
+    } else if (strcmp(shape, "text") == 0) {
+        spec.shape = AnimationShape::Text;
+    } else {
+        return "shape must be rect, roundrect, circle or text";
+    }
+
+    const JsonObject target = obj["to"];
+    if (target.isNull()) {
+        return "missing to";
+    }
+
+    spec.id = static_cast<uint8_t>(obj["id"] | 0);
+
+    // A running animation with the same id hands over the state it last drew
+    AnimationState base{DEFAULT_POS, DEFAULT_POS, DEFAULT_SIZE_MEDIUM, DEFAULT_SIZE_MEDIUM, DEFAULT_SIZE_SMALL,
+                        LCD_WHITE};
+    Animation::current(spec.id, base);
+
+    spec.from = parseAnimationState(obj, base);
+    spec.to = parseAnimationState(target, spec.from);
+    spec.fill = getBool(obj, "fill", true);
+    spec.easing = parseEasing(obj["easing"] | "linear");
+    spec.bg = obj.containsKey("bg") ? getColorFromJson(obj, "bg") : DisplayManager::backdropColor();
+    spec.durationMs = std::min<uint32_t>(obj["duration"] | DEFAULT_ANIMATION_MS, MAX_ANIMATION_MS);
+    spec.delayMs = std::min<uint32_t>(obj["delay"] | 0U, MAX_ANIMATION_MS);
+    spec.yoyo = getBool(obj, "yoyo", false);
+
+    const int repeat = obj["repeat"] | 0;
+    spec.repeat = repeat < 0 ? ANIMATION_REPEAT_FOREVER
+                             : static_cast<uint16_t>(std::min<int>(repeat, ANIMATION_REPEAT_FOREVER - 1));
+
+    spec.textSize = static_cast<uint8_t>(obj["size"] | DEFAULT_TEXT_SIZE);
+    spec.text.fill('\0');
+    strncpy(spec.text.data(), obj["text"] | "", spec.text.size() - 1);
+
+    return nullptr;
+}
+
+// Parse and start one animation, returns an error message or nullptr
+static auto startAnimation(const JsonObject& obj) -> const char* {
+    AnimationSpec spec{};
+    const char* error = parseAnimationSpec(obj, spec);
+
+    if (error == nullptr && !Animation::start(spec, millis())) {
+        error = "too many animations running";
+    }
+    return error;
+}
+
+/**
+ * @brief Start on-device animations (tweens)
+ * POST /api/v1/animate
+ * Body: {"id": 1, "shape": "rect", "x": 20, "y": 200, "w": 0, "h": 12, "color": "#40c0ff", "bg": "#000000",
+ *        "to": {"w": 200}, "duration": 800, "easing": "easeOut", "delay": 0, "repeat": 0, "yoyo": false}
+ * or {"animations": [...]} to start several at once. The device interpolates x, y, w, h, r and color from the
+ * top-level values to "to" and repaints only the moving shape. Starting an id that is running moves the shape on
+ * from where it is; at most ANIMATION_POOL_SIZE animations run at the same time
+ */
+void handleAnimate(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, body);
+
+    if (err) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    const char* error = nullptr;
+    size_t started = 0;
+    JsonArray list = doc["animations"];
+
+    if (list.isNull()) {
+        error = startAnimation(doc.as<JsonObject>());
+        started = (error == nullptr) ? 1 : 0;
+    } else {
+        for (JsonObject obj : list) {
+            error = startAnimation(obj);
+            if (error != nullptr) {
+                break;
+            }
+            started++;
+        }
+    }
+
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
+
+    JsonDocument resp;
+    resp["status"] = "ok";
+    resp["started"] = started;
+    resp["active"] = Animation::activeCount();
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Stop animations where they are
+ * POST /api/v1/animate/stop
+ * Body: {"id": 1} (optional, every animation stops without it)
+ */
+void handleStopAnimation(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (body.length() > 0 && !deserializeJson(doc, body) && doc.containsKey("id")) {
+        if (!Animation::stop(static_cast<uint8_t>(doc["id"].as<int>()))) {
+            sendErrorResponse(webserver, "no animation with this id");
+            return;
+        }
+    } else {
+        Animation::stopAll();
+    }
+
+    sendSuccessResponse(webserver);
+}
+
+// ============================================================================
+// Effect API Handlers
+// ============================================================================
+
+// Read an effect name, false when it is unknown
+static auto parseEffectKind(const char* name, EffectKind& kind) -> bool {
+    for (size_t i = 0; i < EFFECT_KIND_COUNT; ++i) {
+        if (strcmp(name, Effects::kindName(static_cast<EffectKind>(i))) == 0) {
+            kind = static_cast<EffectKind>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Read a palette name, keeping fallback when missing or unknown
+static auto parseEffectPalette(const char* name, EffectPalette fallback) -> EffectPalette {
+    for (const EffectPalette palette :
+         {EffectPalette::Rainbow, EffectPalette::Fire, EffectPalette::Ocean, EffectPalette::Mono}) {
+        if (strcmp(name, Effects::paletteName(palette)) == 0) {
+            return palette;
+        }
+    }
+    return fallback;
+}
+
+// Read a 1-255 setting, keeping fallback when missing
+static auto getParam(const JsonObject& obj, const char* key, uint8_t fallback) -> uint8_t {
+    return obj.containsKey(key) ? static_cast<uint8_t>(std::clamp(obj[key].as<int>(), 1, UINT8_MAX)) : fallback;
+}
+
+static auto sendEffectState(Webserver* webserver) -> void {
+    JsonDocument resp;
+    const EffectParams params = Effects::params();
+    const EffectStats stats = Effects::stats(params.kind);
+
+    resp["status"] = "ok";
+    resp["running"] = Effects::running();
+    resp["effect"] = Effects::kindName(params.kind);
+    resp["x"] = params.x;
+    resp["y"] = params.y;
+    resp["w"] = params.w;
+    resp["h"] = params.h;
+    resp["fps"] = params.fps;
+    resp["speed"] = params.speed;
+    resp["scale"] = params.scale;
+    resp["density"] = params.density;
+    resp["color"] = params.color;
+    resp["palette"] = Effects::paletteName(params.palette);
+    resp["step"] = stats.step;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Start a procedural effect, or change the settings of the running one
+ * POST /api/v1/effect
+ * Body: {"effect": "plasma", "x": 0, "y": 0, "w": 240, "h": 240, "fps": 30, "speed": 4, "scale": 4, "density": 4,
+ *        "color": "#00ff40", "palette": "rainbow"}
+ * Every key is optional. With "effect" the effect (re)starts, keys left out take its defaults; without it the
+ * running effect keeps its state and only the given settings change. A playing GIF is stopped first
+ */
+void handleStartEffect(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+
+    if (body.length() > 0 && deserializeJson(doc, body)) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+    const JsonObject obj = doc.as<JsonObject>();
+
+    EffectParams params = Effects::params();
+    const bool restart = obj.containsKey("effect") || !Effects::running();
+    if (restart) {
+        EffectKind kind = EffectKind::Plasma;
+        if (obj.containsKey("effect") && !parseEffectKind(obj["effect"] | "", kind)) {
+            sendErrorResponse(webserver, "unknown effect");
+            return;
+        }
+        params = Effects::defaults(kind);
+    }
+
+    params.x = getInt16(obj, "x", params.x);
+    params.y = getInt16(obj, "y", params.y);
+    params.w = getInt16(obj, "w", params.w);
+    params.h = getInt16(obj, "h", params.h);
+    params.fps = getParam(obj, "fps", params.fps);
+    params.speed = getParam(obj, "speed", params.speed);
+    params.scale = getParam(obj, "scale", params.scale);
+    params.density = getParam(obj, "density", params.density);
+    params.color = obj.containsKey("color") ? getColorFromJson(obj) : params.color;
+    params.palette = parseEffectPalette(obj["palette"] | "", params.palette);
+
+    DisplayManager::stopGifPlayback();
+    Template::hide();
+    Script::stop();
+
+    const bool started = restart ? Effects::start(params, millis()) : Effects::setParams(params, millis());
+    if (!started) {
+        sendErrorResponse(webserver, "effect could not start (empty area or out of memory)");
+        return;
+    }
+
+    sendEffectState(webserver);
+}
+
+/**
+ * @brief Settings of the running effect
+ * GET /api/v1/effect
+ */
+void handleGetEffect(Webserver* webserver) { sendEffectState(webserver); }
+
+/**
+ * @brief Stop the running effect, its last frame stays on the screen
+ * POST /api/v1/effect/stop
+ */
+void handleStopEffect(Webserver* webserver) {
+    Effects::stop();
+    sendSuccessResponse(webserver);
+}
+
+// ============================================================================
+// Transition API Handlers
+// ============================================================================
+
+// Read an effect name, returns false when unknown
+static auto parseTransitionEffect(const char* name, TransitionEffect& effect) -> bool {
+    for (const TransitionEffect candidate : {TransitionEffect::None, TransitionEffect::Slide, TransitionEffect::Wipe,
+                                             TransitionEffect::Dissolve}) {
+        if (strcmp(name, Transition::effectName(candidate)) == 0) {
+            effect = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Read effect, duration, easing and color into spec, keeping spec for the missing keys
+static auto parseTransitionSettings(const JsonObject& obj, TransitionSpec& spec) -> const char* {
+    if (!obj["effect"].isNull() && !parseTransitionEffect(obj["effect"] | "", spec.effect)) {
+        return "effect must be none, slide, wipe or dissolve";
+    }
+    if (!obj["easing"].isNull()) {
+        spec.easing = parseEasing(obj["easing"] | "");
+    }
+    if (!obj["color"].isNull()) {
+        spec.color = getColorFromJson(obj);
+    }
+    spec.durationMs = std::min<uint32_t>(obj["duration"] | spec.durationMs, TRANSITION_MAX_MS);
+
+    return nullptr;
+}
+
+/**
+ * @brief Read the transition of a content switch, the configured default when the request has none
+ *
+ * "transition" is an effect name ("slide") or an object {"effect", "duration", "easing", "color"} whose missing
+ * keys come from the default
+ */
+static auto parseTransition(const JsonObject& obj, TransitionSpec& spec) -> const char* {
+    spec = Transition::defaults();
+
+    JsonVariant transition = obj["transition"];
+    if (transition.is<JsonObject>()) {
+        return parseTransitionSettings(transition.as<JsonObject>(), spec);
+    }
+    if (!transition.isNull() && !parseTransitionEffect(transition | "", spec.effect)) {
+        return "transition must be none, slide, wipe or dissolve";
+    }
+
+    return nullptr;
+}
+
+// Same from the query string: ?transition=slide&duration=400
+static auto parseTransitionArgs(Webserver* webserver, TransitionSpec& spec) -> const char* {
+    spec = Transition::defaults();
+
+    const String effect = webserver->raw().arg("transition");
+    if (!effect.isEmpty() && !parseTransitionEffect(effect.c_str(), spec.effect)) {
+        return "transition must be none, slide, wipe or dissolve";
+    }
+    if (webserver->raw().hasArg("duration")) {
+        const long duration = webserver->raw().arg("duration").toInt();
+        spec.durationMs = static_cast<uint32_t>(constrain(duration, 0L, static_cast<long>(TRANSITION_MAX_MS)));
+    }
+
+    return nullptr;
+}
+
+// Helper to send the default transition and the frame timing of the last one
+static auto sendTransitionConfig(Webserver* webserver) -> void {
+    const TransitionSpec spec = Transition::defaults();
+    const TransitionStats stats = DisplayManager::transitionStats();
+    JsonDocument resp;
+
+    resp["status"] = "ok";
+    resp["effect"] = Transition::effectName(spec.effect);
+    resp["duration"] = spec.durationMs;
+    resp["easing"] = easingName(spec.easing);
+    resp["color"] = spec.color;
+
+    JsonObject last = resp["last"].to<JsonObject>();
+    last["effect"] = Transition::effectName(stats.lastEffect);
+    last["ms"] = stats.lastMs;
+    last["frames"] = stats.frames;
+    last["avgFrameUs"] = stats.avgFrameUs;
+    last["maxFrameUs"] = stats.maxFrameUs;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Get the default transition and the frame timing of the last one
+ * GET /api/v1/config/transition
+ */
+void handleGetTransitionConfig(Webserver* webserver) { sendTransitionConfig(webserver); }
+
+/**
+ * @brief Set the transition used by GIF and image switches that do not ask for one
+ * POST /api/v1/config/transition
+ * Body: {"effect": "slide", "duration": 400, "easing": "easeInOut", "color": "#000000"}
+ * Missing keys keep their current value. The default at boot is "none": GIFs clear the screen, images draw over it
+ */
+void handleSetTransitionConfig(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, body);
+
+    if (err) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    TransitionSpec spec = Transition::defaults();
+    const char* error = parseTransitionSettings(doc.as<JsonObject>(), spec);
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
+
+    Transition::setDefaults(spec);
+    sendTransitionConfig(webserver);
+}
+
+// ============================================================================
+// Image API Handlers
+// ============================================================================
+
+static constexpr const char* IMAGE_DIR = "/img";
+
+// Upload in progress on /api/v1/image
+static File s_imageFile;
+static String s_imagePath;
+static bool s_imageUploadError = false;
+
+// Read a scale divisor: 1, 2, 4, 8 or "fit" (the default)
+static auto parseImageScale(const String& value) -> uint8_t {
+    if (value.isEmpty() || value == "fit") {
+        return JPEG_SCALE_FIT;
+    }
+    return static_cast<uint8_t>(constrain(value.toInt(), 1, 8));
+}
+
+// Path of an image in IMAGE_DIR, only the last component of the name is kept
+static auto imagePath(const String& name) -> String {
+    String filename(name);
+    filename.replace("\\", "/");
+    return String(IMAGE_DIR) + "/" + filename.substring(filename.lastIndexOf('/') + 1);
+}
+
+// Helper to report a JPEG decode: drawn size, scale and decode time
+static auto sendImageResult(Webserver* webserver, const String& path, const JpegResult& result) -> void {
+    JsonDocument resp;
+
+    resp["status"] = result.ok ? "ok" : "error";
+    resp["file"] = path;
+    if (result.ok) {
+        resp["width"] = result.width;
+        resp["height"] = result.height;
+        resp["scale"] = result.scale;
+    } else {
+        resp["message"] = "decode failed";
+        resp["error"] = result.error;
+    }
+    resp["decodeUs"] = result.decodeUs;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(result.ok ? HTTP_CODE_OK : HTTP_CODE_INTERNAL_ERROR, "application/json", jsonOut);
+}
+
+// Helper to report a QOI/R565 decode: format, size and decode time
+static auto sendImageResult(Webserver* webserver, const String& path, const StillResult& result) -> void {
+    JsonDocument resp;
+
+    resp["status"] = result.ok ? "ok" : "error";
+    if (!path.isEmpty()) {
+        resp["file"] = path;
+    }
+    resp["format"] = Still::formatName(result.format);
+    if (result.ok) {
+        resp["width"] = result.width;
+        resp["height"] = result.height;
+    } else {
+        resp["message"] = "decode failed";
+    }
+    resp["decodeUs"] = result.decodeUs;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(result.ok ? HTTP_CODE_OK : HTTP_CODE_INTERNAL_ERROR, "application/json", jsonOut);
+}
+
+// Helper to draw a stored image, QOI/R565 are recognized by their magic bytes and anything else goes to JPEGDEC
+static auto drawStoredImage(Webserver* webserver, const String& path, int16_t posX, int16_t posY, uint8_t scale,
+                            const TransitionSpec& transition) -> void {
+    if (Still::probeFile(path) != StillFormat::None) {
+        sendImageResult(webserver, path, DisplayManager::drawStill(path, posX, posY, transition));
+    } else {
+        sendImageResult(webserver, path, DisplayManager::drawJpeg(path, posX, posY, scale, transition));
+    }
+}
+
+// Helper to receive an upload into path, chunk by chunk
+static auto receiveImageUpload(HTTPUpload& upload, const String& path) -> void {
+    switch (upload.status) {
+        case UPLOAD_FILE_START:
+            s_imagePath = path;
+            s_imageUploadError = false;
+            if (!LittleFS.exists(IMAGE_DIR) && !LittleFS.mkdir(IMAGE_DIR)) {
+                Logger::error("Failed to create /img directory!", "API::Image");
+            }
+            s_imageFile = LittleFS.open(s_imagePath, "w");
+            if (!s_imageFile) {
+                s_imageUploadError = true;
+                Logger::error((String("Impossible to open file: ") + s_imagePath).c_str(), "API::Image");
+            }
+            break;
+        case UPLOAD_FILE_WRITE:
+            handleGifUploadWrite(upload, s_imageFile, s_imageUploadError);
+            break;
+        case UPLOAD_FILE_END:
+            if (s_imageFile) {
+                s_imageFile.close();
+            }
+            break;
+        case UPLOAD_FILE_ABORTED:
+            handleGifUploadAborted(s_imagePath, s_imageFile, s_imageUploadError);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Receive an image upload into IMAGE_DIR, chunk by chunk
+ *
+ * The body is never held in RAM: each chunk goes to LittleFS as it arrives, the decode runs once it is complete
+ */
+void handleImageUpload(Webserver* webserver) {
+    HTTPUpload& upload = webserver->raw().upload();
+    receiveImageUpload(upload, upload.status == UPLOAD_FILE_START ? imagePath(upload.filename) : s_imagePath);
+}
+
+/**
+ * @brief Upload an image (JPEG, QOI or R565) and draw it
+ * POST /api/v1/image?x=0&y=0&scale=fit&transition=wipe&duration=400 (multipart, field "file")
+ * The image is kept in /img and can be drawn again with /api/v1/image/play. scale only applies to JPEG
+ */
+void handleImageUploaded(Webserver* webserver) {
+    if (s_imageUploadError || s_imagePath.isEmpty()) {
+        sendErrorResponse(webserver, "Error during image upload");
+        return;
+    }
+
+    TransitionSpec transition{};
+    const char* error = parseTransitionArgs(webserver, transition);
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
+
+    const auto posX = static_cast<int16_t>(webserver->raw().arg("x").toInt());
+    const auto posY = static_cast<int16_t>(webserver->raw().arg("y").toInt());
+    const uint8_t scale = parseImageScale(webserver->raw().arg("scale"));
+
+    drawStoredImage(webserver, s_imagePath, posX, posY, scale, transition);
+}
+
+/**
+ * @brief Draw an image previously uploaded to /img
+ * POST /api/v1/image/play
+ * Body: {"name": "cover.jpg", "x": 0, "y": 0, "scale": "fit", "transition": "wipe"}
+ * For JPEG, scale is 1, 2, 4, 8 (applied during the IDCT) or "fit" for the largest that fits the screen. With a
+ * transition the rest of the screen becomes background, without one the image is drawn over what is there
+ */
+void handlePlayImage(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, body);
+
+    if (err) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    const char* name = doc["name"];
+    if (name == nullptr || strlen(name) == 0) {
+        sendErrorResponse(webserver, "missing name");
+        return;
+    }
+
+    const String path = imagePath(name);
+    if (!LittleFS.exists(path)) {
+        JsonDocument resp;
+        resp["status"] = "error";
+        resp["message"] = "file not found";
+
+        String jsonOut;
+        serializeJson(resp, jsonOut);
+        webserver->raw().send(HTTP_CODE_NOT_FOUND, "application/json", jsonOut);
+        return;
+    }
+
+    JsonObject cmd = doc.as<JsonObject>();
+    TransitionSpec transition{};
+    const char* error = parseTransition(cmd, transition);
+    if (error != nullptr) {
+        sendErrorResponse(webserver, error);
+        return;
+    }
+
+    const int16_t posX = getInt16(cmd, "x", DEFAULT_POS);
+    const int16_t posY = getInt16(cmd, "y", DEFAULT_POS);
+    const uint8_t scale = parseImageScale(cmd["scale"].isNull() ? String() : cmd["scale"].as<String>());
+
+    drawStoredImage(webserver, path, posX, posY, scale, transition);
+}
+
+// Decoder of the body being streamed to /api/v1/image/stream
+static std::unique_ptr<StillDecoder> s_imageStream;
+
+/**
+ * @brief Decode a QOI or R565 request body while it is received
+ *
+ * Each piece of the body is decoded and on the panel before the next one is read, nothing is stored
+ */
+void handleImageStream(Webserver* webserver) {
+    HTTPRaw& body = webserver->raw().raw();
+
+    switch (body.status) {
+        case RAW_START: {
+            const auto posX = static_cast<int16_t>(webserver->raw().arg("x").toInt());
+            const auto posY = static_cast<int16_t>(webserver->raw().arg("y").toInt());
+
+            DisplayManager::stopGifPlayback();
+            s_imageStream.reset(new (std::nothrow) StillDecoder(posX, posY));
+            break;
+        }
+        case RAW_WRITE:
+            if (s_imageStream) {
+                s_imageStream->feed(body.buf, body.currentSize);
+            }
+            break;
+        case RAW_ABORTED:
+            s_imageStream.reset();
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Stream a QOI or R565 image straight to the screen
+ * POST /api/v1/image/stream?x=0&y=0 (Content-Type: application/octet-stream, body: the file)
+ */
+void handleImageStreamed(Webserver* webserver) {
+    if (!s_imageStream) {
+        sendErrorResponse(webserver, "missing image body");
+        return;
+    }
+
+    const StillResult result = s_imageStream->result();
+    s_imageStream.reset();
+
+    Still::record(result);
+    sendImageResult(webserver, String(), result);
+}
+
+// Helper to describe the background layer
+static auto sendBackgroundInfo(Webserver* webserver) -> void {
+    const BackgroundInfo layer = Background::info();
+    JsonDocument resp;
+
+    resp["status"] = "ok";
+    resp["active"] = DisplayManager::hasBackground();
+    if (DisplayManager::hasBackground()) {
+        resp["width"] = layer.width;
+        resp["height"] = layer.height;
+        resp["tile"] = layer.tileSize;
+        resp["encoding"] = layer.rle ? "rle" : "raw";
+        resp["cachedTiles"] = layer.cacheSlots;
+    }
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Receive a background layer upload, stored as BACKGROUND_PATH
+ */
+void handleBackgroundUpload(Webserver* webserver) {
+    HTTPUpload& upload = webserver->raw().upload();
+
+    if (upload.status == UPLOAD_FILE_START) {
+        // The stored layer is about to be overwritten
+        DisplayManager::clearBackground();
+    }
+    receiveImageUpload(upload, BACKGROUND_PATH);
+}
+
+/**
+ * @brief Upload a tiled R5TL image and use it as the background layer
+ * POST /api/v1/background (multipart, field "file")
+ * The layer is painted on the whole screen and restored at boot. Clears without a color, text "clear" and the
+ * status bar/body helpers then repaint the erased area from it instead of a flat color
+ */
+void handleBackgroundUploaded(Webserver* webserver) {
+    if (s_imageUploadError || s_imagePath != BACKGROUND_PATH) {
+        sendErrorResponse(webserver, "Error during background upload");
+        return;
+    }
+
+    DisplayManager::stopGifPlayback();
+    if (!DisplayManager::setBackground(BACKGROUND_PATH)) {
+        LittleFS.remove(BACKGROUND_PATH);
+        sendErrorResponse(webserver, "not a valid R5TL image");
+        return;
+    }
+
+    sendBackgroundInfo(webserver);
+}
+
+/**
+ * @brief Describe the background layer
+ * GET /api/v1/background
+ */
+void handleGetBackground(Webserver* webserver) { sendBackgroundInfo(webserver); }
+
+/**
+ * @brief Drop the background layer and delete it from flash, clears go back to flat colors
+ * POST /api/v1/background/remove
+ */
+void handleRemoveBackground(Webserver* webserver) {
+    DisplayManager::clearBackground();
+    if (LittleFS.exists(BACKGROUND_PATH)) {
+        LittleFS.remove(BACKGROUND_PATH);
+    }
+    sendSuccessResponse(webserver);
+}
+
+// ============================================================================
+// Display configuration
+// ============================================================================
+
+// Helper to send the current display transform
+static auto sendDisplayConfig(Webserver* webserver) -> void {
+    const DisplayTransform transform = DisplayManager::getTransform();
+    JsonDocument resp;
+
+    resp["status"] = "ok";
+    resp["rotate"] = transform.rotate;
+    resp["mirrorX"] = transform.mirrorX;
+    resp["mirrorY"] = transform.mirrorY;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Get the display orientation
+ * GET /api/v1/config/display
+ */
+void handleGetDisplayConfig(Webserver* webserver) { sendDisplayConfig(webserver); }
+
+/**
+ * @brief Change the display orientation (applied through MADCTL, the screen is cleared)
+ * POST /api/v1/config/display
+ * Body: {"rotate": 0, "mirrorX": true, "mirrorY": false, "save": true}
+ * Missing keys keep their current value, "save" persists the orientation to the configuration file
+ */
+void handleSetDisplayConfig(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, body);
+
+    if (err) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    DisplayTransform transform = DisplayManager::getTransform();
+    const int rotate = doc["rotate"] | static_cast<int>(transform.rotate);
+
+    if (!isValidRotate(rotate)) {
+        sendErrorResponse(webserver, "rotate must be 0, 90, 180 or 270");
+        return;
+    }
+
+    transform.rotate = static_cast<uint16_t>(rotate);
+    transform.mirrorX = doc["mirrorX"] | transform.mirrorX;
+    transform.mirrorY = doc["mirrorY"] | transform.mirrorY;
+
+    if (!DisplayManager::setTransform(transform)) {
+        sendErrorResponse(webserver, "display not ready");
+        return;
+    }
+
+    configManager.setLCDTransform(transform.rotate, transform.mirrorX, transform.mirrorY);
+    if ((doc["save"] | false) && !configManager.save()) {
+        sendErrorResponse(webserver, "failed to save configuration");
+        return;
+    }
+
+    sendDisplayConfig(webserver);
+}
+
+// ============================================================================
+// MQTT
+// ============================================================================
+
+/**
+ * @brief Draw a batch received over MQTT, the payload is a /api/v1/draw/batch body
+ *
+ * ArduinoJson 7 has no zero-copy mode: the JSON tree and a copy of every string (colors, texts, macro names) are
+ * allocated in the document for each message, on top of the client's receive buffer
+ *
+ * @return false when the payload is not a batch or calls an unknown macro
+ */
+auto handleMqttMessage(const char* topic, uint8_t* payload, size_t length) -> bool {
+    JsonDocument doc;
+    if (deserializeJson(doc, reinterpret_cast<const char*>(payload), length)) {
+        Logger::warn(("MQTT message on " + String(topic) + " is not valid json").c_str(), "API");
+        return false;
+    }
+
+    BatchReport report{};
+    const char* error = drawBatchDocument(doc, report);
+    if (error != nullptr) {
+        Logger::warn(("MQTT message on " + String(topic) + ": " + error).c_str(), "API");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief (Re)start the MQTT client with the broker and topics of the configuration
+ */
+void startMqtt() {
+    MqttSettings settings{};
+    settings.host = configManager.getMqttHost();
+    settings.port = configManager.getMqttPort();
+    settings.user = configManager.getMqttUser();
+    settings.password = configManager.getMqttPassword();
+    for (const std::string& topic : configManager.getMqttTopics()) {
+        settings.topics.emplace_back(topic.c_str());
+    }
+    settings.screenTopic = configManager.getMqttScreenTopic();
+
+    Mqtt::begin(settings, handleMqttMessage);
+}
+
+// Helper to describe the MQTT settings and connection, the password is left out
+static auto sendMqttConfig(Webserver* webserver) -> void {
+    const MqttSettings& settings = Mqtt::settings();
+    JsonDocument resp;
+
+    resp["status"] = "ok";
+    resp["host"] = settings.host;
+    resp["port"] = settings.port;
+    resp["user"] = settings.user;
+    JsonArray topics = resp["topics"].to<JsonArray>();
+    for (const String& topic : settings.topics) {
+        topics.add(topic);
+    }
+    resp["screenTopic"] = settings.screenTopic;
+    resp["connected"] = Mqtt::connected();
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Get the MQTT broker, topics and connection state
+ * GET /api/v1/config/mqtt
+ */
+void handleGetMqttConfig(Webserver* webserver) { sendMqttConfig(webserver); }
+
+/**
+ * @brief Change the MQTT broker and topics, the client reconnects with them
+ * POST /api/v1/config/mqtt
+ * Body: {"host": "192.168.7.2", "port": 1883, "user": "", "password": "", "topics": ["holocube/draw"],
+ *        "screenTopic": "holocube/screen", "save": true}
+ * Missing keys keep their current value, an empty host turns MQTT off. "save" persists the settings to the
+ * configuration file
+ */
+void handleSetMqttConfig(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, body);
+
+    if (err) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    std::vector<std::string> topics = configManager.getMqttTopics();
+    if (doc.containsKey("topics")) {
+        JsonArray list = doc["topics"].as<JsonArray>();
+        if (list.size() > MQTT_MAX_TOPICS) {
+            sendErrorResponse(webserver, "too many topics (8 at most)");
+            return;
+        }
+        topics.clear();
+        for (JsonVariant topic : list) {
+            topics.emplace_back(topic | "");
+        }
+    }
+
+    configManager.setMqtt(doc["host"] | configManager.getMqttHost(), doc["port"] | configManager.getMqttPort(),
+                          doc["user"] | configManager.getMqttUser(), doc["password"] | configManager.getMqttPassword(),
+                          topics, doc["screenTopic"] | configManager.getMqttScreenTopic());
+    if ((doc["save"] | false) && !configManager.save()) {
+        sendErrorResponse(webserver, "failed to save configuration");
+        return;
+    }
+
+    startMqtt();
+    sendMqttConfig(webserver);
+}
+
+// ============================================================================
+// Broadcast
+// ============================================================================
+
+/**
+ * @brief Draw a packet received on the broadcast group, in sequence order
+ *
+ * @return false when the packet does not decode
+ */
+auto handleBroadcastPacket(const uint8_t* packet, size_t length) -> bool {
+    DrawBatch batch;
+    const char* error = DrawPacket::decode(packet, length, batch);
+    if (error != nullptr) {
+        Logger::warn(("Broadcast packet: " + String(error)).c_str(), "API");
+        return false;
+    }
+
+    batch.optimize(DisplayManager::screenWidth(), DisplayManager::screenHeight());
+    batch.execute();
+    return true;
+}
+
+/**
+ * @brief (Re)start the broadcast listener with the address and groups of the configuration
+ */
+void startBroadcast() {
+    BroadcastSettings settings{};
+    settings.enabled = configManager.getBroadcastEnabled();
+    if (!settings.address.fromString(configManager.getBroadcastAddress())) {
+        settings.address = IPAddress(BROADCAST_DEFAULT_ADDRESS[0], BROADCAST_DEFAULT_ADDRESS[1],
+                                     BROADCAST_DEFAULT_ADDRESS[2], BROADCAST_DEFAULT_ADDRESS[3]);
+    }
+    settings.port = configManager.getBroadcastPort();
+    settings.groups = configManager.getBroadcastGroups();
+
+    Broadcast::begin(settings, handleBroadcastPacket);
+}
+
+// Helper to describe the broadcast settings
+static auto sendBroadcastConfig(Webserver* webserver) -> void {
+    const BroadcastSettings& settings = Broadcast::settings();
+    JsonDocument resp;
+
+    resp["status"] = "ok";
+    resp["enabled"] = settings.enabled;
+    resp["address"] = settings.address.toString();
+    resp["port"] = settings.port;
+    JsonArray groups = resp["groups"].to<JsonArray>();
+    for (uint16_t group : settings.groups) {
+        groups.add(group);
+    }
+    resp["listening"] = Broadcast::listening();
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Get the broadcast address, port and groups
+ * GET /api/v1/config/broadcast
+ */
+void handleGetBroadcastConfig(Webserver* webserver) { sendBroadcastConfig(webserver); }
+
+/**
+ * @brief Change the broadcast listener, the group is joined again with the new settings
+ * POST /api/v1/config/broadcast
+ * Body: {"enabled": true, "address": "239.72.67.1", "port": 4210, "groups": [1, 12], "save": true}
+ * Missing keys keep their current value. Group 0 reaches every device and is always applied. "save" persists the
+ * settings to the configuration file
+ */
+void handleSetBroadcastConfig(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, body);
+
+    if (err) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    IPAddress address;
+    const char* addressText = doc["address"] | configManager.getBroadcastAddress();
+    constexpr uint8_t MULTICAST_PREFIX = 0xE0;  // 224.0.0.0/4
+    constexpr uint8_t MULTICAST_MASK = 0xF0;
+    if (addressText[0] != '\0' &&
+        (!address.fromString(addressText) || (address[0] & MULTICAST_MASK) != MULTICAST_PREFIX)) {
+        sendErrorResponse(webserver, "address must be a multicast address (224.0.0.0/4)");
+        return;
+    }
+
+    std::vector<uint16_t> groups = configManager.getBroadcastGroups();
+    if (doc.containsKey("groups")) {
+        JsonArray list = doc["groups"].as<JsonArray>();
+        if (list.size() > BROADCAST_MAX_GROUPS) {
+            sendErrorResponse(webserver, "too many groups (8 at most)");
+            return;
+        }
+        groups.clear();
+        for (JsonVariant group : list) {
+            groups.push_back(group.as<uint16_t>());
+        }
+    }
+
+    configManager.setBroadcast(doc["enabled"] | configManager.getBroadcastEnabled(), addressText,
+                               doc["port"] | configManager.getBroadcastPort(), groups);
+    if ((doc["save"] | false) && !configManager.save()) {
+        sendErrorResponse(webserver, "failed to save configuration");
+        return;
+    }
+
+    startBroadcast();
+    sendBroadcastConfig(webserver);
+}
+
+// ============================================================================
+// Time sync
+// ============================================================================
+
+/**
+ * @brief (Re)start the time sync with the server of the configuration, none makes this device the reference
+ */
+void startTimeSync() {
+    IPAddress server;
+    if (!server.fromString(configManager.getSyncServer())) {
+        server = IPAddress();
+    }
+
+    TimeSync::begin(server);
+}
+
+/**
+ * @brief Sync clock, its estimate of the server clock and how well the synced GIF meets its frame deadlines
+ * GET /api/v1/sync
+ * The achieved skew between two devices is at most the difference of their avgLateUs plus their errorUs
+ */
+void handleGetSync(Webserver* webserver) {
+    const TimeSyncStats stats = TimeSync::stats();
+    const GifSyncStats gif = DisplayManager::gifSyncStats();
+    JsonDocument resp;
+
+    resp["status"] = "ok";
+    resp["nowUs"] = TimeSync::now();
+    resp["localUs"] = TimeSync::localUs();
+    resp["server"] = TimeSync::server().isSet() ? TimeSync::server().toString() : "";
+    resp["synced"] = stats.synced;
+    resp["offsetUs"] = stats.offsetUs;
+    resp["skewPpb"] = stats.skewPpb;
+    resp["delayUs"] = stats.delayUs;
+    resp["errorUs"] = stats.errorUs;
+    resp["residualUs"] = stats.residualUs;
+    resp["samples"] = stats.samples;
+    resp["requests"] = stats.requests;
+    resp["replies"] = stats.replies;
+    resp["answered"] = stats.answered;
+    resp["sampleAgeMs"] = stats.samples > 0 ? millis() - stats.lastSampleMs : 0;
+
+    JsonObject playback = resp["gif"].to<JsonObject>();
+    playback["active"] = gif.active;
+    playback["at"] = gif.startUs;
+    playback["frame"] = gif.startFrame;
+    playback["frames"] = gif.frames;
+    playback["late"] = gif.late;
+    playback["avgLateUs"] = gif.avgLateUs;
+    playback["maxLateUs"] = gif.maxLateUs;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+// Helper to describe the time sync settings
+static auto sendSyncConfig(Webserver* webserver) -> void {
+    JsonDocument resp;
+
+    resp["status"] = "ok";
+    resp["server"] = configManager.getSyncServer();
+    resp["port"] = TIME_SYNC_PORT;
+    resp["synced"] = TimeSync::stats().synced;
+
+    String jsonOut;
+    serializeJson(resp, jsonOut);
+    webserver->raw().send(HTTP_CODE_OK, "application/json", jsonOut);
+}
+
+/**
+ * @brief Get the time sync server
+ * GET /api/v1/config/sync
+ */
+void handleGetSyncConfig(Webserver* webserver) { sendSyncConfig(webserver); }
+
+/**
+ * @brief Change the time sync server, the clock model starts again with it
+ * POST /api/v1/config/sync
+ * Body: {"server": "192.168.1.20", "save": true}
+ * An empty server makes this device the reference the others follow. "save" persists the setting to the
+ * configuration file
+ */
+void handleSetSyncConfig(Webserver* webserver) {
+    String body = webserver->raw().arg("plain");
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, body);
+
+    if (err) {
+        sendErrorResponse(webserver, "invalid json");
+        return;
+    }
+
+    IPAddress server;
+    const char* serverText = doc["server"] | configManager.getSyncServer();
+    if (serverText[0] != '\0' && !server.fromString(serverText)) {
+        sendErrorResponse(webserver, "server must be an IP address");
+        return;
+    }
+
+    configManager.setSyncServer(serverText);
+    if ((doc["save"] | false) && !configManager.save()) {
+        sendErrorResponse(webserver, "failed to save configuration");
+        return;
+    }
+
+    startTimeSync();
+    sendSyncConfig(webserver);
+}
@@ -0,0 +1,341 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <Logger.h>
+#include <WiFiUdp.h>
+
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#include "display/DrawPacket.h"
+#include "wireless/Broadcast.h"
+#include "wireless/WiFiManager.h"
+
+/**
+ * @brief Sequence state of one group
+ */
+struct GroupState {
+    uint16_t id;
+    bool synced;        // false until the first packet gives the sequence to expect
+    uint32_t next;      // sequence to apply next
+    IPAddress sender;   // where NACKs go, the source of the last packet
+    uint16_t senderPort;
+    uint8_t nacks;      // NACKs sent for the current gap
+    uint32_t nackMs;
+};
+
+/**
+ * @brief A packet received ahead of its turn
+ */
+struct PendingPacket {
+    uint16_t group;
+    uint32_t sequence;
+    std::vector<uint8_t> data;
+};
+
+static WiFiUDP s_udp;
+static BroadcastSettings s_settings{};
+static BroadcastHandler s_handler = nullptr;
+static BroadcastStats s_stats{};
+static std::vector<GroupState> s_groups;
+static std::vector<PendingPacket> s_pending;
+static std::unique_ptr<uint8_t[]> s_packet;
+static IPAddress s_joinedIp;  // interface the membership was joined on, unset when not listening
+
+static auto findGroup(uint16_t id) -> GroupState* {
+    auto group =
+        std::find_if(s_groups.begin(), s_groups.end(), [id](const GroupState& state) { return state.id == id; });
+    return group != s_groups.end() ? &*group : nullptr;
+}
+
+static auto findPending(uint16_t group, uint32_t sequence) -> std::vector<PendingPacket>::iterator {
+    return std::find_if(s_pending.begin(), s_pending.end(), [group, sequence](const PendingPacket& packet) {
+        return packet.group == group && packet.sequence == sequence;
+    });
+}
+
+// Lowest sequence held for a group, relative to the one expected; 0 when nothing is held
+static auto heldAhead(const GroupState& group) -> uint32_t {
+    uint32_t lowest = 0;
+    for (const PendingPacket& packet : s_pending) {
+        const uint32_t ahead = packet.sequence - group.next;
+        if (packet.group == group.id && (lowest == 0 || ahead < lowest)) {
+            lowest = ahead;
+        }
+    }
+    return lowest;
+}
+
+static void apply(const uint8_t* data, size_t length) {
+    const uint32_t startUs = micros();
+    if (s_handler != nullptr && s_handler(data, length)) {
+        s_stats.applied++;
+    } else {
+        s_stats.invalid++;
+    }
+    s_stats.lastApplyUs = micros() - startUs;
+}
+
+/**
+ * @brief Apply the held packets that are now in sequence
+ */
+static void drain(GroupState& group) {
+    for (auto packet = findPending(group.id, group.next); packet != s_pending.end();
+         packet = findPending(group.id, group.next)) {
+        apply(packet->data.data(), packet->data.size());
+        s_pending.erase(packet);
+        group.next++;
+    }
+    if (heldAhead(group) == 0) {
+        group.nacks = 0;
+    }
+}
+
+/**
+ * @brief Give up on the packets missing before the first held one
+ */
+static void skipGap(GroupState& group) {
+    const uint32_t missing = heldAhead(group);
+    s_stats.lost += missing;
+    group.next += missing;
+    group.nacks = 0;
+    drain(group);
+}
+
+/**
+ * @brief Ask the sender again for the packets missing before the first held one
+ */
+static void sendNack(GroupState& group, uint32_t nowMs) {
+    const uint32_t count = std::min<uint32_t>(heldAhead(group), UINT16_MAX);
+    if (count == 0) {
+        return;
+    }
+
+    std::array<uint8_t, BROADCAST_NACK_SIZE> nack = {
+        BROADCAST_NACK_MAGIC[0],
+        BROADCAST_NACK_MAGIC[1],
+        DRAW_PACKET_VERSION,
+        0,
+        static_cast<uint8_t>(group.id),
+        static_cast<uint8_t>(group.id >> 8U),
+        static_cast<uint8_t>(group.next),
+        static_cast<uint8_t>(group.next >> 8U),
+        static_cast<uint8_t>(group.next >> 16U),
+        static_cast<uint8_t>(group.next >> 24U),
+        static_cast<uint8_t>(count),
+        static_cast<uint8_t>(count >> 8U),
+    };
+    s_udp.beginPacket(group.sender, group.senderPort);
+    s_udp.write(nack.data(), nack.size());
+    s_udp.endPacket();
+
+    group.nacks++;
+    group.nackMs = nowMs;
+    s_stats.nacks++;
+}
+
+/**
+ * @brief Apply a packet in sequence, or hold it and report the gap before it
+ */
+static void receive(size_t length, uint32_t nowMs) {
+    const uint8_t* data = s_packet.get();
+    DrawPacketHeader header{};
+    if (!DrawPacket::readHeader(data, length, header)) {
+        s_stats.invalid++;
+        return;
+    }
+    GroupState* group = findGroup(header.group);
+    if (group == nullptr) {
+        s_stats.ignored++;
+        return;
+    }
+
+    group->sender = s_udp.remoteIP();
+    group->senderPort = s_udp.remotePort();
+    if (!group->synced) {
+        group->synced = true;
+        group->next = header.sequence;
+    }
+
+    const auto ahead = static_cast<int32_t>(header.sequence - group->next);
+    if (ahead < 0 && static_cast<uint32_t>(-ahead) <= BROADCAST_RESYNC_WINDOW) {
+        s_stats.duplicates++;
+        return;
+    }
+    if (ahead < 0 || static_cast<uint32_t>(ahead) > BROADCAST_RESYNC_WINDOW) {
+        // The sender restarted its sequence, or this device was away: what is held belongs to the old one
+        s_pending.erase(std::remove_if(s_pending.begin(), s_pending.end(),
+                                       [group](const PendingPacket& packet) { return packet.group == group->id; }),
+                        s_pending.end());
+        group->next = header.sequence;
+        group->nacks = 0;
+    }
+
+    if (header.sequence == group->next) {
+        if (heldAhead(*group) != 0) {
+            s_stats.recovered++;
+        }
+        apply(data, length);
+        group->next++;
+        drain(*group);
+        return;
+    }
+
+    if ((header.flags & DRAW_PACKET_KEY) != 0) {
+        // A full screen: what came before it is not needed any more
+        uint32_t held = 0;
+        for (auto packet = s_pending.begin(); packet != s_pending.end();) {
+            if (packet->group == group->id && packet->sequence - group->next < header.sequence - group->next) {
+                packet = s_pending.erase(packet);
+                held++;
+            } else {
+                ++packet;
+            }
+        }
+        s_stats.lost += header.sequence - group->next - held;
+        group->next = header.sequence + 1;
+        group->nacks = 0;
+        apply(data, length);
+        drain(*group);
+        return;
+    }
+
+    if (findPending(group->id, header.sequence) != s_pending.end()) {
+        s_stats.duplicates++;
+        return;
+    }
+
+    if (s_pending.size() >= BROADCAST_PENDING_MAX) {
+        // No room to wait: give up on the gaps before this packet
+        while (heldAhead(*group) != 0 && heldAhead(*group) < header.sequence - group->next) {
+            skipGap(*group);
+        }
+        s_stats.lost += header.sequence - group->next;
+        group->next = header.sequence + 1;
+        apply(data, length);
+        drain(*group);
+        return;
+    }
+
+    s_pending.push_back(PendingPacket{group->id, header.sequence, std::vector<uint8_t>(data, data + length)});
+    s_stats.reordered++;
+    if (group->nacks == 0) {
+        sendNack(*group, nowMs);
+    }
+}
+
+/**
+ * @brief Join the multicast group on the current address, or leave it when WiFi is gone
+ */
+static void listen() {
+    const IPAddress localIp = WiFi.localIP();
+    if (s_joinedIp == localIp) {
+        return;
+    }
+
+    s_udp.stop();
+    s_joinedIp = IPAddress();
+    if (!localIp.isSet()) {
+        return;
+    }
+    if (s_udp.beginMulticast(localIp, s_settings.address, s_settings.port) == 0) {
+        Logger::warn("Failed to join the broadcast group", "Broadcast");
+        return;
+    }
+
+    s_joinedIp = localIp;
+    Logger::info(("Listening to " + s_settings.address.toString() + ":" + String(s_settings.port)).c_str(),
+                 "Broadcast");
+}
+
+namespace Broadcast {
+
+/**
+ * @brief Apply new settings, the group membership is joined again with them
+ *
+ * @param settings Multicast address, port and groups, disabled frees the receive buffer
+ * @param handler Called for every packet to apply
+ */
+void begin(const BroadcastSettings& settings, BroadcastHandler handler) {
+    s_udp.stop();
+    s_joinedIp = IPAddress();
+    s_handler = handler;
+    s_settings = settings;
+    if (s_settings.port == 0) {
+        s_settings.port = BROADCAST_DEFAULT_PORT;
+    }
+    if (s_settings.groups.size() > BROADCAST_MAX_GROUPS) {
+        s_settings.groups.resize(BROADCAST_MAX_GROUPS);
+    }
+
+    s_groups.clear();
+    s_pending.clear();
+    s_groups.push_back(GroupState{BROADCAST_GROUP_ALL, false, 0, IPAddress(), 0, 0, 0});
+    for (uint16_t id : s_settings.groups) {
+        if (findGroup(id) == nullptr) {
+            s_groups.push_back(GroupState{id, false, 0, IPAddress(), 0, 0, 0});
+        }
+    }
+
+    // The receive buffer is only allocated while listening
+    if (!s_settings.enabled) {
+        s_packet.reset();
+    } else if (!s_packet) {
+        s_packet.reset(new (std::nothrow) uint8_t[DRAW_PACKET_MAX]);
+    }
+}
+
+/**
+ * @brief Read the packets that arrived and ask again for the missing ones
+ *
+ * @param nowMs Current time
+ */
+void update(uint32_t nowMs) {
+    if (!s_settings.enabled || !s_packet) {
+        return;
+    }
+    if (!WiFiManager::isConnected()) {
+        if (s_joinedIp.isSet()) {
+            s_udp.stop();
+            s_joinedIp = IPAddress();
+        }
+        return;
+    }
+    listen();
+    if (!s_joinedIp.isSet()) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < BROADCAST_PACKETS_PER_UPDATE; ++i) {
+        const int size = s_udp.parsePacket();
+        if (size <= 0) {
+            break;
+        }
+        s_stats.received++;
+        if (static_cast<size_t>(size) > DRAW_PACKET_MAX) {
+            s_stats.invalid++;
+            s_udp.flush();
+            continue;
+        }
+        receive(static_cast<size_t>(s_udp.read(s_packet.get(), DRAW_PACKET_MAX)), nowMs);
+    }
+
+    for (GroupState& group : s_groups) {
+        if (heldAhead(group) == 0 || nowMs - group.nackMs < BROADCAST_NACK_INTERVAL_MS) {
+            continue;
+        }
+        if (group.nacks < BROADCAST_NACK_TRIES) {
+            sendNack(group, nowMs);
+        } else {
+            skipGap(group);
+        }
+    }
+}
+
+auto listening() -> bool { return s_joinedIp.isSet(); }
+
+auto settings() -> const BroadcastSettings& { return s_settings; }
+
+auto stats() -> BroadcastStats { return s_stats; }
+
+}  // namespace Broadcast
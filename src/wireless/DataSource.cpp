@@ -0,0 +1,325 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESP8266HTTPClient.h>
+#include <ESP8266WiFi.h>
+#include <Logger.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "wireless/DataSource.h"
+#include "wireless/WiFiManager.h"
+
+// Longest validator kept, a longer ETag or date is not sent back
+static constexpr size_t VALIDATOR_MAX = 64;
+
+static constexpr uint32_t PHASE_HASH = 2654435761U;  // Knuth's multiplicative hash
+
+struct SourceEntry {
+    DataSourceSpec spec;
+    JsonDocument filter;
+    String etag;
+    String lastModified;
+    uint32_t dueMs;
+    DataSourceStats stats;
+};
+
+static std::vector<SourceEntry> s_sources;
+static uint32_t s_lastPollMs = 0;
+static bool s_polled = false;
+
+static auto findEntry(const char* name) -> std::vector<SourceEntry>::iterator {
+    return std::find_if(s_sources.begin(), s_sources.end(),
+                        [name](const SourceEntry& entry) { return strcmp(entry.spec.name.data(), name) == 0; });
+}
+
+/**
+ * @brief Offset of a source's polls within its interval, different from one device and one source to the next
+ */
+static auto pollPhase(const char* name, uint32_t intervalMs) -> uint32_t {
+    uint32_t hash = ESP.getChipId();  // NOLINT(readability-static-accessed-through-instance)
+    for (const char* chr = name; *chr != '\0'; ++chr) {
+        hash = (hash ^ static_cast<uint8_t>(*chr)) * PHASE_HASH;
+    }
+    return hash % intervalMs;
+}
+
+/**
+ * @brief Add a path to a filter: every step keeps one key (or every element of an array), the last one its value
+ */
+static void addFilter(JsonVariant node, const DataSourceStep* step, size_t remaining) {
+    if (remaining == 0) {
+        node.set(true);
+        return;
+    }
+    if (node.is<bool>()) {
+        return;  // a shorter path already keeps the whole value
+    }
+
+    if (step->index != DATA_SOURCE_NO_INDEX) {
+        JsonArray array = node.is<JsonArray>() ? node.as<JsonArray>() : node.to<JsonArray>();
+        // Element 0 of a filter array applies to every element
+        addFilter(array.size() > 0 ? array[0].as<JsonVariant>() : array.add<JsonVariant>(), step + 1,
+                  remaining - 1);
+        return;
+    }
+
+    JsonObject object = node.is<JsonObject>() ? node.as<JsonObject>() : node.to<JsonObject>();
+    const char* key = step->key.data();
+    addFilter(object.containsKey(key) ? object[key].as<JsonVariant>() : object[key].to<JsonVariant>(), step + 1,
+              remaining - 1);
+}
+
+/**
+ * @brief Follow a path in a parsed response
+ */
+static auto resolve(JsonVariantConst value, const std::vector<DataSourceStep>& path) -> JsonVariantConst {
+    for (const DataSourceStep& step : path) {
+        value = step.index != DATA_SOURCE_NO_INDEX ? value[static_cast<size_t>(step.index)] : value[step.key.data()];
+    }
+    return value;
+}
+
+/**
+ * @brief Read a value as template text: strings as they are, numbers and booleans as JSON writes them
+ */
+static auto valueText(JsonVariantConst value, std::array<char, TEMPLATE_VALUE_MAX>& out) -> const char* {
+    if (value.is<const char*>()) {
+        return value.as<const char*>();
+    }
+    const size_t length = serializeJson(value, out.data(), out.size() - 1);
+    out[length] = '\0';
+    return out.data();
+}
+
+/**
+ * @brief Copy the parsed values into the template, drawing the widgets of those that changed
+ */
+static void applyValues(SourceEntry& entry, const JsonDocument& doc) {
+    TemplateScreen* screen = Template::find(entry.spec.templateName.data());
+    if (screen == nullptr) {
+        return;
+    }
+
+    std::array<char, TEMPLATE_VALUE_MAX> scratch{};
+    uint32_t changed = 0;
+    for (const DataSourceBinding& binding : entry.spec.bindings) {
+        const JsonVariantConst value = resolve(doc.as<JsonVariantConst>(), binding.path);
+        const int var = screen->findVar(binding.var.data());
+        if (value.isNull() || var < 0) {
+            continue;
+        }
+        if (screen->setValue(static_cast<size_t>(var), valueText(value, scratch))) {
+            changed++;
+        }
+    }
+
+    entry.stats.valuesChanged += changed;
+    Template::refresh(*screen, changed);
+}
+
+/**
+ * @brief Conditional GET of one source, parsed through its filter while it is received
+ */
+static void poll(SourceEntry& entry) {
+    const uint32_t startMs = millis();
+    static const char* const VALIDATORS[] = {"ETag", "Last-Modified"};
+
+    WiFiClient client;
+    HTTPClient http;
+    http.setTimeout(DATA_SOURCE_TIMEOUT_MS);
+    http.useHTTP10(true);  // no chunked encoding, so the body can be parsed straight from the socket
+    entry.stats.polls++;
+
+    if (!http.begin(client, entry.spec.url)) {
+        entry.stats.errors++;
+        entry.stats.lastStatus = HTTPC_ERROR_CONNECTION_FAILED;
+        return;
+    }
+    http.collectHeaders(VALIDATORS, 2);
+    if (!entry.etag.isEmpty()) {
+        http.addHeader("If-None-Match", entry.etag);
+    }
+    if (!entry.lastModified.isEmpty()) {
+        http.addHeader("If-Modified-Since", entry.lastModified);
+    }
+
+    const int status = http.GET();
+    entry.stats.lastStatus = static_cast<int16_t>(status);
+
+    if (status == HTTP_CODE_NOT_MODIFIED) {
+        entry.stats.notModified++;
+    } else if (status == HTTP_CODE_OK) {
+        JsonDocument doc;
+        const DeserializationError error =
+            deserializeJson(doc, http.getStream(), DeserializationOption::Filter(entry.filter));
+        if (error) {
+            entry.stats.errors++;
+            Logger::warn(("Source " + String(entry.spec.name.data()) + ": " + error.c_str()).c_str(), "DataSource");
+        } else {
+            const String etag = http.header("ETag");
+            const String lastModified = http.header("Last-Modified");
+            entry.etag = etag.length() < VALIDATOR_MAX ? etag : String();
+            entry.lastModified = lastModified.length() < VALIDATOR_MAX ? lastModified : String();
+            applyValues(entry, doc);
+        }
+    } else {
+        entry.stats.errors++;
+    }
+
+    http.end();
+    entry.stats.lastPollMs = millis() - startMs;
+}
+
+namespace DataSource {
+
+/**
+ * @brief Compile a path expression: keys separated by dots, array indices in brackets ("hosts[2].cpu")
+ *
+ * @return false if the path is empty, too long or malformed
+ */
+auto parsePath(const char* text, std::vector<DataSourceStep>& path) -> bool {
+    path.clear();
+    const char* chr = text;
+
+    while (*chr != '\0') {
+        if (path.size() == DATA_SOURCE_PATH_STEPS) {
+            return false;
+        }
+        DataSourceStep step{{}, DATA_SOURCE_NO_INDEX};
+
+        if (*chr == '[') {
+            char* end = nullptr;
+            const long index = strtol(chr + 1, &end, 10);
+            if (end == chr + 1 || *end != ']' || index < 0 || index > INT16_MAX) {
+                return false;
+            }
+            step.index = static_cast<int16_t>(index);
+            chr = end + 1;
+            if (*chr != '\0' && *chr != '.' && *chr != '[') {
+                return false;
+            }
+        } else {
+            const size_t length = strcspn(chr, ".[");
+            if (length == 0 || length >= step.key.size()) {
+                return false;
+            }
+            memcpy(step.key.data(), chr, length);
+            chr += length;
+        }
+        path.push_back(step);
+
+        // A key follows a dot, an index follows directly
+        if (*chr == '.') {
+            chr++;
+            if (*chr == '\0' || *chr == '[') {
+                return false;
+            }
+        }
+    }
+
+    return !path.empty();
+}
+
+/**
+ * @brief Define a source, replacing one with the same name; its first poll comes within one interval
+ *
+ * @return nullptr when defined, otherwise what is wrong
+ */
+auto define(const DataSourceSpec& spec) -> const char* {
+    if (!spec.url.startsWith("http://") || spec.url.length() >= DATA_SOURCE_URL_MAX) {
+        return "url must be http:// and shorter than 128 characters";
+    }
+    if (spec.bindings.empty() || spec.bindings.size() > DATA_SOURCE_MAX_BINDINGS) {
+        return "bind must hold 1 to 8 variables";
+    }
+
+    auto entry = findEntry(spec.name.data());
+    if (entry == s_sources.end() && s_sources.size() >= DATA_SOURCE_MAX) {
+        return "too many sources (4 at most)";
+    }
+    if (entry == s_sources.end()) {
+        entry = s_sources.emplace(s_sources.end());
+    }
+
+    entry->spec = spec;
+    entry->spec.intervalMs = std::max(spec.intervalMs, DATA_SOURCE_MIN_INTERVAL_MS);
+    entry->filter.clear();
+    for (const DataSourceBinding& binding : spec.bindings) {
+        addFilter(entry->filter.as<JsonVariant>(), binding.path.data(), binding.path.size());
+    }
+    entry->etag = String();
+    entry->lastModified = String();
+    entry->stats = DataSourceStats{};
+    entry->dueMs = millis() + pollPhase(spec.name.data(), entry->spec.intervalMs);
+
+    return nullptr;
+}
+
+/**
+ * @brief Stop polling a source, the template keeps the values it got
+ */
+auto remove(const char* name) -> bool {
+    auto entry = findEntry(name);
+    if (entry == s_sources.end()) {
+        return false;
+    }
+    s_sources.erase(entry);
+    return true;
+}
+
+/**
+ * @brief Poll a source at the next chance instead of waiting for its turn
+ */
+auto pollSoon(const char* name) -> bool {
+    auto entry = findEntry(name);
+    if (entry == s_sources.end()) {
+        return false;
+    }
+    entry->dueMs = millis();
+    return true;
+}
+
+/**
+ * @brief Poll the source that is due, if any, called from loop()
+ *
+ * At most one source is polled per call, and none within DATA_SOURCE_GAP_MS of the previous poll
+ *
+ * @param nowMs Current time
+ */
+void update(uint32_t nowMs) {
+    if (s_sources.empty() || !WiFiManager::isConnected() || (s_polled && nowMs - s_lastPollMs < DATA_SOURCE_GAP_MS)) {
+        return;
+    }
+
+    // Most overdue first
+    auto due = s_sources.end();
+    for (auto entry = s_sources.begin(); entry != s_sources.end(); ++entry) {
+        if (static_cast<int32_t>(nowMs - entry->dueMs) >= 0 &&
+            (due == s_sources.end() || static_cast<int32_t>(entry->dueMs - due->dueMs) < 0)) {
+            due = entry;
+        }
+    }
+    if (due == s_sources.end()) {
+        return;
+    }
+
+    poll(*due);
+    s_polled = true;
+    s_lastPollMs = millis();
+
+    // Keep the phase; a source that fell behind by a whole interval starts again from now
+    due->dueMs += due->spec.intervalMs;
+    if (static_cast<int32_t>(s_lastPollMs - due->dueMs) >= 0) {
+        due->dueMs = s_lastPollMs + due->spec.intervalMs;
+    }
+}
+
+auto count() -> size_t { return s_sources.size(); }
+
+auto spec(size_t index) -> const DataSourceSpec& { return s_sources[index].spec; }
+
+auto stats(size_t index) -> DataSourceStats { return s_sources[index].stats; }
+
+}  // namespace DataSource
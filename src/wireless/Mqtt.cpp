@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <Logger.h>
+#include <PubSubClient.h>
+
+#include <algorithm>
+
+#include "wireless/Mqtt.h"
+#include "wireless/WiFiManager.h"
+
+static WiFiClient s_net;
+static PubSubClient s_client(s_net);
+static MqttSettings s_settings{};
+static MqttHandler s_handler = nullptr;
+static MqttStats s_stats{};
+static String s_clientId;
+static uint32_t s_retryMs = MQTT_RETRY_MIN_MS;
+static uint32_t s_nextAttemptMs = 0;
+static bool s_buffer = false;
+
+static void onMessage(char* topic, uint8_t* payload, unsigned int length) {
+    s_stats.messages++;
+    s_stats.bytes += length;
+    if (s_handler == nullptr) {
+        return;
+    }
+
+    const uint32_t startUs = micros();
+    if (s_handler(topic, payload, length)) {
+        s_stats.drawn++;
+    } else {
+        s_stats.rejected++;
+    }
+    s_stats.lastDrawUs = micros() - startUs;
+    s_stats.maxDrawUs = std::max(s_stats.maxDrawUs, s_stats.lastDrawUs);
+}
+
+/**
+ * @brief One connection attempt, subscribing to every topic on success
+ *
+ * The name lookup and the TCP connect are each bounded by MQTT_CONNECT_TIMEOUT_MS instead of the 10 s and 5 s
+ * defaults of the core, and the wait for the broker's CONNACK by MQTT_SOCKET_TIMEOUT_S. The TCP connection is
+ * opened here, so the client only sends CONNECT over it
+ */
+static auto connect() -> bool {
+    const char* user = s_settings.user.isEmpty() ? nullptr : s_settings.user.c_str();
+    const char* password = s_settings.password.isEmpty() ? nullptr : s_settings.password.c_str();
+    const uint16_t port = s_settings.port != 0 ? s_settings.port : MQTT_DEFAULT_PORT;
+
+    IPAddress address;
+    if (!address.fromString(s_settings.host) &&
+        !WiFi.hostByName(s_settings.host.c_str(), address, MQTT_CONNECT_TIMEOUT_MS)) {
+        Logger::warn(("MQTT broker " + s_settings.host + " not found").c_str(), "MQTT");
+        return false;
+    }
+    s_client.setServer(address, port);
+
+    s_net.stop();
+    s_net.setTimeout(MQTT_CONNECT_TIMEOUT_MS);
+    if (s_net.connect(address, port) != 1) {
+        Logger::warn(("MQTT broker " + s_settings.host + " unreachable").c_str(), "MQTT");
+        return false;
+    }
+
+    if (!s_client.connect(s_clientId.c_str(), user, password)) {
+        Logger::warn(("MQTT connection failed, state " + String(s_client.state())).c_str(), "MQTT");
+        return false;
+    }
+
+    for (const String& topic : s_settings.topics) {
+        s_client.subscribe(topic.c_str(), 0);
+    }
+    // Subscribed last, so the retained screen is drawn over what retained messages of the other topics drew
+    if (!s_settings.screenTopic.isEmpty()) {
+        s_client.subscribe(s_settings.screenTopic.c_str(), 0);
+    }
+
+    Logger::info(("MQTT connected to " + s_settings.host).c_str(), "MQTT");
+    return true;
+}
+
+namespace Mqtt {
+
+/**
+ * @brief Apply new settings, an open connection is closed and made again with them
+ *
+ * @param settings Broker and topics, an empty host disables MQTT
+ * @param handler Called for every message
+ */
+void begin(const MqttSettings& settings, MqttHandler handler) {
+    if (s_client.connected()) {
+        s_client.disconnect();
+    }
+
+    s_settings = settings;
+    if (s_settings.topics.size() > MQTT_MAX_TOPICS) {
+        s_settings.topics.resize(MQTT_MAX_TOPICS);
+    }
+    s_handler = handler;
+    s_clientId = s_settings.clientId;
+    if (s_clientId.isEmpty()) {
+        const uint32_t chipId = ESP.getChipId();  // NOLINT(readability-static-accessed-through-instance)
+        s_clientId = "holocube-" + String(chipId, HEX);
+    }
+
+    // The receive buffer is only allocated once a broker is configured
+    if (!s_buffer && !s_settings.host.isEmpty()) {
+        s_buffer = s_client.setBufferSize(MQTT_BUFFER_SIZE);
+    }
+    s_client.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
+    s_client.setCallback(onMessage);
+
+    s_retryMs = MQTT_RETRY_MIN_MS;
+    s_nextAttemptMs = millis();
+}
+
+/**
+ * @brief Read what the broker sent, reconnecting when it is time to
+ *
+ * @param nowMs Current time
+ */
+void update(uint32_t nowMs) {
+    if (s_settings.host.isEmpty() || !s_buffer || !WiFiManager::isConnected()) {
+        return;
+    }
+
+    if (s_client.loop()) {
+        return;
+    }
+    if (static_cast<int32_t>(nowMs - s_nextAttemptMs) < 0) {
+        return;
+    }
+
+    // The next attempt is scheduled before this one, so a broker that drops every connection is not retried at
+    // every loop()
+    s_nextAttemptMs = nowMs + s_retryMs;
+    if (connect()) {
+        s_stats.connects++;
+        s_retryMs = MQTT_RETRY_MIN_MS;
+    } else {
+        s_stats.failures++;
+        s_retryMs = std::min(s_retryMs * 2, MQTT_RETRY_MAX_MS);
+    }
+}
+
+auto connected() -> bool { return s_client.connected(); }
+
+auto settings() -> const MqttSettings& { return s_settings; }
+
+auto stats() -> MqttStats { return s_stats; }
+
+}  // namespace Mqtt
@@ -0,0 +1,326 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <Logger.h>
+#include <WiFiUdp.h>
+
+#include <algorithm>
+
+#include "wireless/TimeSync.h"
+#include "wireless/WiFiManager.h"
+
+static constexpr int64_t PPB = 1000000000LL;
+static constexpr uint32_t MIN_SKEW_SPAN_US = 10000000;  // samples closer than this give too noisy a skew
+static constexpr int64_t STEP_US = 10000;               // a larger residual steps the clock instead of slewing it
+static constexpr int32_t SKEW_SMOOTHING = 4;
+static constexpr uint8_t PACKETS_PER_UPDATE = 4;
+
+enum TimeSyncType : uint8_t {
+    TIME_SYNC_REQUEST = 0,
+    TIME_SYNC_REPLY = 1,
+};
+
+/**
+ * @brief Request or reply: t1 is the client's local time when sent, t2 and t3 the server's sync time when the
+ * request was read and when the reply was sent
+ */
+struct TimeSyncPacket {
+    uint8_t type;
+    uint64_t t1;
+    uint64_t t2;
+    uint64_t t3;
+};
+
+static WiFiUDP s_udp;
+static bool s_open = false;
+static IPAddress s_server;
+static TimeSyncStats s_stats{};
+
+// 64-bit local clock, extended from micros() which wraps every 71 minutes
+static uint32_t s_lastMicros = 0;
+static uint64_t s_highUs = 0;
+
+// Clock model: sync = local + offset + skew * (local - base)
+static bool s_modelSet = false;
+static uint64_t s_baseLocal = 0;
+static int64_t s_baseOffset = 0;
+static int32_t s_skewPpb = 0;
+static bool s_skewSet = false;
+static uint64_t s_prevLocal = 0;
+static int64_t s_prevOffset = 0;
+
+// Exchange in progress
+static std::array<uint64_t, TIME_SYNC_BURST> s_sentT1{};
+static std::array<bool, TIME_SYNC_BURST> s_answered{};  // a duplicated reply is not counted twice
+static uint8_t s_sent = 0;
+static uint8_t s_received = 0;
+static uint32_t s_lastSendMs = 0;
+static uint32_t s_nextExchangeMs = 0;
+static uint32_t s_exchanges = 0;
+static bool s_bestValid = false;
+static uint64_t s_bestLocal = 0;
+static int64_t s_bestOffset = 0;
+static uint32_t s_bestDelay = 0;
+
+static void putU64(uint8_t* out, uint64_t value) {
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8U * i));
+    }
+}
+
+static auto getU64(const uint8_t* in) -> uint64_t {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8U * i);
+    }
+    return value;
+}
+
+static void send(const IPAddress& address, uint16_t port, const TimeSyncPacket& packet) {
+    std::array<uint8_t, TIME_SYNC_PACKET_SIZE> out{};
+    out[0] = TIME_SYNC_MAGIC[0];
+    out[1] = TIME_SYNC_MAGIC[1];
+    out[2] = TIME_SYNC_VERSION;
+    out[3] = packet.type;
+    putU64(&out[8], packet.t1);
+    putU64(&out[16], packet.t2);
+    putU64(&out[24], packet.t3);
+
+    s_udp.beginPacket(address, port);
+    s_udp.write(out.data(), out.size());
+    s_udp.endPacket();
+}
+
+static auto modelOffset(uint64_t local) -> int64_t {
+    const auto elapsed = static_cast<int64_t>(local - s_baseLocal);
+    return s_baseOffset + elapsed * s_skewPpb / PPB;
+}
+
+/**
+ * @brief Fold the best sample of an exchange into the clock model
+ */
+static void applySample(uint64_t local, int64_t offset, uint32_t delayUs) {
+    s_stats.samples++;
+    s_stats.offsetUs = offset;
+    s_stats.delayUs = delayUs;
+    s_stats.errorUs = delayUs / 2;
+    s_stats.lastSampleMs = millis();
+
+    if (!s_modelSet) {
+        s_modelSet = true;
+        s_baseLocal = local;
+        s_baseOffset = offset;
+        s_skewPpb = 0;
+        s_skewSet = false;
+        s_prevLocal = local;
+        s_prevOffset = offset;
+        s_stats.residualUs = 0;
+        return;
+    }
+
+    const int64_t predicted = modelOffset(local);
+    const int64_t residual = offset - predicted;
+    s_stats.residualUs = static_cast<int32_t>(std::max<int64_t>(std::min<int64_t>(residual, INT32_MAX), INT32_MIN));
+
+    // Skew from the offsets measured by two samples far enough apart; the first one is taken as is, later ones are
+    // smoothed
+    const uint64_t span = local - s_prevLocal;
+    if (span >= MIN_SKEW_SPAN_US) {
+        const int64_t measured = (offset - s_prevOffset) * PPB / static_cast<int64_t>(span);
+        const int64_t skew = s_skewSet ? s_skewPpb + (measured - s_skewPpb) / SKEW_SMOOTHING : measured;
+        s_skewSet = true;
+        s_skewPpb = static_cast<int32_t>(std::max<int64_t>(std::min<int64_t>(skew, TIME_SYNC_MAX_SKEW_PPB),
+                                                           -TIME_SYNC_MAX_SKEW_PPB));
+        s_prevLocal = local;
+        s_prevOffset = offset;
+    }
+
+    // Slew by half the residual, so one noisy sample moves the clock by half its error; step on a large one
+    if (residual > STEP_US || residual < -STEP_US) {
+        Logger::warn(("Clock stepped by " + String(static_cast<int32_t>(residual)) + " us").c_str(), "TimeSync");
+        s_baseOffset = offset;
+    } else {
+        s_baseOffset = predicted + residual / 2;
+    }
+    s_baseLocal = local;
+}
+
+static void sendRequest(uint32_t nowMs) {
+    const uint64_t t1 = TimeSync::localUs();
+    s_answered[s_sent] = false;
+    s_sentT1[s_sent++] = t1;
+    s_lastSendMs = nowMs;
+    s_stats.requests++;
+    send(s_server, TIME_SYNC_PORT, TimeSyncPacket{TIME_SYNC_REQUEST, t1, 0, 0});
+}
+
+static void finishExchange(uint32_t nowMs) {
+    if (s_bestValid) {
+        applySample(s_bestLocal, s_bestOffset, s_bestDelay);
+    }
+    s_exchanges++;
+    s_sent = 0;
+    s_received = 0;
+    s_bestValid = false;
+    s_nextExchangeMs =
+        nowMs + (s_exchanges < TIME_SYNC_FAST_EXCHANGES ? TIME_SYNC_FAST_INTERVAL_MS : TIME_SYNC_INTERVAL_MS);
+}
+
+/**
+ * @brief A reply to one of the requests of the exchange: keep it if its round trip is the shortest so far
+ *
+ * Only the first reply to each request counts, so a duplicated datagram cannot end the burst early
+ */
+static void onReply(const TimeSyncPacket& reply) {
+    const uint64_t t4 = TimeSync::localUs();
+    const auto* sent = std::find(s_sentT1.begin(), s_sentT1.begin() + s_sent, reply.t1);
+    if (sent == s_sentT1.begin() + s_sent || s_udp.remoteIP() != s_server) {
+        return;
+    }
+    bool& answered = s_answered[sent - s_sentT1.begin()];
+    if (answered) {
+        return;
+    }
+    answered = true;
+    s_received++;
+    s_stats.replies++;
+
+    const auto roundTrip = static_cast<int64_t>(t4 - reply.t1) - static_cast<int64_t>(reply.t3 - reply.t2);
+    const auto delayUs = static_cast<uint32_t>(std::max<int64_t>(roundTrip, 0));
+    if (delayUs > TIME_SYNC_MAX_DELAY_US || (s_bestValid && delayUs >= s_bestDelay)) {
+        return;
+    }
+
+    // The offset holds at the middle of the exchange
+    s_bestValid = true;
+    s_bestDelay = delayUs;
+    s_bestLocal = reply.t1 + (t4 - reply.t1) / 2;
+    s_bestOffset = (static_cast<int64_t>(reply.t2 - reply.t1) + static_cast<int64_t>(reply.t3 - t4)) / 2;
+}
+
+static void receive() {
+    std::array<uint8_t, TIME_SYNC_PACKET_SIZE> in{};
+    for (uint8_t i = 0; i < PACKETS_PER_UPDATE; ++i) {
+        const int size = s_udp.parsePacket();
+        if (size <= 0) {
+            return;
+        }
+        const uint64_t readSync = TimeSync::now();
+        if (size != static_cast<int>(in.size()) || s_udp.read(in.data(), in.size()) != size ||
+            in[0] != TIME_SYNC_MAGIC[0] || in[1] != TIME_SYNC_MAGIC[1] || in[2] != TIME_SYNC_VERSION) {
+            s_udp.flush();
+            continue;
+        }
+
+        const TimeSyncPacket packet{in[3], getU64(&in[8]), getU64(&in[16]), getU64(&in[24])};
+        if (packet.type == TIME_SYNC_REQUEST) {
+            s_stats.answered++;
+            send(s_udp.remoteIP(), s_udp.remotePort(),
+                 TimeSyncPacket{TIME_SYNC_REPLY, packet.t1, readSync, TimeSync::now()});
+        } else if (packet.type == TIME_SYNC_REPLY && s_sent > 0) {
+            onReply(packet);
+        }
+    }
+}
+
+namespace TimeSync {
+
+/**
+ * @brief Follow a server, or be the reference
+ *
+ * @param server Device or host to take the time from, an unset address makes this device's clock the reference
+ */
+void begin(const IPAddress& server) {
+    s_server = server;
+    s_modelSet = false;
+    s_sent = 0;
+    s_received = 0;
+    s_bestValid = false;
+    s_exchanges = 0;
+    s_nextExchangeMs = millis();
+    s_stats = TimeSyncStats{};
+}
+
+/**
+ * @brief Answer the requests of other devices and run the exchanges with the server
+ *
+ * @param nowMs Current time
+ */
+void update(uint32_t nowMs) {
+    localUs();  // keeps the 64-bit clock across micros() wraps
+
+    if (!WiFiManager::isConnected()) {
+        if (s_open) {
+            s_udp.stop();
+            s_open = false;
+        }
+        return;
+    }
+    if (!s_open) {
+        s_open = s_udp.begin(TIME_SYNC_PORT) != 0;
+        if (!s_open) {
+            return;
+        }
+    }
+
+    receive();
+    if (!s_server.isSet()) {
+        return;
+    }
+
+    if (s_sent == 0) {
+        if (static_cast<int32_t>(nowMs - s_nextExchangeMs) >= 0) {
+            sendRequest(nowMs);
+        }
+    } else if (s_received == s_sent && s_sent == TIME_SYNC_BURST) {
+        finishExchange(nowMs);
+    } else if (s_sent < TIME_SYNC_BURST && nowMs - s_lastSendMs >= TIME_SYNC_REQUEST_GAP_MS) {
+        sendRequest(nowMs);
+    } else if (s_sent == TIME_SYNC_BURST && nowMs - s_lastSendMs >= TIME_SYNC_REPLY_TIMEOUT_MS) {
+        finishExchange(nowMs);
+    }
+}
+
+/**
+ * @brief Local time since boot in microseconds, on 64 bits
+ *
+ * Must be read at least once per micros() period (71 minutes), update() does
+ */
+auto localUs() -> uint64_t {
+    const uint32_t micro = micros();
+    if (micro < s_lastMicros) {
+        s_highUs += 1ULL << 32U;
+    }
+    s_lastMicros = micro;
+    return s_highUs | micro;
+}
+
+/**
+ * @brief Sync time in microseconds: the server's clock as estimated here, the local clock on the reference
+ */
+auto now() -> uint64_t {
+    const uint64_t local = localUs();
+    return s_modelSet ? local + modelOffset(local) : local;
+}
+
+/**
+ * @brief Local time at which the sync clock reads syncUs
+ */
+auto toLocal(uint64_t syncUs) -> uint64_t {
+    if (!s_modelSet) {
+        return syncUs;
+    }
+    // The offset changes by the skew only, one correction is exact to well under a microsecond
+    const uint64_t guess = syncUs - s_baseOffset;
+    return syncUs - modelOffset(guess);
+}
+
+auto server() -> IPAddress { return s_server; }
+
+auto stats() -> TimeSyncStats {
+    TimeSyncStats stats = s_stats;
+    stats.synced = !s_server.isSet() || s_modelSet;
+    stats.skewPpb = s_skewPpb;
+    return stats;
+}
+
+}  // namespace TimeSync
@@ -0,0 +1,253 @@
+#include <unity.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "script/ScriptVm.h"
+
+// Instructions one loop() tick may run, as in script/Script.h
+static constexpr uint32_t TICK_BUDGET = 2000;
+// Iterations of the benchmark loop, 8 instructions each
+static constexpr int32_t BENCH_ITERATIONS = 1000000;
+
+/**
+ * @brief Host stand-in recording the draw commands, with fixed inputs
+ */
+class MockHost : public ScriptHost {
+   public:
+    auto input(ScriptInput input) -> int32_t override { return static_cast<int32_t>(input) * 10; }
+    auto draw(const DrawCommand& command) -> void override { draws.push_back(command); }
+    auto allocateText(size_t bytes) -> char* override {
+        if (!hasText) {
+            return nullptr;
+        }
+        texts.emplace_back(bytes, '\0');
+        return texts.back().data();
+    }
+
+    std::vector<DrawCommand> draws;
+    std::vector<std::string> texts;
+    bool hasText = true;
+};
+
+static auto op(ScriptOp code) -> uint8_t { return static_cast<uint8_t>(code); }
+
+/**
+ * @brief A bytecode file: header, code, then the string pool as given
+ */
+static auto image(const std::vector<uint8_t>& code, uint8_t globals = 0, const std::string& strings = "")
+    -> std::vector<uint8_t> {
+    const ScriptHeader header{SCRIPT_MAGIC, SCRIPT_FORMAT_VERSION, globals, static_cast<uint16_t>(code.size()),
+                              static_cast<uint16_t>(strings.size())};
+    std::vector<uint8_t> file(sizeof(header) + code.size() + strings.size());
+    memcpy(file.data(), &header, sizeof(header));
+    std::copy(code.begin(), code.end(), file.begin() + sizeof(header));
+    std::copy(strings.begin(), strings.end(), file.begin() + static_cast<std::ptrdiff_t>(sizeof(header) + code.size()));
+    return file;
+}
+
+static auto load(ScriptVm& vm, const std::vector<uint8_t>& file) -> const char* {
+    return vm.load(file.data(), file.size());
+}
+
+static void assertRejected(const char* reason, const std::vector<uint8_t>& file) {
+    ScriptVm vm;
+    const char* error = load(vm, file);
+    TEST_ASSERT_NOT_NULL(error);
+    TEST_ASSERT_EQUAL_STRING(reason, error);
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Stopped);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_rejects_bad_files() {
+    std::vector<uint8_t> file = image({op(ScriptOp::Halt)});
+
+    assertRejected("file too short", std::vector<uint8_t>(file.begin(), file.begin() + 4));
+
+    std::vector<uint8_t> magic = file;
+    magic[0] = 'X';
+    assertRejected("not a script for this firmware version", magic);
+
+    std::vector<uint8_t> version = file;
+    version[4] = SCRIPT_FORMAT_VERSION + 1;
+    assertRejected("not a script for this firmware version", version);
+
+    assertRejected("script too large", image({}));
+    assertRejected("script too large", image({op(ScriptOp::Halt)}, SCRIPT_MAX_GLOBALS + 1));
+
+    std::vector<uint8_t> padded = file;
+    padded.push_back(0);
+    assertRejected("file size does not match its header", padded);
+
+    assertRejected("string pool not terminated", image({op(ScriptOp::Halt)}, 0, "abc"));
+}
+
+void test_rejects_bad_code() {
+    assertRejected("unknown opcode", image({0xFF}));
+    assertRejected("instruction cut by the end of the code", image({op(ScriptOp::Push32), 1, 2}));
+    assertRejected("global out of range", image({op(ScriptOp::Load), 2}, 2));
+    assertRejected("timer out of range", image({op(ScriptOp::TimerDue), SCRIPT_TIMERS}));
+    assertRejected("unknown input", image({op(ScriptOp::Input), SCRIPT_INPUT_COUNT}));
+    assertRejected("jump out of the code", image({op(ScriptOp::Jmp), 3, 0}));
+    assertRejected("jump into the middle of an instruction",
+                   image({op(ScriptOp::Push8), 1, op(ScriptOp::Jz), 1, 0, op(ScriptOp::Halt)}));
+    assertRejected("string out of range", image({op(ScriptOp::Text), 4, 0}, 0, std::string("abc", 4)));
+}
+
+void test_runs_to_halt() {
+    ScriptVm vm;
+    MockHost host;
+    // g0 = (7 - 10) * 3 / 2, then read the Width input into g1
+    TEST_ASSERT_NULL(load(vm, image({op(ScriptOp::Push8), 7, op(ScriptOp::Push8), 10, op(ScriptOp::Sub),
+                                     op(ScriptOp::Push8), 3, op(ScriptOp::Mul), op(ScriptOp::Push8), 2,
+                                     op(ScriptOp::Div), op(ScriptOp::Store), 0, op(ScriptOp::Input),
+                                     static_cast<uint8_t>(ScriptInput::Width), op(ScriptOp::Store), 1,
+                                     op(ScriptOp::Halt)},
+                                    2)));
+
+    TEST_ASSERT_EQUAL_UINT32(11, vm.run(host, 0, TICK_BUDGET));
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Halted);
+    TEST_ASSERT_EQUAL_INT32(-4, vm.global(0));
+    TEST_ASSERT_EQUAL_INT32(static_cast<int32_t>(ScriptInput::Width) * 10, vm.global(1));
+}
+
+void test_budget_ends_the_tick() {
+    ScriptVm vm;
+    MockHost host;
+    TEST_ASSERT_NULL(load(vm, image({op(ScriptOp::Nop), op(ScriptOp::Jmp), 0, 0})));
+
+    // A script that never yields is cut at the budget and carries on from there on the next tick
+    TEST_ASSERT_EQUAL_UINT32(TICK_BUDGET, vm.run(host, 0, TICK_BUDGET));
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Running);
+    TEST_ASSERT_EQUAL_UINT32(3, vm.run(host, 16, 3));
+    TEST_ASSERT_EQUAL_UINT32(1, vm.pc());
+}
+
+void test_yield_and_sleep() {
+    ScriptVm vm;
+    MockHost host;
+    TEST_ASSERT_NULL(load(vm, image({op(ScriptOp::Yield), op(ScriptOp::Push8), 50, op(ScriptOp::Sleep),
+                                     op(ScriptOp::Halt)})));
+
+    TEST_ASSERT_EQUAL_UINT32(1, vm.run(host, 0, TICK_BUDGET));
+    TEST_ASSERT_EQUAL_UINT32(2, vm.run(host, 0, TICK_BUDGET));
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Sleeping);
+    TEST_ASSERT_EQUAL_UINT32(0, vm.run(host, 49, TICK_BUDGET));
+    TEST_ASSERT_EQUAL_UINT32(1, vm.run(host, 50, TICK_BUDGET));
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Halted);
+}
+
+static void assertFault(ScriptFault fault, const std::vector<uint8_t>& code, bool hasText = true) {
+    ScriptVm vm;
+    MockHost host;
+    host.hasText = hasText;
+    TEST_ASSERT_NULL(load(vm, image(code)));
+
+    vm.run(host, 0, TICK_BUDGET);
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Faulted);
+    TEST_ASSERT_TRUE(vm.fault() == fault);
+    TEST_ASSERT_EQUAL_size_t(0, host.draws.size());
+
+    // A faulted script stays stopped
+    TEST_ASSERT_EQUAL_UINT32(0, vm.run(host, 16, TICK_BUDGET));
+    vm.stop();
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Faulted);
+}
+
+void test_runtime_faults() {
+    assertFault(ScriptFault::StackUnderflow, {op(ScriptOp::Push8), 1, op(ScriptOp::Add)});
+    assertFault(ScriptFault::StackOverflow, {op(ScriptOp::Push8), 1, op(ScriptOp::Jmp), 0, 0});
+    assertFault(ScriptFault::DivideByZero, {op(ScriptOp::Push8), 1, op(ScriptOp::Push8), 0, op(ScriptOp::Mod)});
+    assertFault(ScriptFault::CallOverflow, {op(ScriptOp::Call), 0, 0});
+    assertFault(ScriptFault::CallUnderflow, {op(ScriptOp::Ret)});
+    assertFault(ScriptFault::OutOfMemory,
+                {op(ScriptOp::Push8), 1, op(ScriptOp::Push8), 2, op(ScriptOp::Push8), 3, op(ScriptOp::Number)},
+                false);
+}
+
+void test_overflowing_division_wraps() {
+    ScriptVm vm;
+    MockHost host;
+    TEST_ASSERT_NULL(load(vm, image({op(ScriptOp::Push32), 0, 0, 0, 0x80, op(ScriptOp::Push8), 0xFF,
+                                     op(ScriptOp::Div), op(ScriptOp::Store), 0},
+                                    1)));
+
+    vm.run(host, 0, TICK_BUDGET);
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Halted);
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, vm.global(0));
+}
+
+void test_draws_reach_the_host() {
+    ScriptVm vm;
+    MockHost host;
+    TEST_ASSERT_NULL(load(vm, image({op(ScriptOp::Push16), 0x00, 0xF8, op(ScriptOp::Color), op(ScriptOp::Push8), 1,
+                                     op(ScriptOp::Push8), 2, op(ScriptOp::Push8), 30, op(ScriptOp::Push8), 40,
+                                     op(ScriptOp::FillRect), op(ScriptOp::Push8), 5, op(ScriptOp::Push8), 6,
+                                     op(ScriptOp::Text), 0, 0},
+                                    0, std::string("hi", 3))));
+
+    vm.run(host, 0, TICK_BUDGET);
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Halted);
+    TEST_ASSERT_EQUAL_size_t(2, host.draws.size());
+    TEST_ASSERT_TRUE(host.draws[0].op == DrawOp::Rect && host.draws[0].fill);
+    TEST_ASSERT_EQUAL_UINT32(0xF800, host.draws[0].color);
+    TEST_ASSERT_EQUAL_INT16(1, host.draws[0].args[0]);
+    TEST_ASSERT_EQUAL_INT16(40, host.draws[0].args[3]);
+    TEST_ASSERT_TRUE(host.draws[1].op == DrawOp::Text);
+    TEST_ASSERT_EQUAL_STRING("hi", host.draws[1].text);
+}
+
+/**
+ * @brief Speed of the interpreter loop on the host, the device figure comes from holoscript.py bench
+ */
+void test_benchmark() {
+    ScriptVm vm;
+    MockHost host;
+    std::vector<uint8_t> code = {op(ScriptOp::Load),  0, op(ScriptOp::Push8), 1, op(ScriptOp::Add), op(ScriptOp::Dup),
+                                 op(ScriptOp::Store), 0, op(ScriptOp::Push32)};
+    for (size_t shift = 0; shift < sizeof(BENCH_ITERATIONS) * 8; shift += 8) {
+        code.push_back(static_cast<uint8_t>(BENCH_ITERATIONS >> shift));
+    }
+    code.insert(code.end(), {op(ScriptOp::Lt), op(ScriptOp::Jnz), 0, 0, op(ScriptOp::Halt)});
+    TEST_ASSERT_NULL(load(vm, image(code, 1)));
+
+    uint64_t executed = 0;
+    uint32_t ticks = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (vm.state() == ScriptState::Running) {
+        executed += vm.run(host, ticks++ * 16, TICK_BUDGET);
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    TEST_ASSERT_TRUE(vm.state() == ScriptState::Halted);
+    TEST_ASSERT_EQUAL_INT32(BENCH_ITERATIONS, vm.global(0));
+    TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(BENCH_ITERATIONS) * 8 + 1, executed);
+
+    char line[96];
+    snprintf(line, sizeof(line), "%llu instructions in %.1f ms, %.1f M instructions/s",
+             static_cast<unsigned long long>(executed), elapsed * 1e3, static_cast<double>(executed) / elapsed / 1e6);
+    TEST_MESSAGE(line);
+}
+
+auto main() -> int {
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_bad_files);
+    RUN_TEST(test_rejects_bad_code);
+    RUN_TEST(test_runs_to_halt);
+    RUN_TEST(test_budget_ends_the_tick);
+    RUN_TEST(test_yield_and_sleep);
+    RUN_TEST(test_runtime_faults);
+    RUN_TEST(test_overflowing_division_wraps);
+    RUN_TEST(test_draws_reach_the_host);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
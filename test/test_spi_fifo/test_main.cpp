@@ -0,0 +1,192 @@
+#include <unity.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "display/SpiFifo.h"
+
+/**
+ * @brief Host stand-in for the HSPI data buffer (W0-W15) and its command register
+ *
+ * kick() records the bytes the engine would shift out: the first bitLength / 8 bytes of the data buffer, each
+ * register LSB byte first. Like the full-duplex hardware, it then overwrites the buffer with what MISO read
+ */
+struct MockSpiRegs {
+    static std::array<uint32_t, SPI_FIFO_WORDS> w;
+    static uint32_t bitLength;
+    static bool busy;
+    static bool loadWhileBusy;
+    static std::vector<std::vector<uint8_t>> bursts;
+
+    static void reset() {
+        w.fill(0);
+        bitLength = 0;
+        busy = false;
+        loadWhileBusy = false;
+        bursts.clear();
+    }
+
+    static void waitIdle() { busy = false; }
+
+    static void setBitLength(uint32_t bits) {
+        loadWhileBusy |= busy;
+        bitLength = bits;
+    }
+
+    static void load(uint32_t index, uint32_t word) {
+        TEST_ASSERT_LESS_THAN_UINT32(SPI_FIFO_WORDS, index);
+        loadWhileBusy |= busy;
+        w[index] = word;
+    }
+
+    static void kick() {
+        TEST_ASSERT_EQUAL_UINT32(0, bitLength % 8U);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(SPI_FIFO_BYTES * 8U, bitLength);
+
+        std::vector<uint8_t> burst;
+        for (uint32_t i = 0; i < bitLength / 8U; ++i) {
+            burst.push_back(static_cast<uint8_t>(w[i / 4U] >> (8U * (i % 4U))));
+        }
+        bursts.push_back(burst);
+        w.fill(0xFFFFFFFFU);
+        busy = true;
+    }
+
+    static auto stream() -> std::vector<uint8_t> {
+        std::vector<uint8_t> all;
+        for (const std::vector<uint8_t>& burst : bursts) {
+            all.insert(all.end(), burst.begin(), burst.end());
+        }
+        return all;
+    }
+};
+
+std::array<uint32_t, SPI_FIFO_WORDS> MockSpiRegs::w{};
+uint32_t MockSpiRegs::bitLength = 0;
+bool MockSpiRegs::busy = false;
+bool MockSpiRegs::loadWhileBusy = false;
+std::vector<std::vector<uint8_t>> MockSpiRegs::bursts;
+
+using MockFifo = SpiFifoWriter<MockSpiRegs>;
+
+static auto bigEndian(const std::vector<uint16_t>& pixels) -> std::vector<uint8_t> {
+    std::vector<uint8_t> bytes;
+    for (uint16_t pixel : pixels) {
+        bytes.push_back(static_cast<uint8_t>(pixel >> 8U));
+        bytes.push_back(static_cast<uint8_t>(pixel));
+    }
+    return bytes;
+}
+
+static void assertStream(const std::vector<uint8_t>& expected) {
+    const std::vector<uint8_t> actual = MockSpiRegs::stream();
+    TEST_ASSERT_EQUAL_size_t(expected.size(), actual.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), actual.data(), expected.size());
+    TEST_ASSERT_FALSE(MockSpiRegs::loadWhileBusy);
+    TEST_ASSERT_FALSE(MockSpiRegs::busy);
+}
+
+void setUp() { MockSpiRegs::reset(); }
+
+void tearDown() {}
+
+void test_pack_bytes_zero_fills_the_tail() {
+    const std::array<uint8_t, 3> data = {0x11, 0x22, 0x33};
+    TEST_ASSERT_EQUAL_HEX32(0x00332211U, SpiFifoPack::bytes(data.data(), 3));
+}
+
+void test_pack_pixels_msb_first() {
+    TEST_ASSERT_EQUAL_HEX32(0xCDABF800U, SpiFifoPack::pixels(0x00F8, 0xABCD));
+    TEST_ASSERT_EQUAL_HEX32(0x34123412U, SpiFifoPack::repeat(0x1234));
+}
+
+void test_write_bytes_tail_packing() {
+    std::vector<uint8_t> data(7);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(0xA0 + i);
+    }
+
+    MockFifo::writeBytes(data.data(), static_cast<uint32_t>(data.size()));
+
+    TEST_ASSERT_EQUAL_size_t(1, MockSpiRegs::bursts.size());
+    assertStream(data);
+}
+
+void test_write_bytes_across_fifo_boundary() {
+    std::vector<uint8_t> data(SPI_FIFO_BYTES * 2 + 5);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7U);
+    }
+
+    MockFifo::writeBytes(data.data(), static_cast<uint32_t>(data.size()));
+
+    TEST_ASSERT_EQUAL_size_t(3, MockSpiRegs::bursts.size());
+    TEST_ASSERT_EQUAL_size_t(SPI_FIFO_BYTES, MockSpiRegs::bursts[0].size());
+    TEST_ASSERT_EQUAL_size_t(5, MockSpiRegs::bursts[2].size());
+    assertStream(data);
+}
+
+void test_write_pixels_odd_length() {
+    const std::vector<uint16_t> pixels = {0xF800, 0x07E0, 0x001F};
+
+    MockFifo::writePixels(pixels.data(), static_cast<uint32_t>(pixels.size()));
+
+    TEST_ASSERT_EQUAL_size_t(1, MockSpiRegs::bursts.size());
+    assertStream(bigEndian(pixels));
+}
+
+void test_write_pixels_odd_tail_after_full_burst() {
+    std::vector<uint16_t> pixels(SPI_FIFO_BYTES / 2 + 3);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<uint16_t>(0x1000 + i * 0x0101);
+    }
+
+    MockFifo::writePixels(pixels.data(), static_cast<uint32_t>(pixels.size()));
+
+    TEST_ASSERT_EQUAL_size_t(2, MockSpiRegs::bursts.size());
+    TEST_ASSERT_EQUAL_size_t(6, MockSpiRegs::bursts[1].size());
+    assertStream(bigEndian(pixels));
+}
+
+void test_write_repeat_across_fifo_boundary() {
+    const uint32_t count = SPI_FIFO_BYTES / 2 + 1;
+
+    MockFifo::writeRepeat(0xBEEF, count);
+
+    // The second burst is one pixel: the pattern has to survive the data buffer being overwritten by MISO
+    TEST_ASSERT_EQUAL_size_t(2, MockSpiRegs::bursts.size());
+    TEST_ASSERT_EQUAL_size_t(2, MockSpiRegs::bursts[1].size());
+    assertStream(bigEndian(std::vector<uint16_t>(count, 0xBEEF)));
+}
+
+void test_write_repeat_several_full_bursts() {
+    const uint32_t count = (SPI_FIFO_BYTES / 2) * 3;
+
+    MockFifo::writeRepeat(0x1234, count);
+
+    TEST_ASSERT_EQUAL_size_t(3, MockSpiRegs::bursts.size());
+    assertStream(bigEndian(std::vector<uint16_t>(count, 0x1234)));
+}
+
+void test_zero_length_sends_nothing() {
+    MockFifo::writeBytes(nullptr, 0);
+    MockFifo::writePixels(nullptr, 0);
+    MockFifo::writeRepeat(0xFFFF, 0);
+
+    TEST_ASSERT_EQUAL_size_t(0, MockSpiRegs::bursts.size());
+}
+
+auto main() -> int {
+    UNITY_BEGIN();
+    RUN_TEST(test_pack_bytes_zero_fills_the_tail);
+    RUN_TEST(test_pack_pixels_msb_first);
+    RUN_TEST(test_write_bytes_tail_packing);
+    RUN_TEST(test_write_bytes_across_fifo_boundary);
+    RUN_TEST(test_write_pixels_odd_length);
+    RUN_TEST(test_write_pixels_odd_tail_after_full_burst);
+    RUN_TEST(test_write_repeat_across_fifo_boundary);
+    RUN_TEST(test_write_repeat_several_full_bursts);
+    RUN_TEST(test_zero_length_sends_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,76 @@
+#include <unity.h>
+
+#include <cstdint>
+
+#include "display/Starfield.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * @brief Project every star of the spread, at the far and the near depth, and check each sample is hidden or lands
+ * inside the sample grid starRow() writes to
+ */
+static void assertInsideGrid(int32_t width, int32_t height, int32_t step) {
+    const int32_t columns = (width + step - 1) / step;
+    const int32_t rows = (height + step - 1) / step;
+    uint32_t shown = 0;
+
+    for (const int32_t depth : {STAR_DEPTH, STAR_DEPTH / 2, STAR_NEAR}) {
+        for (int32_t starY = -STAR_SPREAD; starY < STAR_SPREAD; starY += 16) {
+            for (int32_t starX = -STAR_SPREAD; starX < STAR_SPREAD; starX += 16) {
+                const Star star{static_cast<int16_t>(starX), static_cast<int16_t>(starY), static_cast<int16_t>(depth)};
+                const StarSample sample = projectStar(star, width, height, step);
+                if (sample.row == STAR_HIDDEN) {
+                    continue;
+                }
+                TEST_ASSERT_TRUE(sample.column >= 0 && sample.column < columns);
+                TEST_ASSERT_TRUE(sample.row >= 0 && sample.row < rows);
+                ++shown;
+            }
+        }
+    }
+
+    TEST_ASSERT_GREATER_THAN_UINT32(0, shown);
+}
+
+void test_tall_area_stays_inside() {
+    for (const int32_t step : {1, 2, 4}) {
+        assertInsideGrid(100, 240, step);
+    }
+}
+
+void test_wide_area_stays_inside() {
+    for (const int32_t step : {1, 2, 4}) {
+        assertInsideGrid(240, 60, step);
+    }
+}
+
+void test_odd_area_stays_inside() {
+    assertInsideGrid(75, 33, 4);
+}
+
+void test_centre_star_lands_in_the_middle() {
+    const StarSample sample = projectStar(Star{0, 0, STAR_DEPTH}, 100, 240, 2);
+
+    TEST_ASSERT_EQUAL_INT16(25, sample.column);
+    TEST_ASSERT_EQUAL_INT16(60, sample.row);
+    TEST_ASSERT_EQUAL_UINT8(STAR_MIN_LEVEL, sample.level);
+}
+
+void test_near_star_is_hidden() {
+    const StarSample sample = projectStar(Star{0, 0, STAR_NEAR - 1}, 240, 240, 1);
+
+    TEST_ASSERT_EQUAL_INT16(STAR_HIDDEN, sample.row);
+}
+
+auto main() -> int {
+    UNITY_BEGIN();
+    RUN_TEST(test_tall_area_stays_inside);
+    RUN_TEST(test_wide_area_stays_inside);
+    RUN_TEST(test_odd_area_stays_inside);
+    RUN_TEST(test_centre_star_lands_in_the_middle);
+    RUN_TEST(test_near_star_is_hidden);
+    return UNITY_END();
+}